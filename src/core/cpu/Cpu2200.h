@@ -4,8 +4,11 @@
 #define _INCLUDE_CPU2200_H_
 
 #include "../system/w2200.h"
+#include <map>
 
 class Scheduler;
+class StateReader;
+class StateWriter;
 class Timer;
 
 // ============================= base class =============================
@@ -23,8 +26,8 @@ public:
     // true=hard reset, false=soft reset
     virtual void reset(bool hard_reset) noexcept = 0;
 
-    // indicates if cpu is running or halted
-    enum { CPU_RUNNING=0, CPU_HALTED=1 };
+    // indicates if cpu is running, halted, or stopped by the debugger
+    enum { CPU_RUNNING=0, CPU_HALTED=1, CPU_STOPPED=2 };
     int status() const noexcept { return m_status; }
 
     // the disk controller is odd in that it uses the AB bus to signal some
@@ -55,6 +58,11 @@ public:
     // I know it is used for is when the keyboard HALT key is pressed.
     virtual void halt() noexcept = 0;
 
+    // save or restore the complete cpu state (registers, memory, and the
+    // writable control store); see IoCard::saveState()
+    virtual bool saveState(StateWriter &) const { return false; }
+    virtual bool restoreState(StateReader &) { return false; }
+
 protected:
     int m_status = CPU_HALTED;  // whether the cpu is running or halted
 
@@ -185,14 +193,66 @@ public:
     void  ioCardCbIbs(int data) override;
     int   execOneOp() override;  // simulate one instruction
     void  halt() noexcept override;
+    bool  saveState(StateWriter &out) const override;
+    bool  restoreState(StateReader &in) override;
 
     // ---- class-specific members: ----
 
+    // debugger support.  a breakpoint swaps the predecoded op of a ucode
+    // word for a trap op, and writes are checked only if they land in a
+    // page of RAM holding a watchpoint, so nothing is slowed down until
+    // the debugger actually sets something.
+    enum dbg_stop_t {
+        DBG_NOT_STOPPED,
+        DBG_STOP_REQUEST,       // dbgStop() was called
+        DBG_STOP_BREAK,         // reached a breakpoint
+        DBG_STOP_WATCH,         // the previous op wrote to a watchpoint
+        DBG_STOP_STEP           // dbgStep() finished
+    };
+    struct dbg_stop_info_t {
+        int    reason;          // dbg_stop_t
+        uint16 ic;              // breakpoint, or ic of the op which wrote
+        int    addr;            // watch: RAM byte address written
+        uint8  old_value;       // watch: value before the write
+        uint8  new_value;       // watch: value written
+    };
+
+    // breakpoints are on ucode addresses
+    bool setBreakpoint(uint16 ic);
+    bool clearBreakpoint(uint16 ic);
+    std::vector<uint16> getBreakpoints() const;
+
+    // watchpoints are on byte addresses of m_ram (ie, after bank mapping)
+    bool setWatchpoint(int addr, int len);
+    bool clearWatchpoint(int addr);
+    std::vector<std::pair<int,int>> getWatchpoints() const;  // (addr, len)
+
+    // stop before the next op, resume, or perform one op while stopped
+    void dbgStop() noexcept;
+    void dbgContinue() noexcept;
+    void dbgStep();
+    const dbg_stop_info_t& dbgStopInfo() const noexcept { return m_dbg_stop; }
+
+    // for display by the debugger
+    std::string dbgFormatState() const;
+    int    dbgReadRam(int addr) const noexcept;     // -1 if out of range
+    int    dbgRamSize() const noexcept { return m_mem_size; }
+    uint32 dbgReadUcode(uint16 addr) const noexcept;
+
 private:
     // ---- member functions ----
     // predecode uinstruction and write it to store
     void writeUcode(uint16 addr, uint32 uop, bool force=false) noexcept;
 
+    // redo the loop acceleration tags which the word at addr can affect
+    void retagAccel(uint16 addr) noexcept;
+
+    // debugger internals
+    int  dbgTrap();
+    void dbgWatchWrite(int addr, int value);
+    void armTrap(uint16 ic) noexcept;
+    void disarmTrap(uint16 ic) noexcept;
+
     // dump the most important contents of the uP state
     void dumpState(bool full_dump);
 
@@ -208,6 +268,24 @@ private:
     // this callback occurs when the 30 ms timeslicing one-shot times out.
     void oneShot30msCallback() noexcept;
 
+#if VP_BOOT_ACCEL || VP_LOOP_ACCEL
+    // identify a loop starting at the given address which can be run
+    // natively.  returns an accel_t.
+    int accelKind(uint16 head) const noexcept;
+
+    // run passes of the loop at ic natively.
+    // returns the ns consumed, or 0 to have the op interpreted normally.
+    int accelLoop(int kind) noexcept;
+#endif
+#if VP_BOOT_ACCEL
+    int bootAccelClear() noexcept;
+    int bootAccelTest() noexcept;
+#endif
+#if VP_LOOP_ACCEL
+    int accelCopy(bool limit_form) noexcept;
+    int accelCompare() noexcept;
+#endif
+
 #ifdef HAVE_FILE_DUMP
     void dumpRam(const std::string &filename);
 #endif
@@ -225,13 +303,20 @@ private:
     std::shared_ptr<Scheduler>  m_scheduler;   // shared system timing scheduler object
     std::shared_ptr<Timer>      m_tmr_30ms;    // time slice 30 ms one shot
 
+    // the microstore is kept twice.  m_ucode holds everything execOneOp()
+    // needs, already pulled out of the word, so the words the OS actually
+    // runs stay in the host's cache.  m_ucode_raw holds the 24b words as
+    // written, for RCM, the disassembler, and saved state.
     struct ucode_t {
-        uint32 ucode;       // raw ucode word (really 24b)
-                            // upper 8b are used to hold flags
         uint8  op;          // predecode: specific instruction
+        uint8  flags;       // predecode: operand fetch, carry op, accel kind
+        uint8  ab;          // a field [7:4], b field [3:0]
+        uint8  cd;          // Hb Ha [7:6], d field [5:4], c field [3:0]
+        uint8  imm;         // predecode: immediate, aux index, or CIO s,t
         uint8  p8;          // predecode: instruction specific
         uint16 p16;         // predecode: instruction specific
     } m_ucode[MAX_UCODE];
+    uint32 m_ucode_raw[MAX_UCODE];  // raw ucode words (24b)
     int m_ucode_words;      // number of implemented words
 
     // main memory
@@ -260,6 +345,23 @@ private:
 
     // debugging feature
     bool m_dbg = false;
+
+    // debugger state.  each trap is a breakpoint, a one-time stop planted
+    // after a watchpoint write, or both.
+    struct trap_t {
+        ucode_t saved;          // the word the trap op replaced
+        bool    user;           // a breakpoint
+        bool    once;           // one-time stop
+    };
+    std::map<uint16, trap_t> m_traps;
+    bool m_dbg_resume = false;  // perform the op under the trap at ic once
+    dbg_stop_info_t m_dbg_stop = { DBG_NOT_STOPPED, 0, 0, 0, 0 };
+
+    // one flag per page of RAM; null if there are no watchpoints
+    static const int WATCH_PAGE_SHIFT = 8;
+    std::vector<uint8> m_watch_pages;
+    uint8 *m_watch_map = nullptr;
+    std::vector<std::pair<int,int>> m_watches;  // (addr, len)
 };
 
 // microcode disassembly utilities
@@ -13,11 +13,15 @@
 #include "Cpu2200.h"
 #include "../io/IoCardKeyboard.h"
 #include "../system/Scheduler.h"
+#include "../system/StateStream.h"
 #include "../../gui/system/Ui.h"
 #include "../../platform/common/host.h"             // for dbglog
 #include "../system/system2200.h"
 #include "../system/ucode_2200.h"
 
+#include <algorithm>
+#include <cstdio>
+
 // control which functions get inlined
 // FIXME: it doesn't work, becuse static func can't access members
 #define INLINE_STORE_C 1
@@ -99,6 +103,7 @@ enum op_t {
     // misc
     OP_PECM,            // bad control memory parity
     OP_ILLEGAL,         // illegal instruction
+    OP_BREAK,           // debugger trap
 
     // register instructions
     OP_OR,  OP_ORX,
@@ -151,11 +156,122 @@ enum op_t {
 
 };
 
-static const uint32 FETCH_B  = 0x80000000;  // load b_op according to uop[3:0]
-static const uint32 FETCH_A  = 0x40000000;  // load a_op according to uop[7:4]
-static const uint32 FETCH_AB = 0xC0000000;  // fetch a_op and b_op
-static const uint32 FETCH_X  = 0x20000000;  // get a_op, a_op2, b_op, b_op2
-static const uint32 FETCH_CY = 0x10000000;  // perform CY operation
+// time each op takes, in ns, indexed by op_t.  the basic cycle is 600 ns;
+// a few ops take longer.  the time depends only on the op, so execOneOp()
+// charges it with a lookup, and a timing correction is an edit here.
+// each entry names its op, so the checks below catch a table which has
+// fallen out of step with op_t.
+struct op_time_t {
+    op_t op;
+    int  ns;
+};
+
+static constexpr op_time_t op_ns[] = {
+
+    // misc
+    { OP_PECM,     600 },
+    { OP_ILLEGAL,    0 },       // halts instead
+    { OP_BREAK,      0 },       // dbgTrap() decides
+
+    // register instructions
+    { OP_OR,   600 }, { OP_ORX,   600 },
+    { OP_XOR,  600 }, { OP_XORX,  600 },
+    { OP_AND,  600 }, { OP_ANDX,  600 },
+    { OP_SC,   600 }, { OP_SCX,   600 },
+    { OP_DAC,  600 }, { OP_DACX,  600 },
+    { OP_DSC,  600 }, { OP_DSCX,  600 },
+    { OP_AC,   600 }, { OP_ACX,   600 },
+    { OP_M,    600 }, { OP_MX,    600 },
+    { OP_SH,   600 }, { OP_SHX,   600 },
+
+    // register immediate instructions
+    { OP_ORI,  600 }, { OP_XORI,  600 }, { OP_ANDI,  600 }, { OP_AI,   600 },
+    { OP_DACI, 600 }, { OP_DSCI,  600 }, { OP_ACI,   600 }, { OP_MI,   600 },
+
+    // mini instructions
+    { OP_TAP,      600 },
+    { OP_TPA,      600 },
+    { OP_XPA,      600 },
+    { OP_TPS,      600 },
+    { OP_TSP,      600 },
+    { OP_RCM,     1600 },
+    { OP_WCM,     1600 },
+    { OP_SR,       800 },
+    { OP_CIO,      600 },
+    { OP_LPI,     1100 },
+
+    // mask branch instructions
+    { OP_BT,   600 }, { OP_BF,    600 }, { OP_BEQ,   600 }, { OP_BNE,  600 },
+
+    // register branch instructions
+    { OP_BLR,  600 }, { OP_BLRX,  800 },
+    { OP_BLER, 600 }, { OP_BLERX, 800 },
+    { OP_BER,  600 },
+    { OP_BNR,  600 },
+
+    // branch instructions
+    { OP_SB,   600 },
+    { OP_B,    600 }
+};
+
+static_assert(sizeof(op_ns)/sizeof(op_ns[0]) == OP_B+1,
+              "op_ns[] needs one entry per op_t");
+
+static constexpr bool
+opNsInOrder()
+{
+    for (int i = 0; i <= OP_B; i++) {
+        if (op_ns[i].op != i) {
+            return false;
+        }
+    }
+    return true;
+}
+static_assert(opNsInOrder(), "op_ns[] must list the ops in op_t order");
+
+// ucode_t.flags
+static const uint8 FETCH_B  = 0x80;  // load b_op according to uop[3:0]
+static const uint8 FETCH_A  = 0x40;  // load a_op according to uop[7:4]
+static const uint8 FETCH_AB = 0xC0;  // fetch a_op and b_op
+static const uint8 FETCH_X  = 0x20;  // get a_op, a_op2, b_op, b_op2
+static const uint8 FETCH_CY = 0x10;  // perform CY operation
+static const uint8 CY_SET   = 0x08;  // the CY operation sets carry
+static const uint8 ACCEL    = 0x07;  // head of a loop run natively
+
+// fields of a predecoded ucode word
+#define UOP_A_FIELD(u)  (((u).ab >> 4) & 0xF)
+#define UOP_B_FIELD(u)  (((u).ab >> 0) & 0xF)
+#define UOP_C_FIELD(u)  (((u).cd >> 0) & 0xF)
+#define UOP_D_FIELD(u)  (((u).cd >> 4) & 0x3)
+#define UOP_HBHA(u)     (((u).cd >> 6) & 0x3)
+#define UOP_AUX_IDX(u)  ((u).imm)
+
+#if VP_BOOT_ACCEL || VP_LOOP_ACCEL
+// the kinds of loops which accelLoop() can run natively.
+// the kind is kept in the ACCEL flags of the loop's first ucode word.
+enum accel_t {
+    ACCEL_NONE,
+    ACCEL_BOOT_CLEAR,   // boot ROM zero fill of one 64 KB bank
+    ACCEL_BOOT_TEST,    // boot ROM address pattern test of one bank
+    ACCEL_COPY_PL,      // byte copy, until PL reaches a register value
+    ACCEL_COPY_LIMIT,   // byte copy, until PC reaches a register pair value
+    ACCEL_COMPARE       // byte compare, until a difference or PC limit
+};
+#define ACCEL_KIND(u) ((u).flags & ACCEL)
+
+// longest recognized loop, in ucode words
+static const int ACCEL_MAX_LEN = 5;
+
+// each call performs as many loop passes as fit in this many ns.
+// system2200 treats a longer op as an error.
+static const int ACCEL_SLICE_NS = 10000;
+#endif
+
+#if VP_BOOT_ACCEL
+// boot ROM loops which bootAccelClear/Test() know how to run natively
+#define ACCEL_CLEAR_LOOP 0x80CF         // zero fill of one 64 KB bank
+#define ACCEL_TEST_LOOP  0x8216         // address pattern test of one bank
+#endif
 
 // 10b page branch target address
 #define PAGE_BR(uop) \
@@ -195,7 +311,13 @@ Cpu2200vp::writeUcode(uint16 addr, uint32 uop, bool force) noexcept
         return;
     }
 
-    m_ucode[addr].ucode = uop;
+    // the fields most ops use are kept whatever the op; the ones which
+    // depend on the op are filled in below
+    m_ucode_raw[addr]   = uop;
+    m_ucode[addr].flags = 0;
+    m_ucode[addr].ab    = static_cast<uint8>(uop & 0xFF);           // a, b
+    m_ucode[addr].cd    = static_cast<uint8>((uop >> 8) & 0x3F);    // c, d
+    m_ucode[addr].imm   = 0;    // default
     m_ucode[addr].p8    = 0;    // default
     m_ucode[addr].p16   = 0;    // default
 
@@ -213,7 +335,7 @@ Cpu2200vp::writeUcode(uint16 addr, uint32 uop, bool force) noexcept
     } else if (lpi_op) {
 
         if (d_field == 1) {
-            m_ucode[addr].ucode |= FETCH_B;
+            m_ucode[addr].flags |= FETCH_B;
         }
         m_ucode[addr].op  = OP_LPI;
         m_ucode[addr].p16 = static_cast<uint16>(
@@ -225,12 +347,14 @@ Cpu2200vp::writeUcode(uint16 addr, uint32 uop, bool force) noexcept
 
         int inc = 0;
 
+        m_ucode[addr].imm = static_cast<uint8>((uop >> 4) & 0x1F);  // aux index
+
         switch ((uop >> 17) & 0xF) {
 
             case 0x5:   // TAP
                 illegal = (uop & 0x7F8000) != 0x0B8000;
                 if (d_field >= 2) {
-                    m_ucode[addr].ucode |= FETCH_B;
+                    m_ucode[addr].flags |= FETCH_B;
                 }
                 m_ucode[addr].op  = OP_TAP;
                 break;
@@ -240,7 +364,7 @@ Cpu2200vp::writeUcode(uint16 addr, uint32 uop, bool force) noexcept
                 inc = ((uop >> 12) & 4)         // sign
                     | ((uop >>  9) & 3);        // offset
                 if (d_field >= 2) {
-                    m_ucode[addr].ucode |= FETCH_B;
+                    m_ucode[addr].flags |= FETCH_B;
                 }
                 m_ucode[addr].op  = OP_TPA;
                 m_ucode[addr].p16 = static_cast<uint16>(inc_map[inc]);
@@ -251,7 +375,7 @@ Cpu2200vp::writeUcode(uint16 addr, uint32 uop, bool force) noexcept
                 inc = ((uop >> 12) & 4)         // sign
                     | ((uop >>  9) & 3);        // offset
                 if (d_field >= 2) {
-                    m_ucode[addr].ucode |= FETCH_B;
+                    m_ucode[addr].flags |= FETCH_B;
                 }
                 m_ucode[addr].op  = OP_XPA;
                 m_ucode[addr].p16 = static_cast<uint16>(inc_map[inc]);
@@ -262,7 +386,7 @@ Cpu2200vp::writeUcode(uint16 addr, uint32 uop, bool force) noexcept
                 inc = ((uop >> 12) & 4)         // sign
                     | ((uop >>  9) & 3);        // offset
                 if (d_field >= 2) {
-                    m_ucode[addr].ucode |= FETCH_B;
+                    m_ucode[addr].flags |= FETCH_B;
                 }
                 m_ucode[addr].op  = OP_TPS;
                 m_ucode[addr].p16 = static_cast<uint16>(inc_map[inc]);
@@ -271,7 +395,7 @@ Cpu2200vp::writeUcode(uint16 addr, uint32 uop, bool force) noexcept
             case 0x6:   // TSP
                 illegal = (uop & 0x7F8800) != 0x0D8000;
                 if (d_field >= 2) {
-                    m_ucode[addr].ucode |= FETCH_B;
+                    m_ucode[addr].flags |= FETCH_B;
                 }
                 m_ucode[addr].op  = OP_TSP;
                 break;
@@ -286,7 +410,7 @@ Cpu2200vp::writeUcode(uint16 addr, uint32 uop, bool force) noexcept
                 } else if ((uop & 0x7F8C00) == 0x078000) {
                     // perform subroutine return
                     if (d_field >= 2) {
-                        m_ucode[addr].ucode |= FETCH_B;
+                        m_ucode[addr].flags |= FETCH_B;
                     }
                     m_ucode[addr].op  = OP_SR;
                 } else {
@@ -298,6 +422,9 @@ Cpu2200vp::writeUcode(uint16 addr, uint32 uop, bool force) noexcept
             case 0xB:   // CIO (control input/output)
                 illegal = (uop & 0x7FB000) != 0x178000;
                 m_ucode[addr].op  = OP_CIO;
+                m_ucode[addr].imm = static_cast<uint8>(
+                                      ((uop >> 4) & 0x80)      // s: [11]   -> [7]
+                                    | ((uop >> 4) & 0x7F));    // t: [10:4] -> [6:0]
                 break;
 
             default:
@@ -309,13 +436,15 @@ Cpu2200vp::writeUcode(uint16 addr, uint32 uop, bool force) noexcept
 
         const int x_field = (uop >> 17) & 1;
 
+        m_ucode[addr].cd |= static_cast<uint8>(((uop >> 18) & 3) << 6);   // HbHa
+
         if (x_field != 0) {
             illegal = (c_field == 9) || (c_field == 10) || (c_field == 11);
-            m_ucode[addr].ucode |= FETCH_X;
+            m_ucode[addr].flags |= FETCH_X;
             m_ucode[addr].op  = OP_SHX;
         } else {
             illegal = (c_field == 10) || (c_field == 11);
-            m_ucode[addr].ucode |= FETCH_AB;
+            m_ucode[addr].flags |= FETCH_AB;
             m_ucode[addr].op  = OP_SH;
             m_ucode[addr].p16 = static_cast<uint16>(PC_ADJUST(a_field));
         }
@@ -336,19 +465,25 @@ Cpu2200vp::writeUcode(uint16 addr, uint32 uop, bool force) noexcept
             case 0x05:  // DSC: decimal subtract w/ carry
             case 0x06:  // AC: binary add w/ carry
                 if (((uop >> 14) & 3) >= 2) {
-                    m_ucode[addr].ucode |= FETCH_CY;    // clear or set
+                    m_ucode[addr].flags |= FETCH_CY;    // clear or set
+                    if ((uop & 0x4000) != 0) {
+                        m_ucode[addr].flags |= CY_SET;
+                    }
                 }
                 [[fallthrough]];
             case 0x07:  // M: multiply
                 illegal = (uop & 0x010000) != 0x000000;
+                if (op == 0x07) {
+                    m_ucode[addr].cd |= static_cast<uint8>(((uop >> 14) & 3) << 6);
+                }
                 x_field = (uop >> 17) & 1;
                 if (x_field != 0) {
                     illegal |= (c_field == 9) || (c_field == 10) || (c_field == 11);
-                    m_ucode[addr].ucode |= FETCH_X;
+                    m_ucode[addr].flags |= FETCH_X;
                     m_ucode[addr].op  = static_cast<uint8>(OP_ORX + 2*op);
                 } else {
                     illegal |= (c_field == 10) || (c_field == 11);
-                    m_ucode[addr].ucode |= FETCH_AB;
+                    m_ucode[addr].flags |= FETCH_AB;
                     m_ucode[addr].op  = static_cast<uint8>(OP_OR + 2*op);
                     m_ucode[addr].p16 = static_cast<uint16>(PC_ADJUST(a_field));
                 }
@@ -365,8 +500,15 @@ Cpu2200vp::writeUcode(uint16 addr, uint32 uop, bool force) noexcept
             case 0x0E:  // ACI: binary add immediate w/ carry
             case 0x0F:  // MI: binary multiply immediate
                 illegal |= (c_field == 10) || (c_field == 11);
-                m_ucode[addr].ucode |= FETCH_B;
+                m_ucode[addr].flags |= FETCH_B;
                 m_ucode[addr].op  = static_cast<uint8>(OP_ORI + (op-0x08));
+                if (op == 0x0F) {
+                    // MI has a 4b immediate; uop[15] picks the half of B
+                    m_ucode[addr].imm = static_cast<uint8>(a_field);
+                    m_ucode[addr].cd |= static_cast<uint8>(((uop >> 15) & 1) << 7);
+                } else {
+                    m_ucode[addr].imm = static_cast<uint8>(IMM8(uop));
+                }
                 break;
 
         // register branch instructions:
@@ -377,12 +519,12 @@ Cpu2200vp::writeUcode(uint16 addr, uint32 uop, bool force) noexcept
             case 0x16:                  // BNE: branch if R[AAAA] != R[BBBB]
                 x_field = (uop >> 18) & 1;
                 if (x_field != 0) {
-                    m_ucode[addr].ucode |= FETCH_X;
+                    m_ucode[addr].flags |= FETCH_X;
                     m_ucode[addr].op  = static_cast<uint8>(
                                                 (op <= 0x11) ? OP_BLRX
                                                              : OP_BLERX);
                 } else {
-                    m_ucode[addr].ucode |= FETCH_AB;
+                    m_ucode[addr].flags |= FETCH_AB;
                     m_ucode[addr].op  = static_cast<uint8>(
                                                 (op <= 0x11) ? OP_BLR
                                               : (op <= 0x13) ? OP_BLER
@@ -407,22 +549,22 @@ Cpu2200vp::writeUcode(uint16 addr, uint32 uop, bool force) noexcept
         // mask branch instructions:
 
             case 0x18: case 0x19:       // branch if true
-                m_ucode[addr].ucode |= FETCH_B;
+                m_ucode[addr].flags |= FETCH_B;
                 m_ucode[addr].op  = OP_BT;
                 m_ucode[addr].p16 = PAGE_BR(uop);
                 break;
             case 0x1A: case 0x1B:       // branch if false
-                m_ucode[addr].ucode |= FETCH_B;
+                m_ucode[addr].flags |= FETCH_B;
                 m_ucode[addr].op  = OP_BF;
                 m_ucode[addr].p16 = PAGE_BR(uop);
                 break;
             case 0x1C: case 0x1D:       // branch if = to mask
-                m_ucode[addr].ucode |= FETCH_B;
+                m_ucode[addr].flags |= FETCH_B;
                 m_ucode[addr].op  = OP_BEQ;
                 m_ucode[addr].p16 = PAGE_BR(uop);
                 break;
             case 0x1E: case 0x1F:       // branch if != to mask
-                m_ucode[addr].ucode |= FETCH_B;
+                m_ucode[addr].flags |= FETCH_B;
                 m_ucode[addr].op  = OP_BNE;
                 m_ucode[addr].p16 = PAGE_BR(uop);
                 break;
@@ -432,17 +574,122 @@ Cpu2200vp::writeUcode(uint16 addr, uint32 uop, bool force) noexcept
                 break;
         }
 
+        if (op >= 0x18) {
+            // mask branches: the mask is uop[7:4]; uop[18] picks the half of B
+            m_ucode[addr].imm = static_cast<uint8>(a_field);
+            m_ucode[addr].cd |= static_cast<uint8>(((uop >> 18) & 1) << 7);
+        }
+
     } // all other ops
 
     if (illegal) {
-        m_ucode[addr].ucode &= 0x00FFFFFF;      // clear flags we might have set
+        m_ucode[addr].flags  = 0;               // clear flags we might have set
         m_ucode[addr].op     = OP_ILLEGAL;
         m_ucode[addr].p8     = 0;
         m_ucode[addr].p16    = 0;
     }
+
+    retagAccel(addr);
+
+    // microcode which rewrites itself mustn't wipe out a breakpoint
+    if (!m_traps.empty() && (m_traps.find(addr) != m_traps.end())) {
+        armTrap(addr);
+    }
+}
+
+
+// this word may complete or break a loop starting a few words back
+void
+Cpu2200vp::retagAccel(uint16 addr) noexcept
+{
+#if VP_BOOT_ACCEL || VP_LOOP_ACCEL
+    for (int head = addr - ACCEL_MAX_LEN + 1; head <= addr; head++) {
+        if (head >= 0) {
+            const uint16 h = static_cast<uint16>(head);
+            m_ucode[h].flags = static_cast<uint8>((m_ucode[h].flags & ~ACCEL)
+                                                | accelKind(h));
+        }
+    }
+#else
+    (void)addr;
+#endif
 }
 
 
+#if VP_BOOT_ACCEL || VP_LOOP_ACCEL
+// ------------------------------------------------------------------------
+// recognize the start of a loop which accelLoop() can run natively.
+// called from writeUcode(), so the ucode store is only inspected when it
+// changes.  returns an accel_t.
+// ------------------------------------------------------------------------
+
+#if VP_LOOP_ACCEL
+// XPA with the given memory operation (1=read, 2=write1)
+#define IS_XPA(u, d) (((u).op == OP_XPA) && (UOP_D_FIELD(u) == (d)))
+
+// register branch comparing a file register pair with PHPL
+#define IS_BLERX_PC(u) (((u).op == OP_BLERX) && (UOP_A_FIELD(u) <= 6) \
+                                             && (UOP_B_FIELD(u) == 8))
+#endif
+
+int
+Cpu2200vp::accelKind(uint16 head) const noexcept
+{
+#if VP_BOOT_ACCEL
+    // the boot ROM can't be rewritten, so its address is enough to know
+    // it is the loop bootAccelClear/Test() expect
+    if (head == ACCEL_CLEAR_LOOP) { return ACCEL_BOOT_CLEAR; }
+    if (head == ACCEL_TEST_LOOP)  { return ACCEL_BOOT_TEST; }
+#endif
+
+#if VP_LOOP_ACCEL
+    if (head > MAX_UCODE - ACCEL_MAX_LEN) {
+        return ACCEL_NONE;
+    }
+    const ucode_t * const u = &m_ucode[head];
+
+    // copy one byte per pass, PC is the destination, AUX[n] the source:
+    //     XPA+1,W1  CH,n              ; mem[PC] = CH, swap PC and AUX[n]
+    //     XPA+1,R   ,n                ; CH CL = mem[PC], swap back
+    // followed by either of
+    //     BNR       Fr,PL,head
+    // or
+    //     BLERX     FxFx,PHPL,exit
+    //     B         head
+    if (   IS_XPA(u[0], 2) && (UOP_B_FIELD(u[0]) == 11)      // CH
+        && IS_XPA(u[1], 1) && (UOP_AUX_IDX(u[1]) == UOP_AUX_IDX(u[0]))) {
+        if (   (u[2].op == OP_BNR) && (UOP_A_FIELD(u[2]) <= 7)
+            && (UOP_B_FIELD(u[2]) == 8) && (u[2].p16 == head)) {
+            return ACCEL_COPY_PL;
+        }
+        if (IS_BLERX_PC(u[2]) && (u[3].op == OP_B) && (u[3].p16 == head)) {
+            return ACCEL_COPY_LIMIT;
+        }
+    }
+
+    // compare PC and AUX[n] byte strings, stopping at a PC limit:
+    //     BLERX     FxFx,PHPL,exit
+    //     XPA+1,R   ,n
+    //     MV        CH,Fm
+    //     XPA+1,R   ,n
+    //     BER       Fm,CH,head
+    if (   IS_BLERX_PC(u[0])
+        && IS_XPA(u[1], 1)
+        && (u[2].op == OP_ORI) && (u[2].imm == 0)
+        && (UOP_B_FIELD(u[2]) == 11) && (UOP_C_FIELD(u[2]) <= 7)
+        && (UOP_D_FIELD(u[2]) == 0)
+        && IS_XPA(u[3], 1) && (UOP_AUX_IDX(u[3]) == UOP_AUX_IDX(u[1]))
+        && (u[4].op == OP_BER) && (UOP_A_FIELD(u[4]) == UOP_C_FIELD(u[2]))
+        && (UOP_B_FIELD(u[4]) == 11) && (u[4].p16 == head)) {
+        return ACCEL_COMPARE;
+    }
+#endif
+
+    return ACCEL_NONE;
+}
+#endif
+
+
 // ------------------------------------------------------------------------
 // instruction interpretation subroutines
 // ------------------------------------------------------------------------
@@ -665,17 +912,23 @@ decimalSub(int a_op, int b_op, int ci) noexcept
 // there are two modes: write 1 and write 2
 // write1 means write to the specified address.
 // write2 means write to (address ^ 1).
+// writes to a page holding a debugger watchpoint are reported first.
 #define INLINE_MEM_WRITE(addr,wr_value,write2)            \
     do {                                                  \
         int la = (addr);                                  \
         if (la < 8192 && !m_cpu.bsr_mode) {               \
             la ^= (write2);                               \
-            m_ram[la] = static_cast<uint8>(wr_value);     \
         } else if (la + m_cpu.bank_offset < m_mem_size) { \
             la += m_cpu.bank_offset;                      \
             la ^= (write2);                               \
-            m_ram[la] = static_cast<uint8>(wr_value);     \
+        } else {                                          \
+            break;  /* no memory there */                 \
+        }                                                 \
+        if (m_watch_map != nullptr                        \
+            && m_watch_map[la >> WATCH_PAGE_SHIFT] != 0) {  \
+            dbgWatchWrite(la, (wr_value));                \
         }                                                 \
+        m_ram[la] = static_cast<uint8>(wr_value);         \
     } while (false)
 
 // return the chosen bits of B and A, returns with the bits
@@ -711,15 +964,15 @@ Cpu2200vp::getHbHa(int HbHa, int a_op, int b_op) const noexcept
 }
 
 
-#define GET_HB(Hb, b_op)               \
-    (((Hb) & 1) ? (((b_op) >> 4) & 0xF)  \
-                : (((b_op) >> 0) & 0xF))
+#define GET_HB(HbHa, b_op)               \
+    (((HbHa) & 2) ? (((b_op) >> 4) & 0xF)  \
+                  : (((b_op) >> 0) & 0xF))
 
 
 // decode the DD field and perform memory rd/wr op if specified
 #define INLINE_PERFORM_DD_OP(uop,wr_val)                               \
     {                                                                  \
-        const int d_field = ((uop) >> 12) & 0x3;                       \
+        const int d_field = UOP_D_FIELD(uop);                          \
         switch (d_field) {                                             \
             case 0: /* nothing */                                      \
                 break;                                                 \
@@ -794,7 +1047,7 @@ Cpu2200vp::Cpu2200vp(std::shared_ptr<Scheduler> scheduler,
         char buff[200];
         uint16 pc;
         for (pc=0x8000; pc < 0x8400; pc++) {
-            dasmOneVpOp(buff, pc, m_ucode[pc].ucode);
+            dasmOneVpOp(buff, pc, m_ucode_raw[pc]);
             dbglog(buff);
         }
     }
@@ -876,6 +1129,7 @@ Cpu2200vp::reset(bool hard_reset) noexcept
     }
 
     m_status = CPU_RUNNING;
+    m_dbg_stop.reason = DBG_NOT_STOPPED;
 }
 
 
@@ -944,16 +1198,413 @@ Cpu2200vp::oneShot30msCallback() noexcept
 }
 
 
+// save everything which isn't rebuilt from the configuration: registers,
+// main memory, and the control store, which the OS loads at boot.
+// a cpu stopped by the debugger, or with breakpoints planted in the
+// control store, isn't saved.
+bool
+Cpu2200vp::saveState(StateWriter &out) const
+{
+    if ((m_status == CPU_STOPPED) || !m_traps.empty() || !m_watches.empty()) {
+        return false;
+    }
+
+    out.put8(m_cpu_subtype);
+    out.put32(m_mem_size);
+    out.put8(m_status);
+
+    out.put16(m_cpu.pc);
+    out.put16(m_cpu.orig_pc);
+    for (auto aux : m_cpu.aux) {
+        out.put16(aux);
+    }
+    out.putBytes(m_cpu.reg, sizeof(m_cpu.reg));
+    out.put16(m_cpu.ic);
+    for (auto ic : m_cpu.icstack) {
+        out.put16(ic);
+    }
+    out.put8(m_cpu.icsp);
+    out.put8(m_cpu.ch);
+    out.put8(m_cpu.cl);
+    out.put8(m_cpu.k);
+    out.put8(m_cpu.ab);
+    out.put8(m_cpu.ab_sel);
+    out.put8(m_cpu.sh);
+    out.put8(m_cpu.sl);
+    out.put8(m_cpu.bsr);
+    out.put64(m_scheduler->timeLeftNs(m_tmr_30ms));
+
+    out.putBytes(m_ram, m_mem_size);
+
+    // only the 24b words; the predecoded fields are derived from them
+    for (int i=0; i < MAX_UCODE; i++) {
+        const uint32 uop = m_ucode_raw[i];
+        out.put8(uop);
+        out.put16(uop >> 8);
+    }
+    return true;
+}
+
+
+bool
+Cpu2200vp::restoreState(StateReader &in)
+{
+    if ((in.get8() != m_cpu_subtype) || (in.get32() != m_mem_size)) {
+        in.fail();
+        return false;
+    }
+    const int status = in.get8();
+    if ((status != CPU_RUNNING) && (status != CPU_HALTED)) {
+        in.fail();
+        return false;
+    }
+
+    m_cpu.pc      = static_cast<uint16>(in.get16());
+    m_cpu.orig_pc = static_cast<uint16>(in.get16());
+    for (auto &aux : m_cpu.aux) {
+        aux = static_cast<uint16>(in.get16());
+    }
+    in.getBytes(m_cpu.reg, sizeof(m_cpu.reg));
+    m_cpu.ic = static_cast<uint16>(in.get16());
+    for (auto &ic : m_cpu.icstack) {
+        ic = static_cast<uint16>(in.get16());
+    }
+    m_cpu.icsp   = in.get8();
+    m_cpu.ch     = static_cast<uint8>(in.get8());
+    m_cpu.cl     = static_cast<uint8>(in.get8());
+    m_cpu.k      = static_cast<uint8>(in.get8());
+    m_cpu.ab     = static_cast<uint8>(in.get8());
+    m_cpu.ab_sel = static_cast<uint8>(in.get8());
+    m_cpu.sh     = static_cast<uint8>(in.get8());
+    m_cpu.sl     = static_cast<uint8>(in.get8());
+    m_cpu.bsr    = static_cast<uint8>(in.get8());
+    updateBankOffset();
+    const int64 tmr_30ms = in.get64();
+
+    in.getBytes(m_ram, m_mem_size);
+
+    for (int i=0; i < MAX_UCODE; i++) {
+        const uint32 lo = static_cast<uint32>(in.get8());
+        const uint32 hi = static_cast<uint32>(in.get16());
+        writeUcode(static_cast<uint16>(i), (hi << 8) | lo, true);
+    }
+
+    if (!in.ok() || (m_cpu.icsp >= STACKSIZE)) {
+        in.fail();
+        return false;
+    }
+
+    m_tmr_30ms = nullptr;
+    if (m_has_oneshot && (tmr_30ms > 0)) {
+        m_tmr_30ms = m_scheduler->createTimer(tmr_30ms,
+                                               [&](){ oneShot30msCallback(); });
+    }
+    m_status = status;
+    m_dbg_stop.reason = DBG_NOT_STOPPED;
+    return true;
+}
+
+
+#if VP_BOOT_ACCEL || VP_LOOP_ACCEL
+// run the loop at m_cpu.ic natively.  returns the ns consumed, or 0 if
+// the op should be interpreted as usual.
+int
+Cpu2200vp::accelLoop(int kind) noexcept
+{
+    // stepping through the loop a pass at a time would skip over
+    // breakpoints and watchpoints
+    if (!m_traps.empty() || (m_watch_map != nullptr)) {
+        return 0;
+    }
+
+    switch (kind) {
+#if VP_BOOT_ACCEL
+        case ACCEL_BOOT_CLEAR: return bootAccelClear();
+        case ACCEL_BOOT_TEST:  return bootAccelTest();
+#endif
+#if VP_LOOP_ACCEL
+        case ACCEL_COPY_PL:    return accelCopy(false);
+        case ACCEL_COPY_LIMIT: return accelCopy(true);
+        case ACCEL_COMPARE:    return accelCompare();
+#endif
+        default:               return 0;
+    }
+}
+#endif
+
+
+#if VP_BOOT_ACCEL
+// ------------------------------------------------------------------------
+// boot ROM loop acceleration
+//
+// with a lot of RAM, the boot ROM spends most of its time in two loops:
+// one clears a 64 KB bank, the other pattern tests one.  the routines
+// below perform whole passes of those loops and leave RAM and the
+// registers exactly as the microcode would have.  anything unusual --
+// a miscompare, a parity error, an address beyond the installed memory --
+// drops back to interpreting the microcode, so the error paths of the ROM
+// are still taken the normal way.
+// ------------------------------------------------------------------------
+
+// time charged for one pass of an accelerated loop.  normally a pass is
+// charged exactly what the microcode would have taken, so only host time is
+// saved.  with misc/fast_boot set, each pass costs this nominal amount
+// instead, which also shortens the boot in emulated (and so, when the cpu is
+// regulated, in real) time.  a real pass is 1.4 to 11 us.
+static constexpr int FAST_BOOT_PASS_NS = 100;
+
+// the loop clears memory from PC up to the end of the 64 KB bank:
+//     80CF: OR,W1     +,,                 ; mem[PC++] = 00
+//     80D0: BLRX      F1F0,PHPL,*-1       ; loop while F1F0 < PC
+int
+Cpu2200vp::bootAccelClear() noexcept
+{
+    const int limit = (m_cpu.reg[1] << 8) | m_cpu.reg[0];
+    const int pass_ns = (system2200::isFastBoot())
+                      ? FAST_BOOT_PASS_NS
+                      : (op_ns[OP_OR].ns + op_ns[OP_BLRX].ns);
+
+    int ns = 0;
+    int pc = m_cpu.pc;
+    do {
+        INLINE_MEM_WRITE(pc, 0x00, 0);
+        pc = (pc + 1) & 0xFFFF;
+        ns += pass_ns;
+    } while ((limit < pc) && (ns + pass_ns <= ACCEL_SLICE_NS));
+
+    m_cpu.pc = static_cast<uint16>(pc);
+    m_cpu.orig_pc = m_cpu.pc;
+    m_cpu.ic = (limit < pc) ? ACCEL_CLEAR_LOOP : ACCEL_CLEAR_LOOP+2;
+    return ns;
+}
+
+
+// the loop walks PC down two bytes at a time to the bottom of the bank.
+// on the first of three passes (F6=0) each word is written with F1F0 and
+// read back; the other two passes only check what was written.  F1F0
+// steps through a sequence which skips the value in F7.
+//     8216: OR,0      -,,F2               ; F2=0, clear carry, PC--
+//     8217: OR        -,,                 ; PC--
+//     8218: BNR       F6,,821B            ; skip the write if F6 != 0
+//     8219: MV,W1     F1,
+//     821A: MV,W2     F0,
+//     821B: SB        836A                ; read back and compare:
+//       836A: MVI,R     00,               ;   CH CL = mem[PC]
+//       836B: BTH       4,SH,836E         ;   parity error
+//       836C: BNR       CH,F1,836E        ;   miscompare
+//       836D: BER       CL,F0,80A7        ;   80A7 is an SR
+//     821C: MV        F1,F0
+//     821D: AI        01,F1,F1
+//     821E: BER       F7,F1,*-1
+//     821F: BNR       F2,PL,8216
+//     8220: BNR       F2,PH,8216
+int
+Cpu2200vp::bootAccelTest() noexcept
+{
+    if ((m_cpu.sh & SH_MASK_PARITY) != 0) {
+        return 0;
+    }
+
+    const bool write_pass = (m_cpu.reg[6] == 0);
+    const bool fast_boot = system2200::isFastBoot();
+    const uint8 skip = m_cpu.reg[7];
+    uint8 f0 = m_cpu.reg[0];
+    uint8 f1 = m_cpu.reg[1];
+    int pc = m_cpu.pc;
+    int ns = 0;
+
+    for (;;) {
+        const int addr = (pc - 2) & 0xFFFF;
+        const bool in_range = (addr < 8192 && !m_cpu.bsr_mode)
+                           || (addr + m_cpu.bank_offset < m_mem_size);
+        const bool skipped = (static_cast<uint8>(f1 + 1) == skip);
+        const uint8 next_f1 = static_cast<uint8>(skipped ? f1 + 2 : f1 + 1);
+
+        int pass_ns = op_ns[OP_OR].ns*2 + op_ns[OP_BNR].ns      // 8216-8218
+                    + (write_pass ? op_ns[OP_OR].ns*2 : 0)      // 8219-821A
+                    + op_ns[OP_SB].ns + op_ns[OP_ORI].ns        // 821B-836A
+                    + op_ns[OP_BT].ns + op_ns[OP_BNR].ns        // 836B-836C
+                    + op_ns[OP_BER].ns + op_ns[OP_SR].ns        // 836D, 80A7
+                    + op_ns[OP_OR].ns                           // 821C
+                    + (op_ns[OP_AI].ns + op_ns[OP_BER].ns)      // 821D-821E
+                        * (skipped ? 2 : 1)
+                    + op_ns[OP_BNR].ns                          // 821F-8220
+                        * (((addr & 0xFF) == 0) ? 2 : 1);
+        if (fast_boot) {
+            pass_ns = FAST_BOOT_PASS_NS;
+        }
+        if (!in_range || (ns + pass_ns > ACCEL_SLICE_NS)) {
+            break;
+        }
+
+        const int ra = INLINE_MAP_ADDRESS(addr);
+        if (write_pass) {
+            INLINE_MEM_WRITE(addr, f1, 0);
+            INLINE_MEM_WRITE(addr, f0, 1);
+        } else if ((m_ram[ra] != f1) || (m_ram[ra ^ 1] != f0)) {
+            break;  // let the microcode report it
+        }
+
+        m_cpu.ch = m_ram[ra];
+        m_cpu.cl = m_ram[ra ^ 1];
+        f0 = f1;
+        f1 = next_f1;
+        pc = addr;
+        ns += pass_ns;
+
+        if (pc == 0) {
+            break;
+        }
+    }
+
+    if (ns == 0) {
+        return 0;
+    }
+
+    m_cpu.reg[0] = f0;
+    m_cpu.reg[1] = f1;
+    m_cpu.reg[2] = 0x00;
+    m_cpu.sh &= ~SH_MASK_CARRY;
+    m_cpu.icstack[m_cpu.icsp] = ACCEL_TEST_LOOP+6;   // left by the SB
+    m_cpu.pc = static_cast<uint16>(pc);
+    m_cpu.orig_pc = m_cpu.pc;
+    m_cpu.ic = (pc != 0) ? ACCEL_TEST_LOOP : ACCEL_TEST_LOOP+11;
+    return ns;
+}
+#endif
+
+
+#if VP_LOOP_ACCEL
+// ------------------------------------------------------------------------
+// string loop acceleration
+//
+// the OS moves and compares strings a byte at a time with tight loops of
+// XPA read/write ops (see accelKind() for the exact forms).  these run
+// the loops pass by pass, doing just what the interpreter would do, but
+// without decoding each op.  overlapping moves and bank mapping behave as
+// before since every byte still goes through the normal address mapping.
+// ------------------------------------------------------------------------
+
+// read the word at addr into CH and CL, like an R memory op
+#define ACCEL_MEM_READ(addr)                    \
+    do {                                        \
+        const int ra = INLINE_MAP_ADDRESS(addr); \
+        m_cpu.ch = m_ram[ra];                   \
+        m_cpu.cl = m_ram[ra ^ 1];               \
+    } while (false)
+
+// swap PC with AUX[idx], leaving PC+inc in AUX[idx], like XPA
+#define ACCEL_XPA(idx, inc)                                             \
+    do {                                                                \
+        const uint16 t = m_cpu.aux[idx];                                \
+        m_cpu.aux[idx] = static_cast<uint16>(m_cpu.pc + (inc));         \
+        m_cpu.pc = t;                                                   \
+    } while (false)
+
+// byte copy loop, ending either on a BNR test of PL or a BLERX PC limit
+int
+Cpu2200vp::accelCopy(bool limit_form) noexcept
+{
+    const uint16 head = m_cpu.ic;
+    const ucode_t * const u = &m_ucode[head];
+    const int idx = UOP_AUX_IDX(u[0]);
+    const int inc_wr = static_cast<int16>(u[0].p16);
+    const int inc_rd = static_cast<int16>(u[1].p16);
+    const int test_reg = UOP_A_FIELD(u[2]);
+    const int pass_ns = op_ns[u[0].op].ns + op_ns[u[1].op].ns + op_ns[u[2].op].ns
+                      + ((limit_form) ? op_ns[u[3].op].ns : 0);
+
+    int ns = 0;
+    do {
+        INLINE_MEM_WRITE(m_cpu.pc, m_cpu.ch, 0);
+        ACCEL_XPA(idx, inc_wr);
+        ACCEL_MEM_READ(m_cpu.pc);
+        ACCEL_XPA(idx, inc_rd);
+
+        if (limit_form) {
+            const int limit = (m_cpu.reg[test_reg+1] << 8) | m_cpu.reg[test_reg];
+            if (limit <= m_cpu.pc) {
+                m_cpu.ic = u[2].p16;
+                ns += pass_ns - op_ns[u[3].op].ns;     // the B isn't reached
+                break;
+            }
+        } else if (m_cpu.reg[test_reg] == (m_cpu.pc & 0xFF)) {
+            m_cpu.ic = static_cast<uint16>(head + 3);
+            ns += pass_ns;
+            break;
+        }
+        ns += pass_ns;
+    } while (ns + pass_ns <= ACCEL_SLICE_NS);
+
+    m_cpu.orig_pc = m_cpu.pc;
+    return ns;
+}
+
+
+// byte compare loop; exits through the BLERX at the PC limit, or falls
+// out of the BER at the first difference
+int
+Cpu2200vp::accelCompare() noexcept
+{
+    const uint16 head = m_cpu.ic;
+    const ucode_t * const u = &m_ucode[head];
+    const int limit_reg = UOP_A_FIELD(u[0]);
+    const int idx = UOP_AUX_IDX(u[1]);
+    const int inc_1 = static_cast<int16>(u[1].p16);
+    const int inc_2 = static_cast<int16>(u[3].p16);
+    const int tmp_reg = UOP_C_FIELD(u[2]);
+    const int pass_ns = op_ns[u[0].op].ns + op_ns[u[1].op].ns + op_ns[u[2].op].ns
+                      + op_ns[u[3].op].ns + op_ns[u[4].op].ns;
+
+    int ns = 0;
+    do {
+        const int limit = (m_cpu.reg[limit_reg+1] << 8) | m_cpu.reg[limit_reg];
+        if (limit <= m_cpu.pc) {
+            m_cpu.ic = u[0].p16;
+            ns += op_ns[u[0].op].ns;
+            break;
+        }
+        ACCEL_MEM_READ(m_cpu.pc);
+        ACCEL_XPA(idx, inc_1);
+        m_cpu.reg[tmp_reg] = m_cpu.ch;
+        ACCEL_MEM_READ(m_cpu.pc);
+        ACCEL_XPA(idx, inc_2);
+        ns += pass_ns;
+        if (m_cpu.reg[tmp_reg] != m_cpu.ch) {
+            m_cpu.ic = static_cast<uint16>(head + 5);
+            break;
+        }
+    } while (ns + pass_ns <= ACCEL_SLICE_NS);
+
+    m_cpu.orig_pc = m_cpu.pc;
+    return ns;
+}
+#endif
+
+
 // perform one instruction and return the number of ns the instruction took.
 // returns EXEC_ERR if we hit an illegal op.
 #define EXEC_ERR (1 << 30)
+
+// returned while stopped by the debugger.  system2200 ends the timeslice
+// when it sees this, even summed over the six calls of the MXD case.
+#define EXEC_STOPPED 60001
 int
 Cpu2200vp::execOneOp()
 {
     const ucode_t * const puop = &m_ucode[m_cpu.ic];
-    const uint32 uop = puop->ucode;
+    const ucode_t &uop = *puop;
+
+#if VP_BOOT_ACCEL || VP_LOOP_ACCEL
+    if (ACCEL_KIND(uop) != 0) {
+        const int accel_ns = accelLoop(ACCEL_KIND(uop));
+        if (accel_ns > 0) {
+            return accel_ns;
+        }
+    }
+#endif
 
-    int ns = 600;      // almost all instructions take 600 ns
+    const int ns = op_ns[puop->op].ns;
 
     int a_field, b_field, c_field, s_field, t_field, HbHa;
     int a_op, b_op, a_op2, b_op2, imm, rslt, rslt2;
@@ -966,7 +1617,7 @@ Cpu2200vp::execOneOp()
         g_num_ops++;
         char buff[200];
         dumpState(true);
-        /*bool illegal =*/ dasmOneVpOp(&buff[0], m_cpu.ic, m_ucode[m_cpu.ic].ucode);
+        /*bool illegal =*/ dasmOneVpOp(&buff[0], m_cpu.ic, m_ucode_raw[m_cpu.ic]);
         dbglog("cycle %5d: %s", g_num_ops, &buff[0]);
     }
 #endif
@@ -980,23 +1631,20 @@ Cpu2200vp::execOneOp()
     a_op = a_op2 = b_op = b_op2 = 0;
 #endif
 
-    if ((uop & FETCH_CY) != 0) {
+    if ((uop.flags & FETCH_CY) != 0) {
         // set or clear carry
         // we must do this before FETCH_A/B because it can affect SH state
-        switch ((uop >> 14) & 3) {
-            case 2: m_cpu.sh &= ~SH_MASK_CARRY; break;    // clear
-            case 3: m_cpu.sh |=  SH_MASK_CARRY; break;    // set
-            case 0:     // no change, but this shouldn't be called then
-            default:
-                assert(false);
-                break;
+        if ((uop.flags & CY_SET) != 0) {
+            m_cpu.sh |=  SH_MASK_CARRY;     // set
+        } else {
+            m_cpu.sh &= ~SH_MASK_CARRY;     // clear
         }
     }
 
     // fetch argA and argB as required
-    if ((uop & FETCH_B) != 0) {
+    if ((uop.flags & FETCH_B) != 0) {
 
-        b_field = uop & 0xF;
+        b_field = UOP_B_FIELD(uop);
         switch (b_field) {
             case 0: case 1: case 2: case 3:
             case 4: case 5: case 6: case 7:
@@ -1017,8 +1665,8 @@ Cpu2200vp::execOneOp()
         }
 
         // A is fetched only if B is fetched as well
-        if ((uop & FETCH_A) != 0) {
-            a_field = (uop >> 4) & 0xF;
+        if ((uop.flags & FETCH_A) != 0) {
+            a_field = UOP_A_FIELD(uop);
             switch (a_field) {
                 case 0: case 1: case 2: case 3:
                 case 4: case 5: case 6: case 7:
@@ -1041,9 +1689,9 @@ Cpu2200vp::execOneOp()
             a_op2 = 0;  // keep lint happy
         }
 
-    } else if ((uop & FETCH_X) != 0) {
+    } else if ((uop.flags & FETCH_X) != 0) {
 
-        b_field = uop & 0xF;
+        b_field = UOP_B_FIELD(uop);
         switch (b_field) {
             case 0: case 1: case 2: case 3:
             case 4: case 5: case 6:
@@ -1092,7 +1740,7 @@ Cpu2200vp::execOneOp()
                 break;
         }
 
-        a_field = (uop >> 4) & 0xF;
+        a_field = UOP_A_FIELD(uop);
         switch (a_field) {
             case 0: case 1: case 2: case 3:
             case 4: case 5: case 6:
@@ -1153,38 +1801,40 @@ Cpu2200vp::execOneOp()
     case OP_ILLEGAL:
         {
             char buff[200];
-            dasmOneVpOp(&buff[0], m_cpu.ic, m_ucode[m_cpu.ic].ucode);
+            dasmOneVpOp(&buff[0], m_cpu.ic, m_ucode_raw[m_cpu.ic]);
             UI_error("%s\nIllegal op at ic=%04X", &buff[0], m_cpu.ic);
         }
         m_status = CPU_HALTED;
         return EXEC_ERR;
 
+    case OP_BREAK:
+        return dbgTrap();
+
     case OP_LPI:
         m_cpu.pc = puop->p16;
         m_cpu.orig_pc = m_cpu.pc;       // LPI is a special case where change
                                         //    of PC is seen by R and W
         perform_dd_op(uop, 0x00);       // force B field to pick 0
         ++m_cpu.ic;
-        ns = 1100;  // 1.1us
         break;
 
     case OP_TAP:
         perform_dd_op(uop, b_op);
-        idx = (uop >> 4) & 0x1F;
+        idx = UOP_AUX_IDX(uop);
         m_cpu.pc = m_cpu.aux[idx];
         ++m_cpu.ic;
         break;
 
     case OP_TPA:
         perform_dd_op(uop, b_op);
-        idx = (uop >> 4) & 0x1F;
+        idx = UOP_AUX_IDX(uop);
         m_cpu.aux[idx] = static_cast<uint16>(m_cpu.pc + static_cast<int16>(puop->p16));
         ++m_cpu.ic;
         break;
 
     case OP_XPA:
         perform_dd_op(uop, b_op);
-        idx = (uop >> 4) & 0x1F;
+        idx = UOP_AUX_IDX(uop);
         tmp16 = m_cpu.aux[idx];
         m_cpu.aux[idx] = static_cast<uint16>(m_cpu.pc + static_cast<int16>(puop->p16));
         m_cpu.pc = tmp16;
@@ -1209,12 +1859,11 @@ Cpu2200vp::execOneOp()
         // SR, RCM (read control memory and subroutine return)
         INC_ICSP;
         tmp16 = m_cpu.icstack[m_cpu.icsp];
-        m_cpu.k  = static_cast<uint8>((m_ucode[tmp16].ucode >> 16) & 0xFF);
-        m_cpu.pc = static_cast<uint16>(m_ucode[tmp16].ucode & 0xFFFF);
+        m_cpu.k  = static_cast<uint8>((m_ucode_raw[tmp16] >> 16) & 0xFF);
+        m_cpu.pc = static_cast<uint16>(m_ucode_raw[tmp16] & 0xFFFF);
         // perform subroutine return
         INC_ICSP;
         m_cpu.ic = m_cpu.icstack[m_cpu.icsp];
-        ns = 1600;      // 1.6 us
         break;
 
     case OP_WCM:
@@ -1233,7 +1882,6 @@ Cpu2200vp::execOneOp()
         // perform subroutine return
         INC_ICSP;
         m_cpu.ic = m_cpu.icstack[m_cpu.icsp];
-        ns = 1600;      // 1.6 us
         break;
 
     case OP_SR:
@@ -1241,12 +1889,11 @@ Cpu2200vp::execOneOp()
         perform_dd_op(uop, b_op);
         INC_ICSP;
         m_cpu.ic = m_cpu.icstack[m_cpu.icsp];
-        ns = 800;
         break;
 
     case OP_CIO:
-        s_field = (uop >> 11) & 0x1;
-        t_field = (uop >>  4) & 0x7F;
+        s_field = (uop.imm >> 7) & 0x1;
+        t_field = (uop.imm >> 0) & 0x7F;
 
         if (s_field != 0) {
             m_cpu.ab = m_cpu.k;     // I/O address bus register takes K reg value
@@ -1315,14 +1962,14 @@ Cpu2200vp::execOneOp()
             default:
                 // the one-shot timer falls into this bucket, but it was
                 // handled earlier.
-                if (((uop & 0xC) != 0xC) || (t_field != 0x00)) {
+                if (((UOP_B_FIELD(uop) & 0xC) != 0xC) || (t_field != 0x00)) {
                     UI_info("unknown CIO %02x, AB=%02x, IC=%04X",
                              t_field, m_cpu.ab, m_cpu.ic);
                 }
                 break;
         } // t_field
 
-        if ((uop & 0xC) == 0xC) {
+        if ((UOP_B_FIELD(uop) & 0xC) == 0xC) {
             if (m_has_oneshot) {
                 // this is not documented in the arch manual, but it appears
                 // in the MVP CPU schematic.  if ucode bits 3:2 are both one,
@@ -1351,7 +1998,7 @@ Cpu2200vp::execOneOp()
         break;
 
 #define PREAMBLE1       \
-        c_field = (uop >> 8) & 0xF
+        c_field = UOP_C_FIELD(uop)
 
 #define POSTAMBLE1      \
         store_c(c_field, rslt);                                        \
@@ -1407,7 +2054,7 @@ Cpu2200vp::execOneOp()
 
     case OP_M:
         PREAMBLE1;
-        HbHa    = (uop >> 14) & 3;
+        HbHa = UOP_HBHA(uop);
         rslt = getHbHa(HbHa, a_op, b_op);
         rslt = ((rslt >> 4) & 0xF) * (rslt & 0xF);
         POSTAMBLE1;
@@ -1415,13 +2062,13 @@ Cpu2200vp::execOneOp()
 
     case OP_SH:
         PREAMBLE1;
-        HbHa = (uop >> 18) & 3;
+        HbHa = UOP_HBHA(uop);
         rslt = getHbHa(HbHa, a_op, b_op);
         POSTAMBLE1;
         break;
 
 #define PREAMBLE2 \
-        c_field = (uop >> 8) & 0xF
+        c_field = UOP_C_FIELD(uop)
 
 #define POSTAMBLE2                                              \
         store_c(c_field, rslt);                                 \
@@ -1484,7 +2131,7 @@ Cpu2200vp::execOneOp()
 
     case OP_MX:
         PREAMBLE2;
-        HbHa = (uop >> 14) & 3;
+        HbHa = UOP_HBHA(uop);
         rslt  = getHbHa(HbHa, a_op, b_op);
         rslt2 = getHbHa(HbHa, a_op2, b_op2);
         rslt  = ((rslt  >> 4) & 0xF) * (rslt  & 0xF);
@@ -1494,15 +2141,15 @@ Cpu2200vp::execOneOp()
 
     case OP_SHX:
         PREAMBLE2;
-        HbHa = (uop >> 18) & 3;
+        HbHa = UOP_HBHA(uop);
         rslt  = getHbHa(HbHa, a_op,  b_op);
         rslt2 = getHbHa(HbHa, a_op2, b_op2);
         POSTAMBLE2;
         break;
 
 #define PREAMBLE3                       \
-        c_field = (uop >> 8) & 0xF;     \
-        imm = IMM8(uop)
+        c_field = UOP_C_FIELD(uop);     \
+        imm = uop.imm
 
 #define POSTAMBLE3                      \
         store_c(c_field, rslt);         \
@@ -1558,15 +2205,14 @@ Cpu2200vp::execOneOp()
 
     case OP_MI:         // binary multiply immediate w/ carry
         PREAMBLE3;
-        imm  = (uop >> 4) & 0xF;
-        b_op = GET_HB(uop >> 15, b_op);
+        b_op = GET_HB(UOP_HBHA(uop), b_op);
         rslt = imm * b_op;
         POSTAMBLE3;
         break;
 
 #define PREAMBLE4                       \
-        imm  = (uop >> 4) & 0xF;        \
-        b_op = GET_HB(uop >> 18, b_op)
+        imm  = uop.imm;                 \
+        b_op = GET_HB(UOP_HBHA(uop), b_op)
 
     case OP_BT:         // branch if true
         PREAMBLE4;
@@ -1603,7 +2249,6 @@ Cpu2200vp::execOneOp()
         b_op = (b_op2 << 8) | b_op;
         if (a_op < b_op) { m_cpu.ic = puop->p16; }
         else             { ++m_cpu.ic; }
-        ns = 800;
         break;
 
     case OP_BLER:       // BLER: branch if R[AAAA] <= R[BBBB]
@@ -1617,7 +2262,6 @@ Cpu2200vp::execOneOp()
         b_op = (b_op2 << 8) | b_op;
         if (a_op <= b_op) { m_cpu.ic = puop->p16; }
         else              { ++m_cpu.ic; }
-        ns = 800;
         break;
 
     case OP_BER:        // BEQ: branch if R[AAAA] == R[BBBB]
@@ -1648,11 +2292,320 @@ Cpu2200vp::execOneOp()
 
     } // op
 
-    // at this point we know how long each instruction is
     return ns;
 }
 
 
+// ------------------------------------------------------------------------
+//  debugger support
+// ------------------------------------------------------------------------
+
+// replace the word at ic with a trap op, keeping the real word to run later.
+// the trap has no operand fetch or acceleration flags, so execOneOp()
+// goes straight to it.
+void
+Cpu2200vp::armTrap(uint16 ic) noexcept
+{
+    auto it = m_traps.find(ic);
+    assert(it != m_traps.end());
+    if (m_ucode[ic].op != OP_BREAK) {
+        it->second.saved   = m_ucode[ic];
+        m_ucode[ic].flags  = 0;
+        m_ucode[ic].op     = OP_BREAK;
+        m_ucode[ic].p8     = 0;
+        m_ucode[ic].p16    = 0;
+    }
+}
+
+
+// put back the real word and forget the trap
+void
+Cpu2200vp::disarmTrap(uint16 ic) noexcept
+{
+    auto it = m_traps.find(ic);
+    assert(it != m_traps.end());
+    m_ucode[ic] = it->second.saved;
+    m_traps.erase(it);
+    retagAccel(ic);
+}
+
+
+// a trap op has been reached
+int
+Cpu2200vp::dbgTrap()
+{
+    const uint16 ic = m_cpu.ic;
+    auto it = m_traps.find(ic);
+    assert(it != m_traps.end());
+
+    if (m_status != CPU_RUNNING) {
+        // system2200 may call again before it notices we have stopped
+        return EXEC_STOPPED;
+    }
+
+    if (m_dbg_resume) {
+        // resuming from this trap: perform the real op this one time
+        m_dbg_resume = false;
+        m_ucode[ic] = it->second.saved;
+        const int ns = execOneOp();
+        if (m_traps.find(ic) != m_traps.end()) {
+            armTrap(ic);
+        }
+        return ns;
+    }
+
+    if (it->second.once) {
+        // the stop after a watchpoint write; m_dbg_stop is already filled in
+        it->second.once = false;
+        if (!it->second.user) {
+            disarmTrap(ic);
+        }
+    } else {
+        m_dbg_stop = { DBG_STOP_BREAK, ic, 0, 0, 0 };
+    }
+
+    m_status = CPU_STOPPED;
+    return EXEC_STOPPED;
+}
+
+
+// the current op is about to write a page holding a watchpoint
+void
+Cpu2200vp::dbgWatchWrite(int addr, int value)
+{
+    for (const auto &w : m_watches) {
+        if ((addr < w.first) || (addr >= w.first + w.second)) {
+            continue;
+        }
+
+        m_dbg_stop = { DBG_STOP_WATCH, m_cpu.ic, addr, m_ram[addr],
+                       static_cast<uint8>(value) };
+
+        // stop before the next op.  every op which writes memory then
+        // goes on to ic+1, except SR which returns.
+        const uint16 next_ic = (m_ucode[m_cpu.ic].op == OP_SR)
+                             ? m_cpu.icstack[(m_cpu.icsp + 1) % STACKSIZE]
+                             : static_cast<uint16>(m_cpu.ic + 1);
+        m_traps[next_ic].once = true;
+        armTrap(next_ic);
+        return;
+    }
+}
+
+
+bool
+Cpu2200vp::setBreakpoint(uint16 ic)
+{
+    trap_t &trap = m_traps[ic];     // value initialized if new
+    const bool was_set = trap.user;
+    trap.user = true;
+    armTrap(ic);
+    return !was_set;
+}
+
+
+bool
+Cpu2200vp::clearBreakpoint(uint16 ic)
+{
+    auto it = m_traps.find(ic);
+    if ((it == m_traps.end()) || !it->second.user) {
+        return false;
+    }
+    it->second.user = false;
+    if (!it->second.once) {
+        disarmTrap(ic);
+    }
+    return true;
+}
+
+
+std::vector<uint16>
+Cpu2200vp::getBreakpoints() const
+{
+    std::vector<uint16> bps;
+    for (const auto &t : m_traps) {
+        if (t.second.user) {
+            bps.push_back(t.first);
+        }
+    }
+    return bps;
+}
+
+
+bool
+Cpu2200vp::setWatchpoint(int addr, int len)
+{
+    // written so nothing can overflow, whatever the debugger passes
+    if ((addr < 0) || (addr >= m_mem_size) || (len < 1) || (len > m_mem_size - addr)) {
+        return false;
+    }
+    if (m_watches.empty()) {
+        m_watch_pages.assign((m_mem_size >> WATCH_PAGE_SHIFT) + 1, 0);
+        m_watch_map = m_watch_pages.data();
+    }
+    m_watches.emplace_back(addr, len);
+    for (int pg = addr >> WATCH_PAGE_SHIFT;
+             pg <= (addr + len - 1) >> WATCH_PAGE_SHIFT; pg++) {
+        m_watch_map[pg] = 1;
+    }
+    return true;
+}
+
+
+bool
+Cpu2200vp::clearWatchpoint(int addr)
+{
+    const auto old_size = m_watches.size();
+    m_watches.erase(std::remove_if(m_watches.begin(), m_watches.end(),
+                        [addr](const std::pair<int,int> &w)
+                            { return w.first == addr; }),
+                    m_watches.end());
+    if (m_watches.size() == old_size) {
+        return false;
+    }
+
+    if (m_watches.empty()) {
+        // back to not checking writes at all
+        m_watch_map = nullptr;
+        m_watch_pages.clear();
+        return true;
+    }
+
+    std::fill(m_watch_pages.begin(), m_watch_pages.end(), 0);
+    for (const auto &w : m_watches) {
+        for (int pg = w.first >> WATCH_PAGE_SHIFT;
+                 pg <= (w.first + w.second - 1) >> WATCH_PAGE_SHIFT; pg++) {
+            m_watch_map[pg] = 1;
+        }
+    }
+    return true;
+}
+
+
+std::vector<std::pair<int,int>>
+Cpu2200vp::getWatchpoints() const
+{
+    return m_watches;
+}
+
+
+void
+Cpu2200vp::dbgStop() noexcept
+{
+    if (m_status == CPU_RUNNING) {
+        m_status = CPU_STOPPED;
+        m_dbg_stop = { DBG_STOP_REQUEST, m_cpu.ic, 0, 0, 0 };
+    }
+}
+
+
+void
+Cpu2200vp::dbgContinue() noexcept
+{
+    if (m_status == CPU_STOPPED) {
+        m_dbg_resume = (m_ucode[m_cpu.ic].op == OP_BREAK);
+        m_dbg_stop.reason = DBG_NOT_STOPPED;
+        m_status = CPU_RUNNING;
+    }
+}
+
+
+// perform one op while stopped.  the rest of the system sees the time
+// it took, but nothing else runs in the meantime.
+void
+Cpu2200vp::dbgStep()
+{
+    if (m_status != CPU_STOPPED) {
+        return;
+    }
+
+    m_dbg_resume = (m_ucode[m_cpu.ic].op == OP_BREAK);
+    m_dbg_stop.reason = DBG_NOT_STOPPED;
+    m_status = CPU_RUNNING;
+    const int ns = execOneOp();
+    if (m_status == CPU_HALTED) {
+        return;     // illegal op
+    }
+
+    // we are stopping anyway, so drop any stop a watchpoint just planted
+    for (auto it = m_traps.begin(); it != m_traps.end(); ) {
+        const uint16 ic = it->first;
+        auto next = std::next(it);
+        if (it->second.once) {
+            it->second.once = false;
+            if (!it->second.user) {
+                disarmTrap(ic);
+            }
+        }
+        it = next;
+    }
+
+    if (m_dbg_stop.reason == DBG_NOT_STOPPED) {
+        m_dbg_stop = { DBG_STOP_STEP, m_cpu.ic, 0, 0, 0 };
+    }
+    m_status = CPU_STOPPED;
+    m_scheduler->timerTick(ns);
+}
+
+
+// registers, stack and the next op, formatted like dumpState()
+std::string
+Cpu2200vp::dbgFormatState() const
+{
+    char buff[200];
+    std::string text;
+
+    snprintf(&buff[0], sizeof(buff),
+             " K SH SL CH CL PH PL F7 F6 F5 F4 F3 F2 F1 F0\n"
+             "%02X %02X %02X %02X %02X %02X %02X %02X %02X %02X %02X %02X %02X %02X %02X\n",
+             m_cpu.k, m_cpu.sh, m_cpu.sl, m_cpu.ch, m_cpu.cl,
+             (m_cpu.pc >> 8) & 0xFF, (m_cpu.pc >> 0) & 0xFF,
+             m_cpu.reg[7], m_cpu.reg[6], m_cpu.reg[5], m_cpu.reg[4],
+             m_cpu.reg[3], m_cpu.reg[2], m_cpu.reg[1], m_cpu.reg[0]);
+    text += &buff[0];
+    snprintf(&buff[0], sizeof(buff), "    AB=%02X, AB_SEL=%02X, cy=%d, bank_offset=%06X\n",
+             m_cpu.ab, m_cpu.ab_sel, CARRY_BIT, m_cpu.bank_offset);
+    text += &buff[0];
+
+    for (int row = 0; row < 32; row += 8) {
+        snprintf(&buff[0], sizeof(buff),
+                 "AUX %02X-%02X   %04X %04X %04X %04X %04X %04X %04X %04X\n",
+                 row, row+7,
+                 m_cpu.aux[row+0], m_cpu.aux[row+1], m_cpu.aux[row+2], m_cpu.aux[row+3],
+                 m_cpu.aux[row+4], m_cpu.aux[row+5], m_cpu.aux[row+6], m_cpu.aux[row+7]);
+        text += &buff[0];
+    }
+
+    const int depth = STACKSIZE-1 - m_cpu.icsp;
+    snprintf(&buff[0], sizeof(buff), "stack depth=%d", depth);
+    text += &buff[0];
+    for (int i=0; i < depth && i < 6; i++) {
+        snprintf(&buff[0], sizeof(buff), " %04X", m_cpu.icstack[STACKSIZE-1-i]);
+        text += &buff[0];
+    }
+    text += "\n";
+
+    dasmOneVpOp(&buff[0], m_cpu.ic, dbgReadUcode(m_cpu.ic));
+    text += &buff[0];
+    return text;
+}
+
+
+int
+Cpu2200vp::dbgReadRam(int addr) const noexcept
+{
+    return ((addr >= 0) && (addr < m_mem_size)) ? m_ram[addr] : -1;
+}
+
+
+// the real word, even if a trap is in its place
+uint32
+Cpu2200vp::dbgReadUcode(uint16 addr) const noexcept
+{
+    return m_ucode_raw[addr];
+}
+
+
 // ------------------------------------------------------------------------
 //  misc utilities
 // ------------------------------------------------------------------------
@@ -1684,7 +2637,7 @@ Cpu2200vp::dumpRam(const std::string &filename)
     ofs << "===============================================" << std::endl << std::endl;
     for (int addr=0; addr < 0x8000; addr++) {
         char buff[200];
-        dasmOneVpOp(buff, addr, m_ucode[addr].ucode);
+        dasmOneVpOp(buff, addr, m_ucode_raw[addr]);
         ofs << buff;
     }
 
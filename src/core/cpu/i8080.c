@@ -59,14 +59,35 @@
 #define F_ZERO          0x40
 #define F_NEG           0x80
 
+// carry is kept current.  sign, zero, parity and half carry are lazy: an
+// ALU op only records its 8b result, its operands, and which kind of op it
+// was; the flags are derived from those only when something looks at them
+// (conditional jumps/calls/returns, DAA, PUSH PSW).  after POP PSW the flags
+// are taken from F until the next op which sets them.
 #define C_FLAG          FLAGS.carry_flag
-#define P_FLAG          FLAGS.parity_flag
-#define H_FLAG          FLAGS.half_carry_flag
-#define Z_FLAG          FLAGS.zero_flag
-#define S_FLAG          FLAGS.sign_flag
-#define UN1_FLAG        FLAGS.unused1
-#define UN3_FLAG        FLAGS.unused3
-#define UN5_FLAG        FLAGS.unused5
+#define S_FLAG          i8080_s_flag(cpu)
+#define Z_FLAG          i8080_z_flag(cpu)
+#define P_FLAG          i8080_p_flag(cpu)
+#define H_FLAG          i8080_h_flag(cpu)
+
+// kinds of op recorded in FLAGS.lazy_op, to tell how to derive half carry
+enum {
+    LAZY_EXPLICIT,      // flags are in F (after reset or POP PSW)
+    LAZY_ADD,           // add, adc, daa
+    LAZY_SUB,           // sub, sbb, cmp
+    LAZY_INR,
+    LAZY_DCR,
+    LAZY_ANA,
+    LAZY_LOGIC,         // xra, ora: half carry is cleared
+};
+
+#define SET_LAZY(res, a, b, op) \
+{                                               \
+    FLAGS.result  = (uint8_t)(res);             \
+    FLAGS.lazy_a  = (uint8_t)(a);               \
+    FLAGS.lazy_b  = (uint8_t)(b);               \
+    FLAGS.lazy_op = (op);                       \
+}
 
 #define SET(flag)       (flag = 1)
 #define CLR(flag)       (flag = 0)
@@ -82,117 +103,72 @@
 #define INR(reg) \
 {                                               \
     ++(reg);                                    \
-    S_FLAG = (((reg) & 0x80) != 0);             \
-    Z_FLAG = ((reg) == 0);                      \
-    H_FLAG = (((reg) & 0x0f) == 0);             \
-    P_FLAG = PARITY(reg);                       \
+    SET_LAZY((reg), 0, 0, LAZY_INR);            \
 }
 
 #define DCR(reg) \
 {                                               \
     --(reg);                                    \
-    S_FLAG = (((reg) & 0x80) != 0);             \
-    Z_FLAG = ((reg) == 0);                      \
-    H_FLAG = !(((reg) & 0x0f) == 0x0f);         \
-    P_FLAG = PARITY(reg);                       \
+    SET_LAZY((reg), 0, 0, LAZY_DCR);            \
 }
 
 #define ADD(val) \
 {                                               \
     work16 = (uint16_t)A + (val);               \
-    index = ((A & 0x88) >> 1) |                 \
-            (((val) & 0x88) >> 2) |             \
-            ((work16 & 0x88) >> 3);             \
+    SET_LAZY(work16, A, (val), LAZY_ADD);       \
     A = work16 & 0xff;                          \
-    S_FLAG = ((A & 0x80) != 0);                 \
-    Z_FLAG = (A == 0);                          \
-    H_FLAG = half_carry_table[index & 0x7];     \
-    P_FLAG = PARITY(A);                         \
     C_FLAG = ((work16 & 0x0100) != 0);          \
 }
 
 #define ADC(val) \
 {                                               \
     work16 = (uint16_t)A + (val) + C_FLAG;      \
-    index = ((A & 0x88) >> 1) |                 \
-            (((val) & 0x88) >> 2) |             \
-            ((work16 & 0x88) >> 3);             \
+    SET_LAZY(work16, A, (val), LAZY_ADD);       \
     A = work16 & 0xff;                          \
-    S_FLAG = ((A & 0x80) != 0);                 \
-    Z_FLAG = (A == 0);                          \
-    H_FLAG = half_carry_table[index & 0x7];     \
-    P_FLAG = PARITY(A);                         \
     C_FLAG = ((work16 & 0x0100) != 0);          \
 }
 
 #define SUB(val) \
-{                                                \
-    work16 = (uint16_t)A - (val);                \
-    index = ((A & 0x88) >> 1) |                  \
-            (((val) & 0x88) >> 2) |              \
-            ((work16 & 0x88) >> 3);              \
-    A = work16 & 0xff;                           \
-    S_FLAG = ((A & 0x80) != 0);                  \
-    Z_FLAG = (A == 0);                           \
-    H_FLAG = !sub_half_carry_table[index & 0x7]; \
-    P_FLAG = PARITY(A);                          \
-    C_FLAG = ((work16 & 0x0100) != 0);           \
+{                                               \
+    work16 = (uint16_t)A - (val);               \
+    SET_LAZY(work16, A, (val), LAZY_SUB);       \
+    A = work16 & 0xff;                          \
+    C_FLAG = ((work16 & 0x0100) != 0);          \
 }
 
 #define SBB(val) \
-{                                                \
-    work16 = (uint16_t)A - (val) - C_FLAG;       \
-    index = ((A & 0x88) >> 1) |                  \
-            (((val) & 0x88) >> 2) |              \
-            ((work16 & 0x88) >> 3);              \
-    A = work16 & 0xff;                           \
-    S_FLAG = ((A & 0x80) != 0);                  \
-    Z_FLAG = (A == 0);                           \
-    H_FLAG = !sub_half_carry_table[index & 0x7]; \
-    P_FLAG = PARITY(A);                          \
-    C_FLAG = ((work16 & 0x0100) != 0);           \
+{                                               \
+    work16 = (uint16_t)A - (val) - C_FLAG;      \
+    SET_LAZY(work16, A, (val), LAZY_SUB);       \
+    A = work16 & 0xff;                          \
+    C_FLAG = ((work16 & 0x0100) != 0);          \
 }
 
 #define CMP(val) \
-{                                                \
-    work16 = (uint16_t)A - (val);                \
-    index = ((A & 0x88) >> 1) |                  \
-            (((val) & 0x88) >> 2) |              \
-            ((work16 & 0x88) >> 3);              \
-    S_FLAG = ((work16 & 0x80) != 0);             \
-    Z_FLAG = ((work16 & 0xff) == 0);             \
-    H_FLAG = !sub_half_carry_table[index & 0x7]; \
-    C_FLAG = ((work16 & 0x0100) != 0);           \
-    P_FLAG = PARITY(work16 & 0xff);              \
+{                                               \
+    work16 = (uint16_t)A - (val);               \
+    SET_LAZY(work16, A, (val), LAZY_SUB);       \
+    C_FLAG = ((work16 & 0x0100) != 0);          \
 }
 
 #define ANA(val) \
 {                                               \
-    H_FLAG = ((A | (val)) & 0x08) != 0;         \
+    SET_LAZY(A & (val), A, (val), LAZY_ANA);    \
     A &= (val);                                 \
-    S_FLAG = ((A & 0x80) != 0);                 \
-    Z_FLAG = (A == 0);                          \
-    P_FLAG = PARITY(A);                         \
     CLR(C_FLAG);                                \
 }
 
 #define XRA(val) \
 {                                               \
     A ^= (val);                                 \
-    S_FLAG = ((A & 0x80) != 0);                 \
-    Z_FLAG = (A == 0);                          \
-    CLR(H_FLAG);                                \
-    P_FLAG = PARITY(A);                         \
+    SET_LAZY(A, 0, 0, LAZY_LOGIC);              \
     CLR(C_FLAG);                                \
 }
 
 #define ORA(val) \
 {                                               \
     A |= (val);                                 \
-    S_FLAG = ((A & 0x80) != 0);                 \
-    Z_FLAG = (A == 0);                          \
-    CLR(H_FLAG);                                \
-    P_FLAG = PARITY(A);                         \
+    SET_LAZY(A, 0, 0, LAZY_LOGIC);              \
     CLR(C_FLAG);                                \
 }
 
@@ -220,7 +196,6 @@
 static uint32_t work32;
 static uint16_t work16;
 static uint8_t work8;
-static int index;
 static uint8_t carry, add;
 
 static uint8_t parity_table[] = {
@@ -245,24 +220,62 @@ static uint8_t parity_table[] = {
 static uint8_t half_carry_table[]     = { 0, 0, 1, 0, 1, 0, 1, 1 };
 static uint8_t sub_half_carry_table[] = { 0, 1, 1, 1, 0, 0, 0, 1 };
 
+// ----- lazy flag evaluation -----
+
+static inline int i8080_s_flag(const i8080 *cpu)
+{
+    return (FLAGS.lazy_op == LAZY_EXPLICIT) ? ((F & F_NEG) != 0)
+                                            : ((FLAGS.result & 0x80) != 0);
+}
+
+static inline int i8080_z_flag(const i8080 *cpu)
+{
+    return (FLAGS.lazy_op == LAZY_EXPLICIT) ? ((F & F_ZERO) != 0)
+                                            : (FLAGS.result == 0);
+}
+
+static inline int i8080_p_flag(const i8080 *cpu)
+{
+    return (FLAGS.lazy_op == LAZY_EXPLICIT) ? ((F & F_PARITY) != 0)
+                                            : PARITY(FLAGS.result);
+}
+
+static int i8080_h_flag(const i8080 *cpu)
+{
+    // for add/sub, bit 3 of each operand and of the result select
+    // whether there was a carry (borrow) out of the low nibble
+    const int index = ((FLAGS.lazy_a & 0x08) >> 1) |
+                      ((FLAGS.lazy_b & 0x08) >> 2) |
+                      ((FLAGS.result & 0x08) >> 3);
+
+    switch (FLAGS.lazy_op) {
+        case LAZY_ADD:   return half_carry_table[index];
+        case LAZY_SUB:   return !sub_half_carry_table[index];
+        case LAZY_INR:   return ((FLAGS.result & 0x0f) == 0);
+        case LAZY_DCR:   return ((FLAGS.result & 0x0f) != 0x0f);
+        case LAZY_ANA:   return (((FLAGS.lazy_a | FLAGS.lazy_b) & 0x08) != 0);
+        case LAZY_LOGIC: return 0;
+        default:         return ((F & F_HCARRY) != 0);
+    }
+}
+
 static void i8080_store_flags(i8080 *cpu)
 {
-    F = F_UN1;     // bit 1 unused; always 1
-    if (S_FLAG) { F |= F_NEG; }
-    if (Z_FLAG) { F |= F_ZERO; }
-    if (H_FLAG) { F |= F_HCARRY; }
-    if (P_FLAG) { F |= F_PARITY; }
-    if (C_FLAG) { F |= F_CARRY; }
-//  F &= ~F_UN3;   // bit 3 unused; always 0
-//  F &= ~F_UN5;   // bit 5 unused; always 0
+    uint8_t f = F_UN1;     // bit 1 unused; always 1
+    if (S_FLAG) { f |= F_NEG; }
+    if (Z_FLAG) { f |= F_ZERO; }
+    if (H_FLAG) { f |= F_HCARRY; }
+    if (P_FLAG) { f |= F_PARITY; }
+    if (C_FLAG) { f |= F_CARRY; }
+//  f &= ~F_UN3;   // bit 3 unused; always 0
+//  f &= ~F_UN5;   // bit 5 unused; always 0
+    F = f;
 }
 
 static void i8080_retrieve_flags(i8080 *cpu)
 {
-    S_FLAG = (F & F_NEG)     ? 1 : 0;
-    Z_FLAG = (F & F_ZERO)    ? 1 : 0;
-    H_FLAG = (F & F_HCARRY)  ? 1 : 0;
-    P_FLAG = (F & F_PARITY)  ? 1 : 0;
+    // S, Z, P, H are read from F until an op sets them again
+    FLAGS.lazy_op = LAZY_EXPLICIT;
     C_FLAG = (F & F_CARRY)   ? 1 : 0;
 }
 
@@ -336,10 +349,8 @@ void i8080_destroy(i8080 *cpu)
 void i8080_reset(i8080 *cpu)
 {
     C_FLAG = 0;
-    S_FLAG = 0;
-    Z_FLAG = 0;
-    H_FLAG = 0;
-    P_FLAG = 0;
+    F = F_UN1;          // S, Z, H, P all clear
+    FLAGS.lazy_op = LAZY_EXPLICIT;
 
     HALT = 0;
     INTE = 0;
@@ -347,11 +358,65 @@ void i8080_reset(i8080 *cpu)
     PC = 0x0000;
 }
 
+// ----- opcode dispatch -----
+// with gcc/clang, each opcode body is a label and dispatch is an indirect
+// jump through a table of label addresses (computed goto); other compilers
+// get the equivalent switch.  the opcode bodies are the same either way.
+
+#if defined(__GNUC__)
+    #define DISPATCH(op)    goto *dispatch_table[(op)];
+    #define OP(nn)          op_##nn:
+    #define NEXT            goto op_done
+    #define END_DISPATCH    op_done: (void)0
+#else
+    #define DISPATCH(op)    switch (op)
+    #define OP(nn)          case 0x##nn:
+    #define NEXT            break
+    #define END_DISPATCH    (void)0
+#endif
+
 int i8080_exec_one_op(i8080 *cpu)
 {
-    int cpu_cycles;
+    int cpu_cycles = 0;
     int opcode;
 
+#if defined(__GNUC__)
+    static const void * const dispatch_table[256] = {
+        &&op_00, &&op_01, &&op_02, &&op_03, &&op_04, &&op_05, &&op_06, &&op_07,
+        &&op_08, &&op_09, &&op_0A, &&op_0B, &&op_0C, &&op_0D, &&op_0E, &&op_0F,
+        &&op_10, &&op_11, &&op_12, &&op_13, &&op_14, &&op_15, &&op_16, &&op_17,
+        &&op_18, &&op_19, &&op_1A, &&op_1B, &&op_1C, &&op_1D, &&op_1E, &&op_1F,
+        &&op_20, &&op_21, &&op_22, &&op_23, &&op_24, &&op_25, &&op_26, &&op_27,
+        &&op_28, &&op_29, &&op_2A, &&op_2B, &&op_2C, &&op_2D, &&op_2E, &&op_2F,
+        &&op_30, &&op_31, &&op_32, &&op_33, &&op_34, &&op_35, &&op_36, &&op_37,
+        &&op_38, &&op_39, &&op_3A, &&op_3B, &&op_3C, &&op_3D, &&op_3E, &&op_3F,
+        &&op_40, &&op_41, &&op_42, &&op_43, &&op_44, &&op_45, &&op_46, &&op_47,
+        &&op_48, &&op_49, &&op_4A, &&op_4B, &&op_4C, &&op_4D, &&op_4E, &&op_4F,
+        &&op_50, &&op_51, &&op_52, &&op_53, &&op_54, &&op_55, &&op_56, &&op_57,
+        &&op_58, &&op_59, &&op_5A, &&op_5B, &&op_5C, &&op_5D, &&op_5E, &&op_5F,
+        &&op_60, &&op_61, &&op_62, &&op_63, &&op_64, &&op_65, &&op_66, &&op_67,
+        &&op_68, &&op_69, &&op_6A, &&op_6B, &&op_6C, &&op_6D, &&op_6E, &&op_6F,
+        &&op_70, &&op_71, &&op_72, &&op_73, &&op_74, &&op_75, &&op_76, &&op_77,
+        &&op_78, &&op_79, &&op_7A, &&op_7B, &&op_7C, &&op_7D, &&op_7E, &&op_7F,
+        &&op_80, &&op_81, &&op_82, &&op_83, &&op_84, &&op_85, &&op_86, &&op_87,
+        &&op_88, &&op_89, &&op_8A, &&op_8B, &&op_8C, &&op_8D, &&op_8E, &&op_8F,
+        &&op_90, &&op_91, &&op_92, &&op_93, &&op_94, &&op_95, &&op_96, &&op_97,
+        &&op_98, &&op_99, &&op_9A, &&op_9B, &&op_9C, &&op_9D, &&op_9E, &&op_9F,
+        &&op_A0, &&op_A1, &&op_A2, &&op_A3, &&op_A4, &&op_A5, &&op_A6, &&op_A7,
+        &&op_A8, &&op_A9, &&op_AA, &&op_AB, &&op_AC, &&op_AD, &&op_AE, &&op_AF,
+        &&op_B0, &&op_B1, &&op_B2, &&op_B3, &&op_B4, &&op_B5, &&op_B6, &&op_B7,
+        &&op_B8, &&op_B9, &&op_BA, &&op_BB, &&op_BC, &&op_BD, &&op_BE, &&op_BF,
+        &&op_C0, &&op_C1, &&op_C2, &&op_C3, &&op_C4, &&op_C5, &&op_C6, &&op_C7,
+        &&op_C8, &&op_C9, &&op_CA, &&op_CB, &&op_CC, &&op_CD, &&op_CE, &&op_CF,
+        &&op_D0, &&op_D1, &&op_D2, &&op_D3, &&op_D4, &&op_D5, &&op_D6, &&op_D7,
+        &&op_D8, &&op_D9, &&op_DA, &&op_DB, &&op_DC, &&op_DD, &&op_DE, &&op_DF,
+        &&op_E0, &&op_E1, &&op_E2, &&op_E3, &&op_E4, &&op_E5, &&op_E6, &&op_E7,
+        &&op_E8, &&op_E9, &&op_EA, &&op_EB, &&op_EC, &&op_ED, &&op_EE, &&op_EF,
+        &&op_F0, &&op_F1, &&op_F2, &&op_F3, &&op_F4, &&op_F5, &&op_F6, &&op_F7,
+        &&op_F8, &&op_F9, &&op_FA, &&op_FB, &&op_FC, &&op_FD, &&op_FE, &&op_FF,
+    };
+#endif
+
     if (HALT) {
         return 4;
     }
@@ -365,200 +430,200 @@ int i8080_exec_one_op(i8080 *cpu)
     }
 
     opcode = RD_BYTE(PC++);
-    switch (opcode) {
-        case 0x00:            /* nop */
+    DISPATCH(opcode) {
+        OP(00)            /* nop */
         // Undocumented NOP.
-        case 0x08:            /* nop */
-        case 0x10:            /* nop */
-        case 0x18:            /* nop */
-        case 0x20:            /* nop */
-        case 0x28:            /* nop */
-        case 0x30:            /* nop */
-        case 0x38:            /* nop */
+        OP(08)            /* nop */
+        OP(10)            /* nop */
+        OP(18)            /* nop */
+        OP(20)            /* nop */
+        OP(28)            /* nop */
+        OP(30)            /* nop */
+        OP(38)            /* nop */
             cpu_cycles = 4;
-            break;
+            NEXT;
 
-        case 0x01:            /* lxi b, data16 */
+        OP(01)            /* lxi b, data16 */
             cpu_cycles = 10;
             BC = RD_WORD(PC);
             PC += 2;
-            break;
+            NEXT;
 
-        case 0x02:            /* stax b */
+        OP(02)            /* stax b */
             cpu_cycles = 7;
             WR_BYTE(BC, A);
-            break;
+            NEXT;
 
-        case 0x03:            /* inx b */
+        OP(03)            /* inx b */
             cpu_cycles = 5;
             BC++;
-            break;
+            NEXT;
 
-        case 0x04:            /* inr b */
+        OP(04)            /* inr b */
             cpu_cycles = 5;
             INR(B);
-            break;
+            NEXT;
 
-        case 0x05:            /* dcr b */
+        OP(05)            /* dcr b */
             cpu_cycles = 5;
             DCR(B);
-            break;
+            NEXT;
 
-        case 0x06:            /* mvi b, data8 */
+        OP(06)            /* mvi b, data8 */
             cpu_cycles = 7;
             B = RD_BYTE(PC++);
-            break;
+            NEXT;
 
-        case 0x07:            /* rlc */
+        OP(07)            /* rlc */
             cpu_cycles = 4;
             C_FLAG = ((A & 0x80) != 0);
             A = (A << 1) | C_FLAG;
-            break;
+            NEXT;
 
-        case 0x09:            /* dad b */
+        OP(09)            /* dad b */
             cpu_cycles = 10;
             DAD(BC);
-            break;
+            NEXT;
 
-        case 0x0A:            /* ldax b */
+        OP(0A)            /* ldax b */
             cpu_cycles = 7;
             A = RD_BYTE(BC);
-            break;
+            NEXT;
 
-        case 0x0B:            /* dcx b */
+        OP(0B)            /* dcx b */
             cpu_cycles = 5;
             BC--;
-            break;
+            NEXT;
 
-        case 0x0C:            /* inr c */
+        OP(0C)            /* inr c */
             cpu_cycles = 5;
             INR(C);
-            break;
+            NEXT;
 
-        case 0x0D:            /* dcr c */
+        OP(0D)            /* dcr c */
             cpu_cycles = 5;
             DCR(C);
-            break;
+            NEXT;
 
-        case 0x0E:            /* mvi c, data8 */
+        OP(0E)            /* mvi c, data8 */
             cpu_cycles = 7;
             C = RD_BYTE(PC++);
-            break;
+            NEXT;
 
-        case 0x0F:            /* rrc */
+        OP(0F)            /* rrc */
             cpu_cycles = 4;
             C_FLAG = A & 0x01;
             A = (A >> 1) | (C_FLAG << 7);
-            break;
+            NEXT;
 
-        case 0x11:            /* lxi d, data16 */
+        OP(11)            /* lxi d, data16 */
             cpu_cycles = 10;
             DE = RD_WORD(PC);
             PC += 2;
-            break;
+            NEXT;
 
-        case 0x12:            /* stax d */
+        OP(12)            /* stax d */
             cpu_cycles = 7;
             WR_BYTE(DE, A);
-            break;
+            NEXT;
 
-        case 0x13:            /* inx d */
+        OP(13)            /* inx d */
             cpu_cycles = 5;
             DE++;
-            break;
+            NEXT;
 
-        case 0x14:            /* inr d */
+        OP(14)            /* inr d */
             cpu_cycles = 5;
             INR(D);
-            break;
+            NEXT;
 
-        case 0x15:            /* dcr d */
+        OP(15)            /* dcr d */
             cpu_cycles = 5;
             DCR(D);
-            break;
+            NEXT;
 
-        case 0x16:            /* mvi d, data8 */
+        OP(16)            /* mvi d, data8 */
             cpu_cycles = 7;
             D = RD_BYTE(PC++);
-            break;
+            NEXT;
 
-        case 0x17:            /* ral */
+        OP(17)            /* ral */
             cpu_cycles = 4;
             work8 = C_FLAG;
             C_FLAG = ((A & 0x80) != 0);
             A = (A << 1) | work8;
-            break;
+            NEXT;
 
-        case 0x19:            /* dad d */
+        OP(19)            /* dad d */
             cpu_cycles = 10;
             DAD(DE);
-            break;
+            NEXT;
 
-        case 0x1A:            /* ldax d */
+        OP(1A)            /* ldax d */
             cpu_cycles = 7;
             A = RD_BYTE(DE);
-            break;
+            NEXT;
 
-        case 0x1B:            /* dcx d */
+        OP(1B)            /* dcx d */
             cpu_cycles = 5;
             DE--;
-            break;
+            NEXT;
 
-        case 0x1C:            /* inr e */
+        OP(1C)            /* inr e */
             cpu_cycles = 5;
             INR(E);
-            break;
+            NEXT;
 
-        case 0x1D:            /* dcr e */
+        OP(1D)            /* dcr e */
             cpu_cycles = 5;
             DCR(E);
-            break;
+            NEXT;
 
-        case 0x1E:            /* mvi e, data8 */
+        OP(1E)            /* mvi e, data8 */
             cpu_cycles = 7;
             E = RD_BYTE(PC++);
-            break;
+            NEXT;
 
-        case 0x1F:             /* rar */
+        OP(1F)             /* rar */
             cpu_cycles = 4;
             work8 = C_FLAG;
             C_FLAG = A & 0x01;
             A = (A >> 1) | (work8 << 7);
-            break;
+            NEXT;
 
-        case 0x21:             /* lxi h, data16 */
+        OP(21)             /* lxi h, data16 */
             cpu_cycles = 10;
             HL = RD_WORD(PC);
             PC += 2;
-            break;
+            NEXT;
 
-        case 0x22:            /* shld addr */
+        OP(22)            /* shld addr */
             cpu_cycles = 16;
             WR_WORD(RD_WORD(PC), HL);
             PC += 2;
-            break;
+            NEXT;
 
-        case 0x23:            /* inx h */
+        OP(23)            /* inx h */
             cpu_cycles = 5;
             HL++;
-            break;
+            NEXT;
 
-        case 0x24:            /* inr h */
+        OP(24)            /* inr h */
             cpu_cycles = 5;
             INR(H);
-            break;
+            NEXT;
 
-        case 0x25:            /* dcr h */
+        OP(25)            /* dcr h */
             cpu_cycles = 5;
             DCR(H);
-            break;
+            NEXT;
 
-        case 0x26:            /* mvi h, data8 */
+        OP(26)            /* mvi h, data8 */
             cpu_cycles = 7;
             H = RD_BYTE(PC++);
-            break;
+            NEXT;
 
-        case 0x27:            /* daa */
+        OP(27)            /* daa */
             cpu_cycles = 4;
             carry = C_FLAG;
             add = 0;
@@ -570,778 +635,777 @@ int i8080_exec_one_op(i8080 *cpu)
                 carry = 1;
             }
             ADD(add);
-            P_FLAG = PARITY(A);
             C_FLAG = carry;
-            break;
+            NEXT;
 
-        case 0x29:            /* dad hl */
+        OP(29)            /* dad hl */
             cpu_cycles = 10;
             DAD(HL);
-            break;
+            NEXT;
 
-        case 0x2A:            /* ldhl addr */
+        OP(2A)            /* ldhl addr */
             cpu_cycles = 16;
             HL = RD_WORD(RD_WORD(PC));
             PC += 2;
-            break;
+            NEXT;
 
-        case 0x2B:            /* dcx h */
+        OP(2B)            /* dcx h */
             cpu_cycles = 5;
             HL--;
-            break;
+            NEXT;
 
-        case 0x2C:            /* inr l */
+        OP(2C)            /* inr l */
             cpu_cycles = 5;
             INR(L);
-            break;
+            NEXT;
 
-        case 0x2D:            /* dcr l */
+        OP(2D)            /* dcr l */
             cpu_cycles = 5;
             DCR(L);
-            break;
+            NEXT;
 
-        case 0x2E:            /* mvi l, data8 */
+        OP(2E)            /* mvi l, data8 */
             cpu_cycles = 7;
             L = RD_BYTE(PC++);
-            break;
+            NEXT;
 
-        case 0x2F:            /* cma */
+        OP(2F)            /* cma */
             cpu_cycles = 4;
             A ^= 0xff;
-            break;
+            NEXT;
 
-        case 0x31:            /* lxi sp, data16 */
+        OP(31)            /* lxi sp, data16 */
             cpu_cycles = 10;
             SP = RD_WORD(PC);
             PC += 2;
-            break;
+            NEXT;
 
-        case 0x32:            /* sta addr */
+        OP(32)            /* sta addr */
             cpu_cycles = 13;
             WR_BYTE(RD_WORD(PC), A);
             PC += 2;
-            break;
+            NEXT;
 
-        case 0x33:            /* inx sp */
+        OP(33)            /* inx sp */
             cpu_cycles = 5;
             SP++;
-            break;
+            NEXT;
 
-        case 0x34:            /* inr m */
+        OP(34)            /* inr m */
             cpu_cycles = 10;
             work8 = RD_BYTE(HL);
             INR(work8);
             WR_BYTE(HL, work8);
-            break;
+            NEXT;
 
-        case 0x35:            /* dcr m */
+        OP(35)            /* dcr m */
             cpu_cycles = 10;
             work8 = RD_BYTE(HL);
             DCR(work8);
             WR_BYTE(HL, work8);
-            break;
+            NEXT;
 
-        case 0x36:            /* mvi m, data8 */
+        OP(36)            /* mvi m, data8 */
             cpu_cycles = 10;
             WR_BYTE(HL, RD_BYTE(PC++));
-            break;
+            NEXT;
 
-        case 0x37:            /* stc */
+        OP(37)            /* stc */
             cpu_cycles = 4;
             SET(C_FLAG);
-            break;
+            NEXT;
 
-        case 0x39:            /* dad sp */
+        OP(39)            /* dad sp */
             cpu_cycles = 10;
             DAD(SP);
-            break;
+            NEXT;
 
-        case 0x3A:            /* lda addr */
+        OP(3A)            /* lda addr */
             cpu_cycles = 13;
             A = RD_BYTE(RD_WORD(PC));
             PC += 2;
-            break;
+            NEXT;
 
-        case 0x3B:            /* dcx sp */
+        OP(3B)            /* dcx sp */
             cpu_cycles = 5;
             SP--;
-            break;
+            NEXT;
 
-        case 0x3C:            /* inr a */
+        OP(3C)            /* inr a */
             cpu_cycles = 5;
             INR(A);
-            break;
+            NEXT;
 
-        case 0x3D:            /* dcr a */
+        OP(3D)            /* dcr a */
             cpu_cycles = 5;
             DCR(A);
-            break;
+            NEXT;
 
-        case 0x3E:            /* mvi a, data8 */
+        OP(3E)            /* mvi a, data8 */
             cpu_cycles = 7;
             A = RD_BYTE(PC++);
-            break;
+            NEXT;
 
-        case 0x3F:            /* cmc */
+        OP(3F)            /* cmc */
             cpu_cycles = 4;
             CPL(C_FLAG);
-            break;
+            NEXT;
 
-        case 0x40:            /* mov b, b */
+        OP(40)            /* mov b, b */
             cpu_cycles = 4;
-            break;
+            NEXT;
 
-        case 0x41:            /* mov b, c */
+        OP(41)            /* mov b, c */
             cpu_cycles = 5;
             B = C;
-            break;
+            NEXT;
 
-        case 0x42:            /* mov b, d */
+        OP(42)            /* mov b, d */
             cpu_cycles = 5;
             B = D;
-            break;
+            NEXT;
 
-        case 0x43:            /* mov b, e */
+        OP(43)            /* mov b, e */
             cpu_cycles = 5;
             B = E;
-            break;
+            NEXT;
 
-        case 0x44:            /* mov b, h */
+        OP(44)            /* mov b, h */
             cpu_cycles = 5;
             B = H;
-            break;
+            NEXT;
 
-        case 0x45:            /* mov b, l */
+        OP(45)            /* mov b, l */
             cpu_cycles = 5;
             B = L;
-            break;
+            NEXT;
 
-        case 0x46:            /* mov b, m */
+        OP(46)            /* mov b, m */
             cpu_cycles = 7;
             B = RD_BYTE(HL);
-            break;
+            NEXT;
 
-        case 0x47:            /* mov b, a */
+        OP(47)            /* mov b, a */
             cpu_cycles = 5;
             B = A;
-            break;
+            NEXT;
 
-        case 0x48:            /* mov c, b */
+        OP(48)            /* mov c, b */
             cpu_cycles = 5;
             C = B;
-            break;
+            NEXT;
 
-        case 0x49:            /* mov c, c */
+        OP(49)            /* mov c, c */
             cpu_cycles = 5;
-            break;
+            NEXT;
 
-        case 0x4A:            /* mov c, d */
+        OP(4A)            /* mov c, d */
             cpu_cycles = 5;
             C = D;
-            break;
+            NEXT;
 
-        case 0x4B:            /* mov c, e */
+        OP(4B)            /* mov c, e */
             cpu_cycles = 5;
             C = E;
-            break;
+            NEXT;
 
-        case 0x4C:            /* mov c, h */
+        OP(4C)            /* mov c, h */
             cpu_cycles = 5;
             C = H;
-            break;
+            NEXT;
 
-        case 0x4D:            /* mov c, l */
+        OP(4D)            /* mov c, l */
             cpu_cycles = 5;
             C = L;
-            break;
+            NEXT;
 
-        case 0x4E:            /* mov c, m */
+        OP(4E)            /* mov c, m */
             cpu_cycles = 7;
             C = RD_BYTE(HL);
-            break;
+            NEXT;
 
-        case 0x4F:            /* mov c, a */
+        OP(4F)            /* mov c, a */
             cpu_cycles = 5;
             C = A;
-            break;
+            NEXT;
 
-        case 0x50:            /* mov d, b */
+        OP(50)            /* mov d, b */
             cpu_cycles = 5;
             D = B;
-            break;
+            NEXT;
 
-        case 0x51:            /* mov d, c */
+        OP(51)            /* mov d, c */
             cpu_cycles = 5;
             D = C;
-            break;
+            NEXT;
 
-        case 0x52:            /* mov d, d */
+        OP(52)            /* mov d, d */
             cpu_cycles = 5;
-            break;
+            NEXT;
 
-        case 0x53:            /* mov d, e */
+        OP(53)            /* mov d, e */
             cpu_cycles = 5;
             D = E;
-            break;
+            NEXT;
 
-        case 0x54:            /* mov d, h */
+        OP(54)            /* mov d, h */
             cpu_cycles = 5;
             D = H;
-            break;
+            NEXT;
 
-        case 0x55:            /* mov d, l */
+        OP(55)            /* mov d, l */
             cpu_cycles = 5;
             D = L;
-            break;
+            NEXT;
 
-        case 0x56:            /* mov d, m */
+        OP(56)            /* mov d, m */
             cpu_cycles = 7;
             D = RD_BYTE(HL);
-            break;
+            NEXT;
 
-        case 0x57:            /* mov d, a */
+        OP(57)            /* mov d, a */
             cpu_cycles = 5;
             D = A;
-            break;
+            NEXT;
 
-        case 0x58:            /* mov e, b */
+        OP(58)            /* mov e, b */
             cpu_cycles = 5;
             E = B;
-            break;
+            NEXT;
 
-        case 0x59:            /* mov e, c */
+        OP(59)            /* mov e, c */
             cpu_cycles = 5;
             E = C;
-            break;
+            NEXT;
 
-        case 0x5A:            /* mov e, d */
+        OP(5A)            /* mov e, d */
             cpu_cycles = 5;
             E = D;
-            break;
+            NEXT;
 
-        case 0x5B:            /* mov e, e */
+        OP(5B)            /* mov e, e */
             cpu_cycles = 5;
-            break;
+            NEXT;
 
-        case 0x5C:            /* mov c, h */
+        OP(5C)            /* mov c, h */
             cpu_cycles = 5;
             E = H;
-            break;
+            NEXT;
 
-        case 0x5D:            /* mov c, l */
+        OP(5D)            /* mov c, l */
             cpu_cycles = 5;
             E = L;
-            break;
+            NEXT;
 
-        case 0x5E:            /* mov c, m */
+        OP(5E)            /* mov c, m */
             cpu_cycles = 7;
             E = RD_BYTE(HL);
-            break;
+            NEXT;
 
-        case 0x5F:            /* mov c, a */
+        OP(5F)            /* mov c, a */
             cpu_cycles = 5;
             E = A;
-            break;
+            NEXT;
 
-        case 0x60:            /* mov h, b */
+        OP(60)            /* mov h, b */
             cpu_cycles = 5;
             H = B;
-            break;
+            NEXT;
 
-        case 0x61:            /* mov h, c */
+        OP(61)            /* mov h, c */
             cpu_cycles = 5;
             H = C;
-            break;
+            NEXT;
 
-        case 0x62:            /* mov h, d */
+        OP(62)            /* mov h, d */
             cpu_cycles = 5;
             H = D;
-            break;
+            NEXT;
 
-        case 0x63:            /* mov h, e */
+        OP(63)            /* mov h, e */
             cpu_cycles = 5;
             H = E;
-            break;
+            NEXT;
 
-        case 0x64:            /* mov h, h */
+        OP(64)            /* mov h, h */
             cpu_cycles = 5;
-            break;
+            NEXT;
 
-        case 0x65:            /* mov h, l */
+        OP(65)            /* mov h, l */
             cpu_cycles = 5;
             H = L;
-            break;
+            NEXT;
 
-        case 0x66:            /* mov h, m */
+        OP(66)            /* mov h, m */
             cpu_cycles = 7;
             H = RD_BYTE(HL);
-            break;
+            NEXT;
 
-        case 0x67:            /* mov h, a */
+        OP(67)            /* mov h, a */
             cpu_cycles = 5;
             H = A;
-            break;
+            NEXT;
 
-        case 0x68:            /* mov l, b */
+        OP(68)            /* mov l, b */
             cpu_cycles = 5;
             L = B;
-            break;
+            NEXT;
 
-        case 0x69:            /* mov l, c */
+        OP(69)            /* mov l, c */
             cpu_cycles = 5;
             L = C;
-            break;
+            NEXT;
 
-        case 0x6A:            /* mov l, d */
+        OP(6A)            /* mov l, d */
             cpu_cycles = 5;
             L = D;
-            break;
+            NEXT;
 
-        case 0x6B:            /* mov l, e */
+        OP(6B)            /* mov l, e */
             cpu_cycles = 5;
             L = E;
-            break;
+            NEXT;
 
-        case 0x6C:            /* mov l, h */
+        OP(6C)            /* mov l, h */
             cpu_cycles = 5;
             L = H;
-            break;
+            NEXT;
 
-        case 0x6D:            /* mov l, l */
+        OP(6D)            /* mov l, l */
             cpu_cycles = 5;
-            break;
+            NEXT;
 
-        case 0x6E:            /* mov l, m */
+        OP(6E)            /* mov l, m */
             cpu_cycles = 7;
             L = RD_BYTE(HL);
-            break;
+            NEXT;
 
-        case 0x6F:            /* mov l, a */
+        OP(6F)            /* mov l, a */
             cpu_cycles = 5;
             L = A;
-            break;
+            NEXT;
 
-        case 0x70:            /* mov m, b */
+        OP(70)            /* mov m, b */
             cpu_cycles = 7;
             WR_BYTE(HL, B);
-            break;
+            NEXT;
 
-        case 0x71:            /* mov m, c */
+        OP(71)            /* mov m, c */
             cpu_cycles = 7;
             WR_BYTE(HL, C);
-            break;
+            NEXT;
 
-        case 0x72:            /* mov m, d */
+        OP(72)            /* mov m, d */
             cpu_cycles = 7;
             WR_BYTE(HL, D);
-            break;
+            NEXT;
 
-        case 0x73:            /* mov m, e */
+        OP(73)            /* mov m, e */
             cpu_cycles = 7;
             WR_BYTE(HL, E);
-            break;
+            NEXT;
 
-        case 0x74:            /* mov m, h */
+        OP(74)            /* mov m, h */
             cpu_cycles = 7;
             WR_BYTE(HL, H);
-            break;
+            NEXT;
 
-        case 0x75:            /* mov m, l */
+        OP(75)            /* mov m, l */
             cpu_cycles = 7;
             WR_BYTE(HL, L);
-            break;
+            NEXT;
 
-        case 0x76:            /* hlt */
+        OP(76)            /* hlt */
             cpu_cycles = 4;
             HALT = 1;
-            break;
+            NEXT;
 
-        case 0x77:            /* mov m, a */
+        OP(77)            /* mov m, a */
             cpu_cycles = 7;
             WR_BYTE(HL, A);
-            break;
+            NEXT;
 
-        case 0x78:            /* mov a, b */
+        OP(78)            /* mov a, b */
             cpu_cycles = 5;
             A = B;
-            break;
+            NEXT;
 
-        case 0x79:            /* mov a, c */
+        OP(79)            /* mov a, c */
             cpu_cycles = 5;
             A = C;
-            break;
+            NEXT;
 
-        case 0x7A:            /* mov a, d */
+        OP(7A)            /* mov a, d */
             cpu_cycles = 5;
             A = D;
-            break;
+            NEXT;
 
-        case 0x7B:            /* mov a, e */
+        OP(7B)            /* mov a, e */
             cpu_cycles = 5;
             A = E;
-            break;
+            NEXT;
 
-        case 0x7C:            /* mov a, h */
+        OP(7C)            /* mov a, h */
             cpu_cycles = 5;
             A = H;
-            break;
+            NEXT;
 
-        case 0x7D:            /* mov a, l */
+        OP(7D)            /* mov a, l */
             cpu_cycles = 5;
             A = L;
-            break;
+            NEXT;
 
-        case 0x7E:            /* mov a, m */
+        OP(7E)            /* mov a, m */
             cpu_cycles = 7;
             A = RD_BYTE(HL);
-            break;
+            NEXT;
 
-        case 0x7F:            /* mov a, a */
+        OP(7F)            /* mov a, a */
             cpu_cycles = 5;
-            break;
+            NEXT;
 
-        case 0x80:            /* add b */
+        OP(80)            /* add b */
             cpu_cycles = 4;
             ADD(B);
-            break;
+            NEXT;
 
-        case 0x81:            /* add c */
+        OP(81)            /* add c */
             cpu_cycles = 4;
             ADD(C);
-            break;
+            NEXT;
 
-        case 0x82:            /* add d */
+        OP(82)            /* add d */
             cpu_cycles = 4;
             ADD(D);
-            break;
+            NEXT;
 
-        case 0x83:            /* add e */
+        OP(83)            /* add e */
             cpu_cycles = 4;
             ADD(E);
-            break;
+            NEXT;
 
-        case 0x84:            /* add h */
+        OP(84)            /* add h */
             cpu_cycles = 4;
             ADD(H);
-            break;
+            NEXT;
 
-        case 0x85:            /* add l */
+        OP(85)            /* add l */
             cpu_cycles = 4;
             ADD(L);
-            break;
+            NEXT;
 
-        case 0x86:            /* add m */
+        OP(86)            /* add m */
             cpu_cycles = 7;
             work8 = RD_BYTE(HL);
             ADD(work8);
-            break;
+            NEXT;
 
-        case 0x87:            /* add a */
+        OP(87)            /* add a */
             cpu_cycles = 4;
             ADD(A);
-            break;
+            NEXT;
 
-        case 0x88:            /* adc b */
+        OP(88)            /* adc b */
             cpu_cycles = 4;
             ADC(B);
-            break;
+            NEXT;
 
-        case 0x89:            /* adc c */
+        OP(89)            /* adc c */
             cpu_cycles = 4;
             ADC(C);
-            break;
+            NEXT;
 
-        case 0x8A:            /* adc d */
+        OP(8A)            /* adc d */
             cpu_cycles = 4;
             ADC(D);
-            break;
+            NEXT;
 
-        case 0x8B:            /* adc e */
+        OP(8B)            /* adc e */
             cpu_cycles = 4;
             ADC(E);
-            break;
+            NEXT;
 
-        case 0x8C:            /* adc h */
+        OP(8C)            /* adc h */
             cpu_cycles = 4;
             ADC(H);
-            break;
+            NEXT;
 
-        case 0x8D:            /* adc l */
+        OP(8D)            /* adc l */
             cpu_cycles = 4;
             ADC(L);
-            break;
+            NEXT;
 
-        case 0x8E:            /* adc m */
+        OP(8E)            /* adc m */
             cpu_cycles = 7;
             work8 = RD_BYTE(HL);
             ADC(work8);
-            break;
+            NEXT;
 
-        case 0x8F:            /* adc a */
+        OP(8F)            /* adc a */
             cpu_cycles = 4;
             ADC(A);
-            break;
+            NEXT;
 
-        case 0x90:            /* sub b */
+        OP(90)            /* sub b */
             cpu_cycles = 4;
             SUB(B);
-            break;
+            NEXT;
 
-        case 0x91:            /* sub c */
+        OP(91)            /* sub c */
             cpu_cycles = 4;
             SUB(C);
-            break;
+            NEXT;
 
-        case 0x92:            /* sub d */
+        OP(92)            /* sub d */
             cpu_cycles = 4;
             SUB(D);
-            break;
+            NEXT;
 
-        case 0x93:            /* sub e */
+        OP(93)            /* sub e */
             cpu_cycles = 4;
             SUB(E);
-            break;
+            NEXT;
 
-        case 0x94:            /* sub h */
+        OP(94)            /* sub h */
             cpu_cycles = 4;
             SUB(H);
-            break;
+            NEXT;
 
-        case 0x95:            /* sub l */
+        OP(95)            /* sub l */
             cpu_cycles = 4;
             SUB(L);
-            break;
+            NEXT;
 
-        case 0x96:            /* sub m */
+        OP(96)            /* sub m */
             cpu_cycles = 7;
             work8 = RD_BYTE(HL);
             SUB(work8);
-            break;
+            NEXT;
 
-        case 0x97:            /* sub a */
+        OP(97)            /* sub a */
             cpu_cycles = 4;
             SUB(A);
-            break;
+            NEXT;
 
-        case 0x98:            /* sbb b */
+        OP(98)            /* sbb b */
             cpu_cycles = 4;
             SBB(B);
-            break;
+            NEXT;
 
-        case 0x99:            /* sbb c */
+        OP(99)            /* sbb c */
             cpu_cycles = 4;
             SBB(C);
-            break;
+            NEXT;
 
-        case 0x9A:            /* sbb d */
+        OP(9A)            /* sbb d */
             cpu_cycles = 4;
             SBB(D);
-            break;
+            NEXT;
 
-        case 0x9B:            /* sbb e */
+        OP(9B)            /* sbb e */
             cpu_cycles = 4;
             SBB(E);
-            break;
+            NEXT;
 
-        case 0x9C:            /* sbb h */
+        OP(9C)            /* sbb h */
             cpu_cycles = 4;
             SBB(H);
-            break;
+            NEXT;
 
-        case 0x9D:            /* sbb l */
+        OP(9D)            /* sbb l */
             cpu_cycles = 4;
             SBB(L);
-            break;
+            NEXT;
 
-        case 0x9E:            /* sbb m */
+        OP(9E)            /* sbb m */
             cpu_cycles = 7;
             work8 = RD_BYTE(HL);
             SBB(work8);
-            break;
+            NEXT;
 
-        case 0x9F:            /* sbb a */
+        OP(9F)            /* sbb a */
             cpu_cycles = 4;
             SBB(A);
-            break;
+            NEXT;
 
-        case 0xA0:            /* ana b */
+        OP(A0)            /* ana b */
             cpu_cycles = 4;
             ANA(B);
-            break;
+            NEXT;
 
-        case 0xA1:            /* ana c */
+        OP(A1)            /* ana c */
             cpu_cycles = 4;
             ANA(C);
-            break;
+            NEXT;
 
-        case 0xA2:            /* ana d */
+        OP(A2)            /* ana d */
             cpu_cycles = 4;
             ANA(D);
-            break;
+            NEXT;
 
-        case 0xA3:            /* ana e */
+        OP(A3)            /* ana e */
             cpu_cycles = 4;
             ANA(E);
-            break;
+            NEXT;
 
-        case 0xA4:            /* ana h */
+        OP(A4)            /* ana h */
             cpu_cycles = 4;
             ANA(H);
-            break;
+            NEXT;
 
-        case 0xA5:            /* ana l */
+        OP(A5)            /* ana l */
             cpu_cycles = 4;
             ANA(L);
-            break;
+            NEXT;
 
-        case 0xA6:            /* ana m */
+        OP(A6)            /* ana m */
             cpu_cycles = 7;
             work8 = RD_BYTE(HL);
             ANA(work8);
-            break;
+            NEXT;
 
-        case 0xA7:            /* ana a */
+        OP(A7)            /* ana a */
             cpu_cycles = 4;
             ANA(A);
-            break;
+            NEXT;
 
-        case 0xA8:            /* xra b */
+        OP(A8)            /* xra b */
             cpu_cycles = 4;
             XRA(B);
-            break;
+            NEXT;
 
-        case 0xA9:            /* xra c */
+        OP(A9)            /* xra c */
             cpu_cycles = 4;
             XRA(C);
-            break;
+            NEXT;
 
-        case 0xAA:            /* xra d */
+        OP(AA)            /* xra d */
             cpu_cycles = 4;
             XRA(D);
-            break;
+            NEXT;
 
-        case 0xAB:            /* xra e */
+        OP(AB)            /* xra e */
             cpu_cycles = 4;
             XRA(E);
-            break;
+            NEXT;
 
-        case 0xAC:            /* xra h */
+        OP(AC)            /* xra h */
             cpu_cycles = 4;
             XRA(H);
-            break;
+            NEXT;
 
-        case 0xAD:            /* xra l */
+        OP(AD)            /* xra l */
             cpu_cycles = 4;
             XRA(L);
-            break;
+            NEXT;
 
-        case 0xAE:            /* xra m */
+        OP(AE)            /* xra m */
             cpu_cycles = 7;
             work8 = RD_BYTE(HL);
             XRA(work8);
-            break;
+            NEXT;
 
-        case 0xAF:            /* xra a */
+        OP(AF)            /* xra a */
             cpu_cycles = 4;
             XRA(A);
-            break;
+            NEXT;
 
-        case 0xB0:            /* ora b */
+        OP(B0)            /* ora b */
             cpu_cycles = 4;
             ORA(B);
-            break;
+            NEXT;
 
-        case 0xB1:            /* ora c */
+        OP(B1)            /* ora c */
             cpu_cycles = 4;
             ORA(C);
-            break;
+            NEXT;
 
-        case 0xB2:            /* ora d */
+        OP(B2)            /* ora d */
             cpu_cycles = 4;
             ORA(D);
-            break;
+            NEXT;
 
-        case 0xB3:            /* ora e */
+        OP(B3)            /* ora e */
             cpu_cycles = 4;
             ORA(E);
-            break;
+            NEXT;
 
-        case 0xB4:            /* ora h */
+        OP(B4)            /* ora h */
             cpu_cycles = 4;
             ORA(H);
-            break;
+            NEXT;
 
-        case 0xB5:            /* ora l */
+        OP(B5)            /* ora l */
             cpu_cycles = 4;
             ORA(L);
-            break;
+            NEXT;
 
-        case 0xB6:            /* ora m */
+        OP(B6)            /* ora m */
             cpu_cycles = 7;
             work8 = RD_BYTE(HL);
             ORA(work8);
-            break;
+            NEXT;
 
-        case 0xB7:            /* ora a */
+        OP(B7)            /* ora a */
             cpu_cycles = 4;
             ORA(A);
-            break;
+            NEXT;
 
-        case 0xB8:            /* cmp b */
+        OP(B8)            /* cmp b */
             cpu_cycles = 4;
             CMP(B);
-            break;
+            NEXT;
 
-        case 0xB9:            /* cmp c */
+        OP(B9)            /* cmp c */
             cpu_cycles = 4;
             CMP(C);
-            break;
+            NEXT;
 
-        case 0xBA:            /* cmp d */
+        OP(BA)            /* cmp d */
             cpu_cycles = 4;
             CMP(D);
-            break;
+            NEXT;
 
-        case 0xBB:            /* cmp e */
+        OP(BB)            /* cmp e */
             cpu_cycles = 4;
             CMP(E);
-            break;
+            NEXT;
 
-        case 0xBC:            /* cmp h */
+        OP(BC)            /* cmp h */
             cpu_cycles = 4;
             CMP(H);
-            break;
+            NEXT;
 
-        case 0xBD:            /* cmp l */
+        OP(BD)            /* cmp l */
             cpu_cycles = 4;
             CMP(L);
-            break;
+            NEXT;
 
-        case 0xBE:            /* cmp m */
+        OP(BE)            /* cmp m */
             cpu_cycles = 7;
             work8 = RD_BYTE(HL);
             CMP(work8);
-            break;
+            NEXT;
 
-        case 0xBF:            /* cmp a */
+        OP(BF)            /* cmp a */
             cpu_cycles = 4;
             CMP(A);
-            break;
+            NEXT;
 
-        case 0xC0:            /* rnz */
+        OP(C0)            /* rnz */
             cpu_cycles = 5;
             if (!TST(Z_FLAG)) {
                 cpu_cycles = 11;
                 POP(PC);
             }
-            break;
+            NEXT;
 
-        case 0xC1:            /* pop b */
+        OP(C1)            /* pop b */
             cpu_cycles = 11;
             POP(BC);
-            break;
+            NEXT;
 
-        case 0xC2:            /* jnz addr */
+        OP(C2)            /* jnz addr */
             cpu_cycles = 10;
             if (!TST(Z_FLAG)) {
                 PC = RD_WORD(PC);
@@ -1349,15 +1413,15 @@ int i8080_exec_one_op(i8080 *cpu)
             else {
                 PC += 2;
             }
-            break;
+            NEXT;
 
-        case 0xC3:            /* jmp addr */
-        case 0xCB:            /* jmp addr, undocumented */
+        OP(C3)            /* jmp addr */
+        OP(CB)            /* jmp addr, undocumented */
             cpu_cycles = 10;
             PC = RD_WORD(PC);
-            break;
+            NEXT;
 
-        case 0xC4:            /* cnz addr */
+        OP(C4)            /* cnz addr */
             if (!TST(Z_FLAG)) {
                 cpu_cycles = 17;
                 CALL;
@@ -1365,48 +1429,48 @@ int i8080_exec_one_op(i8080 *cpu)
                 cpu_cycles = 11;
                 PC += 2;
             }
-            break;
+            NEXT;
 
-        case 0xC5:            /* push b */
+        OP(C5)            /* push b */
             cpu_cycles = 11;
             PUSH(BC);
-            break;
+            NEXT;
 
-        case 0xC6:            /* adi data8 */
+        OP(C6)            /* adi data8 */
             cpu_cycles = 7;
             work8 = RD_BYTE(PC++);
             ADD(work8);
-            break;
+            NEXT;
 
-        case 0xC7:            /* rst 0 */
+        OP(C7)            /* rst 0 */
             cpu_cycles = 11;
             RST(0x0000);
-            break;
+            NEXT;
 
-        case 0xC8:            /* rz */
+        OP(C8)            /* rz */
             cpu_cycles = 5;
             if (TST(Z_FLAG)) {
                 cpu_cycles = 11;
                 POP(PC);
             }
-            break;
+            NEXT;
 
-        case 0xC9:            /* ret */
-        case 0xD9:            /* ret, undocumented */
+        OP(C9)            /* ret */
+        OP(D9)            /* ret, undocumented */
             cpu_cycles = 10;
             POP(PC);
-            break;
+            NEXT;
 
-        case 0xCA:            /* jz addr */
+        OP(CA)            /* jz addr */
             cpu_cycles = 10;
             if (TST(Z_FLAG)) {
                 PC = RD_WORD(PC);
             } else {
                 PC += 2;
             }
-            break;
+            NEXT;
 
-        case 0xCC:            /* cz addr */
+        OP(CC)            /* cz addr */
             if (TST(Z_FLAG)) {
                 cpu_cycles = 17;
                 CALL;
@@ -1414,55 +1478,55 @@ int i8080_exec_one_op(i8080 *cpu)
                 cpu_cycles = 11;
                 PC += 2;
             }
-            break;
+            NEXT;
 
-        case 0xCD:            /* call addr */
-        case 0xDD:            /* call, undocumented */
-        case 0xED:
-        case 0xFD:
+        OP(CD)            /* call addr */
+        OP(DD)            /* call, undocumented */
+        OP(ED)
+        OP(FD)
             cpu_cycles = 17;
             CALL;
-            break;
+            NEXT;
 
-        case 0xCE:            /* aci data8 */
+        OP(CE)            /* aci data8 */
             cpu_cycles = 7;
             work8 = RD_BYTE(PC++);
             ADC(work8);
-            break;
+            NEXT;
 
-        case 0xCF:            /* rst 1 */
+        OP(CF)            /* rst 1 */
             cpu_cycles = 11;
             RST(0x0008);
-            break;
+            NEXT;
 
-        case 0xD0:            /* rnc */
+        OP(D0)            /* rnc */
             cpu_cycles = 5;
             if (!TST(C_FLAG)) {
                 cpu_cycles = 11;
                 POP(PC);
             }
-            break;
+            NEXT;
 
-        case 0xD1:            /* pop d */
+        OP(D1)            /* pop d */
             cpu_cycles = 11;
             POP(DE);
-            break;
+            NEXT;
 
-        case 0xD2:            /* jnc addr */
+        OP(D2)            /* jnc addr */
             cpu_cycles = 10;
             if (!TST(C_FLAG)) {
                 PC = RD_WORD(PC);
             } else {
                 PC += 2;
             }
-            break;
+            NEXT;
 
-        case 0xD3:            /* out port8 */
+        OP(D3)            /* out port8 */
             cpu_cycles = 10;
             (*(cpu->out_func))(RD_BYTE(PC++), A, cpu->user);
-            break;
+            NEXT;
 
-        case 0xD4:            /* cnc addr */
+        OP(D4)            /* cnc addr */
             if (!TST(C_FLAG)) {
                 cpu_cycles = 17;
                 CALL;
@@ -1470,47 +1534,47 @@ int i8080_exec_one_op(i8080 *cpu)
                 cpu_cycles = 11;
                 PC += 2;
             }
-            break;
+            NEXT;
 
-        case 0xD5:            /* push d */
+        OP(D5)            /* push d */
             cpu_cycles = 11;
             PUSH(DE);
-            break;
+            NEXT;
 
-        case 0xD6:            /* sui data8 */
+        OP(D6)            /* sui data8 */
             cpu_cycles = 7;
             work8 = RD_BYTE(PC++);
             SUB(work8);
-            break;
+            NEXT;
 
-        case 0xD7:            /* rst 2 */
+        OP(D7)            /* rst 2 */
             cpu_cycles = 11;
             RST(0x0010);
-            break;
+            NEXT;
 
-        case 0xD8:            /* rc */
+        OP(D8)            /* rc */
             cpu_cycles = 5;
             if (TST(C_FLAG)) {
                 cpu_cycles = 11;
                 POP(PC);
             }
-            break;
+            NEXT;
 
-        case 0xDA:            /* jc addr */
+        OP(DA)            /* jc addr */
             cpu_cycles = 10;
             if (TST(C_FLAG)) {
                 PC = RD_WORD(PC);
             } else {
                 PC += 2;
             }
-            break;
+            NEXT;
 
-        case 0xDB:            /* in port8 */
+        OP(DB)            /* in port8 */
             cpu_cycles = 10;
             A = (*(cpu->in_func))(RD_BYTE(PC++), cpu->user);
-            break;
+            NEXT;
 
-        case 0xDC:            /* cc addr */
+        OP(DC)            /* cc addr */
             if (TST(C_FLAG)) {
                 cpu_cycles = 17;
                 CALL;
@@ -1518,33 +1582,33 @@ int i8080_exec_one_op(i8080 *cpu)
                 cpu_cycles = 11;
                 PC += 2;
             }
-            break;
+            NEXT;
 
-        case 0xDE:            /* sbi data8 */
+        OP(DE)            /* sbi data8 */
             cpu_cycles = 7;
             work8 = RD_BYTE(PC++);
             SBB(work8);
-            break;
+            NEXT;
 
-        case 0xDF:            /* rst 3 */
+        OP(DF)            /* rst 3 */
             cpu_cycles = 11;
             RST(0x0018);
-            break;
+            NEXT;
 
-        case 0xE0:            /* rpo */
+        OP(E0)            /* rpo */
             cpu_cycles = 5;
             if (!TST(P_FLAG)) {
                 cpu_cycles = 11;
                 POP(PC);
             }
-            break;
+            NEXT;
 
-        case 0xE1:            /* pop h */
+        OP(E1)            /* pop h */
             cpu_cycles = 11;
             POP(HL);
-            break;
+            NEXT;
 
-        case 0xE2:            /* jpo addr */
+        OP(E2)            /* jpo addr */
             cpu_cycles = 10;
             if (!TST(P_FLAG)) {
                 PC = RD_WORD(PC);
@@ -1552,16 +1616,16 @@ int i8080_exec_one_op(i8080 *cpu)
             else {
                 PC += 2;
             }
-            break;
+            NEXT;
 
-        case 0xE3:            /* xthl */
+        OP(E3)            /* xthl */
             cpu_cycles = 18;
             work16 = RD_WORD(SP);
             WR_WORD(SP, HL);
             HL = work16;
-            break;
+            NEXT;
 
-        case 0xE4:            /* cpo addr */
+        OP(E4)            /* cpo addr */
             if (!TST(P_FLAG)) {
                 cpu_cycles = 17;
                 CALL;
@@ -1569,54 +1633,54 @@ int i8080_exec_one_op(i8080 *cpu)
                 cpu_cycles = 11;
                 PC += 2;
             }
-            break;
+            NEXT;
 
-        case 0xE5:            /* push h */
+        OP(E5)            /* push h */
             cpu_cycles = 11;
             PUSH(HL);
-            break;
+            NEXT;
 
-        case 0xE6:            /* ani data8 */
+        OP(E6)            /* ani data8 */
             cpu_cycles = 7;
             work8 = RD_BYTE(PC++);
             ANA(work8);
-            break;
+            NEXT;
 
-        case 0xE7:            /* rst 4 */
+        OP(E7)            /* rst 4 */
             cpu_cycles = 11;
             RST(0x0020);
-            break;
+            NEXT;
 
-        case 0xE8:            /* rpe */
+        OP(E8)            /* rpe */
             cpu_cycles = 5;
             if (TST(P_FLAG)) {
                 cpu_cycles = 11;
                 POP(PC);
             }
-            break;
+            NEXT;
 
-        case 0xE9:            /* pchl */
+        OP(E9)            /* pchl */
             cpu_cycles = 5;
             PC = HL;
-            break;
+            NEXT;
 
-        case 0xEA:            /* jpe addr */
+        OP(EA)            /* jpe addr */
             cpu_cycles = 10;
             if (TST(P_FLAG)) {
                 PC = RD_WORD(PC);
             } else {
                 PC += 2;
             }
-            break;
+            NEXT;
 
-        case 0xEB:            /* xchg */
+        OP(EB)            /* xchg */
             cpu_cycles = 4;
             work16 = DE;
             DE = HL;
             HL = work16;
-            break;
+            NEXT;
 
-        case 0xEC:            /* cpe addr */
+        OP(EC)            /* cpe addr */
             if (TST(P_FLAG)) {
                 cpu_cycles = 17;
                 CALL;
@@ -1624,48 +1688,48 @@ int i8080_exec_one_op(i8080 *cpu)
                 cpu_cycles = 11;
                 PC += 2;
             }
-            break;
+            NEXT;
 
-        case 0xEE:            /* xri data8 */
+        OP(EE)            /* xri data8 */
             cpu_cycles = 7;
             work8 = RD_BYTE(PC++);
             XRA(work8);
-            break;
+            NEXT;
 
-        case 0xEF:            /* rst 5 */
+        OP(EF)            /* rst 5 */
             cpu_cycles = 11;
             RST(0x0028);
-            break;
+            NEXT;
 
-        case 0xF0:            /* rp */
+        OP(F0)            /* rp */
             cpu_cycles = 5;
             if (!TST(S_FLAG)) {
                 cpu_cycles = 11;
                 POP(PC);
             }
-            break;
+            NEXT;
 
-        case 0xF1:            /* pop psw */
+        OP(F1)            /* pop psw */
             cpu_cycles = 10;
             POP(AF);
             i8080_retrieve_flags(cpu);
-            break;
+            NEXT;
 
-        case 0xF2:            /* jp addr */
+        OP(F2)            /* jp addr */
             cpu_cycles = 10;
             if (!TST(S_FLAG)) {
                 PC = RD_WORD(PC);
             } else {
                 PC += 2;
             }
-            break;
+            NEXT;
 
-        case 0xF3:            /* di */
+        OP(F3)            /* di */
             cpu_cycles = 4;
             INTE = 0;
-            break;
+            NEXT;
 
-        case 0xF4:            /* cp addr */
+        OP(F4)            /* cp addr */
             if (!TST(S_FLAG)) {
                 cpu_cycles = 17;
                 CALL;
@@ -1673,48 +1737,48 @@ int i8080_exec_one_op(i8080 *cpu)
                 cpu_cycles = 11;
                 PC += 2;
             }
-            break;
+            NEXT;
 
-        case 0xF5:            /* push psw */
+        OP(F5)            /* push psw */
             cpu_cycles = 11;
             i8080_store_flags(cpu);
             PUSH(AF);
-            break;
+            NEXT;
 
-        case 0xF6:            /* ori data8 */
+        OP(F6)            /* ori data8 */
             cpu_cycles = 7;
             work8 = RD_BYTE(PC++);
             ORA(work8);
-            break;
+            NEXT;
 
-        case 0xF7:            /* rst 6 */
+        OP(F7)            /* rst 6 */
             cpu_cycles = 11;
             RST(0x0030);
-            break;
+            NEXT;
 
-        case 0xF8:            /* rm */
+        OP(F8)            /* rm */
             cpu_cycles = 5;
             if (TST(S_FLAG)) {
                 cpu_cycles = 11;
                 POP(PC);
             }
-            break;
+            NEXT;
 
-        case 0xF9:            /* sphl */
+        OP(F9)            /* sphl */
             cpu_cycles = 5;
             SP = HL;
-            break;
+            NEXT;
 
-        case 0xFA:            /* jm addr */
+        OP(FA)            /* jm addr */
             cpu_cycles = 10;
             if (TST(S_FLAG)) {
                 PC = RD_WORD(PC);
             } else {
                 PC += 2;
             }
-            break;
+            NEXT;
 
-        case 0xFB:            /* ei */
+        OP(FB)            /* ei */
             /* FIXME: interrupt enable doesn't take effect until after the next
              * instruction, so the program state always makes at least one
              * instruction progress even with an always on interrupt. for now,
@@ -1722,9 +1786,9 @@ int i8080_exec_one_op(i8080 *cpu)
              */
             cpu_cycles = 4;
             INTE = 1;
-            break;
+            NEXT;
 
-        case 0xFC:            /* cm addr */
+        OP(FC)            /* cm addr */
             if (TST(S_FLAG)) {
                 cpu_cycles = 17;
                 CALL;
@@ -1732,23 +1796,22 @@ int i8080_exec_one_op(i8080 *cpu)
                 cpu_cycles = 11;
                 PC += 2;
             }
-            break;
+            NEXT;
 
-        case 0xFE:            /* cpi data8 */
+        OP(FE)            /* cpi data8 */
             cpu_cycles = 7;
             work8 = RD_BYTE(PC++);
             CMP(work8);
-            break;
+            NEXT;
 
-        case 0xFF:            /* rst 7 */
+        OP(FF)            /* rst 7 */
             cpu_cycles = 11;
             RST(0x0038);
-            break;
+            NEXT;
 
-        default:
-            cpu_cycles = -1;  /* Shouldn't be really here. */
-            break;
     }
+    END_DISPATCH;
+
 
     return cpu_cycles;
 }
@@ -60,13 +60,15 @@ typedef union {
     uint16_t w;
 } reg_pair;
 
-// bits 1,3,5 are unused and not represented
+// bits 1,3,5 are unused and not represented.
+// only carry is stored directly; the other flags are derived on demand
+// from the most recent result and operands (see i8080.c).
 typedef struct {
     uint8_t carry_flag;
-    uint8_t parity_flag;
-    uint8_t half_carry_flag;
-    uint8_t zero_flag;
-    uint8_t sign_flag;
+    uint8_t result;     // low 8b of the last result that set S, Z, P
+    uint8_t lazy_a;     // its operands, for half carry
+    uint8_t lazy_b;
+    uint8_t lazy_op;    // which kind of op produced them
 } flag_reg;
 
 typedef struct {
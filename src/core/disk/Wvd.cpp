@@ -3,12 +3,20 @@
 // ------------------------------------------------------------------------
 
 #include "../io/IoCardDisk.h"
+#include "../system/system2200.h"
 #include "../../gui/system/Ui.h"
 #include "Wvd.h"
+#include "WvdRemote.h"
 #include "../../platform/common/host.h"              // for dbglog()
 
-#include <fstream>
+#include <algorithm>
 #include <cstring>
+#include <fstream>
+
+#if !defined(_WIN32) && !defined(__APPLE__)
+    #include <fcntl.h>      // for posix_fallocate()
+    #include <unistd.h>
+#endif
 
 #ifdef _DEBUG
     #define DBG  (0)            // turn on some debug logging
@@ -24,10 +32,67 @@
 // therefore the most platters a drive could ever have is 15 platters
 #define WVD_MAX_PLATTERS 15
 
+// format() zeros a platter this many sectors at a time
+static constexpr int FORMAT_BLOCK_SECTORS = 1024;
+
+const Wvd::geometry_t Wvd::geometries[] = {
+                                                                                        // tracks*sectors*sides
+    { "fd5",    "PCS 5.25\" floppy disk (88 KB)",        Wvd::DISKTYPE_FD5,      1,   35*10   },  // =   350
+    { "fd5dd",  "PCS 5.25\" DSDD floppy disk (320 KB)",  Wvd::DISKTYPE_FD5_DD,   1,   40*16*2 },  // =  1280
+    { "fd5hd",  "PCS 5.25\" DSHD floppy disk (1040 KB)", Wvd::DISKTYPE_FD5_HD,   1,   80*26*2 },  // =  4160
+
+    { "fd8",    "2270 8\" floppy disk (260 KB)",         Wvd::DISKTYPE_FD8,      1,   64*16   },  // =  1024
+    { "fd8a",   "2270A 8\" floppy disk (308 KB)",        Wvd::DISKTYPE_FD8,      1,   77*16   },  // =  1232
+
+    { "hd60-5", "2260 5 MB disk",                        Wvd::DISKTYPE_HD60,     1,  816*24   },  // = 19584
+    { "hd60-8", "2260 8 MB disk",                        Wvd::DISKTYPE_HD60,     1,   32767   },  // damn -- partial track.  32760 would have been best
+
+    { "hd80-1", "2280-1 13 MB * 1 platter disk",         Wvd::DISKTYPE_HD80,     1,  822*64   },  // = 52608
+    { "hd80-3", "2280-3 13 MB * 3 platter disk",         Wvd::DISKTYPE_HD80,     3,  822*64   },  // = 52608
+    { "hd80-5", "2280-5 13 MB * 5 platter disk",         Wvd::DISKTYPE_HD80,     5,  822*64   },  // = 52608
+
+// these are real products described in the document "CS-2200 Ramblings.pdf", page 21:
+//  { "ds20",   "DS-20 10 MB * 2 platter disk",   Wvd::DISKTYPE_HD80,  2,  640*64  },  // = 40960
+//  { "ds32",   "DS-32 16 MB * 2 platter disk",   Wvd::DISKTYPE_HD80,  2, 1023*64  },  // = 65472 (65536 is too big)
+//  { "ds64",   "DS-64 16 MB * 4 platter disk",   Wvd::DISKTYPE_HD80,  4, 1023*64  },  // = 65472
+    { "ds112",  "DS-112 16 MB * 7 platter disk",  Wvd::DISKTYPE_HD80,  7, 1023*64  },  // = 65472
+    { "ds140",  "DS-140 10 MB * 14 platter disk", Wvd::DISKTYPE_HD80, 14,  640*64  },  // = 40960
+// this is one I just made up -- it is the largest possible disk:
+    { "ds224",  "DS-224 16 MB * 14 platter disk", Wvd::DISKTYPE_HD80, 14, 1023*64  },  // = 65472
+};
+const int Wvd::num_geometries = sizeof(Wvd::geometries) / sizeof(Wvd::geometry_t);
+
+
+// allocate real blocks for the first "bytes" of an existing file, so later
+// writes can't fail for lack of space and don't fragment.  returns false
+// if the host can't do it, in which case the file is left as it was.
+static bool
+reserveFileSpace(const std::string &filename, int64 bytes)
+{
+#if defined(_WIN32) || defined(__APPLE__)
+    // NTFS and APFS zero-fill extended files without help;
+    // there is no portable call to reserve the blocks up front
+    (void)filename;
+    (void)bytes;
+    return false;
+#else
+    const int fd = ::open(filename.c_str(), O_WRONLY);
+    if (fd < 0) {
+        return false;
+    }
+    const int err = posix_fallocate(fd, 0, static_cast<off_t>(bytes));
+    ::close(fd);
+    return (err == 0);
+#endif
+}
+
 // =====================================================
 //   public interface
 // =====================================================
 
+Wvd::Wvd() = default;  // here, where WvdRemote is complete
+
+
 Wvd::~Wvd()
 {
     close();
@@ -56,6 +121,29 @@ Wvd::open(const std::string &filename)
     assert(!m_has_path);
     assert(!filename.empty());
 
+    if (WvdRemote::isRemotePath(filename)) {
+        m_remote = std::make_unique<WvdRemote>();
+        if (!m_remote->open(filename)) {
+            m_remote = nullptr;
+            return false;
+        }
+        m_has_path = true;
+        m_path = filename;
+        bool ok = readHeader();
+        if (ok && m_num_platters*m_num_platter_sectors+1 > m_remote->numSectors()) {
+            UI_error("The disk image '%s' is shorter than its header says",
+                     filename.c_str());
+            ok = false;
+        }
+        if (!ok) {
+            m_remote = nullptr;
+            m_has_path = false;
+            m_path = "";
+        }
+        m_metadata_stale = false;
+        return ok;
+    }
+
     // set up a file handle
     m_file = std::make_unique<std::fstream>(
                     filename.c_str(),
@@ -90,6 +178,10 @@ Wvd::close()
         }
         m_file = nullptr;
     }
+    m_remote = nullptr;
+
+    m_overlay = false;
+    m_overlay_sectors.clear();
 
     // reinitialize in case the Wvd object gets recycled
     setPath("");
@@ -248,9 +340,10 @@ Wvd::readSector(int platter, int sector, const uint8 *buffer)
 
     assert(platter >= 0 && platter < m_num_platters);
     assert(sector  >= 0 && sector  < m_num_platter_sectors);
-    assert(m_file != nullptr);
+    assert(m_file != nullptr || m_remote != nullptr);
 
     const int abs_sector = m_num_platter_sectors*platter + sector + 1;
+    system2200::ActivityScope activity(system2200::ACTIVITY_DISK);
     return rawReadSector(abs_sector, buffer);
 }
 
@@ -265,13 +358,26 @@ Wvd::writeSector(int platter, int sector, const uint8 *buffer)
 
     assert(platter >= 0 && platter < m_num_platters);
     assert(sector  >= 0 && sector  < m_num_platter_sectors);
-    assert(m_file != nullptr);
+    assert(m_file != nullptr || m_remote != nullptr);
 
     const int abs_sector = m_num_platter_sectors*platter + sector + 1;
+    system2200::ActivityScope activity(system2200::ACTIVITY_DISK);
     return rawWriteSector(abs_sector, buffer);
 }
 
 
+// switch overlay mode on or off.  turning it off discards the writes
+// made while it was on.
+void
+Wvd::setOverlay(bool overlay)
+{
+    m_overlay = overlay;
+    if (!overlay) {
+        m_overlay_sectors.clear();
+    }
+}
+
+
 // flush any pending write and close the filehandle,
 // but keep the association (unlike close())
 // this function is called when another function wants to touch
@@ -281,6 +387,13 @@ Wvd::writeSector(int platter, int sector, const uint8 *buffer)
 void
 Wvd::flush()
 {
+    if (m_remote != nullptr) {
+        // nobody else can change a server image under us
+        if (!m_remote->flush()) {
+            UI_error("Couldn't write back to '%s'", m_path.c_str());
+        }
+        return;
+    }
     if (m_file != nullptr) {
         if (m_file->is_open()) {
             m_file->flush();
@@ -311,12 +424,12 @@ Wvd::save()
 // if the state was constructed following a call to create(), we need
 // to create the entire disk file from scratch.
 void
-Wvd::save(const std::string &filename)
+Wvd::save(const std::string &filename, bool preallocate)
 {
     assert(!filename.empty());
     assert(!m_has_path);
 
-    if (createFile(filename)) {
+    if (createFile(filename, preallocate)) {
         setModified(false);
     } else {
         UI_error("Error: operation failed");
@@ -337,7 +450,7 @@ Wvd::rawWriteSector(const int sector, const uint8 *data)
     assert(m_has_path);
     assert(sector >= 0 && sector < m_num_platters*m_num_platter_sectors+1);
     assert(data != nullptr);
-    assert(m_file->is_open());
+    assert(m_remote || m_file->is_open());
 
     if (DBG > 0) {
         dbglog("========== writing absolute sector %d ==========\n", sector);
@@ -351,6 +464,36 @@ Wvd::rawWriteSector(const int sector, const uint8 *data)
         }
     }
 
+    return rawWriteSectors(sector, 1, data);
+}
+
+
+// write a run of sectors starting at an absolute sector address
+bool
+Wvd::rawWriteSectors(const int sector, const int count, const uint8 *data)
+{
+    assert(m_has_path);
+    assert(count > 0);
+    assert(sector >= 0 && sector+count <= m_num_platters*m_num_platter_sectors+1);
+    assert(data != nullptr);
+    assert(m_remote || m_file->is_open());
+
+    if (m_overlay) {
+        for (int n=0; n < count; n++) {
+            memcpy(m_overlay_sectors[sector+n].data(), &data[256*n], 256);
+        }
+        return true;
+    }
+
+    if (m_remote) {
+        if (!m_remote->writeSectors(sector, count, data)) {
+            UI_error("Error writing to sector %d of '%s'",
+                      sector, m_path.c_str());
+            return false;
+        }
+        return true;
+    }
+
     // go to the start of the Nth sector
     m_file->seekp(256LL*sector);
     if (!m_file->good()) {
@@ -361,7 +504,7 @@ Wvd::rawWriteSector(const int sector, const uint8 *data)
     }
 
     // write them all
-    m_file->write(reinterpret_cast<const char*>(data), 256);
+    m_file->write(reinterpret_cast<const char*>(data), 256LL*count);
     if (!m_file->good()) {
         UI_error("Error writing to sector %d of '%s'",
                   sector, m_path.c_str());
@@ -384,7 +527,24 @@ Wvd::rawReadSector(const int sector, const uint8 *data)
     assert(m_has_path);
     assert(sector >= 0 && sector < m_num_platters*m_num_platter_sectors+1);
     assert(data != nullptr);
-    assert(m_file->is_open());
+    assert(m_remote || m_file->is_open());
+
+    if (m_overlay) {
+        const auto it = m_overlay_sectors.find(sector);
+        if (it != m_overlay_sectors.end()) {
+            memcpy(const_cast<uint8*>(data), it->second.data(), 256);
+            return true;
+        }
+    }
+
+    if (m_remote) {
+        if (!m_remote->readSector(sector, const_cast<uint8*>(data))) {
+            UI_error("Error reading from sector %d of '%s'",
+                     sector, m_path.c_str());
+            return false;
+        }
+        return true;
+    }
 
     // go to the start of the Nth sector
     m_file->seekg(256LL * sector);
@@ -509,7 +669,7 @@ Wvd::reopen()
 bool
 Wvd::readHeader()
 {
-    assert(m_file != nullptr);
+    assert(m_file != nullptr || m_remote != nullptr);
 
     // set it so rawReadSector() knows what to operate on
     m_num_platters = 1;
@@ -581,15 +741,20 @@ Wvd::readHeader()
 bool
 Wvd::format(const int platter)
 {
+    refreshMetadata();
     assert(platter >= 0 && platter < m_num_platters);
+    assert(m_file != nullptr || m_remote != nullptr);
 
-    // fill all non-header sectors with 0x00
-    uint8 data[256];
-    memset(&data[0], static_cast<uint8>(0x00), 256);
+    // fill all non-header sectors with 0x00.  this is done a large block
+    // at a time; seeking and flushing for each sector was very slow on
+    // the larger hard disk images.
+    const std::vector<uint8> zeros(256*FORMAT_BLOCK_SECTORS, 0x00);
+    const int first = m_num_platter_sectors*platter + 1;
 
     bool ok = true;
-    for (int n=0; ok && n < m_num_platter_sectors; n++) {
-        ok = writeSector(platter, n, &data[0]);
+    for (int n=0; ok && n < m_num_platter_sectors; n += FORMAT_BLOCK_SECTORS) {
+        const int count = std::min(FORMAT_BLOCK_SECTORS, m_num_platter_sectors - n);
+        ok = rawWriteSectors(first + n, count, zeros.data());
     }
 
     return ok;
@@ -600,7 +765,7 @@ Wvd::format(const int platter)
 // write the header and then format all platters.
 // returns true on success.
 bool
-Wvd::createFile(const std::string &filename)
+Wvd::createFile(const std::string &filename, bool preallocate)
 {
     assert(m_file == nullptr);
     assert(!m_has_path);
@@ -623,14 +788,33 @@ Wvd::createFile(const std::string &filename)
         return false;
     }
 
-    bool ok = writeHeader();
-    if (ok) {
-        for (int p=0; ok && p < m_num_platters; p++) {
-            ok = format(p);
-        }
+    if (!writeHeader()) {
+        return false;
     }
 
-    return ok;
+    // a formatted platter is nothing but zeros, which is also what the
+    // host filesystem returns for the part of a file which was never
+    // written.  so rather than formatting each platter, it is enough to
+    // write the final byte of the image: the file is created at full size
+    // without touching the blocks in between.
+    const int64 image_bytes = 256LL * (1 + static_cast<int64>(m_num_platters)*m_num_platter_sectors);
+    const char zero = 0x00;
+    m_file->seekp(image_bytes - 1);
+    m_file->write(&zero, 1);
+    m_file->flush();
+    if (!m_file->good()) {
+        UI_error("Error extending '%s' to %lld bytes",
+                 m_path.c_str(), static_cast<long long>(image_bytes));
+        m_file->close();
+        return false;
+    }
+
+    if (preallocate && !reserveFileSpace(m_path, image_bytes)) {
+        // not fatal: the image is valid, just sparse
+        dbglog("Wvd: couldn't preallocate '%s'; image is sparse\n", m_path.c_str());
+    }
+
+    return true;
 }
 
 // vim: ts=8:et:sw=4:smarttab
@@ -49,11 +49,21 @@
 //          once the virtual disk image is no longer needed, for example, when
 //          the disk is ejected from the logical drive, wvd.close() must be
 //          called.
+//
+//      wvd.open("wvd://host[:port]/name.wvd")
+//          this is the same, but the image lives on a disk image server.
+//          the sector accesses are handed to a WvdRemote, which caches
+//          them locally; flush() sends pending writes to the server.
+//          creating images on a server isn't supported.
 
+#include <array>
 #include <fstream>
+#include <unordered_map>
 
 #include "../system/w2200.h"
 
+class WvdRemote;
+
 class Wvd
 {
 public:
@@ -61,7 +71,7 @@ public:
 
     // making a valid Wvd is a two step process.  create a container with the
     // default constructor, then call either open() or create() to fill it.
-     Wvd() = default;  // must be followed by either open() or create()
+     Wvd();            // must be followed by either open() or create()
     ~Wvd();
 
     // new blank disk with default values
@@ -93,6 +103,17 @@ public:
     int  getDiskType();
     void setDiskType(int type);
 
+    // the geometries offered for a new disk, for create()
+    struct geometry_t {
+        const char *name;           // short name, eg, for the command line
+        const char *description;
+        int         disk_type;      // DISKTYPE_*
+        int         platters;
+        int         sectors_per_platter;
+    };
+    static const geometry_t geometries[];
+    static const int        num_geometries;
+
     int  getNumPlatters();
     void setNumPlatters(int num);
 
@@ -108,8 +129,10 @@ public:
 
     // this saves modified state when open() was used to get it to begin with:
     void save();
-    // create a new disk when create() was the original call:
-    void save(const std::string &filename);
+    // create a new disk when create() was the original call.
+    // the image is normally left sparse; if preallocate is set, the host
+    // is asked to reserve all of its blocks up front.
+    void save(const std::string &filename, bool preallocate=false);
 
     // logical sector data access.
     // returns true on success, false on failure.
@@ -126,6 +149,13 @@ public:
     // returns true if successful.
     bool format(int platter);
 
+    // in overlay mode, sector writes are kept in memory and the image
+    // file is only ever read.  a system forked from a running one uses
+    // this to share disk images with its siblings; the writes are gone
+    // once the disk is closed.
+    void setOverlay(bool overlay);
+    bool isOverlay() const noexcept { return m_overlay; }
+
 private:
     // make sure metadata is up to date
     void refreshMetadata() { if (m_metadata_stale && !!m_file) { reopen(); } }
@@ -134,6 +164,10 @@ private:
     // write 256 bytes to an absolute sector address
     bool rawWriteSector(int sector, const uint8 *data);
 
+    // write count*256 bytes to consecutive sectors, starting at an
+    // absolute sector address, with a single seek and flush
+    bool rawWriteSectors(int sector, int count, const uint8 *data);
+
     // read 256 bytes from an absolute sector address
     bool rawReadSector(int sector, const uint8 *data);
 
@@ -146,12 +180,14 @@ private:
     bool readHeader();
 
     // create a virtual disk file if it doesn't exist, erase it if does.
-    // write the header and then format all platters.
+    // write the header and then extend the file to its full size, which
+    // leaves all platters formatted.
     // returns true on success.
-    bool createFile(const std::string &filename);
+    bool createFile(const std::string &filename, bool preallocate);
 
     // ----- data members -----
     std::unique_ptr<std::fstream> m_file;   // file handle
+    std::unique_ptr<WvdRemote>    m_remote; // instead of m_file, for a server image
     bool          m_metadata_stale      = true;    // is the metadata possibly out of date?
     bool          m_metadata_modified   = false;   // metadata has been modified
     bool          m_has_path            = false;   // is m_path valid?
@@ -161,6 +197,8 @@ private:
     int           m_num_platters        = 0;       // platters in the virtual disk image
     int           m_num_platter_sectors = 0;       // sectors per platter
     bool          m_write_protect       = false;   // true=don't write
+    bool          m_overlay             = false;   // writes go to m_overlay_sectors
+    std::unordered_map<int, std::array<uint8, 256>> m_overlay_sectors;  // by absolute sector
 };
 
 #endif // _INCLUDE_WVD_H_
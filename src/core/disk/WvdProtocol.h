@@ -0,0 +1,60 @@
+#ifndef _INCLUDE_WVD_PROTOCOL_H_
+#define _INCLUDE_WVD_PROTOCOL_H_
+
+// the block protocol spoken between WvdRemote and the disk image server.
+//
+// a client opens one TCP connection per disk image.  every request is
+// answered before the next one is sent:
+//
+//      request:   op (1 byte), payload length (4), payload
+//      reply:     status (1 byte), payload length (4), payload
+//
+// all numbers are little endian.  sector numbers are absolute, ie, sector
+// 0 is the wvd header, exactly as the image is laid out on the server.
+//
+//      OPEN   token (8), image name     -> sectors (4), lease ms (4), generation (8)
+//      READ   first (4), count (2)      -> count*256 bytes
+//      WRITE  first (4), count (2), data
+//      RENEW
+//      CLOSE                            -> generation (8)
+//
+// OPEN grants a lease on the image to the client's token: while the lease
+// is held, no other token can open the image.  any request renews the
+// lease; a client which goes away without CLOSE loses it when it expires.
+// the same token may open the image again at any time, eg, to reconnect.
+//
+// the generation is a count kept by the server: it changes with every
+// WRITE the server handles and whenever the server restarts.  a client keeps
+// a disk cache only while the generation it saw at CLOSE is still the
+// one reported by the next OPEN.
+
+#include <cstdint>
+
+namespace wvdproto {
+
+constexpr int DEFAULT_PORT    = 22600;
+constexpr int MAX_IO_SECTORS  = 256;     // per READ or WRITE
+constexpr int MAX_NAME_LEN    = 255;
+
+enum op_t : uint8_t {
+    OP_OPEN  = 'O',
+    OP_READ  = 'R',
+    OP_WRITE = 'W',
+    OP_RENEW = 'L',
+    OP_CLOSE = 'C',
+};
+
+enum status_t : uint8_t {
+    ST_OK         = 0,
+    ST_BAD        = 1,   // malformed request, or out of range
+    ST_NOT_FOUND  = 2,   // no such image
+    ST_BUSY       = 3,   // another client holds the lease
+    ST_NO_LEASE   = 4,   // the lease was lost
+    ST_IO_ERROR   = 5,   // the server couldn't read or write the image
+};
+
+} // namespace wvdproto
+
+#endif // _INCLUDE_WVD_PROTOCOL_H_
+
+// vim: ts=8:et:sw=4:smarttab
@@ -0,0 +1,780 @@
+// ------------------------------------------------------------------------
+//  WvdRemote: a virtual disk image on a disk image server
+// ------------------------------------------------------------------------
+
+#include "WvdRemote.h"
+#include "WvdProtocol.h"
+#include "../../gui/system/Ui.h"
+#include "../../platform/common/host.h"              // for dbglog()
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+
+// the cache settings for images opened from now on
+static std::string s_cache_dir;
+static int         s_cache_mb = 16;
+
+bool
+WvdRemote::isRemotePath(const std::string &path)
+{
+    return path.compare(0, 6, "wvd://") == 0;
+}
+
+
+void
+WvdRemote::setCache(const std::string &dir, int mem_mb)
+{
+    s_cache_dir = dir;
+    s_cache_mb  = std::max(1, mem_mb);
+}
+
+
+#ifdef _WIN32
+
+// the disk server is only reached from the terminal server, which is posix
+
+WvdRemote::~WvdRemote()
+{
+}
+
+bool
+WvdRemote::open(const std::string &url)
+{
+    UI_error("Disk images on a server aren't supported on this platform:\n%s",
+             url.c_str());
+    return false;
+}
+
+void WvdRemote::close() { }
+bool WvdRemote::readSector(int, uint8 *) { return false; }
+bool WvdRemote::writeSectors(int, int, const uint8 *) { return false; }
+bool WvdRemote::flush() { return true; }
+
+#else
+
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <random>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+using namespace wvdproto;
+
+// a server which doesn't answer in this long is treated as gone
+static constexpr int IO_TIMEOUT_SEC = 10;
+
+// disk cache map file: magic, generation, sectors, then a valid mask per block
+static const char CACHE_MAGIC[4] = { 'W', 'V', 'D', 'C' };
+
+static void
+put32(std::vector<uint8> &v, uint32 x)
+{
+    for (int i=0; i < 4; i++) {
+        v.push_back(static_cast<uint8>(x >> (8*i)));
+    }
+}
+
+static uint64
+getN(const uint8 *p, int bytes)
+{
+    uint64 x = 0;
+    for (int i=0; i < bytes; i++) {
+        x |= static_cast<uint64>(p[i]) << (8*i);
+    }
+    return x;
+}
+
+static bool
+sendAll(int fd, const uint8 *data, size_t len)
+{
+    while (len > 0) {
+        const ssize_t n = send(fd, data, len, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        data += n;
+        len  -= n;
+    }
+    return true;
+}
+
+static bool
+recvAll(int fd, uint8 *data, size_t len)
+{
+    while (len > 0) {
+        const ssize_t n = recv(fd, data, len, 0);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        data += n;
+        len  -= n;
+    }
+    return true;
+}
+
+
+WvdRemote::~WvdRemote()
+{
+    close();
+}
+
+
+// the url is wvd://host[:port]/name
+bool
+WvdRemote::open(const std::string &url)
+{
+    assert(m_fd < 0);
+
+    const size_t slash = url.find('/', 6);
+    if (!isRemotePath(url) || slash == std::string::npos || slash == 6
+                           || slash+1 == url.size()) {
+        UI_error("Disk server image '%s' should look like\nwvd://host[:port]/name.wvd",
+                 url.c_str());
+        return false;
+    }
+    m_url  = url;
+    m_host = url.substr(6, slash-6);
+    m_name = url.substr(slash+1);
+    m_port = DEFAULT_PORT;
+    const size_t colon = m_host.rfind(':');
+    if (colon != std::string::npos && m_host.find(']') == std::string::npos) {
+        m_port = atoi(m_host.c_str() + colon + 1);
+        m_host.erase(colon);
+    }
+    if (m_host.size() > 2 && m_host.front() == '[' && m_host.back() == ']') {
+        m_host = m_host.substr(1, m_host.size()-2);  // [ipv6]
+    }
+
+    // identifies this client to the server for the lease
+    std::random_device rd;
+    m_token = (static_cast<uint64>(rd()) << 32) ^ rd();
+
+    if (!connectServer()) {
+        UI_error("Couldn't connect to the disk server for\n%s", url.c_str());
+        return false;
+    }
+
+    uint8 status = ST_IO_ERROR;
+    std::vector<uint8> reply;
+    if (!sendOpen(&status, &reply) || status != ST_OK || reply.size() != 16) {
+        switch (status) {
+        case ST_BUSY:
+            UI_error("Disk image '%s' is in use by another system", url.c_str());
+            break;
+        case ST_NOT_FOUND:
+            UI_error("The disk server has no image '%s'", m_name.c_str());
+            break;
+        default:
+            UI_error("The disk server couldn't open '%s'", url.c_str());
+            break;
+        }
+        disconnect();
+        return false;
+    }
+    m_num_sectors = static_cast<int>(getN(&reply[0], 4));
+    m_lease_ms    = static_cast<int>(getN(&reply[4], 4));
+    const uint64 generation = getN(&reply[8], 8);
+
+    m_max_blocks = std::max<size_t>(64, (s_cache_mb * 1024LL*1024LL) / (256*BLOCK_SECTORS));
+    m_last_miss  = -2;
+    m_hits = m_misses = m_disk_hits = m_writes = m_write_reqs = 0;
+    openDiskCache(generation);
+
+    m_stop = false;
+    m_helper = std::thread(&WvdRemote::helperProc, this);
+    return true;
+}
+
+
+void
+WvdRemote::close()
+{
+    if (m_helper.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_wake.notify_all();
+        m_helper.join();
+    }
+    if (m_num_sectors == 0) {
+        return;  // not open
+    }
+
+    std::lock_guard<std::mutex> net_lock(m_net_mutex);
+    uint64 generation = 0;
+    if (writeBack()) {
+        std::vector<uint8> reply;
+        if (transact(OP_CLOSE, {}, &reply) && reply.size() == 8) {
+            generation = getN(&reply[0], 8);
+        }
+    } else {
+        UI_error("Writes to '%s' were lost; the disk server is unreachable",
+                 m_url.c_str());
+    }
+    disconnect();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    // a disk cache is only reused if it is known to match the image
+    closeDiskCache(generation);
+
+    dbglog("WvdRemote: %s: %llu hits, %llu misses (%llu from disk cache), "
+           "%llu sector writes in %llu requests\n",
+           m_url.c_str(),
+           static_cast<unsigned long long>(m_hits),
+           static_cast<unsigned long long>(m_misses),
+           static_cast<unsigned long long>(m_disk_hits),
+           static_cast<unsigned long long>(m_writes),
+           static_cast<unsigned long long>(m_write_reqs));
+
+    m_blocks.clear();
+    m_dirty_blocks.clear();
+    m_dirty_sectors = 0;
+    m_num_sectors = 0;
+}
+
+// -------------------------------------------------------------------------
+// sector access
+// -------------------------------------------------------------------------
+
+bool
+WvdRemote::readSector(int sector, uint8 *data)
+{
+    assert(sector >= 0 && sector < m_num_sectors);
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    const int blk = sector / BLOCK_SECTORS;
+    const int idx = sector % BLOCK_SECTORS;
+    auto it = m_blocks.find(blk);
+    if (it != m_blocks.end() && (it->second.valid & (1 << idx))) {
+        m_hits++;
+    } else {
+        lock.unlock();
+        if (!fetch(blk)) {
+            return false;
+        }
+        lock.lock();
+    }
+
+    Block &b = m_blocks[blk];
+    b.used = ++m_tick;
+    memcpy(data, &b.data[256*idx], 256);
+    return true;
+}
+
+
+bool
+WvdRemote::writeSectors(int sector, int count, const uint8 *data)
+{
+    assert(sector >= 0 && sector+count <= m_num_sectors);
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    if (m_dirty_sectors == 0) {
+        m_first_dirty = std::chrono::steady_clock::now();
+    }
+    for (int n=0; n < count; n++) {
+        const int blk = (sector+n) / BLOCK_SECTORS;
+        const uint16 bit = static_cast<uint16>(1 << ((sector+n) % BLOCK_SECTORS));
+        Block &b = block(blk);
+        memcpy(&b.data[256*((sector+n) % BLOCK_SECTORS)], &data[256*n], 256);
+        b.valid |= bit;
+        if (!(b.dirty & bit)) {
+            b.dirty |= bit;
+            m_dirty_sectors++;
+        }
+        m_dirty_blocks.insert(blk);
+    }
+    m_writes += count;
+
+    if (m_dirty_sectors >= DIRTY_LIMIT) {
+        lock.unlock();
+        std::lock_guard<std::mutex> net_lock(m_net_mutex);
+        return writeBack();
+    }
+    return true;
+}
+
+
+bool
+WvdRemote::flush()
+{
+    std::lock_guard<std::mutex> net_lock(m_net_mutex);
+    return writeBack();
+}
+
+// -------------------------------------------------------------------------
+// the cache.  the caller holds m_mutex, except for fetch() and writeBack(),
+// which take it themselves around everything but the network request.
+// -------------------------------------------------------------------------
+
+// find a block, making room for it if it isn't cached
+WvdRemote::Block&
+WvdRemote::block(int blk)
+{
+    auto it = m_blocks.find(blk);
+    if (it == m_blocks.end()) {
+        if (m_blocks.size() >= m_max_blocks) {
+            evict();
+        }
+        it = m_blocks.emplace(blk, Block()).first;
+    }
+    it->second.used = ++m_tick;
+    return it->second;
+}
+
+
+// drop the least recently used clean block.  if everything is waiting to
+// be written, the cache grows for now; DIRTY_LIMIT bounds by how much.
+void
+WvdRemote::evict()
+{
+    auto victim = m_blocks.end();
+    for (auto it = m_blocks.begin(); it != m_blocks.end(); ++it) {
+        if (it->second.dirty == 0 &&
+            (victim == m_blocks.end() || it->second.used < victim->second.used)) {
+            victim = it;
+        }
+    }
+    if (victim != m_blocks.end()) {
+        m_blocks.erase(victim);
+    }
+}
+
+
+// bring in a block which isn't (completely) cached.  after a miss on the
+// block following the previous miss, read ahead.
+bool
+WvdRemote::fetch(int blk)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_misses++;
+    const bool sequential = (blk == m_last_miss + 1);
+    m_last_miss = blk;
+
+    Block &b = block(blk);
+    if (readDiskCache(blk, &b)) {
+        m_disk_hits++;
+        return true;
+    }
+    lock.unlock();
+
+    const int first = blk * BLOCK_SECTORS;
+    const int blocks = sequential ? READAHEAD_BLOCKS : 1;
+    const int count = std::min({ blocks * BLOCK_SECTORS,
+                                 m_num_sectors - first,
+                                 MAX_IO_SECTORS });
+    std::vector<uint8> req;
+    put32(req, static_cast<uint32>(first));
+    req.push_back(static_cast<uint8>(count & 0xFF));
+    req.push_back(static_cast<uint8>(count >> 8));
+    std::vector<uint8> reply;
+    {
+        std::lock_guard<std::mutex> net_lock(m_net_mutex);
+        if (!transact(OP_READ, req, &reply) || reply.size() != 256u*count) {
+            return false;
+        }
+    }
+
+    // cached sectors are at least as new as the server's
+    lock.lock();
+    for (int n=0; n < count; n++) {
+        Block &dst = block((first+n) / BLOCK_SECTORS);
+        const uint16 bit = static_cast<uint16>(1 << ((first+n) % BLOCK_SECTORS));
+        if (!(dst.valid & bit)) {
+            memcpy(&dst.data[256*((first+n) % BLOCK_SECTORS)], &reply[256*n], 256);
+            dst.valid |= bit;
+        }
+    }
+    m_blocks[blk].used = ++m_tick;
+    writeDiskCache(first, count, reply.data());
+    return true;
+}
+
+
+// send dirty sectors to the server, merging consecutive ones into one
+// request.  the caller holds m_net_mutex, which keeps write-backs in order.
+// m_mutex is only held to copy the runs out and to mark them clean after,
+// so the emulator can keep using the cache meanwhile; a sector written
+// again in between stays dirty.  sectors which couldn't be written stay
+// dirty too.
+bool
+WvdRemote::writeBack()
+{
+    std::vector<std::vector<uint8>> reqs;   // one WRITE per run
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_dirty_sectors == 0) {
+            return true;
+        }
+
+        std::vector<std::pair<int, int>> runs;   // first sector, count
+        for (const int blk : m_dirty_blocks) {
+            const uint16 dirty = m_blocks[blk].dirty;
+            for (int idx=0; idx < BLOCK_SECTORS; idx++) {
+                if (!(dirty & (1 << idx))) {
+                    continue;
+                }
+                const int sector = blk*BLOCK_SECTORS + idx;
+                if (!runs.empty() && runs.back().first + runs.back().second == sector
+                                  && runs.back().second < MAX_IO_SECTORS) {
+                    runs.back().second++;
+                } else {
+                    runs.emplace_back(sector, 1);
+                }
+            }
+        }
+
+        for (auto const &run : runs) {
+            reqs.emplace_back();
+            std::vector<uint8> &req = reqs.back();
+            put32(req, static_cast<uint32>(run.first));
+            req.push_back(static_cast<uint8>(run.second & 0xFF));
+            req.push_back(static_cast<uint8>(run.second >> 8));
+            req.resize(6 + 256u*run.second);
+            for (int n=0; n < run.second; n++) {
+                const int sector = run.first + n;
+                memcpy(&req[6 + 256*n],
+                       &m_blocks[sector / BLOCK_SECTORS].data[256*(sector % BLOCK_SECTORS)], 256);
+            }
+        }
+    }
+
+    bool ok = true;
+    std::vector<uint8> reply;
+    for (auto const &req : reqs) {
+        if (!transact(OP_WRITE, req, &reply)) {
+            ok = false;
+            break;
+        }
+        const int first = static_cast<int>(getN(&req[0], 4));
+        const int count = static_cast<int>(getN(&req[4], 2));
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_write_reqs++;
+        for (int n=0; n < count; n++) {
+            const int sector = first + n;
+            Block &b = m_blocks[sector / BLOCK_SECTORS];
+            const uint16 bit = static_cast<uint16>(1 << (sector % BLOCK_SECTORS));
+            if ((b.dirty & bit) &&
+                memcmp(&b.data[256*(sector % BLOCK_SECTORS)], &req[6 + 256*n], 256) == 0) {
+                b.dirty &= ~bit;
+                m_dirty_sectors--;
+            }
+        }
+        writeDiskCache(first, count, &req[6]);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto it = m_dirty_blocks.begin(); it != m_dirty_blocks.end(); ) {
+            it = (m_blocks[*it].dirty == 0) ? m_dirty_blocks.erase(it) : std::next(it);
+        }
+    }
+
+    // say so once when the server stops taking writes, and once when it
+    // takes them again, whichever thread was sending them
+    if (!ok && !m_writeback_failed) {
+        UI_error("Writes to '%s' can't reach the disk server; "
+                 "they are kept until it is back", m_url.c_str());
+    } else if (ok && m_writeback_failed) {
+        UI_info("Writes to '%s' reach the disk server again", m_url.c_str());
+    }
+    m_writeback_failed = !ok;
+    return ok;
+}
+
+// -------------------------------------------------------------------------
+// the connection.  the caller holds m_net_mutex, except during open().
+// -------------------------------------------------------------------------
+
+bool
+WvdRemote::connectServer()
+{
+    addrinfo hints{};
+    hints.ai_family   = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo *res = nullptr;
+    const std::string port = std::to_string(m_port);
+    if (getaddrinfo(m_host.c_str(), port.c_str(), &hints, &res) != 0) {
+        dbglog("WvdRemote: can't resolve '%s'\n", m_host.c_str());
+        return false;
+    }
+
+    for (addrinfo *ai = res; ai != nullptr && m_fd < 0; ai = ai->ai_next) {
+        m_fd = socket(ai->ai_family, ai->ai_socktype | SOCK_CLOEXEC, ai->ai_protocol);
+        if (m_fd < 0) {
+            continue;
+        }
+        timeval tv{};
+        tv.tv_sec = IO_TIMEOUT_SEC;
+        setsockopt(m_fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+        setsockopt(m_fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+        const int one = 1;
+        setsockopt(m_fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        if (connect(m_fd, ai->ai_addr, ai->ai_addrlen) < 0) {
+            ::close(m_fd);
+            m_fd = -1;
+        }
+    }
+    freeaddrinfo(res);
+    return m_fd >= 0;
+}
+
+
+void
+WvdRemote::disconnect()
+{
+    if (m_fd >= 0) {
+        ::close(m_fd);
+        m_fd = -1;
+    }
+}
+
+
+// one request and its reply; false if the connection failed
+bool
+WvdRemote::exchange(uint8 op, const std::vector<uint8> &req,
+                    uint8 *status, std::vector<uint8> *reply)
+{
+    if (m_fd < 0) {
+        return false;
+    }
+    std::vector<uint8> frame;
+    frame.reserve(5 + req.size());
+    frame.push_back(op);
+    put32(frame, static_cast<uint32>(req.size()));
+    frame.insert(frame.end(), req.begin(), req.end());
+
+    uint8 hdr[5];
+    if (!sendAll(m_fd, frame.data(), frame.size()) || !recvAll(m_fd, hdr, 5)) {
+        return false;
+    }
+    const size_t len = static_cast<size_t>(getN(&hdr[1], 4));
+    if (len > 256u*MAX_IO_SECTORS) {
+        return false;
+    }
+    reply->resize(len);
+    if (!recvAll(m_fd, reply->data(), len)) {
+        return false;
+    }
+    *status = hdr[0];
+    m_last_contact = std::chrono::steady_clock::now();
+    return true;
+}
+
+
+bool
+WvdRemote::sendOpen(uint8 *status, std::vector<uint8> *reply)
+{
+    std::vector<uint8> req;
+    put32(req, static_cast<uint32>(m_token));
+    put32(req, static_cast<uint32>(m_token >> 32));
+    req.insert(req.end(), m_name.begin(), m_name.end());
+    return exchange(OP_OPEN, req, status, reply);
+}
+
+
+// a request which must succeed.  a dropped connection is reopened once;
+// the lease belongs to our token, not to the connection.
+bool
+WvdRemote::transact(uint8 op, const std::vector<uint8> &req, std::vector<uint8> *reply)
+{
+    uint8 status = ST_IO_ERROR;
+    if (!exchange(op, req, &status, reply)) {
+        dbglog("WvdRemote: lost the connection to %s, reconnecting\n", m_host.c_str());
+        disconnect();
+        std::vector<uint8> open_reply;
+        if (!connectServer() || !sendOpen(&status, &open_reply) || status != ST_OK
+                             || !exchange(op, req, &status, reply)) {
+            dbglog("WvdRemote: can't reach %s\n", m_host.c_str());
+            disconnect();
+            return false;
+        }
+    }
+    if (status != ST_OK) {
+        dbglog("WvdRemote: %s: request '%c' failed with status %d\n",
+               m_url.c_str(), op, status);
+        return false;
+    }
+    return true;
+}
+
+// -------------------------------------------------------------------------
+// the helper thread: renew the lease, and write back old writes
+// -------------------------------------------------------------------------
+
+void
+WvdRemote::helperProc()
+{
+    using clock = std::chrono::steady_clock;
+    const auto renew = std::chrono::milliseconds(std::max(1000, m_lease_ms / 3));
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_stop) {
+        m_wake.wait_for(lock, std::chrono::milliseconds(WRITEBACK_MS));
+        if (m_stop) {
+            break;
+        }
+        const bool due = (m_dirty_sectors > 0) &&
+            (clock::now() - m_first_dirty >= std::chrono::milliseconds(WRITEBACK_MS));
+
+        // the server may take a while to answer, or not at all; the
+        // emulator mustn't wait for it on a cache hit
+        lock.unlock();
+        {
+            std::lock_guard<std::mutex> net_lock(m_net_mutex);
+            if (due) {
+                writeBack();
+            }
+            if (clock::now() - m_last_contact >= renew) {
+                std::vector<uint8> reply;
+                transact(OP_RENEW, {}, &reply);
+            }
+        }
+        lock.lock();
+    }
+}
+
+// -------------------------------------------------------------------------
+// the disk cache: a sparse copy of the image, plus a map of which sectors
+// of it are filled in.  the map is only written by a clean close, so after
+// a crash the cache starts over.  the caller holds m_mutex.
+// -------------------------------------------------------------------------
+
+void
+WvdRemote::openDiskCache(uint64 generation)
+{
+    const int num_blocks = (m_num_sectors + BLOCK_SECTORS - 1) / BLOCK_SECTORS;
+    m_cache_valid.assign(num_blocks, 0);
+    if (s_cache_dir.empty()) {
+        return;
+    }
+
+    std::string base = s_cache_dir + "/";
+    for (const char c : m_url.substr(6)) {
+        base += isalnum(static_cast<unsigned char>(c)) || c == '.' || c == '-' ? c : '_';
+    }
+    m_cache_map = base + ".map";
+    m_cache_fd = ::open((base + ".cache").c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (m_cache_fd < 0) {
+        dbglog("WvdRemote: no disk cache for %s: %s\n", m_url.c_str(), strerror(errno));
+        return;
+    }
+
+    bool reuse = false;
+    const int map_fd = ::open(m_cache_map.c_str(), O_RDONLY | O_CLOEXEC);
+    if (map_fd >= 0) {
+        uint8 hdr[16];
+        const size_t map_bytes = sizeof(uint16) * m_cache_valid.size();
+        reuse = (read(map_fd, hdr, 16) == 16)
+             && (memcmp(hdr, CACHE_MAGIC, 4) == 0)
+             && (getN(&hdr[4], 8) == generation)
+             && (static_cast<int>(getN(&hdr[12], 4)) == m_num_sectors)
+             && (read(map_fd, m_cache_valid.data(), map_bytes) == static_cast<ssize_t>(map_bytes));
+        ::close(map_fd);
+    }
+    // until the next clean close, the map doesn't describe the cache
+    unlink(m_cache_map.c_str());
+
+    if (!reuse) {
+        std::fill(m_cache_valid.begin(), m_cache_valid.end(), 0);
+        if (ftruncate(m_cache_fd, 0) != 0) {
+            ::close(m_cache_fd);
+            m_cache_fd = -1;
+        }
+    }
+}
+
+
+void
+WvdRemote::closeDiskCache(uint64 generation)
+{
+    if (m_cache_fd < 0) {
+        return;
+    }
+    ::close(m_cache_fd);
+    m_cache_fd = -1;
+    if (generation == 0) {
+        return;
+    }
+
+    const std::string tmp = m_cache_map + ".tmp";
+    const int map_fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (map_fd < 0) {
+        return;
+    }
+    std::vector<uint8> hdr(CACHE_MAGIC, CACHE_MAGIC+4);
+    put32(hdr, static_cast<uint32>(generation));
+    put32(hdr, static_cast<uint32>(generation >> 32));
+    put32(hdr, static_cast<uint32>(m_num_sectors));
+    const size_t map_bytes = sizeof(uint16) * m_cache_valid.size();
+    const bool ok = (write(map_fd, hdr.data(), hdr.size()) == static_cast<ssize_t>(hdr.size()))
+                 && (write(map_fd, m_cache_valid.data(), map_bytes) == static_cast<ssize_t>(map_bytes));
+    ::close(map_fd);
+    if (!ok || rename(tmp.c_str(), m_cache_map.c_str()) != 0) {
+        unlink(tmp.c_str());
+    }
+}
+
+
+// fill in a block from the disk cache, if all of it is there
+bool
+WvdRemote::readDiskCache(int blk, Block *b)
+{
+    if (m_cache_fd < 0) {
+        return false;
+    }
+    const int count = std::min(BLOCK_SECTORS, m_num_sectors - blk*BLOCK_SECTORS);
+    const uint16 need = static_cast<uint16>((1u << count) - 1);
+    if ((m_cache_valid[blk] & need) != need) {
+        return false;
+    }
+
+    std::array<uint8, 256*BLOCK_SECTORS> data;
+    const ssize_t len = 256 * count;
+    if (pread(m_cache_fd, data.data(), len, 256LL*blk*BLOCK_SECTORS) != len) {
+        return false;
+    }
+    for (int idx=0; idx < count; idx++) {
+        if (!(b->valid & (1 << idx))) {
+            memcpy(&b->data[256*idx], &data[256*idx], 256);
+        }
+    }
+    b->valid |= need;
+    return true;
+}
+
+
+void
+WvdRemote::writeDiskCache(int sector, int count, const uint8 *data)
+{
+    if (m_cache_fd < 0) {
+        return;
+    }
+    const ssize_t len = 256 * count;
+    if (pwrite(m_cache_fd, data, len, 256LL*sector) != len) {
+        dbglog("WvdRemote: disk cache write failed, dropping it: %s\n", strerror(errno));
+        ::close(m_cache_fd);
+        m_cache_fd = -1;
+        return;
+    }
+    for (int n=0; n < count; n++) {
+        m_cache_valid[(sector+n) / BLOCK_SECTORS] |=
+            static_cast<uint16>(1 << ((sector+n) % BLOCK_SECTORS));
+    }
+}
+
+#endif // _WIN32
+
+// vim: ts=8:et:sw=4:smarttab
@@ -0,0 +1,143 @@
+#ifndef _INCLUDE_WVD_REMOTE_H_
+#define _INCLUDE_WVD_REMOTE_H_
+
+// a virtual disk image kept on a disk image server rather than locally.
+//
+// Wvd hands its absolute sector reads and writes to this object when the
+// image path has the form
+//
+//      wvd://host[:port]/name.wvd
+//
+// sectors are cached in memory in blocks of BLOCK_SECTORS, and optionally
+// also in a local disk cache which survives a restart, so once the working
+// set has been read, sector access doesn't touch the network.  a miss
+// fetches the whole block, and a run of misses on consecutive blocks reads
+// further ahead.  writes go to the cache and are sent to the server a
+// little later, merged into runs of consecutive sectors; flush() sends
+// them at once.
+//
+// the server grants this client a lease on the image when it is opened, so
+// two systems can't both write the same image.  a helper thread renews the
+// lease, and writes back what has been sitting in the cache for a while.
+// it talks to the server without holding the cache lock, so sectors which
+// are cached can be read and written while it waits for an answer.  when
+// write-backs start failing, that is reported right away.
+//
+// see WvdProtocol.h for the protocol.
+
+#include "../system/w2200.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <unordered_map>
+
+class WvdRemote
+{
+public:
+    CANT_ASSIGN_OR_COPY_CLASS(WvdRemote);
+
+     WvdRemote() = default;
+    ~WvdRemote();
+
+    // true if the path names an image on a disk server
+    static bool isRemotePath(const std::string &path);
+
+    // the cache used by images opened from now on.  an empty dir means
+    // memory only.
+    static void setCache(const std::string &dir, int mem_mb);
+
+    // connect and take the lease.  complains and returns false on failure.
+    bool open(const std::string &url);
+
+    // write back, give up the lease, and disconnect
+    void close();
+
+    // absolute sector access; sector 0 is the wvd header
+    bool readSector(int sector, uint8 *data);
+    bool writeSectors(int sector, int count, const uint8 *data);
+
+    // send all pending writes to the server
+    bool flush();
+
+    // size of the image, in absolute sectors
+    int numSectors() const noexcept { return m_num_sectors; }
+
+private:
+    static constexpr int BLOCK_SECTORS    = 16;
+    static constexpr int READAHEAD_BLOCKS = 8;     // on a sequential miss
+    static constexpr int DIRTY_LIMIT      = 256;   // sectors; then write back now
+    static constexpr int WRITEBACK_MS     = 250;   // longest a write waits
+
+    struct Block {
+        std::array<uint8, 256*BLOCK_SECTORS> data;
+        uint16 valid = 0;       // sectors holding image data
+        uint16 dirty = 0;       // sectors not yet written back
+        uint64 used  = 0;       // for lru
+    };
+
+    // ---- network ----
+    bool connectServer();
+    void disconnect();
+    bool transact(uint8 op, const std::vector<uint8> &req, std::vector<uint8> *reply);
+    bool exchange(uint8 op, const std::vector<uint8> &req, uint8 *status, std::vector<uint8> *reply);
+    bool sendOpen(uint8 *status, std::vector<uint8> *reply);
+
+    // ---- cache ----
+    Block& block(int blk);
+    bool fetch(int blk);
+    bool writeBack();
+    void evict();
+
+    // ---- disk cache ----
+    void openDiskCache(uint64 generation);
+    void closeDiskCache(uint64 generation);
+    bool readDiskCache(int blk, Block *b);
+    void writeDiskCache(int sector, int count, const uint8 *data);
+
+    // ---- lease and write-back thread ----
+    void helperProc();
+
+    std::string     m_url;
+    std::string     m_host;
+    int             m_port = 0;
+    std::string     m_name;
+    uint64          m_token = 0;
+    int             m_num_sectors = 0;
+    int             m_lease_ms = 0;
+
+    std::mutex      m_net_mutex;        // the connection; taken before m_mutex
+    int             m_fd = -1;
+    std::chrono::steady_clock::time_point m_last_contact;
+    bool            m_writeback_failed = false;  // and it has been reported
+
+    std::mutex      m_mutex;            // everything below
+    std::unordered_map<int, Block> m_blocks;
+    std::set<int>   m_dirty_blocks;     // ordered, so runs can be merged
+    int             m_dirty_sectors = 0;
+    size_t          m_max_blocks = 0;
+    uint64          m_tick = 0;
+    int             m_last_miss = -2;   // block of the previous miss
+    std::chrono::steady_clock::time_point m_first_dirty;
+
+    int             m_cache_fd = -1;    // disk cache: image data
+    std::string     m_cache_map;        // disk cache: which blocks are valid
+    std::vector<uint16> m_cache_valid;  // by block
+
+    std::thread     m_helper;
+    std::condition_variable m_wake;
+    bool            m_stop = false;
+
+    // statistics
+    uint64          m_hits = 0;
+    uint64          m_misses = 0;
+    uint64          m_disk_hits = 0;
+    uint64          m_writes = 0;
+    uint64          m_write_reqs = 0;
+};
+
+#endif // _INCLUDE_WVD_REMOTE_H_
+
+// vim: ts=8:et:sw=4:smarttab
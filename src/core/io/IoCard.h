@@ -26,6 +26,8 @@ class CardInfo;
 class CardCfgState;
 class Cpu2200;
 class Scheduler;
+class StateReader;
+class StateWriter;
 
 class IoCard
 {
@@ -99,6 +101,13 @@ public:
     // ioCardCbIbs() to supply the IBS data to the CPU.
     virtual void setCpuBusy(bool busy) = 0;
 
+    // save or restore the running state of the card, so another instance
+    // of the emulator can pick up where this one left off.  a card which
+    // can't do it, or can't do it at the moment, returns false.  restore
+    // is done on a freshly built card with the same configuration.
+    virtual bool saveState(StateWriter &) const { return false; }
+    virtual bool restoreState(StateReader &) { return false; }
+
     // --------------- static member functions ---------------
 
     // the types of cards that may by plugged into a slot
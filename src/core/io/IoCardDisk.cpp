@@ -124,12 +124,16 @@
 #include "../disk/DiskCtrlCfgState.h"
 #include "IoCardDisk.h"
 #include "../system/Scheduler.h"
+#include "../system/StateStream.h"
 #include "../../shared/config/SysCfgState.h"
 #include "../../gui/system/Ui.h"                // for UI_warn()
 #include "../disk/Wvd.h"
 #include "../../platform/common/host.h"              // for dbglog()
 #include "../system/system2200.h"
 
+#include <array>
+#include <atomic>
+
 #ifdef _DEBUG
     int iodisk_noisy = 1;
     #define NOISY  (iodisk_noisy) // turn on some alert messages
@@ -149,6 +153,11 @@
 // the minimum number of ticks for a callback event
 const int64 DISK_MIN_TICKS = TIMER_US(20);
 
+// drive status as of the last disk event, for pollers on any thread (see
+// wvdPublishedStatus()).  only the emulation thread writes it.
+static std::array<std::atomic<uint8>, NUM_IOSLOTS*4> s_published_status;
+static std::atomic<uint32> s_status_seq(0);
+
 // =====================================================
 //   public interface
 // =====================================================
@@ -169,6 +178,7 @@ IoCardDisk::IoCardDisk(std::shared_ptr<Scheduler> scheduler,
         assert(cp != nullptr);
         m_cfg = *cp;
         createDiskController();
+        publishDriveStatus();
     }
 }
 
@@ -182,6 +192,10 @@ IoCardDisk::~IoCardDisk()
         for (int drive=0; drive < numDrives(); drive++) {
             m_d[drive].wvd = nullptr;
         }
+        for (int drive=0; drive < 4; drive++) {
+            s_published_status[4*m_slot + drive].store(0, std::memory_order_relaxed);
+        }
+        s_status_seq.fetch_add(1, std::memory_order_release);
     }
 }
 
@@ -299,9 +313,7 @@ IoCardDisk::select()
     }
 
     m_cpu->setDevRdy(!m_card_busy);
-    for (int drive=0; drive < numDrives(); drive++) {
-        UI_diskEvent(m_slot, drive);
-    }
+    publishDriveStatus();
 }
 
 
@@ -316,9 +328,7 @@ IoCardDisk::deselect()
     m_selected = false;
     m_cpb      = true;
 
-    for (int drive=0; drive < numDrives(); drive++) {
-        UI_diskEvent(m_slot, drive);
-    }
+    publishDriveStatus();
 }
 
 
@@ -408,7 +418,7 @@ IoCardDisk::stopMotor(int drive)
     m_d[drive].tmr_track  = nullptr;
     m_d[drive].tmr_sector = nullptr;
 
-    UI_diskEvent(m_slot, drive);        // let UI know things have changed
+    publishDriveStatus();
 }
 
 
@@ -475,6 +485,58 @@ IoCardDisk::setBusyState(bool busy)
 }
 
 
+// returns a bitwise 'or' of the WVD_STAT_DRIVE_* enums
+int
+IoCardDisk::driveStatus(int drive) const noexcept
+{
+    int rv = 0; // default return value
+
+    if (drive < numDrives()) {
+        rv |= WVD_STAT_DRIVE_EXISTENT;
+    }
+
+    if ((rv != 0) && m_d[drive].state != DRIVE_EMPTY) {
+        rv |= WVD_STAT_DRIVE_OCCUPIED;
+    }
+
+    if ((rv != 0) && m_selected && (m_drive == drive)) {
+        rv |= WVD_STAT_DRIVE_SELECTED;
+    }
+
+    if ((rv != 0) && !inIdleState()) {
+        rv |= WVD_STAT_DRIVE_BUSY;
+    }
+
+    if ((rv != 0) && m_d[drive].state != DRIVE_IDLE) {
+        rv |= WVD_STAT_DRIVE_RUNNING;
+    }
+
+    return rv;
+}
+
+
+// copy the status of our drives to the published status block.  this
+// replaces calling into the UI on each transition: the status bar and
+// the web server poll the block at their own pace, and the sequence
+// number only moves when something actually changed.
+void
+IoCardDisk::publishDriveStatus() noexcept
+{
+    bool changed = false;
+    for (int drive=0; drive < 4; drive++) {
+        const auto status = static_cast<uint8>(driveStatus(drive));
+        auto &slot_status = s_published_status[4*m_slot + drive];
+        if (slot_status.load(std::memory_order_relaxed) != status) {
+            slot_status.store(status, std::memory_order_relaxed);
+            changed = true;
+        }
+    }
+    if (changed) {
+        s_status_seq.fetch_add(1, std::memory_order_release);
+    }
+}
+
+
 // true=same timing as real disk, false=going fast
 bool
 IoCardDisk::realtimeDisk() noexcept
@@ -713,6 +775,7 @@ IoCardDisk::tcbTrack(int arg)
 
     if (m_d[m_drive].state == DRIVE_IDLE) {
         m_d[m_drive].state = DRIVE_SPINNING;
+        publishDriveStatus();
     }
 
     if ((m_command == CMD_SPECIAL) ||
@@ -793,6 +856,198 @@ IoCardDisk::tcbSector(int arg)
 }
 
 
+// ==========================================================
+//   save/restore of the running state
+// ==========================================================
+
+// the controller state machine, the position of each drive, and the
+// pending timers.  the images are flushed so the next owner sees every
+// sector written so far.  a disk in overlay mode keeps its writes in
+// memory, so that isn't handed over.
+bool
+IoCardDisk::saveState(StateWriter &out) const
+{
+    for (int drive=0; drive < numDrives(); drive++) {
+        if ((m_d[drive].state != DRIVE_EMPTY) && m_d[drive].wvd->isOverlay()) {
+            return false;
+        }
+    }
+
+    out.put8(numDrives());
+    out.putBool(m_selected);
+    out.putBool(m_cpb);
+    out.putBool(m_card_busy);
+    out.putBool(m_compare_err);
+    out.putBool(m_acting_intelligent);
+    out.putBool(m_abs_hog);
+    out.putBool(m_cbs_hog);
+
+    for (int drive=0; drive < numDrives(); drive++) {
+        const drive_t &d = m_d[drive];
+        out.put8(d.state);
+        out.putString((d.state != DRIVE_EMPTY) ? d.wvd->getPath() : "");
+        out.put32(d.track);
+        out.put32(d.sector);
+        out.put32(d.secwait);
+        out.put32(d.idle_cnt);
+        out.put64(m_scheduler->timeLeftNs(d.tmr_track));
+        out.put64(m_scheduler->timeLeftNs(d.tmr_sector));
+        if (d.state != DRIVE_EMPTY) {
+            d.wvd->flush();
+        }
+    }
+    out.put64(m_scheduler->timeLeftNs(m_tmr_motor_off));
+
+    out.put32(m_host_type);
+    out.put32(m_command);
+    out.put32(m_special_command);
+    out.putBool(m_primary);
+    out.put32(m_drive);
+    out.put32(m_platter);
+    out.put32(m_lastdrive);
+    out.put32(m_secaddr);
+    out.put32(m_byte_to_send);
+    out.putBytes(m_buffer, sizeof(m_buffer));
+    out.putBytes(m_host_buffer, sizeof(m_host_buffer));
+    out.put32(m_bufptr);
+    out.putBytes(m_header, sizeof(m_header));
+    out.put32(m_state_cnt);
+    out.put32(m_xfer_length);
+    out.put32(m_state);
+    out.put32(m_calling_state);
+    out.put32(m_return_state);
+    out.put32(m_byte_count);
+    for (auto v : m_get_bytes) {
+        out.put32(v);
+    }
+    for (auto v : m_send_bytes) {
+        out.put32(v);
+    }
+    out.put32(m_get_bytes_ptr);
+    out.put32(m_send_bytes_ptr);
+    out.putBool(m_copy_pending);
+    out.put32(m_range_drive);
+    out.put32(m_range_platter);
+    out.put32(m_range_start);
+    out.put32(m_range_end);
+    out.put32(m_dest_drive);
+    out.put32(m_dest_platter);
+    out.put32(m_dest_start);
+    return true;
+}
+
+
+bool
+IoCardDisk::restoreState(StateReader &in)
+{
+    if (in.get8() != numDrives()) {
+        in.fail();
+        return false;
+    }
+    m_selected           = in.getBool();
+    m_cpb                = in.getBool();
+    m_card_busy          = in.getBool();
+    m_compare_err        = in.getBool();
+    m_acting_intelligent = in.getBool();
+    m_abs_hog            = in.getBool();
+    m_cbs_hog            = in.getBool();
+
+    for (int drive=0; drive < numDrives(); drive++) {
+        drive_t &d = m_d[drive];
+        const int state = in.get8();
+        const std::string filename = in.getString();
+        if (!in.ok() || (state < DRIVE_EMPTY) || (state > DRIVE_SPINNING)) {
+            in.fail();
+            return false;
+        }
+
+        // the new owner normally mounted the same disks from the ini file
+        const bool mounted = (d.state != DRIVE_EMPTY);
+        if (mounted && ((state == DRIVE_EMPTY) || (d.wvd->getPath() != filename))) {
+            d.wvd->close();
+            d.state = DRIVE_EMPTY;
+        }
+        if ((state != DRIVE_EMPTY) && (d.state == DRIVE_EMPTY)) {
+            if (!iwvdInsertDisk(drive, filename)) {
+                UI_error("Can't reopen disk image '%s'", filename.c_str());
+                in.fail();
+                return false;
+            }
+        }
+
+        d.state    = static_cast<state_t>(state);
+        d.track    = in.getInt();
+        d.sector   = in.getInt();
+        d.secwait  = in.getInt();
+        d.idle_cnt = in.getInt();
+        const int64 tmr_track  = in.get64();
+        const int64 tmr_sector = in.get64();
+
+        d.tmr_track  = nullptr;
+        d.tmr_sector = nullptr;
+        if (tmr_track > 0) {
+            d.tmr_track = m_scheduler->createTimer(tmr_track,
+                                                   [&](){ tcbTrack(m_drive); });
+        }
+        if (tmr_sector > 0) {
+            d.tmr_sector = m_scheduler->createTimer(tmr_sector,
+                                                    [&, drive](){ tcbSector(drive); });
+        }
+    }
+    const int64 tmr_motor_off = in.get64();
+
+    m_host_type       = in.getInt();
+    m_command         = in.getInt();
+    m_special_command = in.getInt();
+    m_primary         = in.getBool();
+    m_drive           = in.getInt();
+    m_platter         = in.getInt();
+    m_lastdrive       = in.getInt();
+    m_secaddr         = in.getInt();
+    m_byte_to_send    = in.getInt();
+    in.getBytes(m_buffer, sizeof(m_buffer));
+    in.getBytes(m_host_buffer, sizeof(m_host_buffer));
+    m_bufptr          = in.getInt();
+    in.getBytes(m_header, sizeof(m_header));
+    m_state_cnt       = in.getInt();
+    m_xfer_length     = in.getInt();
+    m_state           = static_cast<disk_sm_t>(in.getInt());
+    m_calling_state   = static_cast<disk_sm_t>(in.getInt());
+    m_return_state    = static_cast<disk_sm_t>(in.getInt());
+    m_byte_count      = in.getInt();
+    for (auto &v : m_get_bytes) {
+        v = in.getInt();
+    }
+    for (auto &v : m_send_bytes) {
+        v = in.getInt();
+    }
+    m_get_bytes_ptr   = in.getInt();
+    m_send_bytes_ptr  = in.getInt();
+    m_copy_pending    = in.getBool();
+    m_range_drive     = in.getInt();
+    m_range_platter   = in.getInt();
+    m_range_start     = in.getInt();
+    m_range_end       = in.getInt();
+    m_dest_drive      = in.getInt();
+    m_dest_platter    = in.getInt();
+    m_dest_start      = in.getInt();
+
+    if (!in.ok() || (m_state < 0) || (m_state >= CTRL_NUM_STATES)
+                 || (m_drive < 0) || (m_drive >= numDrives())) {
+        in.fail();
+        return false;
+    }
+
+    m_tmr_motor_off = nullptr;
+    if (tmr_motor_off > 0) {
+        m_tmr_motor_off = m_scheduler->createTimer(tmr_motor_off,
+                                                   [&](){ tcbMotorOff(m_drive); });
+    }
+    publishDriveStatus();
+    return true;
+}
+
+
 // ==========================================================
 //   exported functions
 // ==========================================================
@@ -877,29 +1132,24 @@ IoCardDisk::wvdDriveStatus(int slot, int drive) noexcept
         return 0;       // !EXISTENT, !OCCUPIED, !RUNNING, !SELECTED
     }
 
-    int rv = 0; // default return value
-
-    if (drive < tthis->numDrives()) {
-        rv |= WVD_STAT_DRIVE_EXISTENT;
-    }
-
-    if ((rv != 0) && tthis->m_d[drive].state != DRIVE_EMPTY) {
-        rv |= WVD_STAT_DRIVE_OCCUPIED;
-    }
+    return tthis->driveStatus(drive);
+}
 
-    if ((rv != 0) && tthis->m_selected && (tthis->m_drive == drive)) {
-        rv |= WVD_STAT_DRIVE_SELECTED;
-    }
 
-    if ((rv != 0) && !tthis->inIdleState()) {
-        rv |= WVD_STAT_DRIVE_BUSY;
-    }
+// the drive status as of the last disk event
+int
+IoCardDisk::wvdPublishedStatus(int slot, int drive) noexcept
+{
+    ASSERT_VALID_SLOT(slot);
+    ASSERT_VALID_DRIVE(drive);
+    return s_published_status[4*slot + drive].load(std::memory_order_acquire);
+}
 
-    if ((rv != 0) && tthis->m_d[drive].state != DRIVE_IDLE) {
-        rv |= WVD_STAT_DRIVE_RUNNING;
-    }
 
-    return rv;
+uint32
+IoCardDisk::wvdStatusSeq() noexcept
+{
+    return s_status_seq.load(std::memory_order_acquire);
 }
 
 
@@ -916,7 +1166,7 @@ IoCardDisk::wvdInsertDisk(int slot,
     assert(tthis != nullptr);
 
     const bool ok = tthis->iwvdInsertDisk(drive, filename);
-    UI_diskEvent(slot, drive);
+    tthis->publishDriveStatus();
     return ok;
 }
 
@@ -933,7 +1183,7 @@ IoCardDisk::wvdRemoveDisk(int slot, int drive)
     assert(tthis != nullptr);
 
     const bool ok = tthis->iwvdRemoveDisk(drive);
-    UI_diskEvent(slot, drive);
+    tthis->publishDriveStatus();
     return ok;
 }
 
@@ -953,6 +1203,25 @@ IoCardDisk::wvdFlush(int slot, int drive)
 }
 
 
+// put the disk in the specified drive in overlay mode.  the file handle is
+// closed first; a forked process shares it, including the file offset,
+// with its parent and siblings.
+void
+IoCardDisk::wvdMakeOverlay(int slot, int drive)
+{
+    ASSERT_VALID_SLOT(slot);
+    ASSERT_VALID_DRIVE(drive);
+
+    const IoCardDisk *tthis = dynamic_cast<IoCardDisk*>
+                                    (system2200::getInstFromSlot(slot));
+    assert(tthis != nullptr);
+    assert(tthis->m_d[drive].state != DRIVE_EMPTY);
+
+    tthis->m_d[drive].wvd->flush();
+    tthis->m_d[drive].wvd->setOverlay(true);
+}
+
+
 // format a disk by filename
 // returns true if successful
 bool
@@ -1148,12 +1417,7 @@ IoCardDisk::iwvdReadSector()
     }
     const bool ok = m_d[m_drive].wvd->readSector(m_platter, m_secaddr, &m_buffer[0]);
 
-    // compute LRC
-    int cksum = 0;
-    for (int i=0; i < 256; i++) {
-        cksum += m_buffer[i];
-    }
-    m_buffer[256] = static_cast<uint8>(cksum & 0xFF);  // LRC byte
+    m_buffer[256] = sectorLrc(&m_buffer[0]);  // LRC byte
 
     return ok;
 }
@@ -37,6 +37,8 @@ public:
     void  strobeOBS(int val) override;
     void  strobeCBS(int val) noexcept override;
     void  setCpuBusy(bool busy) override;
+    bool  saveState(StateWriter &out) const override;
+    bool  restoreState(StateReader &in) override;
 
     // ----- IoCardDisk specific functions -----
 
@@ -68,6 +70,14 @@ public:
     // returns a bitwise 'or' of the WVD_STAT_DRIVE_* enums
     static int wvdDriveStatus(int slot, int drive) noexcept;
 
+    // the same, as of the last disk event.  this doesn't touch the card,
+    // so unlike the above, it may be called from any thread.
+    static int wvdPublishedStatus(int slot, int drive) noexcept;
+
+    // changes whenever any published drive status changes; a poller
+    // can skip its work while this stays the same
+    static uint32 wvdStatusSeq() noexcept;
+
     // returns false if something went wrong, true otherwise
     static bool wvdInsertDisk(int slot,
                               int drive,
@@ -81,6 +91,10 @@ public:
     // close the filehandle associated with the specified drive
     static void wvdFlush(int slot, int drive);
 
+    // put the disk in the specified drive in overlay mode (see Wvd):
+    // its filehandle is reopened, and from then on writes stay in memory
+    static void wvdMakeOverlay(int slot, int drive);
+
     // format a disk by filename
     // returns true if successful
     static bool wvdFormatFile(const std::string &filename);
@@ -249,6 +263,8 @@ private:
         CTRL_VERIFY_RANGE3,
         CTRL_VERIFY_RANGE4,
         CTRL_VERIFY_RANGE5,
+
+        CTRL_NUM_STATES         // must be last
     };
 
     // disk channel commands
@@ -308,6 +324,12 @@ private:
     // indicate if the controller state machine is idle or busy
     bool inIdleState() const noexcept;
 
+    // status of one drive, as wvdDriveStatus()
+    int driveStatus(int drive) const noexcept;
+
+    // update the published status of our drives (see wvdPublishedStatus())
+    void publishDriveStatus() noexcept;
+
     // report if a given drive is occupied and has media that is suitable
     // for the intelligent disk protocol, namely disks with > 32K sectors,
     // or multiplatter disks.  these aren't necessarily opposite, as a
@@ -322,12 +344,60 @@ private:
     void sendBytes(int count, disk_sm_t return_state) noexcept;
 
     // for debugging
-    std::string stateName(int state) const;
+    static const char* stateName(int state) noexcept;
 
     // centralized function to handle updating sequencing state
     bool advanceState(disk_event_t event, int val=0);
     bool advanceStateInt(disk_event_t event, int val);
 
+    // each controller state has a handler.  it is called with the event
+    // that woke the controller and, for EVENT_OBS, the byte received.
+    // it returns true if m_byte_to_send holds a byte for the host.
+    using state_fn_t = bool (IoCardDisk::*)(disk_event_t event, int val);
+    struct state_info_t {
+        const char *name;           // for tracing
+        bool        expects_obs;    // false: an OBS here is unexpected
+        state_fn_t  handler;
+    };
+    static const state_info_t m_state_table[CTRL_NUM_STATES];
+
+    bool ctrlWakeup(disk_event_t event, int val);
+    bool ctrlStatus1(disk_event_t event, int val);
+    bool ctrlGetBytes(disk_event_t event, int val);
+    bool ctrlGetBytes2(disk_event_t event, int val);
+    bool ctrlSendBytes(disk_event_t event, int val);
+    bool ctrlCommand(disk_event_t event, int val);
+    bool ctrlCommandEcho(disk_event_t event, int val);
+    bool ctrlCommandStatus(disk_event_t event, int val);
+    bool ctrlRead1(disk_event_t event, int val);
+    bool ctrlRead2(disk_event_t event, int val);
+    bool ctrlRead3(disk_event_t event, int val);
+    bool ctrlWrite1(disk_event_t event, int val);
+    bool ctrlWrite2(disk_event_t event, int val);
+    bool ctrlVerify1(disk_event_t event, int val);
+    bool ctrlVerify2(disk_event_t event, int val);
+    bool ctrlCopy1(disk_event_t event, int val);
+    bool ctrlCopy2(disk_event_t event, int val);
+    bool ctrlCopy3(disk_event_t event, int val);
+    bool ctrlCopy4(disk_event_t event, int val);
+    bool ctrlCopy5(disk_event_t event, int val);
+    bool ctrlCopy6(disk_event_t event, int val);
+    bool ctrlCopy7(disk_event_t event, int val);
+    bool ctrlFormat1(disk_event_t event, int val);
+    bool ctrlFormat2(disk_event_t event, int val);
+    bool ctrlFormat3(disk_event_t event, int val);
+    bool ctrlMsectWrStart(disk_event_t event, int val);
+    bool ctrlMsectWrEnd1(disk_event_t event, int val);
+    bool ctrlMsectWrEnd2(disk_event_t event, int val);
+    bool ctrlVerifyRange1(disk_event_t event, int val);
+    bool ctrlVerifyRange2(disk_event_t event, int val);
+    bool ctrlVerifyRange3(disk_event_t event, int val);
+    bool ctrlVerifyRange4(disk_event_t event, int val);
+    bool ctrlVerifyRange5(disk_event_t event, int val);
+
+    // LRC of a 256 byte sector
+    static uint8 sectorLrc(const uint8 *data) noexcept;
+
     int        m_host_type;          // 00=2200 T or PROM mode, 01=2200 VP, 02=2200 MVP
     int        m_command;            // command byte
     int        m_special_command;    // special command byte
@@ -339,6 +409,7 @@ private:
     int        m_byte_to_send;        // the value that IBS returns
 
     uint8      m_buffer[257];        // 256B of data plus an LRC byte
+    uint8      m_host_buffer[257];   // VERIFY: data plus LRC from the host
     int        m_bufptr;             // which buffer entry is read or written next
     uint8      m_header[10];         // header bytes
     int        m_state_cnt = 0;      // how many bytes of the have been processed
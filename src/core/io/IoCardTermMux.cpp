@@ -11,6 +11,7 @@
 //     https://wang2200.org/2200tech/wang_2236mxd.lst
 
 #include <algorithm>  // for std::min
+#include <chrono>
 
 #ifdef _WIN32
 #define NOMINMAX  // Prevent Windows from defining min/max macros
@@ -20,6 +21,7 @@
 #include "IoCardKeyboard.h"   // for key encodings
 #include "IoCardTermMux.h"
 #include "../system/Scheduler.h"
+#include "../system/StateStream.h"
 #include "../../shared/config/TermMuxCfgState.h"
 #ifndef HEADLESS_BUILD
 #include "../../shared/terminal/Terminal.h"
@@ -44,6 +46,15 @@ const int NS_PER_TICK = 561;
 // 11 bits per character (start + 8 data + odd parity + stop) at 19200 bps
 static const int64 SERIAL_CHAR_DELAY = TIMER_US(11.0 * 1.0E6 / 19200.0);
 
+// host time for the flow control measurements; the terminal's typing and
+// the link don't slow down along with the emulation
+static int64
+hostTimeNs() noexcept
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
 // mxd eprom image
 #include "IoCardTermMux_eprom.h"
 
@@ -149,6 +160,10 @@ IoCardTermMux::IoCardTermMux(std::shared_ptr<Scheduler> scheduler,
     [[maybe_unused]] const bool vp_mode = (cpu_type != Cpu2200::CPUTYPE_2200B)
                       && (cpu_type != Cpu2200::CPUTYPE_2200T);
     for(int n=0; n<m_num_terms; n++) {
+        // 8 data bits, start and stop, ignoring parity
+        m_terms[n].link_bps = m_cfg.getTerminalBaudRate(n) / 10;
+        updateFlowLevels(n);
+
         // Check if this terminal should use COM port
         if (m_cfg.isTerminalComPort(n)) {
             // Create and configure the serial port
@@ -157,8 +172,9 @@ IoCardTermMux::IoCardTermMux(std::shared_ptr<Scheduler> scheduler,
             SerialConfig serial_cfg;
             serial_cfg.portName = m_cfg.getTerminalComPort(n);
             serial_cfg.baudRate = m_cfg.getTerminalBaudRate(n);
-            // Hardware flow control (RTS/CTS) is disabled for Wang terminals since they don't support it
-            serial_cfg.hwFlowControl = false;
+            // Wang terminals don't do RTS/CTS, but some cables and
+            // adapters in front of them do
+            serial_cfg.hwFlowControl = m_cfg.getTerminalFlowControl(n);
             serial_cfg.swFlowControl = m_cfg.getTerminalSwFlowControl(n);
             serial_cfg.dataBits = 8;
 #ifdef _WIN32
@@ -511,24 +527,27 @@ IoCardTermMux::mxdToTermCallback(int term_num, int byte)
     m_term_t &term = m_terms[term_num];
     term.tx_tmr = nullptr;
 
-    // Check TX queue backpressure before sending - use lighter approach to avoid RX interference
-    if (term.serial_port && term.serial_port->isOpen()) {
-        size_t queue_size = term.serial_port->getTxQueueSize();
-        size_t queue_capacity = term.serial_port->getTxQueueCapacity();
-        float queue_fullness = static_cast<float>(queue_size) / queue_capacity;
+    // Check TX queue backpressure before sending - use lighter approach to avoid RX interference.
+    // The queue only fills when the terminal has paused us (XOFF/CTS).
+    float queue_fullness = 0.0f;
+    if (term.session) {
+        queue_fullness = term.session->getTxQueueFullness();
+    } else if (term.serial_port && term.serial_port->isOpen()) {
+        queue_fullness = static_cast<float>(term.serial_port->getTxQueueSize())
+                       / term.serial_port->getTxQueueCapacity();
+    }
         
-        // Apply much gentler backpressure to avoid affecting RX responsiveness
-        if (queue_fullness > 0.90f) { // Increase threshold to 90% to reduce interference
-            // Use much shorter delays: 90%=50μs, 95%=100μs, 100%=200μs
-            int64 delay_us = 50 + static_cast<int64>((queue_fullness - 0.90f) * 1500); // 50μs to 200μs max
-            term.tx_tmr = m_scheduler->createTimer(
-                TIMER_US(delay_us),
-                std::bind(&IoCardTermMux::mxdToTermCallback, this, term_num, byte)
-            );
-            dbglog("IoCardTermMux: TX queue %d%% full (%zu/%zu), delaying %lldμs for terminal %d\n", 
-                   static_cast<int>(queue_fullness * 100), queue_size, queue_capacity, delay_us, term_num);
-            return;  // Don't proceed with checkTxBuffer yet
-        }
+    // Apply much gentler backpressure to avoid affecting RX responsiveness
+    if (queue_fullness > 0.90f) { // Increase threshold to 90% to reduce interference
+        // Use much shorter delays: 90%=50μs, 95%=100μs, 100%=200μs
+        int64 delay_us = 50 + static_cast<int64>((queue_fullness - 0.90f) * 1500); // 50μs to 200μs max
+        term.tx_tmr = m_scheduler->createTimer(
+            TIMER_US(delay_us),
+            std::bind(&IoCardTermMux::mxdToTermCallback, this, term_num, byte)
+        );
+        dbglog("IoCardTermMux: TX queue %d%% full, delaying %lldμs for terminal %d\n", 
+               static_cast<int>(queue_fullness * 100), delay_us, term_num);
+        return;  // Don't proceed with checkTxBuffer yet
     }
 
     // Route output to appropriate backend: session, serial port, or GUI terminal
@@ -576,6 +595,8 @@ IoCardTermMux::queueRxByte(int term_num, uint8_t byte)
         dbglog("IoCardTermMux: Filtering flow control byte 0x%02X from terminal %d\n", byte, term_num);
         return; // Don't queue flow control characters
     }
+
+    noteRxArrival(term_num);
     
     if (t.rx_fifo.size() >= RX_FIFO_MAX) {
         // Drop oldest to avoid hard-stall; count a stat
@@ -585,7 +606,7 @@ IoCardTermMux::queueRxByte(int term_num, uint8_t byte)
     t.rx_fifo.push_back(byte);
 
     // Send XOFF immediately if buffer becomes full to prevent further overrun
-    if (t.rx_fifo.size() >= RX_FIFO_XOFF_THRESHOLD && !t.xoff_sent) {
+    if (t.rx_fifo.size() >= t.xoff_level && !t.xoff_sent) {
         sendXOFF(term_num);
     }
 
@@ -646,7 +667,7 @@ IoCardTermMux::serialRxByte(int term_num, uint8_t byte)
     
     // Only check RX-related flow control (XON when buffer drains) - deferred to avoid latency
     // XOFF will be sent when buffer gets full during queueRxByte processing
-    if (m_terms[term_num].rx_fifo.size() <= RX_FIFO_XON_THRESHOLD && m_terms[term_num].xoff_sent) {
+    if (m_terms[term_num].rx_fifo.size() <= m_terms[term_num].xon_level && m_terms[term_num].xoff_sent) {
         checkAndSendFlowControl(term_num);
     }
 }
@@ -661,11 +682,11 @@ IoCardTermMux::checkAndSendFlowControl(int term_num)
     size_t fifo_size = t.rx_fifo.size();
     
     // Send XOFF if FIFO is getting full and we haven't sent XOFF yet
-    if (fifo_size >= RX_FIFO_XOFF_THRESHOLD && !t.xoff_sent) {
+    if (fifo_size >= t.xoff_level && !t.xoff_sent) {
         sendXOFF(term_num);
     }
     // Send XON if FIFO has drained enough and we previously sent XOFF
-    else if (fifo_size <= RX_FIFO_XON_THRESHOLD && t.xoff_sent) {
+    else if (fifo_size <= t.xon_level && t.xoff_sent) {
         sendXON(term_num);
     }
 }
@@ -676,23 +697,51 @@ IoCardTermMux::sendXON(int term_num)
 {
     assert((0 <= term_num) && (term_num < MAX_TERMINALS));
     auto &t = m_terms[term_num];
+    bool sent = false;
     
-    // Send XON via serial port if available
+    // Raise RTS or send XON via serial port if available
     if (t.serial_port && t.serial_port->isOpen()) {
-        t.serial_port->sendXON();
-        t.xoff_sent = false;
-        t.xon_sent_count++;
+        if (t.serial_port->hasHwFlowControl()) {
+            t.serial_port->setRts(true);
+        } else {
+            t.serial_port->sendXON();
+        }
+        sent = true;
         dbglog("IoCardTermMux: Sent XON to terminal %d (FIFO size: %zu)\n", 
                term_num, t.rx_fifo.size());
     }
     // Send XON via session if available  
     else if (t.session && t.session->isActive()) {
-        t.session->mxdToTerm(0x11); // DC1 (XON)
-        t.xoff_sent = false;
-        t.xon_sent_count++;
+        if (!t.session->throttleInput(false)) {
+            t.session->sendFlowControl(false);  // DC1 (XON)
+        }
+        sent = true;
         dbglog("IoCardTermMux: Sent XON to terminal %d via session (FIFO size: %zu)\n", 
                term_num, t.rx_fifo.size());
     }
+
+    if (sent) {
+        t.xoff_sent = false;
+        t.xon_sent_count++;
+
+        const int64 now = hostTimeNs();
+        const uint64_t stalled = static_cast<uint64_t>(now - t.xoff_time_ns);
+        t.throttled_ns += stalled;
+        t.longest_throttle_ns = std::max(t.longest_throttle_ns, stalled);
+
+        // the bytes which kept coming after XOFF show how much room the
+        // next XOFF must leave, and how long the terminal takes to react.
+        // a larger reading is taken at once, a smaller one eases in.
+        if (t.skid_count > 0) {
+            const int64 rtt = t.last_skid_ns - t.xoff_time_ns;
+            t.skid_est = (t.skid_count > t.skid_est) ? t.skid_count
+                       : (7 * t.skid_est + t.skid_count) / 8;
+            t.rtt_ns   = (rtt > t.rtt_ns) ? rtt : (7 * t.rtt_ns + rtt) / 8;
+        }
+        t.skid_count = 0;
+        t.awaiting_resume = true;
+        updateFlowLevels(term_num);
+    }
 }
 
 // Send XOFF to terminal via serial port
@@ -701,39 +750,266 @@ IoCardTermMux::sendXOFF(int term_num)
 {
     assert((0 <= term_num) && (term_num < MAX_TERMINALS));
     auto &t = m_terms[term_num];
+    bool sent = false;
     
-    // Send XOFF via serial port if available
+    // Drop RTS or send XOFF via serial port if available
     if (t.serial_port && t.serial_port->isOpen()) {
-        t.serial_port->sendXOFF();
-        t.xoff_sent = true;
-        t.xoff_sent_count++;
+        t.hw_flow = t.serial_port->hasHwFlowControl();
+        if (t.hw_flow) {
+            t.serial_port->setRts(false);
+        } else {
+            t.serial_port->sendXOFF();
+        }
+        sent = true;
         dbglog("IoCardTermMux: Sent XOFF to terminal %d (FIFO size: %zu)\n", 
                term_num, t.rx_fifo.size());
     }
     // Send XOFF via session if available
     else if (t.session && t.session->isActive()) {
-        t.session->mxdToTerm(0x13); // DC3 (XOFF)
-        t.xoff_sent = true;
-        t.xoff_sent_count++;
+        t.hw_flow = t.session->throttleInput(true);
+        if (!t.hw_flow) {
+            t.session->sendFlowControl(true);   // DC3 (XOFF)
+        }
+        sent = true;
         dbglog("IoCardTermMux: Sent XOFF to terminal %d via session (FIFO size: %zu)\n", 
                term_num, t.rx_fifo.size());
     }
+
+    if (sent) {
+        t.xoff_sent = true;
+        t.xoff_sent_count++;
+        t.xoff_time_ns = hostTimeNs();
+        t.last_skid_ns = t.xoff_time_ns;
+        t.skid_count = 0;
+    }
+}
+
+// a byte has come in from the terminal
+void
+IoCardTermMux::noteRxArrival(int term_num)
+{
+    auto &t = m_terms[term_num];
+    t.awaiting_resume = false;
+    if (t.xoff_sent) {
+        t.skid_count++;
+        t.last_skid_ns = hostTimeNs();
+    }
 }
 
-// Get flow control statistics for debugging/monitoring
+// the 8080 has taken a byte from the FIFO.  the drain rate is only
+// measured while there is a backlog, otherwise it would just be the
+// rate the user types at.
 void
-IoCardTermMux::getFlowControlStats(int term_num, uint32_t* rx_overrun_drops, 
-                                  uint64_t* xon_sent_count, uint64_t* xoff_sent_count, 
-                                  size_t* fifo_size, bool* xoff_sent) const
+IoCardTermMux::noteRxDrain(int term_num)
+{
+    auto &t = m_terms[term_num];
+
+    if (t.rx_fifo.empty()) {
+        if (t.awaiting_resume) {
+            // XON went out too late to keep the 8080 fed
+            t.awaiting_resume = false;
+            t.dry_after_xon++;
+        }
+        t.drain_count = 0;
+        return;
+    }
+
+    const int64 now = hostTimeNs();
+    if (t.drain_count == 0) {
+        t.drain_start_ns = now;
+    } else if (t.drain_count == RX_DRAIN_SAMPLE) {
+        const int64 elapsed = std::max<int64>(now - t.drain_start_ns, 1);
+        const auto rate = static_cast<uint32_t>(
+            std::min<int64>(RX_DRAIN_SAMPLE * 1000000000LL / elapsed, 1000000));
+        t.drain_bps = (t.drain_bps == 0) ? rate : (3 * t.drain_bps + rate) / 4;
+        t.drain_start_ns = now;
+        t.drain_count = 0;
+        updateFlowLevels(term_num);
+    }
+    t.drain_count++;
+}
+
+// set the watermarks from what has been measured so far
+void
+IoCardTermMux::updateFlowLevels(int term_num)
+{
+    auto &t = m_terms[term_num];
+
+    // until a throttle has been seen, assume the link keeps running
+    // at full rate for the default round trip
+    const uint64_t skid = (t.skid_est > 0) ? t.skid_est
+                        : static_cast<uint64_t>(t.link_bps) * RX_DEFAULT_RTT_NS / 1000000000LL;
+    const size_t headroom = std::clamp<size_t>(skid * 3 / 2 + 16,
+                                               RX_FIFO_MIN_HEADROOM, RX_FIFO_MAX_HEADROOM);
+    t.xoff_level = RX_FIFO_MAX - headroom;
+
+    // after XON the first byte shows up a round trip later; keep enough
+    // queued for the 8080 to chew on until then
+    const uint64_t drain = (t.drain_bps > 0) ? t.drain_bps : t.link_bps;
+    const uint64_t need  = drain * static_cast<uint64_t>(t.rtt_ns) / 1000000000LL;
+    t.xon_level = std::clamp<size_t>(need * 3 / 2, RX_FIFO_MIN_XON, t.xoff_level / 2);
+}
+
+// Get flow control statistics for monitoring
+void
+IoCardTermMux::getRxFlowStats(int term_num, rx_flow_stats_t *stats) const
 {
     assert((0 <= term_num) && (term_num < MAX_TERMINALS));
+    assert(stats != nullptr);
     const auto &t = m_terms[term_num];
-    
-    if (rx_overrun_drops) *rx_overrun_drops = t.rx_overrun_drops;
-    if (xon_sent_count) *xon_sent_count = t.xon_sent_count;
-    if (xoff_sent_count) *xoff_sent_count = t.xoff_sent_count;
-    if (fifo_size) *fifo_size = t.rx_fifo.size();
-    if (xoff_sent) *xoff_sent = t.xoff_sent;
+
+    // include the episode in progress
+    uint64_t throttled = t.throttled_ns;
+    uint64_t longest   = t.longest_throttle_ns;
+    if (t.xoff_sent) {
+        const auto now = static_cast<uint64_t>(hostTimeNs() - t.xoff_time_ns);
+        throttled += now;
+        longest = std::max(longest, now);
+    }
+
+    stats->fifo_size           = t.rx_fifo.size();
+    stats->xoff_level          = t.xoff_level;
+    stats->xon_level           = t.xon_level;
+    stats->throttled           = t.xoff_sent;
+    stats->hw_flow             = t.hw_flow;
+    stats->drain_bps           = t.drain_bps;
+    stats->link_rtt_us         = static_cast<uint32_t>(t.rtt_ns / 1000);
+    stats->skid_bytes          = t.skid_est;
+    stats->rx_overrun_drops    = t.rx_overrun_drops;
+    stats->xoff_sent_count     = t.xoff_sent_count;
+    stats->xon_sent_count      = t.xon_sent_count;
+    stats->throttled_us        = throttled / 1000;
+    stats->longest_throttle_us = longest / 1000;
+    stats->dry_after_xon       = t.dry_after_xon;
+}
+
+// ============================================================================
+// Save/restore of the running state
+// ============================================================================
+
+// the 8080 and its RAM, the bus interface latches, and the uarts.  the
+// sessions aren't part of it; the flow control measurements start over
+// when the new owner attaches its sessions.
+bool
+IoCardTermMux::saveState(StateWriter &out) const
+{
+    const i8080 *cpu = static_cast<const i8080*>(m_i8080);
+
+    out.put16(cpu->sp.w);
+    out.put16(cpu->pc.w);
+    out.put16(cpu->af.w);
+    out.put16(cpu->bc.w);
+    out.put16(cpu->de.w);
+    out.put16(cpu->hl.w);
+    out.put8(cpu->f.carry_flag);
+    out.put8(cpu->f.result);
+    out.put8(cpu->f.lazy_a);
+    out.put8(cpu->f.lazy_b);
+    out.put8(cpu->f.lazy_op);
+    out.put8(cpu->inte);
+    out.put8(cpu->halt);
+    out.putBytes(m_ram, sizeof(m_ram));
+
+    out.put8(m_num_terms);
+    out.putBool(m_selected);
+    out.putBool(m_cpb);
+    out.put8(m_io_offset);
+    out.putBool(m_prime_seen);
+    out.putBool(m_obs_seen);
+    out.putBool(m_cbs_seen);
+    out.put8(m_obscbs_offset);
+    out.put16(m_obscbs_data);
+    out.put8(m_rbi);
+    out.put8(m_uart_sel);
+    out.putBool(m_interrupt_pending);
+
+    for (int n=0; n < m_num_terms; n++) {
+        const m_term_t &term = m_terms[n];
+        out.putBool(term.rx_ready);
+        out.put16(term.rx_byte);
+        out.put32(static_cast<int64>(term.rx_fifo.size()));
+        for (auto byte : term.rx_fifo) {
+            out.put8(byte);
+        }
+        out.putBool(term.xoff_sent);
+        out.put64(static_cast<int64>(term.xoff_sent_count));
+        out.put64(static_cast<int64>(term.xon_sent_count));
+        out.put32(term.rx_overrun_drops);
+        out.putBool(term.tx_ready);
+        out.put16(term.tx_byte);
+        out.put64(m_scheduler->timeLeftNs(term.tx_tmr));
+    }
+    return true;
+}
+
+
+bool
+IoCardTermMux::restoreState(StateReader &in)
+{
+    i8080 *cpu = static_cast<i8080*>(m_i8080);
+
+    cpu->sp.w         = static_cast<uint16>(in.get16());
+    cpu->pc.w         = static_cast<uint16>(in.get16());
+    cpu->af.w         = static_cast<uint16>(in.get16());
+    cpu->bc.w         = static_cast<uint16>(in.get16());
+    cpu->de.w         = static_cast<uint16>(in.get16());
+    cpu->hl.w         = static_cast<uint16>(in.get16());
+    cpu->f.carry_flag = static_cast<uint8>(in.get8());
+    cpu->f.result     = static_cast<uint8>(in.get8());
+    cpu->f.lazy_a     = static_cast<uint8>(in.get8());
+    cpu->f.lazy_b     = static_cast<uint8>(in.get8());
+    cpu->f.lazy_op    = static_cast<uint8>(in.get8());
+    cpu->inte         = static_cast<uint8>(in.get8());
+    cpu->halt         = static_cast<uint8>(in.get8());
+    in.getBytes(m_ram, sizeof(m_ram));
+
+    if (in.get8() != m_num_terms) {
+        in.fail();
+        return false;
+    }
+    m_selected          = in.getBool();
+    m_cpb               = in.getBool();
+    m_io_offset         = in.get8();
+    m_prime_seen        = in.getBool();
+    m_obs_seen          = in.getBool();
+    m_cbs_seen          = in.getBool();
+    m_obscbs_offset     = in.get8();
+    m_obscbs_data       = in.get16();
+    m_rbi               = in.get8();
+    m_uart_sel          = in.get8();
+    m_interrupt_pending = in.getBool();
+
+    for (int n=0; n < m_num_terms; n++) {
+        m_term_t &term = m_terms[n];
+        term.rx_ready = in.getBool();
+        term.rx_byte  = in.get16();
+        const size_t fifo_len = static_cast<size_t>(in.get32());
+        if (fifo_len > RX_FIFO_MAX) {
+            in.fail();
+            return false;
+        }
+        term.rx_fifo.clear();
+        for (size_t i=0; i < fifo_len; i++) {
+            term.rx_fifo.push_back(static_cast<uint8_t>(in.get8()));
+        }
+        term.xoff_sent        = in.getBool();
+        term.xoff_sent_count  = static_cast<uint64_t>(in.get64());
+        term.xon_sent_count   = static_cast<uint64_t>(in.get64());
+        term.rx_overrun_drops = static_cast<uint32_t>(in.get32());
+        term.tx_ready         = in.getBool();
+        term.tx_byte          = in.get16();
+        const int64 tx_tmr    = in.get64();
+
+        // the pending byte is always the one in tx_byte
+        term.tx_tmr = nullptr;
+        if (tx_tmr > 0) {
+            term.tx_tmr = m_scheduler->createTimer(
+                              tx_tmr,
+                              std::bind(&IoCardTermMux::mxdToTermCallback, this, n, term.tx_byte)
+                          );
+        }
+    }
+    return in.ok();
 }
 
 // ============================================================================
@@ -759,6 +1035,14 @@ IoCardTermMux::setSession(int term_num, std::shared_ptr<ITermSession> session)
     
     // Set the new session
     term.session = session;
+
+    // start the flow control measurements over for the new link
+    const uint32_t baud = session ? session->getBaudRate() : 0;
+    term.link_bps  = (baud > 0) ? baud / 10 : 1920;
+    term.drain_bps = 0;
+    term.skid_est  = 0;
+    term.rtt_ns    = RX_DEFAULT_RTT_NS;
+    updateFlowLevels(term_num);
     
     if (session) {
         dbglog("IoCardTermMux: Terminal %d connected to session: %s\n", 
@@ -866,6 +1150,7 @@ IoCardTermMux::i8080_in_func(int addr, void *user_data) noexcept
         if (!term.rx_fifo.empty()) {
             rv = term.rx_fifo.front();
             term.rx_fifo.pop_front();
+            tthis->noteRxDrain(term_num);
             // Check if we should send XON now that we've freed up space
             tthis->checkAndSendFlowControl(term_num);
         } else {
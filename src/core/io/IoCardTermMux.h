@@ -41,6 +41,8 @@ public:
     void  strobeCBS(int val) override;
     int   getIB() const noexcept override;
     void  setCpuBusy(bool busy) override;
+    bool  saveState(StateWriter &out) const override;
+    bool  restoreState(StateReader &in) override;
 
     // a keyboard event has happened
     void receiveKeystroke(int term_num, int keycode);
@@ -54,10 +56,26 @@ public:
     // Get shared scheduler for terminal server components
     std::shared_ptr<Scheduler> getScheduler() const { return m_scheduler; }
     
-    // Get flow control statistics for debugging
-    void getFlowControlStats(int term_num, uint32_t* rx_overrun_drops, 
-                            uint64_t* xon_sent_count, uint64_t* xoff_sent_count, 
-                            size_t* fifo_size, bool* xoff_sent) const;
+    // receive flow control state and statistics of one terminal
+    struct rx_flow_stats_t {
+        size_t   fifo_size;         // bytes waiting for the 8080
+        size_t   xoff_level;        // current watermarks
+        size_t   xon_level;
+        bool     throttled;         // XOFF sent (or RTS dropped), no XON yet
+        bool     hw_flow;           // throttling with RTS rather than XOFF
+        uint32_t drain_bps;         // measured 8080 drain rate, bytes/s
+        uint32_t link_rtt_us;       // measured throttle to last byte time
+        uint32_t skid_bytes;        // bytes expected after throttling
+        uint32_t rx_overrun_drops;  // bytes lost to a full FIFO
+        uint64_t xoff_sent_count;   // stall episodes
+        uint64_t xon_sent_count;
+        uint64_t throttled_us;      // total time spent throttled
+        uint64_t longest_throttle_us;
+        uint64_t dry_after_xon;     // FIFO ran empty before input resumed
+    };
+
+    // Get flow control statistics for monitoring
+    void getRxFlowStats(int term_num, rx_flow_stats_t *stats) const;
 
 private:
 
@@ -99,13 +117,25 @@ private:
     void checkAndSendFlowControl(int term_num);
     void sendXON(int term_num);
     void sendXOFF(int term_num);
+
+    // adaptive watermarks: note a byte taken by the 8080 or arriving from
+    // the terminal, and recompute the thresholds from the measurements
+    void noteRxDrain(int term_num);
+    void noteRxArrival(int term_num);
+    void updateFlowLevels(int term_num);
     
     // FIFO capacity - increased from 64 to 2048 for better flow control
     static constexpr size_t RX_FIFO_MAX = 2048;
     
-    // Flow control watermarks for XON/XOFF
-    static constexpr size_t RX_FIFO_XOFF_THRESHOLD = (RX_FIFO_MAX * 3) / 4;  // 75% - send XOFF
-    static constexpr size_t RX_FIFO_XON_THRESHOLD = (RX_FIFO_MAX * 1) / 4;   // 25% - send XON
+    // Flow control watermarks for XON/XOFF.  XOFF goes out when only enough
+    // room is left for the bytes which arrive before the terminal reacts;
+    // XON goes out when the FIFO holds just enough to keep the 8080 busy
+    // until new input comes in.  Both follow the measured rates.
+    static constexpr size_t RX_FIFO_MIN_HEADROOM = 64;
+    static constexpr size_t RX_FIFO_MAX_HEADROOM = RX_FIFO_MAX / 2;
+    static constexpr size_t RX_FIFO_MIN_XON      = 32;
+    static constexpr int64  RX_DEFAULT_RTT_NS    = 40000000;  // USB adapter + terminal
+    static constexpr int    RX_DRAIN_SAMPLE      = 64;        // bytes per drain measurement
 
     // ---- board state ----
     TermMuxCfgState            m_cfg;       // current configuration
@@ -147,6 +177,23 @@ private:
         bool                   xoff_sent = false;    // true if XOFF has been sent and not cleared by XON
         uint64_t               xoff_sent_count = 0;  // number of times XOFF was sent
         uint64_t               xon_sent_count = 0;   // number of times XON was sent
+        bool                   hw_flow = false;      // throttle with RTS instead of XOFF
+        size_t                 xoff_level = RX_FIFO_MAX - RX_FIFO_MIN_HEADROOM;
+        size_t                 xon_level  = RX_FIFO_MIN_XON;
+        // adaptive flow control measurements, in host steady_clock ns
+        uint32_t               link_bps = 1920;      // line rate in bytes/s
+        uint32_t               drain_bps = 0;        // smoothed 8080 drain rate, 0=unknown
+        int                    drain_count = 0;      // bytes in the current drain sample
+        int64                  drain_start_ns = 0;   // first byte of the current sample
+        int64                  rtt_ns = RX_DEFAULT_RTT_NS; // smoothed throttle to last byte
+        uint32_t               skid_est = 0;         // smoothed bytes arriving after throttle
+        uint32_t               skid_count = 0;       // bytes since the current XOFF
+        int64                  xoff_time_ns = 0;     // when the current XOFF went out
+        int64                  last_skid_ns = 0;     // last byte after the current XOFF
+        bool                   awaiting_resume = false; // XON sent, no byte since
+        uint64_t               throttled_ns = 0;     // stall statistics
+        uint64_t               longest_throttle_ns = 0;
+        uint64_t               dry_after_xon = 0;
         // uart transmit state
         bool                   tx_ready;    // room to accept a byte (1 deep FIFO)
         int                    tx_byte;     // value of tx byte
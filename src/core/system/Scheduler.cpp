@@ -28,6 +28,7 @@
 // as a callback may result in a call to createTimer().
 
 #include "Scheduler.h"
+#include "system2200.h"          // for host activity accounting
 #include "../../gui/system/Ui.h"         // needed for UI_error()
 
 #include <algorithm>    // for std::sort
@@ -235,6 +236,7 @@ void Scheduler::creditTimer()
                });
 
     // scan through the retired list and perform callbacks
+    system2200::ActivityScope activity(system2200::ACTIVITY_TIMERS);
     for (auto &t : retired) {
         (t->m_callback)();
     }
@@ -71,6 +71,20 @@ public:
     // After 100 clocks, foo.report(33) is called.
     std::shared_ptr<Timer> createTimer(int64 ns, const sched_callback_t &fcn);
 
+    // current simulated time, in absolute ns
+    int64 getTimeNs() const noexcept { return m_time_ns; }
+
+    // ns until the timer fires (at least 1), or -1 if there is no timer.
+    // this lets the owner of a timer save it and later recreate it.
+    int64 timeLeftNs(const std::shared_ptr<Timer> &tmr) const noexcept
+    {
+        if (tmr == nullptr) {
+            return -1;
+        }
+        const int64 left = tmr->m_expires_ns - m_time_ns;
+        return (left < 1) ? 1 : left;
+    }
+
     // let 'ns' nanoseconds of simulated time go past
     inline void timerTick(int ns)
     {
@@ -0,0 +1,145 @@
+// StateWriter and StateReader serialize the running state of the machine
+// (cpu, cards, pending timers) into a flat byte buffer and back.  This is
+// used to hand a running system over to another copy of the emulator.
+//
+// Values are stored little endian at fixed widths.  The reader doesn't
+// throw; reading past the end, or a failed consistency check, latches an
+// error which the caller checks once at the end with ok().
+
+#ifndef _INCLUDE_STATE_STREAM_H_
+#define _INCLUDE_STATE_STREAM_H_
+
+#include "w2200.h"
+#include <cstring>
+
+class StateWriter
+{
+public:
+    void put8(int v)     { m_buf.push_back(static_cast<uint8>(v)); }
+    void putBool(bool v) { put8(v ? 1 : 0); }
+    void put16(int v)    { putN(static_cast<uint64>(v), 2); }
+    void put32(int64 v)  { putN(static_cast<uint64>(v), 4); }
+    void put64(int64 v)  { putN(static_cast<uint64>(v), 8); }
+
+    void putBytes(const void *data, size_t len) {
+        const uint8 *p = static_cast<const uint8*>(data);
+        m_buf.insert(m_buf.end(), p, p + len);
+    }
+
+    void putString(const std::string &s) {
+        put32(static_cast<int64>(s.size()));
+        putBytes(s.data(), s.size());
+    }
+
+    // a section is prefixed with its length, so a reader can check it
+    // consumed exactly what was written
+    size_t beginSection() {
+        const size_t mark = m_buf.size();
+        put32(0);
+        return mark;
+    }
+    void endSection(size_t mark) {
+        const uint64 len = m_buf.size() - mark - 4;
+        for (int i = 0; i < 4; i++) {
+            m_buf[mark + i] = static_cast<uint8>(len >> (8*i));
+        }
+    }
+
+    const std::vector<uint8>& data() const noexcept { return m_buf; }
+
+private:
+    void putN(uint64 v, int bytes) {
+        for (int i = 0; i < bytes; i++) {
+            m_buf.push_back(static_cast<uint8>(v >> (8*i)));
+        }
+    }
+
+    std::vector<uint8> m_buf;
+};
+
+
+class StateReader
+{
+public:
+    StateReader(const uint8 *data, size_t len) noexcept :
+        m_data(data), m_len(len) { }
+
+    int   get8()    { return static_cast<int>(getN(1)); }
+    bool  getBool() { return getN(1) != 0; }
+    int   get16()   { return static_cast<int>(getN(2)); }
+    int64 get32()   { return static_cast<int64>(getN(4)); }
+    int64 get64()   { return static_cast<int64>(getN(8)); }
+
+    // signed 32b value, eg, a timer which may be -1
+    int getInt() { return static_cast<int32>(static_cast<uint32>(getN(4))); }
+
+    bool getBytes(void *dst, size_t len) {
+        if (!take(len)) {
+            return false;
+        }
+        memcpy(dst, m_data + m_pos - len, len);
+        return true;
+    }
+
+    std::string getString() {
+        const size_t len = static_cast<size_t>(get32());
+        if (!take(len)) {
+            return "";
+        }
+        return std::string(reinterpret_cast<const char*>(m_data) + m_pos - len, len);
+    }
+
+    // returns the end offset of the section, for endSection()
+    size_t beginSection() {
+        const size_t len = static_cast<size_t>(get32());
+        if (len > m_len - m_pos) {
+            m_ok = false;
+            return m_pos;
+        }
+        return m_pos + len;
+    }
+    void endSection(size_t end) {
+        if (m_pos != end) {
+            m_ok = false;
+        }
+    }
+    void skipSection(size_t end) {
+        if (m_ok && end >= m_pos) {
+            m_pos = end;
+        }
+    }
+
+    // latch a failed consistency check
+    void fail() noexcept { m_ok = false; }
+    bool ok() const noexcept { return m_ok; }
+
+private:
+    bool take(size_t len) {
+        if (!m_ok || (len > m_len - m_pos)) {
+            m_ok = false;
+            return false;
+        }
+        m_pos += len;
+        return true;
+    }
+
+    uint64 getN(int bytes) {
+        if (!take(bytes)) {
+            return 0;
+        }
+        uint64 v = 0;
+        for (int i = 0; i < bytes; i++) {
+            v |= static_cast<uint64>(m_data[m_pos - bytes + i]) << (8*i);
+        }
+        return v;
+    }
+
+    const uint8 *m_data;
+    size_t       m_len;
+    size_t       m_pos = 0;
+    bool         m_ok  = true;
+};
+
+#endif // _INCLUDE_STATE_STREAM_H_
+
+// vim: ts=8:et:sw=4:smarttab
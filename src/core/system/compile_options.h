@@ -47,6 +47,25 @@
     #define USE_FILE_BEEPS 0
 #endif
 
+// ========================================================================
+// Cpu2200vp.cpp compile-time options
+// ========================================================================
+
+// the VP boot ROM clears every bank of main memory, and its memory test
+// writes and checks each bank three times for each of sixteen patterns.
+// with 8 MB of RAM the test alone is about a minute of emulated time.
+// 0=interpret those loops like any other microcode
+// 1=recognize the loops by their boot ROM address and run them natively.
+//   RAM and register state at loop exit are the same either way.
+#define VP_BOOT_ACCEL 1
+
+// the OS microcode copies and compares strings one byte at a time with
+// short loops of XPA read/write ops.
+// 0=interpret those loops like any other microcode
+// 1=recognize the loops when the microcode is loaded and run them natively.
+//   RAM, register state and emulated time are exactly as if interpreted.
+#define VP_LOOP_ACCEL 1
+
 // ========================================================================
 // UiDiskCtrlCfgDlg.cpp compile-time options
 // ========================================================================
@@ -55,6 +74,15 @@
 // the support is always there, this just exposes it or hides it from the UI.
 #define SUPPORT_AUTO_INTELLIGENCE false
 
+// ========================================================================
+// system2200.cpp compile-time options
+// ========================================================================
+
+// after an ABS strobe selects a card, the OBS/CBS/CPB/IB strobes go
+// straight to that card instead of looking it up again in the i/o map.
+// define to 1 to check the cached card against the map on every strobe.
+#define VERIFY_IO_DISPATCH 0
+
 // ========================================================================
 // miscellaneous
 // ========================================================================
@@ -5,6 +5,7 @@
 #include "../io/IoCardDisk.h"
 #include "../io/IoCardKeyboard.h"  // for KEYCODE_HALT
 #include "Scheduler.h"
+#include "StateStream.h"
 #include "../../shared/script/ScriptFile.h"
 #ifndef HEADLESS_BUILD
 #include "../../platform/common/SerialPort.h"
@@ -60,13 +61,78 @@ static std::array<iomap_t, 256> ioMap;
 // address of most recent ABS
 static int curIoAddr;
 
+// card selected by the most recent ABS, and its slot.  cur_card is
+// nullptr if nothing is selected, or if the selected address is 00 or
+// has no card, so the strobes which follow need no further lookup.
+static IoCard *cur_card = nullptr;
+static int     cur_slot = -1;
+
+// forget the current selection; must be done whenever ioMap or
+// card_in_slot change
+static inline void
+clearIoSelection() noexcept
+{
+    curIoAddr = -1;
+    cur_card  = nullptr;
+    cur_slot  = -1;
+}
+
+#if VERIFY_IO_DISPATCH
+// confirm the cached card is the one the i/o map says is selected
+static void
+verifyIoSelection()
+{
+    IoCard *expect = nullptr;
+    if ((curIoAddr > 0) && (ioMap[curIoAddr].slot >= 0)) {
+        expect = card_in_slot[ioMap[curIoAddr].slot].get();
+    }
+    assert(cur_card == expect);
+    assert(cur_card == nullptr || cur_slot == ioMap[curIoAddr].slot);
+}
+#else
+static inline void verifyIoSelection() noexcept { }
+#endif
+
+// see system2200::ActivityScope
+std::atomic<int> system2200::host_activity{system2200::ACTIVITY_OTHER};
+
+// bus profiler state; see system2200::enableIoProfile()
+static bool ioprof_enabled = false;
+static std::array<system2200::ioprof_t, 256>         ioprof_by_addr;
+static std::array<system2200::ioprof_t, NUM_IOSLOTS> ioprof_by_slot;
+
+static inline int64
+ioprofNow() noexcept
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// charge one bus event to the address, and if a card owns it, to its slot
+static inline void
+ioprofCharge(int io_addr, int slot, int event, int64 elapsed_ns) noexcept
+{
+    ioprof_by_addr[io_addr].count[event]++;
+    ioprof_by_addr[io_addr].host_ns[event] += elapsed_ns;
+    if (slot >= 0) {
+        ioprof_by_slot[slot].count[event]++;
+        ioprof_by_slot[slot].host_ns[event] += elapsed_ns;
+    }
+}
+
 // ----------------------------- speed regulation -----------------------------
 
 static bool  first_slice    = false; // has realtime_start been initialized?
 static int64 realtime_start = 0;     // relative wall time of when sim started
+static int64 realtime_last  = 0;     // wall time at the previous timeslice
 static int   real_seconds   = 0;     // real time elapsed
 static uint32 sim_seconds   = 0;     // number of actual seconds simulated time
 
+// wall time elapsed, times the speed multiplier in effect at the time.
+// this is the amount of simulated time regulation aims for; accumulating
+// it keeps a change of multiplier from causing a jump.
+static int64 scaled_realtime = 0;
+
 // amount of actual simulated time elapsed, in ms
 static int64 sim_time_ns;
 
@@ -357,7 +423,10 @@ breakDownCards() noexcept
         cpu->setDevRdy(false);  // nobody is driving, so it floats to 0
     }
 
-    curIoAddr = -1;
+    clearIoSelection();
+
+    // per-slot counters no longer describe the same cards
+    system2200::resetIoProfile();
 }
 
 // ------------------------------------------------------------------------
@@ -376,7 +445,7 @@ system2200::initialize()
     for (auto &card : card_in_slot) {
         card = nullptr;
     }
-    curIoAddr = -1;
+    clearIoSelection();
 
     // CPU speed regulation
     first_slice = true;
@@ -384,6 +453,8 @@ system2200::initialize()
     sim_seconds = 0;
 
     realtime_start = 0;  // wall time of when sim started
+    realtime_last = 0;
+    scaled_realtime = 0;
     real_seconds  = 0;   // real time elapsed
 
     m_do_reconfig = false;
@@ -625,6 +696,13 @@ system2200::config() noexcept
 }
 
 
+Cpu2200*
+system2200::getCpu() noexcept
+{
+    return cpu.get();
+}
+
+
 // the user requests a change in configuration from the UiFrontPanel.
 // however, doing so often requires a tear down and rebuild of all the
 // components.  destroying the frontpanel instance and then returning
@@ -643,7 +721,7 @@ system2200::reconfigure() noexcept
 void
 system2200::reset(bool cold_reset)
 {
-    curIoAddr = -1;
+    clearIoSelection();
 
     // In terminal mode (2236WD), reset the terminal instead of CPU
     if (!cpu) {
@@ -666,6 +744,124 @@ system2200::reset(bool cold_reset)
 }
 
 
+// identifies a saved machine state, and its layout
+static const int64 STATE_MAGIC   = 0x32324D57;  // "WM22"
+static const int   STATE_VERSION = 1;
+
+// save the cpu, the bus selection, and each card, in slot order.  each
+// part is a section of its own, so a mismatch is caught where it happens.
+bool
+system2200::saveState(StateWriter &out)
+{
+    if (!cpu) {
+        return false;
+    }
+    for (auto const &kb : keyboard_routes) {
+        if (kb.script_handle) {
+            UI_warn("A keyboard script is running; can't save the system state");
+            return false;
+        }
+    }
+
+    out.put32(STATE_MAGIC);
+    out.put16(STATE_VERSION);
+    out.putBool(current_cfg->isCpuSpeedRegulated());
+    out.put8(current_cfg->getCpuSpeedMultiplier());
+    out.putBool(current_cfg->getDiskRealtime());
+
+    size_t section = out.beginSection();
+    if (!cpu->saveState(out)) {
+        UI_warn("The cpu can't save its state at the moment");
+        return false;
+    }
+    out.endSection(section);
+
+    out.put32(curIoAddr);
+    for (int slot=0; slot < NUM_IOSLOTS; slot++) {
+        int cardtype_idx = -1, io_addr = 0;
+        const bool occupied = getSlotInfo(slot, &cardtype_idx, &io_addr);
+        out.put32(occupied ? cardtype_idx : -1);
+        if (!occupied) {
+            continue;
+        }
+        out.put16(io_addr);
+        section = out.beginSection();
+        if (!card_in_slot[slot]->saveState(out)) {
+            UI_warn("The card in slot %d can't save its state at the moment", slot);
+            return false;
+        }
+        out.endSection(section);
+    }
+    return true;
+}
+
+
+bool
+system2200::restoreState(StateReader &in)
+{
+    if (!cpu) {
+        return false;
+    }
+    if ((in.get32() != STATE_MAGIC) || (in.get16() != STATE_VERSION)) {
+        UI_error("The saved state isn't from a compatible version of the emulator");
+        return false;
+    }
+
+    const bool regulated  = in.getBool();
+    const int  multiplier = in.get8();
+    const bool disk_realtime = in.getBool();
+
+    size_t end = in.beginSection();
+    if (!cpu->restoreState(in)) {
+        UI_error("The saved cpu state doesn't match the configured cpu");
+        return false;
+    }
+    in.endSection(end);
+
+    clearIoSelection();
+    const int io_addr = in.getInt();
+    for (int slot=0; slot < NUM_IOSLOTS; slot++) {
+        int cardtype_idx = -1, addr = 0;
+        const bool occupied = getSlotInfo(slot, &cardtype_idx, &addr);
+        const int saved_type = in.getInt();
+        if (saved_type != (occupied ? cardtype_idx : -1)) {
+            UI_error("Slot %d holds a different card than in the saved state", slot);
+            return false;
+        }
+        if (!occupied) {
+            continue;
+        }
+        if (in.get16() != addr) {
+            UI_error("The card in slot %d is at a different address than in the saved state", slot);
+            return false;
+        }
+        end = in.beginSection();
+        if (!card_in_slot[slot]->restoreState(in)) {
+            UI_error("The card in slot %d couldn't restore its state", slot);
+            return false;
+        }
+        in.endSection(end);
+    }
+    if (!in.ok() || (io_addr < -1) || (io_addr > 0xFF)) {
+        return false;
+    }
+
+    // the cards already know whether they are selected
+    if (io_addr >= 0) {
+        curIoAddr = io_addr;
+        cur_slot  = ioMap[curIoAddr].slot;
+        cur_card  = ((curIoAddr > 0) && (cur_slot >= 0))
+                  ? card_in_slot[cur_slot].get()
+                  : nullptr;
+    }
+
+    setDiskRealtime(disk_realtime);
+    setCpuSpeedMultiplier(multiplier);
+    regulateCpuSpeed(regulated);
+    return true;
+}
+
+
 // turn cpu speed regulation on (true) or off (false)
 void
 system2200::regulateCpuSpeed(bool regulated) noexcept
@@ -686,6 +882,25 @@ system2200::isCpuSpeedRegulated() noexcept
 }
 
 
+// set how many times faster than real hardware regulated speed runs
+void
+system2200::setCpuSpeedMultiplier(int multiplier) noexcept
+{
+    current_cfg->setCpuSpeedMultiplier(multiplier);
+
+    // reset the performance monitor history
+    perf_hist_len = 0;
+    perf_hist_ptr = 0;
+}
+
+
+int
+system2200::getCpuSpeedMultiplier() noexcept
+{
+    return current_cfg->getCpuSpeedMultiplier();
+}
+
+
 void
 system2200::setDiskRealtime(bool realtime) noexcept
 {
@@ -701,6 +916,21 @@ system2200::isDiskRealtime() noexcept
 }
 
 
+void
+system2200::setFastBoot(bool fast) noexcept
+{
+    current_cfg->setFastBoot(fast);
+}
+
+
+// indicate if the VP boot RAM test is charged nominal time
+bool
+system2200::isFastBoot() noexcept
+{
+    return current_cfg->getFastBoot();
+}
+
+
 // halt emulation
 void
 system2200::freezeEmu(bool freeze) noexcept
@@ -854,28 +1084,34 @@ system2200::emulateTimeslice(int ts_ms)
     if (first_slice) {
         first_slice = false;
         realtime_start = now_ms;
+        realtime_last = now_ms;
     }
     const int64 realtime_elapsed = now_ms - realtime_start;
-    int64 offset = adjust_sim_time - realtime_elapsed;
+    const int multiplier = current_cfg->getCpuSpeedMultiplier();
+    scaled_realtime += multiplier * static_cast<int64>(now_ms - realtime_last);
+    realtime_last = now_ms;
+    int64 offset = adjust_sim_time - scaled_realtime;
 
     if (offset > adj_window) {
         // we're way ahead (probably because we are running unregulated)
-        adjust_sim_time = realtime_elapsed + adj_window;
+        adjust_sim_time = scaled_realtime + adj_window;
         offset = adj_window;
     } else if (offset < -adj_window) {
         // we've fallen way behind; catch up so we don't
         // run like mad after any substantial pause
-        adjust_sim_time = realtime_elapsed - adj_window;
+        adjust_sim_time = scaled_realtime - adj_window;
         offset = -adj_window;
     }
 
     if ((offset > 0) && isCpuSpeedRegulated()) {
 
         // we are running ahead of schedule; use absolute deadline sleep.
-        // Convert offset to absolute deadline to prevent multiple relative sleeps
+        // Convert offset to absolute deadline to prevent multiple relative sleeps.
+        // the offset is in simulated time, which passes faster than wall time
+        // by the multiplier.
         using clock = std::chrono::steady_clock;
         const unsigned int ioffset = static_cast<unsigned int>(offset & 0xFFFLL);  // bottom 4 sec or so
-        auto deadline = clock::now() + std::chrono::milliseconds(ioffset/2);
+        auto deadline = clock::now() + std::chrono::microseconds(500*ioffset/multiplier);
         std::this_thread::sleep_until(deadline);
 
     } else {
@@ -891,6 +1127,7 @@ system2200::emulateTimeslice(int ts_ms)
 
         // simulate one timeslice's worth of instructions
         int slice_ns = ts_ms*1000000;
+        ActivityScope activity(ACTIVITY_CPU);
         if (num_devices == 1) {
 
             auto cb = m_clocked_devices[0].callback_fn;
@@ -930,6 +1167,7 @@ system2200::emulateTimeslice(int ts_ms)
                if (run_vp) {
                    // the 2200vp executes about six instructions in the time
                    // the 8080 does one typical instruction
+                   host_activity.store(ACTIVITY_CPU, std::memory_order_relaxed);
                    auto cb = m_clocked_devices[0].callback_fn;
                    op_ns_signed  = cb();
                    op_ns_signed += cb();
@@ -940,13 +1178,15 @@ system2200::emulateTimeslice(int ts_ms)
                    op_ns = static_cast<uint32>(op_ns_signed);
                    m_clocked_devices[0].ns += op_ns;
                } else {
+                   host_activity.store(ACTIVITY_MXD, std::memory_order_relaxed);
                    auto cb = m_clocked_devices[1].callback_fn;
                    op_ns_signed = cb();
                    op_ns = static_cast<uint32>(op_ns_signed);
                    m_clocked_devices[1].ns += op_ns;
                }
 
-               if (op_ns > 50000) {
+               // six calls, each allowed the 10 us of the one device case
+               if (op_ns > 6*10000) {
                    // something went wrong; finish the timeslice
                    slice_ns = 0;
                } else {
@@ -998,6 +1238,9 @@ system2200::emulateTimeslice(int ts_ms)
             // kept in sorted order of increasing time. we call entry 0, adjust
             // its time, then move it to the right place in the list.
             while (slice_ns > 0) {
+                // the cpu registers its clock before any card does
+                host_activity.store((order[0] == 0) ? ACTIVITY_CPU : ACTIVITY_MXD,
+                                    std::memory_order_relaxed);
                 auto cb = m_clocked_devices[order[0]].callback_fn;
                 const int op_ns_signed = cb();
                 const uint32 op_ns = static_cast<uint32>(op_ns_signed);
@@ -1034,7 +1277,7 @@ system2200::emulateTimeslice(int ts_ms)
         sim_time_ns     += ts_ms;
         adjust_sim_time += ts_ms;
 
-        if (cpu->status() != Cpu2200::CPU_RUNNING) {
+        if (cpu->status() == Cpu2200::CPU_HALTED) {
             UI_warn("CPU halted -- must reset");
             cpu->reset(true);  // hard reset
             return;
@@ -1098,16 +1341,31 @@ system2200::emulateTimeslice(int ts_ms)
 void
 system2200::dispatchAbsStrobe(uint8 byte)
 {
+    verifyIoSelection();
+
     // done if reselecting same device
     if (byte == curIoAddr) {
+        if (ioprof_enabled) {
+            ioprof_by_addr[byte].reselects++;
+        }
         return;
     }
 
     // deselect old card
-    if ((curIoAddr > 0) && (ioMap[curIoAddr].slot >= 0)) {
-        (card_in_slot[ioMap[curIoAddr].slot])->deselect();
+    if (cur_card) {
+        if (ioprof_enabled) {
+            const int64 t0 = ioprofNow();
+            cur_card->deselect();
+            ioprofCharge(curIoAddr, cur_slot, IOPROF_DESELECT, ioprofNow() - t0);
+        } else {
+            cur_card->deselect();
+        }
     }
     curIoAddr = byte;
+    cur_slot  = ioMap[curIoAddr].slot;
+    cur_card  = ((curIoAddr > 0) && (cur_slot >= 0))
+              ? card_in_slot[cur_slot].get()
+              : nullptr;
 
     const int cpu_type = cpu->getCpuType();
     const bool vp_mode = (cpu_type != Cpu2200::CPUTYPE_2200B)
@@ -1123,13 +1381,24 @@ system2200::dispatchAbsStrobe(uint8 byte)
     // nobody is driving, so it defaults to 0
     cpu->setDevRdy(false);
 
-    // let the selected card know it has been chosen
-    if (ioMap[curIoAddr].slot >= 0) {
-        const int slot = ioMap[curIoAddr].slot;
-        card_in_slot[slot]->select();
+    // let the selected card know it has been chosen.
+    // a card at address 00 is selected, but isn't cached as cur_card.
+    if (cur_slot >= 0) {
+        IoCard *card = card_in_slot[cur_slot].get();
+        if (ioprof_enabled) {
+            const int64 t0 = ioprofNow();
+            card->select();
+            ioprofCharge(curIoAddr, cur_slot, IOPROF_ABS, ioprofNow() - t0);
+        } else {
+            card->select();
+        }
         return;
     }
 
+    if (ioprof_enabled) {
+        ioprofCharge(curIoAddr, -1, IOPROF_ABS, 0);
+    }
+
     // MVP OS probes addr 80 to test for the bank select register (BSR).
     // for non-VSLI CPUs, it would be annoying to get warned about it.
     if (vp_mode && (curIoAddr == 0x80)) {
@@ -1169,10 +1438,17 @@ system2200::dispatchObsStrobe(uint8 byte)
 // allowing the CPU to do another I/O operation.  Normally, the device
 // being used will generate a Busy indicator after the I/O Bus (!OB1 - !OB8)
 // has been strobed by !OBS, the CPU output strobe.
-    if (curIoAddr > 0) {
-        if (ioMap[curIoAddr].slot >= 0) {
-            card_in_slot[ioMap[curIoAddr].slot]->strobeOBS(byte);
+    verifyIoSelection();
+    if (ioprof_enabled) {
+        if (curIoAddr > 0) {
+            const int64 t0 = ioprofNow();
+            if (cur_card) {
+                cur_card->strobeOBS(byte);
+            }
+            ioprofCharge(curIoAddr, cur_slot, IOPROF_OBS, ioprofNow() - t0);
         }
+    } else if (cur_card) {
+        cur_card->strobeOBS(byte);
     }
 }
 
@@ -1186,8 +1462,17 @@ system2200::dispatchCbsStrobe(uint8 byte)
     //   * some use it like another OBS strobe to capture some type
     //     of command word
     //   * some cards use it to trigger an IBS strobe
-    if ((curIoAddr > 0) && (ioMap[curIoAddr].slot >= 0)) {
-        card_in_slot[ioMap[curIoAddr].slot]->strobeCBS(byte);
+    verifyIoSelection();
+    if (ioprof_enabled) {
+        if (curIoAddr > 0) {
+            const int64 t0 = ioprofNow();
+            if (cur_card) {
+                cur_card->strobeCBS(byte);
+            }
+            ioprofCharge(curIoAddr, cur_slot, IOPROF_CBS, ioprofNow() - t0);
+        }
+    } else if (cur_card) {
+        cur_card->strobeCBS(byte);
     }
 }
 
@@ -1196,9 +1481,16 @@ system2200::dispatchCbsStrobe(uint8 byte)
 void
 system2200::dispatchCpuBusy(bool busy)
 {
-    if ((curIoAddr > 0) && (ioMap[curIoAddr].slot >= 0)) {
+    verifyIoSelection();
+    if (cur_card) {
         // signal that we want to get something
-        card_in_slot[ioMap[curIoAddr].slot]->setCpuBusy(busy);
+        if (ioprof_enabled) {
+            const int64 t0 = ioprofNow();
+            cur_card->setCpuBusy(busy);
+            ioprofCharge(curIoAddr, cur_slot, IOPROF_CPB, ioprofNow() - t0);
+        } else {
+            cur_card->setCpuBusy(busy);
+        }
     }
 }
 
@@ -1207,14 +1499,97 @@ system2200::dispatchCpuBusy(bool busy)
 int
 system2200::cpuPollIB()
 {
-    if  ((curIoAddr > 0) && (ioMap[curIoAddr].slot >= 0)) {
-        // signal that we want to get something
-        return card_in_slot[ioMap[curIoAddr].slot]->getIB();
+    verifyIoSelection();
+    if (cur_card) {
+        if (ioprof_enabled) {
+            const int64 t0 = ioprofNow();
+            const int ib = cur_card->getIB();
+            ioprofCharge(curIoAddr, cur_slot, IOPROF_IB, ioprofNow() - t0);
+            return ib;
+        }
+        return cur_card->getIB();
     }
     return 0;
 }
 
 
+// ========================================================================
+// I/O bus profiler
+// ========================================================================
+
+// turn on/off accounting in the dispatch functions.  the counters are
+// not cleared, so profiling can be paused and resumed.
+void
+system2200::enableIoProfile(bool enable) noexcept
+{
+    ioprof_enabled = enable;
+}
+
+
+bool
+system2200::isIoProfileEnabled() noexcept
+{
+    return ioprof_enabled;
+}
+
+
+void
+system2200::resetIoProfile() noexcept
+{
+    for (auto &entry : ioprof_by_addr) {
+        entry = {};
+    }
+    for (auto &entry : ioprof_by_slot) {
+        entry = {};
+    }
+}
+
+
+const system2200::ioprof_t&
+system2200::getIoProfileByAddr(int io_addr) noexcept
+{
+    assert(0 <= io_addr && io_addr <= 255);
+    return ioprof_by_addr[io_addr];
+}
+
+
+const system2200::ioprof_t&
+system2200::getIoProfileBySlot(int slot) noexcept
+{
+    assert(0 <= slot && slot < NUM_IOSLOTS);
+    return ioprof_by_slot[slot];
+}
+
+
+const char*
+system2200::ioProfileEventName(int event) noexcept
+{
+    switch (event) {
+        case IOPROF_ABS:      return "abs";
+        case IOPROF_DESELECT: return "deselect";
+        case IOPROF_OBS:      return "obs";
+        case IOPROF_CBS:      return "cbs";
+        case IOPROF_CPB:      return "cpb";
+        case IOPROF_IB:       return "ib";
+        default:              return "?";
+    }
+}
+
+
+const char*
+system2200::hostActivityName(int act) noexcept
+{
+    switch (act) {
+        case ACTIVITY_OTHER:  return "other";
+        case ACTIVITY_CPU:    return "cpu";
+        case ACTIVITY_MXD:    return "mxd_8080";
+        case ACTIVITY_TIMERS: return "timers";
+        case ACTIVITY_DISK:   return "disk_io";
+        default:              return "?";
+    }
+}
+
+
 // ========================================================================
 // keyboard input routing
 // ========================================================================
@@ -19,7 +19,12 @@
 
 #include "w2200.h"
 
+#include <atomic>
+
+class Cpu2200;
 class IoCard;
+class StateReader;
+class StateWriter;
 class SysCfgState;
 
 using clkCallback = std::function<int()>;
@@ -45,6 +50,7 @@ namespace system2200
 
     // give access to components
     const SysCfgState& config() noexcept;
+    Cpu2200* getCpu() noexcept;     // nullptr in terminal mode
 
     // indicate that user wants to reconfigure the system
     void reconfigure() noexcept;
@@ -52,14 +58,30 @@ namespace system2200
     // reset the whole system
     void reset(bool cold_reset);
 
+    // save the running state of the whole machine, or restore it into a
+    // freshly initialized one with the same configuration, so another
+    // copy of the emulator can carry on from the same point.  either
+    // returns false if some part can't be handed over at the moment, or
+    // the saved state doesn't fit the configuration.
+    bool saveState(StateWriter &out);
+    bool restoreState(StateReader &in);
+
     // change/query the simulation speed
     void regulateCpuSpeed(bool regulated) noexcept;
     bool isCpuSpeedRegulated() noexcept;
 
+    // when regulated, run N times faster than the real hardware
+    void setCpuSpeedMultiplier(int multiplier) noexcept;
+    int  getCpuSpeedMultiplier() noexcept;
+
     // change/query the simulation speed
     void setDiskRealtime(bool realtime) noexcept;
     bool isDiskRealtime() noexcept;
 
+    // charge the VP boot RAM test a nominal time per pass, or the real time
+    void setFastBoot(bool fast) noexcept;
+    bool isFastBoot() noexcept;
+
     // temporarily halt emulation
     void freezeEmu(bool freeze) noexcept;
 
@@ -78,6 +100,78 @@ namespace system2200
     void dispatchCpuBusy(bool busy);     // notify selected card when CPB changes
     int  cpuPollIB();                    // the CPU can poll IB without any other strobe
 
+    // ---- I/O bus profiler ----
+
+    // when enabled, the dispatch functions above count bus events per
+    // i/o address and per slot, and time how long the host spends inside
+    // the owning card's handler for each event.
+    enum ioprof_event_t {
+        IOPROF_ABS,         // address strobe which selected a card
+        IOPROF_DESELECT,    // card deselected by a following ABS
+        IOPROF_OBS,         // output byte strobe
+        IOPROF_CBS,         // control byte strobe
+        IOPROF_CPB,         // CPU busy change
+        IOPROF_IB,          // IB poll
+        IOPROF_NUM_EVENTS
+    };
+
+    struct ioprof_t {
+        uint64 count[IOPROF_NUM_EVENTS];    // number of events
+        uint64 host_ns[IOPROF_NUM_EVENTS];  // host time spent in card handler
+        uint64 reselects;                   // ABS to the already selected address
+    };
+
+    void enableIoProfile(bool enable) noexcept;
+    bool isIoProfileEnabled() noexcept;
+    void resetIoProfile() noexcept;
+
+    // accumulated counters for one i/o address (0x00-0xFF) or one slot
+    const ioprof_t& getIoProfileByAddr(int io_addr) noexcept;
+    const ioprof_t& getIoProfileBySlot(int slot) noexcept;
+
+    // short human-readable name for an event type, eg "obs"
+    const char* ioProfileEventName(int event) noexcept;
+
+    // ---- host cpu accounting ----
+
+    // what the emulation thread is busy with.  it is stored at coarse
+    // boundaries (a batch of cpu ops, a round of timer callbacks, a disk
+    // sector transfer) so that a sampling profiler can split the host cpu
+    // time of the thread without timing anything itself.
+    enum host_activity_t {
+        ACTIVITY_OTHER,     // main loop, terminal i/o, anything not below
+        ACTIVITY_CPU,       // executing 2200 cpu microcode
+        ACTIVITY_MXD,       // executing the 8080 of a terminal mux
+        ACTIVITY_TIMERS,    // scheduler timer callbacks
+        ACTIVITY_DISK,      // disk image file transfers
+        ACTIVITY_NUM
+    };
+
+    // written by the emulation thread, read from a signal handler
+    extern std::atomic<int> host_activity;
+
+    // set host_activity for the life of the object, then put back
+    // whatever it was before
+    class ActivityScope
+    {
+    public:
+        explicit ActivityScope(host_activity_t act) noexcept :
+            m_prev(host_activity.load(std::memory_order_relaxed))
+        {
+            host_activity.store(act, std::memory_order_relaxed);
+        }
+        ~ActivityScope()
+        {
+            host_activity.store(m_prev, std::memory_order_relaxed);
+        }
+        CANT_ASSIGN_OR_COPY_CLASS(ActivityScope);
+    private:
+        const int m_prev;
+    };
+
+    // short human-readable name for an activity, eg "timers"
+    const char* hostActivityName(int act) noexcept;
+
     // ---- keyboard input routing ----
 
     // register a handler for a key event to a given keyboard terminal
@@ -13,6 +13,7 @@
 #include "../widgets/UiCrtStatusBar.h"
 #include "../widgets/UiDiskFactory.h"
 #include "UiPrinterFrame.h"
+#include "../system/UiFrameClock.h"
 #include "../system/UiSystem.h"
 #include "../../platform/common/host.h"
 #include "../../core/system/system2200.h"
@@ -82,9 +83,6 @@ enum
     TB_SF8,  TB_SF9,  TB_SF10, TB_SF11,
     TB_SF12, TB_SF13, TB_SF14, TB_SF15,
     TB_EDIT,
-
-    Timer_Frame,
-    Timer_QSec,
 };
 
 
@@ -201,14 +199,11 @@ CrtFrame::CrtFrame(const wxString& title,
     // track screen refresh rate, for kicks
     m_fps = 0;
 
-    // only the primary has a status bar
-    m_refresh_tmr     = std::make_unique<wxTimer>(this, Timer_Frame);
-    m_quarter_sec_tmr = std::make_unique<wxTimer>(this, Timer_QSec);
-
-    // it is hard to predict what the optimal refresh period
-    // for a given system
-    m_refresh_tmr->Start(30, wxTIMER_CONTINUOUS);       // ~30 fps
-    m_quarter_sec_tmr->Start(250, wxTIMER_CONTINUOUS);  // 4 Hz
+    // refresh and blink are paced by the clock shared by all windows.
+    // when the emulation is reconfigured, the new window is constructed
+    // before the old one is destroyed, so the clock never sees an empty
+    // list in between and keeps running.
+    FrameClock::addCrt(this);
 
     // event routing table
     Bind(wxEVT_MENU, &CrtFrame::OnScript,   this, File_Script);
@@ -251,8 +246,15 @@ CrtFrame::CrtFrame(const wxString& title,
     // non-menu event handlers
     Bind(wxEVT_MENU_OPEN,    &CrtFrame::OnMenuOpen, this);
     Bind(wxEVT_CLOSE_WINDOW, &CrtFrame::OnClose,    this);
-    Bind(wxEVT_TIMER,        &CrtFrame::OnTimer,    this, Timer_Frame);
-    Bind(wxEVT_TIMER,        &CrtFrame::OnTimer,    this, Timer_QSec);
+    Bind(wxEVT_SHOW,         &CrtFrame::OnShow,     this);
+    Bind(wxEVT_ICONIZE,      &CrtFrame::OnIconize,  this);
+}
+
+
+// destructor
+CrtFrame::~CrtFrame()
+{
+    FrameClock::removeCrt(this);
 }
 
 
@@ -935,7 +937,7 @@ CrtFrame::setSimSeconds(int secs, float relative_speed)
 bool
 CrtFrame::getTextBlinkPhase() const noexcept
 {
-    return (m_blink_phase & 1) == 1;
+    return (FrameClock::getBlinkPhase() & 1) == 1;
 }
 
 
@@ -944,7 +946,7 @@ CrtFrame::getCursorBlinkPhase() const noexcept
 {
     // I believe the 2236 had a 50% duty cycle,
     // but the 2336 definitely has a 75% duty cycle
-    return (m_blink_phase < 3);
+    return (FrameClock::getBlinkPhase() < 3);
 }
 
 
@@ -1207,24 +1209,41 @@ CrtFrame::OnClose(wxCloseEvent& WXUNUSED(event))
 }
 
 
-// update all displays
+// update the display, if needed
 void
-CrtFrame::OnTimer(wxTimerEvent &event)
+CrtFrame::clockTick(bool blink_tick, bool new_second)
 {
-    if (event.GetId() == Timer_Frame) {
-        m_crt->refreshWindow(); // ask screen to update
-    } else if (event.GetId() == Timer_QSec) {
+    if (new_second) {
         // count frames each second to display FPS figure
-        m_blink_phase = (m_blink_phase == 3) ? 0 : (m_blink_phase+1);
-        if (m_blink_phase == 0) {
-            m_fps = m_crt->getFrameCount();
-            m_crt->setFrameCount(0);
-        }
+        m_fps = m_crt->getFrameCount();
+        m_crt->setFrameCount(0);
+    }
+    if (blink_tick) {
         // there might be blinking text or blinking cursor
         m_crt->setDirty();
     }
+    m_crt->refreshWindow(); // ask screen to update
+    m_statusbar->refreshDiskIcons();
 }
 
+
+// the clock stops when no window is visible; let it know to check again
+void
+CrtFrame::OnShow(wxShowEvent &event)
+{
+    FrameClock::visibilityChanged();
+    event.Skip();
+}
+
+
+void
+CrtFrame::OnIconize(wxIconizeEvent &event)
+{
+    FrameClock::visibilityChanged();
+    event.Skip();
+}
+
+
 void
 CrtFrame::OnConfigureDialog(wxCommandEvent& WXUNUSED(event)) noexcept
 {
@@ -1573,20 +1592,4 @@ CrtFrame::refreshWindow()
     m_crt->refreshWindow();
 }
 
-
-// ----------------------------------------------------------------------------
-//   when various disk state changes occur, pass them on to the
-//   status bar of each Crt window.
-// ----------------------------------------------------------------------------
-
-// called when something changes about the specified disk
-void
-CrtFrame::diskEvent(int slot, int drive)
-{
-    CrtFrame *pf = getPrimaryFrame();
-    if (pf != nullptr) {
-        pf->m_statusbar->diskEvent(slot, drive);
-    }
-}
-
 // vim: ts=8:et:sw=4:smarttab
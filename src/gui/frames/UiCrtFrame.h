@@ -23,6 +23,9 @@ public:
              int term_num,     // 0 if dumb, 1-4 if term mux
              crt_state_t *crt_state);
 
+    // destructor
+    ~CrtFrame() override;
+
     // make CRT the focus of further keyboard events
     void refocus();
 
@@ -39,9 +42,6 @@ public:
     // request the CRT to be destroyed
     void destroyWindow();
 
-    // something changed about the indicated drive -- refresh display
-    static void diskEvent(int slot, int drive);
-
     // set simulation time for informative display
     static void setSimSeconds(int secs, float relative_speed);
 
@@ -72,6 +72,11 @@ public:
     bool getTextBlinkPhase() const noexcept;
     bool getCursorBlinkPhase() const noexcept;
 
+    // called by the FrameClock on each frame while the window is visible.
+    // blink_tick is set when the blink phase has changed, and new_second
+    // once per second, for the frames/sec calculation.
+    void clockTick(bool blink_tick, bool new_second);
+
     // mechanics of carrying out format for a given filename
     // must be public so statusbar can use it
     void doFormat(const std::string &filename);
@@ -139,8 +144,9 @@ private:
     // called when the window is manually closed ("X" button, or sys menu)
     void OnClose(wxCloseEvent& WXUNUSED(event));
 
-    // handle timed display refresh
-    void OnTimer(wxTimerEvent &event);
+    // window was shown/hidden or minimized/restored
+    void OnShow(wxShowEvent &event);
+    void OnIconize(wxIconizeEvent &event);
 
     // ---- utility functions ----
 
@@ -191,15 +197,7 @@ private:
     // holds the icons for the toolbar buttons
     wxBitmap m_sf_key_icons[17];
 
-    // triggers display refresh for all windows
-    // once upon a time these were static timers, but when the emulation
-    // would get reconfigured, the even system would end up constructing
-    // the new window before the old one was destroyed.  as a result, the
-    // destructor would stop the (static) timer that the new window had
-    // just initiated.
-    std::unique_ptr<wxTimer> m_refresh_tmr;     // triggers to cause a screen update
-    std::unique_ptr<wxTimer> m_quarter_sec_tmr; // 4 Hz event for blink & frames/sec calc
-    int      m_blink_phase = 0;
+    // display refresh and blinking are driven by the shared FrameClock
     int      m_fps         = 0;     // most recent frames/sec count
 
     // the one privileged CRT (/005 display, or term 1 of MXD at 0x00)
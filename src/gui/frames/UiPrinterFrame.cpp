@@ -53,6 +53,7 @@
 #include "../widgets/UiPrinter.h"
 #include "../dialogs/UiPrinterConfigDlg.h"
 #include "UiPrinterFrame.h"
+#include "../system/UiFrameClock.h"
 #include "../system/UiSystem.h"           // sharing info between UI_wxgui modules
 #include "../../platform/common/host.h"
 #include "../../core/system/system2200.h"
@@ -183,12 +184,18 @@ PrinterFrame::PrinterFrame(const wxString& title, const int io_addr) :
     Bind(wxEVT_MENU,         &PrinterFrame::OnConfigureDialog, this, Configure_Dialog);
     Bind(wxEVT_MENU_OPEN,    &PrinterFrame::OnMenuOpen,        this);
     Bind(wxEVT_CLOSE_WINDOW, &PrinterFrame::OnClose,           this);
+    Bind(wxEVT_SHOW,         &PrinterFrame::OnShow,            this);
+    Bind(wxEVT_ICONIZE,      &PrinterFrame::OnIconize,         this);
+
+    // new output is drawn at the pace of the shared frame clock
+    FrameClock::addPrinter(this);
 }
 
 
 // destructor
 PrinterFrame::~PrinterFrame()
 {
+    FrameClock::removePrinter(this);
     if (m_printer->getPrintasgo()) {
         printAndClear();        // print anything left in the printer
     }
@@ -799,6 +806,31 @@ PrinterFrame::destroyWindow()
 }
 
 
+// bring the view up to date with any newly printed lines
+void
+PrinterFrame::clockTick()
+{
+    m_printer->refreshView();
+}
+
+
+// the clock stops when no window is visible; let it know to check again
+void
+PrinterFrame::OnShow(wxShowEvent &event)
+{
+    FrameClock::visibilityChanged();
+    event.Skip();
+}
+
+
+void
+PrinterFrame::OnIconize(wxIconizeEvent &event)
+{
+    FrameClock::visibilityChanged();
+    event.Skip();
+}
+
+
 // print the contents of the stream, then clear it (if successful)
 void
 PrinterFrame::printAndClear()
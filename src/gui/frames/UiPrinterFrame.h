@@ -46,6 +46,9 @@ public:
     // print the entire contents of the print stream, then clear it
     void printAndClear();
 
+    // called by the FrameClock on each frame while the window is visible
+    void clockTick();
+
 private:
     // ---- event handlers ----
 
@@ -83,6 +86,10 @@ private:
     // called when the window is manually closed ("X" button, or sys menu)
     void OnClose(wxCloseEvent& WXUNUSED(event));
 
+    // window was shown/hidden or minimized/restored
+    void OnShow(wxShowEvent &event);
+    void OnIconize(wxIconizeEvent &event);
+
     // used to override the preview window's OnClose event
     void PP_OnClose(wxCloseEvent &event);
 
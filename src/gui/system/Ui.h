@@ -38,9 +38,6 @@ void UI_displayDing(CrtFrame *wnd);
 // inform the UI how far along the simulation is in emulated time
 void UI_setSimSeconds(unsigned long seconds, float relative_speed);
 
-// the state of the specified disk drive has changed
-void UI_diskEvent(int slot, int drive);
-
 // ---- printer interface ----
 
 // printer view
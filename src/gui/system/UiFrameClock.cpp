@@ -0,0 +1,164 @@
+// Shared refresh clock for all CRT and printer windows.
+// See UiFrameClock.h for the overview.
+
+#include "UiFrameClock.h"
+#include "../frames/UiCrtFrame.h"
+#include "../frames/UiPrinterFrame.h"
+#include "../../platform/common/host.h"
+
+#include <algorithm>
+
+std::unique_ptr<FrameClock> FrameClock::m_clock = nullptr;
+int FrameClock::m_fps         = 30;
+int FrameClock::m_blink_phase = 0;
+
+static constexpr int MIN_FPS  =   5;
+static constexpr int MAX_FPS  =  60;
+static constexpr int BLINK_MS = 250;    // 4 Hz blink phase
+
+
+FrameClock::FrameClock() :
+    m_timer(this),
+    m_blink_time(wxGetLocalTimeMillis())
+{
+    // ini file lets the user trade smoothness against idle CPU load
+    int fps = 30;
+    host::configReadInt("ui/frameclock", "fps", &fps, 30);
+    m_fps = std::max(MIN_FPS, std::min(fps, MAX_FPS));
+
+    Bind(wxEVT_TIMER, &FrameClock::OnTimer, this);
+}
+
+
+FrameClock::~FrameClock()
+{
+    m_timer.Stop();
+}
+
+
+void
+FrameClock::addCrt(CrtFrame *frame)
+{
+    if (!m_clock) {
+        m_clock.reset(new FrameClock());
+    }
+    m_clock->m_crts.push_back(frame);
+    m_clock->start();
+}
+
+
+void
+FrameClock::removeCrt(CrtFrame *frame)
+{
+    if (!m_clock) {
+        return;
+    }
+    auto &v = m_clock->m_crts;
+    v.erase(std::remove(v.begin(), v.end(), frame), v.end());
+    if (m_clock->m_crts.empty() && m_clock->m_printers.empty()) {
+        m_clock = nullptr;
+    }
+}
+
+
+void
+FrameClock::addPrinter(PrinterFrame *frame)
+{
+    if (!m_clock) {
+        m_clock.reset(new FrameClock());
+    }
+    m_clock->m_printers.push_back(frame);
+    m_clock->start();
+}
+
+
+void
+FrameClock::removePrinter(PrinterFrame *frame)
+{
+    if (!m_clock) {
+        return;
+    }
+    auto &v = m_clock->m_printers;
+    v.erase(std::remove(v.begin(), v.end(), frame), v.end());
+    if (m_clock->m_crts.empty() && m_clock->m_printers.empty()) {
+        m_clock = nullptr;
+    }
+}
+
+
+// the visibility test is done on each tick; all that is needed here is
+// to wake the clock up if it had gone to sleep
+void
+FrameClock::visibilityChanged()
+{
+    if (m_clock && !m_clock->m_timer.IsRunning()) {
+        m_clock->start();
+    }
+}
+
+
+int
+FrameClock::getBlinkPhase() noexcept
+{
+    return m_blink_phase;
+}
+
+
+void
+FrameClock::start()
+{
+    m_timer.Start(1000 / m_fps, wxTIMER_CONTINUOUS);
+}
+
+
+bool
+FrameClock::anyVisible() const
+{
+    for (auto *crt : m_crts) {
+        if (crt->IsShown() && !crt->IsIconized()) {
+            return true;
+        }
+    }
+    for (auto *prt : m_printers) {
+        if (prt->IsShown() && !prt->IsIconized()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+void
+FrameClock::OnTimer(wxTimerEvent& WXUNUSED(event))
+{
+    if (!anyVisible()) {
+        // nothing to draw; sleep until a window is shown or restored
+        m_timer.Stop();
+        return;
+    }
+
+    // advance the blink phase based on elapsed time, not tick count,
+    // so the blink rate doesn't depend on the frame rate
+    bool blink_tick = false;
+    bool new_second = false;
+    const wxLongLong now = wxGetLocalTimeMillis();
+    if (now - m_blink_time >= BLINK_MS) {
+        m_blink_time = now;
+        m_blink_phase = (m_blink_phase == 3) ? 0 : (m_blink_phase+1);
+        blink_tick = true;
+        new_second = (m_blink_phase == 0);
+    }
+
+    for (auto *crt : m_crts) {
+        if (crt->IsShown() && !crt->IsIconized()) {
+            crt->clockTick(blink_tick, new_second);
+        }
+    }
+    for (auto *prt : m_printers) {
+        if (prt->IsShown() && !prt->IsIconized()) {
+            prt->clockTick();
+        }
+    }
+}
+
+// vim: ts=8:et:sw=4:smarttab
@@ -0,0 +1,63 @@
+// FrameClock is the one timer which drives screen refresh for every CRT and
+// printer window.  Windows register when they are built and unregister when
+// they are destroyed.  On each tick the clock asks the visible windows to
+// repaint whatever has changed, and every 250 ms it advances the blink phase
+// shared by all CRTs, so terminals blink in step.
+//
+// When no registered window is visible (all hidden or minimized) the timer
+// is stopped outright, and restarted when one of them comes back.
+
+#ifndef _INCLUDE_UI_FRAME_CLOCK_H_
+#define _INCLUDE_UI_FRAME_CLOCK_H_
+
+#include "../../core/system/w2200.h"
+#include "wx/wx.h"
+
+class CrtFrame;
+class PrinterFrame;
+
+class FrameClock : public wxEvtHandler
+{
+public:
+    CANT_ASSIGN_OR_COPY_CLASS(FrameClock);
+    ~FrameClock() override;
+
+    // add/remove a window from the refresh list.  the clock is created
+    // along with the first window and destroyed along with the last.
+    static void addCrt(CrtFrame *frame);
+    static void removeCrt(CrtFrame *frame);
+    static void addPrinter(PrinterFrame *frame);
+    static void removePrinter(PrinterFrame *frame);
+
+    // a registered window was shown, hidden, minimized, or restored
+    static void visibilityChanged();
+
+    // 0..3, advancing at 4 Hz
+    static int getBlinkPhase() noexcept;
+
+private:
+    FrameClock();
+
+    // called on each frame tick
+    void OnTimer(wxTimerEvent &event);
+
+    // (re)start the timer at the current frame rate
+    void start();
+
+    // true if any registered window can be seen
+    bool anyVisible() const;
+
+    std::vector<CrtFrame*>     m_crts;
+    std::vector<PrinterFrame*> m_printers;
+
+    wxTimer    m_timer;
+    wxLongLong m_blink_time;    // time of the last blink phase change
+
+    static std::unique_ptr<FrameClock> m_clock;
+    static int m_fps;           // refresh rate, from ui/frameclock/fps in the ini
+    static int m_blink_phase;
+};
+
+#endif // _INCLUDE_UI_FRAME_CLOCK_H_
+
+// vim: ts=8:et:sw=4:smarttab
@@ -428,13 +428,6 @@ UI_setSimSeconds(unsigned long seconds, float relative_speed)
 }
 
 
-void
-UI_diskEvent(int slot, int drive)
-{
-    CrtFrame::diskEvent(slot, drive);
-}
-
-
 // ---- printer wrappers ----
 
 // called at the start of time to create the actual display
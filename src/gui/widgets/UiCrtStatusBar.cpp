@@ -237,7 +237,7 @@ CrtStatusBar::SetDiskIcon(const int slot, const int drive)
     assert(ok);
 
     // figure out if disk is empty, idle, or running
-    const int stat = IoCardDisk::wvdDriveStatus(slot, drive);
+    const int stat = IoCardDisk::wvdPublishedStatus(slot, drive);
     const bool empty    = (stat & IoCardDisk::WVD_STAT_DRIVE_OCCUPIED) == 0;  // disk is not present
 //  const bool running  = (stat & IoCardDisk::WVD_STAT_DRIVE_RUNNING)  != 0;  // motor is active
     const bool selected = (stat & IoCardDisk::WVD_STAT_DRIVE_SELECTED) != 0;  // unit is being addressed
@@ -526,11 +526,26 @@ CrtStatusBar::getKeywordMode() const
     return m_keyword_ctl->GetValue();
 }
 
-// when there is some significant event, this lets us know what changed
+// called on each frame tick.  the disk controllers only publish their
+// status; this picks it up at the display rate, and only does any work
+// when something changed since last time.
 void
-CrtStatusBar::diskEvent(int slot, int drive)
+CrtStatusBar::refreshDiskIcons()
 {
-    SetDiskIcon(slot, drive);
+    const uint32 seq = IoCardDisk::wvdStatusSeq();
+    if (seq == m_disk_status_seq) {
+        return;
+    }
+    m_disk_status_seq = seq;
+
+    for (int ctrl=0; ctrl < m_num_disk_controllers; ctrl++) {
+        int slot = 0;
+        const bool ok = system2200::findDiskController(ctrl, &slot);
+        assert(ok);
+        for (int drive=0; drive < m_num_drives[ctrl]; drive++) {
+            SetDiskIcon(slot, drive);
+        }
+    }
 }
 
 // vim: ts=8:et:sw=4:smarttab
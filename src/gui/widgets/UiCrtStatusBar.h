@@ -25,8 +25,8 @@ public:
     void setKeywordMode(bool state = true);
     bool getKeywordMode() const;
 
-    // something changed about the indicated drive -- refresh display
-    void diskEvent(int slot, int drive);
+    // redraw the drive icons if any drive status has changed
+    void refreshDiskIcons();
 
 private:
 
@@ -53,6 +53,7 @@ private:
 
     int  m_num_disk_controllers = 0;                // number of disk controllers
     int  m_num_drives[MAX_DISK_CONTROLLERS] = {0};  // drives per controller
+    uint32 m_disk_status_seq = 0;                   // IoCardDisk::wvdStatusSeq() shown
 
     enum { unknown, insert_disk, eject_disk, inspect_disk, format_disk }
           m_popup_action = unknown;
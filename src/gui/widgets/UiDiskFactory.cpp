@@ -12,6 +12,8 @@
 
 #include <wx/notebook.h>        // wxNotebook
 
+#include <vector>
+
 // define to 1 to have a static box drawn around the disk properties
 // define to 0 to have a heading line over the disk properties
 // no functional difference, just appearance tuning
@@ -30,37 +32,9 @@ enum
 };
 
 
-static constexpr struct disk_choice_t {
-    const char *description;
-    int         disk_type;
-    int         platters;
-    int         sectors_per_platter;
-} disk_choices[] = {
-                                                                            // tracks*sectors*sides
-    { "PCS 5.25\" floppy disk (88 KB)",        Wvd::DISKTYPE_FD5,      1,   35*10   },  // =   350
-    { "PCS 5.25\" DSDD floppy disk (320 KB)",  Wvd::DISKTYPE_FD5_DD,   1,   40*16*2 },  // =  1280
-    { "PCS 5.25\" DSHD floppy disk (1040 KB)", Wvd::DISKTYPE_FD5_HD,   1,   80*26*2 },  // =  4160
-
-    { "2270 8\" floppy disk (260 KB)",         Wvd::DISKTYPE_FD8,      1,   64*16   },  // =  1024
-    { "2270A 8\" floppy disk (308 KB)",        Wvd::DISKTYPE_FD8,      1,   77*16   },  // =  1232
-
-    { "2260 5 MB disk",                        Wvd::DISKTYPE_HD60,     1,  816*24   },  // = 19584
-    { "2260 8 MB disk",                        Wvd::DISKTYPE_HD60,     1,   32767   },  // damn -- partial track.  32760 would have been best
-
-    { "2280-1 13 MB * 1 platter disk",         Wvd::DISKTYPE_HD80,     1,  822*64   },  // = 52608
-    { "2280-3 13 MB * 3 platter disk",         Wvd::DISKTYPE_HD80,     3,  822*64   },  // = 52608
-    { "2280-5 13 MB * 5 platter disk",         Wvd::DISKTYPE_HD80,     5,  822*64   },  // = 52608
-
-// these are real products described in the document "CS-2200 Ramblings.pdf", page 21:
-//  { "DS-20 10 MB * 2 platter disk",   Wvd::DISKTYPE_HD80,  2,  640*64  },  // = 40960
-//  { "DS-32 16 MB * 2 platter disk",   Wvd::DISKTYPE_HD80,  2, 1023*64  },  // = 65472 (65536 is too big)
-//  { "DS-64 16 MB * 4 platter disk",   Wvd::DISKTYPE_HD80,  4, 1023*64  },  // = 65472
-    { "DS-112 16 MB * 7 platter disk",  Wvd::DISKTYPE_HD80,  7, 1023*64  },  // = 65472
-    { "DS-140 10 MB * 14 platter disk", Wvd::DISKTYPE_HD80, 14,  640*64  },  // = 40960
-// this is one I just made up -- it is the largest possible disk:
-    { "DS-224 16 MB * 14 platter disk", Wvd::DISKTYPE_HD80, 14, 1023*64  },  // = 65472
-};
-static const int num_disk_types = sizeof(disk_choices) / sizeof(disk_choice_t);
+// the geometries a new disk can have
+static const Wvd::geometry_t * const disk_choices = Wvd::geometries;
+static const int num_disk_types = Wvd::num_geometries;
 
 // ------------------------------------------------------------------------
 //  Tab 1 -- disk properties
@@ -356,7 +330,7 @@ PropPanel::PropPanel(DiskFactory *df,
     wxBoxSizer *boxh = new wxBoxSizer(wxHORIZONTAL);
 
     if (new_disk) {
-        wxString type_choices[num_disk_types];
+        std::vector<wxString> type_choices(num_disk_types);
         for (int i=0; i < num_disk_types; i++) {
             type_choices[i] = disk_choices[i].description;
         }
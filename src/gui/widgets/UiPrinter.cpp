@@ -439,6 +439,7 @@ Printer::printClear()
 {
     m_linebuf_len = 0;          // partially accumulated line
     m_printstream.clear();      // log of all complete lines
+    m_rows_shown = 0;
     scrollbarSet(0, 0, false);
     invalidateAll();
 }
@@ -787,7 +788,9 @@ Printer::emitLine()
         m_parent->Show(true);   // show the printer window if it is off (this should be a
     }
 
-    updateView();
+    // the view is brought up to date on the next frame clock tick,
+    // so a burst of output costs one redraw, not one per line
+    m_view_dirty = true;
 
     if (m_print_as_go) {
         if ((m_printstream.size() % m_page_length) == 0) {
@@ -809,7 +812,6 @@ Printer::formFeed()
         // if necessary
         emitLine();
     }
-    updateView();
 }
 
 
@@ -828,22 +830,35 @@ Printer::updateView()
     if (num_rows <= m_chars_h) {
         // the entire print state fits on screen
         scrollbarSet(0, 0, true);
-    } else if (num_rows == end_row+1) {
-        // if the new row is one off the end,
-        // scroll to make sure the new row is still visible
-        scrollbarSet(first_visible_char, first_visible_row+1, true);
+    } else if (m_rows_shown <= end_row && num_rows > end_row) {
+        // the last row was in view before the new rows were added;
+        // scroll to make sure the new last row is still visible
+        scrollbarSet(first_visible_char, num_rows - m_chars_h, true);
     } else {
-        // the newly added row is off the portion we are looking at.
+        // the newly added rows are off the portion we are looking at.
         // call ScrollbarSet to make sure the scrollbar is updated,
         // but keep the top row unchanged
         scrollbarSet(first_visible_char, first_visible_row, true);
     }
 
+    m_rows_shown = num_rows;
+    m_view_dirty = false;
+
     updateStatusbar();
     invalidateAll();
 }
 
 
+// called by the frame clock: catch up with any lines printed since
+void
+Printer::refreshView()
+{
+    if (m_view_dirty) {
+        updateView();
+    }
+}
+
+
 // update the statusbar text
 void
 Printer::updateStatusbar()
@@ -68,6 +68,9 @@ public:
     // emit a character to the display
     void printChar(uint8 byte);
 
+    // update the view if lines have been added since the last refresh
+    void refreshView();
+
     // save the printer contents to a file
     void saveToFile();
 
@@ -178,6 +181,10 @@ private:
 
     std::vector<std::string> m_printstream;       // represents the entire print stream
     std::vector<std::string> m_printstream_copy;  // this is a copy that is used for printing purposes
+
+    // view updates are batched and done from the frame clock
+    int         m_rows_shown = 0;       // print stream size at last view update
+    bool        m_view_dirty = false;   // rows were added since then
 };
 
 
@@ -0,0 +1,145 @@
+// Unattended execution of a Wang program with captured output.
+// See BatchJob.h for the overview.
+
+#include "BatchJob.h"
+#include "../session/BatchTermSession.h"
+#include "../../core/io/IoCard.h"
+#include "../../core/io/IoCardDisk.h"
+#include "../../core/io/IoCardTermMux.h"
+#include "../../core/system/Scheduler.h"
+#include "../../core/system/system2200.h"
+#include <chrono>
+#include <iostream>
+
+BatchJob::BatchJob(const Settings &settings, IoCardTermMux *termMux) :
+    m_settings(settings),
+    m_termMux(termMux)
+{
+}
+
+
+bool BatchJob::mountDisk(const std::string &spec)
+{
+    // ADDR:DRIVE:PATH, eg 310:1:work.wvd
+    const size_t c1 = spec.find(':');
+    const size_t c2 = (c1 == std::string::npos) ? c1 : spec.find(':', c1+1);
+    if (c2 == std::string::npos || c2+1 == spec.size()) {
+        std::cerr << "[ERROR] Bad mount spec '" << spec << "', expected ADDR:DRIVE:PATH\n";
+        return false;
+    }
+
+    int addr = -1, drive = -1;
+    try {
+        addr  = std::stoi(spec.substr(0, c1), nullptr, 16);
+        drive = std::stoi(spec.substr(c1+1, c2-c1-1));
+    } catch (...) {
+        // reported below
+    }
+    const std::string path = spec.substr(c2+1);
+
+    for (int slot = 0; slot < NUM_IOSLOTS; ++slot) {
+        int cardtype_idx = 0, io_addr = 0;
+        if (!system2200::getSlotInfo(slot, &cardtype_idx, &io_addr)
+            || (cardtype_idx != static_cast<int>(IoCard::card_t::disk))
+            || ((io_addr & 0xFF) != (addr & 0xFF))) {
+            continue;
+        }
+
+        if (drive < 0 || drive > 3
+            || !(IoCardDisk::wvdDriveStatus(slot, drive) & IoCardDisk::WVD_STAT_DRIVE_EXISTENT)) {
+            std::cerr << "[ERROR] Disk controller at " << std::hex << addr << std::dec
+                      << " has no drive " << spec.substr(c1+1, c2-c1-1) << "\n";
+            return false;
+        }
+        if ((IoCardDisk::wvdDriveStatus(slot, drive) & IoCardDisk::WVD_STAT_DRIVE_OCCUPIED)
+            && !IoCardDisk::wvdRemoveDisk(slot, drive)) {
+            std::cerr << "[ERROR] Could not unmount the disk in " << spec << "\n";
+            return false;
+        }
+        if (!IoCardDisk::wvdInsertDisk(slot, drive, path)) {
+            std::cerr << "[ERROR] Could not mount " << path << "\n";
+            return false;
+        }
+        std::cerr << "[INFO] Mounted " << path << " in drive " << drive
+                  << " of disk controller " << std::hex << addr << std::dec << "\n";
+        return true;
+    }
+
+    std::cerr << "[ERROR] No disk controller at address '" << spec.substr(0, c1) << "'\n";
+    return false;
+}
+
+
+int BatchJob::run()
+{
+    using clock = std::chrono::steady_clock;
+
+    // Batch jobs want results, not authentic timing
+    system2200::regulateCpuSpeed(false);
+    system2200::setDiskRealtime(false);
+
+    for (const auto &spec : m_settings.mounts) {
+        if (!mountDisk(spec)) {
+            return EXIT_ERROR;
+        }
+    }
+
+    auto scheduler = m_termMux->getScheduler();
+    const int term = m_settings.terminal;
+    IoCardTermMux *mux = m_termMux;
+    auto session = std::make_shared<BatchTermSession>(
+                        scheduler,
+                        [mux, term](uint8 byte) { mux->serialRxByte(term, byte); },
+                        m_settings.settleMs);
+
+    if (!session->openCapture(m_settings.crtCapture, m_settings.prtCapture)) {
+        std::cerr << "[ERROR] Could not create the batch output files\n";
+        return EXIT_ERROR;
+    }
+    session->setDonePattern(m_settings.donePattern);
+    if (!session->startInput(m_settings.script)) {
+        std::cerr << "[ERROR] Could not open batch script " << m_settings.script << "\n";
+        return EXIT_ERROR;
+    }
+    m_termMux->setSession(term, session);
+
+    std::cerr << "[INFO] Batch job started on terminal " << term
+              << ", timeout " << m_settings.timeoutSec << "s\n";
+
+    const auto start = clock::now();
+    const auto deadline = start + std::chrono::seconds(m_settings.timeoutSec);
+    const int64 emuStartNs = scheduler->getTimeNs();
+    int status = EXIT_ERROR;
+
+    for (;;) {
+        if (!system2200::onIdle()) {
+            std::cerr << "[ERROR] Emulator stopped before the batch job finished\n";
+            break;
+        }
+        if (session->patternSeen()) {
+            status = EXIT_DONE;
+            break;
+        }
+        if (m_settings.donePattern.empty() && session->inputFinished()) {
+            status = EXIT_DONE;
+            break;
+        }
+        if (clock::now() >= deadline) {
+            std::cerr << "[WARN] Batch job timed out after " << m_settings.timeoutSec << "s\n";
+            status = EXIT_TIMEOUT;
+            break;
+        }
+    }
+
+    m_termMux->setSession(term, nullptr);
+
+    const auto wallMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                            clock::now() - start).count();
+    const int64 emuMs = (scheduler->getTimeNs() - emuStartNs) / 1000000;
+    uint64_t typed = 0, received = 0;
+    session->getStats(&typed, &received);
+    std::cerr << "[INFO] Batch job " << ((status == EXIT_DONE) ? "completed" : "ended")
+              << ": " << wallMs << " ms host time, " << emuMs << " ms emulated, "
+              << typed << " bytes typed, " << received << " bytes received\n";
+    return status;
+}
@@ -0,0 +1,59 @@
+#ifndef _INCLUDE_BATCH_JOB_H_
+#define _INCLUDE_BATCH_JOB_H_
+
+#include <string>
+#include <vector>
+
+class IoCardTermMux;
+
+/**
+ * BatchJob - run a Wang program unattended and capture its output
+ *
+ * The configured system is booted with the CPU unregulated and disk
+ * timing off, any requested disk images are mounted, and a script is
+ * typed into one MXD terminal (see BatchTermSession).  Crt and printer
+ * output for that terminal are written to text files.  The job ends when
+ * the completion pattern appears, or, without a pattern, once the script
+ * has been typed and the host has gone quiet.  A wall clock timeout
+ * bounds the whole run.
+ *
+ * Nothing is written back to the INI file and no serial ports are opened,
+ * so any number of jobs can run side by side as separate processes, one
+ * per core.  Jobs which write to disk need their own copies of the images.
+ */
+class BatchJob
+{
+public:
+    struct Settings {
+        std::string script;               // keystroke script; enables batch mode
+        std::string crtCapture;           // crt text output file (empty = none)
+        std::string prtCapture;           // printer text output file (empty = none)
+        std::string donePattern;          // text which ends the job
+        int timeoutSec = 600;             // wall clock limit
+        int settleMs = 2000;              // emulated quiet time before typing on
+        int terminal = 0;                 // MXD terminal the script is typed into
+        std::vector<std::string> mounts;  // ADDR:DRIVE:PATH disk mounts
+
+        bool enabled() const { return !script.empty(); }
+    };
+
+    // process exit status
+    enum { EXIT_DONE = 0, EXIT_ERROR = 1, EXIT_TIMEOUT = 2 };
+
+    BatchJob(const Settings &settings, IoCardTermMux *termMux);
+
+    /**
+     * Run the job to completion
+     * @return one of the EXIT_* codes
+     */
+    int run();
+
+private:
+    const Settings m_settings;
+    IoCardTermMux *m_termMux;
+
+    // Mount one ADDR:DRIVE:PATH disk image; returns false on error
+    static bool mountDisk(const std::string &spec);
+};
+
+#endif // _INCLUDE_BATCH_JOB_H_
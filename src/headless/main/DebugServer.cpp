@@ -0,0 +1,327 @@
+// Microcode debugger on a local socket.
+// See DebugServer.h for the command set.
+
+#include "DebugServer.h"
+#include "../../core/cpu/Cpu2200.h"
+#include "../../core/system/system2200.h"
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+DebugServer::DebugServer(const std::string &path) :
+    m_path(path)
+{
+}
+
+
+DebugServer::~DebugServer()
+{
+    if (m_client >= 0) {
+        detach(vpCpu());
+    }
+    if (m_listen >= 0) {
+        close(m_listen);
+        unlink(m_path.c_str());
+    }
+}
+
+
+bool DebugServer::start()
+{
+    sockaddr_un addr{};
+    if (m_path.size() >= sizeof(addr.sun_path)) {
+        std::cerr << "[ERROR] Debug socket path is too long: " << m_path << "\n";
+        return false;
+    }
+
+    m_listen = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (m_listen < 0) {
+        std::cerr << "[ERROR] Failed to create debug socket: " << strerror(errno) << "\n";
+        return false;
+    }
+
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, m_path.c_str(), sizeof(addr.sun_path) - 1);
+    unlink(m_path.c_str());  // left over from a previous run
+
+    // owner only: the debugger can stop and inspect the whole machine
+    const mode_t oldMask = umask(0077);
+    const int rc = bind(m_listen, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+    umask(oldMask);
+
+    if (rc < 0 || listen(m_listen, 1) < 0) {
+        std::cerr << "[ERROR] Failed to listen on " << m_path << ": " << strerror(errno) << "\n";
+        close(m_listen);
+        m_listen = -1;
+        return false;
+    }
+    return true;
+}
+
+
+Cpu2200vp* DebugServer::vpCpu()
+{
+    // looked up every time, as a reconfiguration replaces the cpu
+    return dynamic_cast<Cpu2200vp*>(system2200::getCpu());
+}
+
+
+void DebugServer::poll()
+{
+    if (m_listen < 0) {
+        return;
+    }
+    if (m_client < 0) {
+        accept();
+        if (m_client < 0) {
+            return;
+        }
+    }
+
+    char buf[512];
+    for (;;) {
+        const ssize_t n = recv(m_client, buf, sizeof(buf), MSG_DONTWAIT);
+        if (n > 0) {
+            for (ssize_t i = 0; i < n; i++) {
+                if (buf[i] == '\n') {
+                    command(m_rxLine);
+                    m_rxLine.clear();
+                    if (m_client < 0) {
+                        return;  // detached
+                    }
+                } else if (buf[i] != '\r' && m_rxLine.size() < 256) {
+                    m_rxLine += buf[i];
+                }
+            }
+            continue;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+            break;
+        }
+        // client went away
+        std::cerr << "[INFO] Debugger disconnected\n";
+        detach(vpCpu());
+        return;
+    }
+
+    // report a stop which wasn't the direct result of a command
+    Cpu2200vp *cpu = vpCpu();
+    if (cpu && cpu->status() == Cpu2200::CPU_STOPPED && !m_reportedStop) {
+        send(describeStop(*cpu) + "\n");
+        m_reportedStop = true;
+    }
+}
+
+
+bool DebugServer::cpuStopped() const
+{
+    const Cpu2200 *cpu = system2200::getCpu();
+    return (m_client >= 0) && cpu && (cpu->status() == Cpu2200::CPU_STOPPED);
+}
+
+
+void DebugServer::accept()
+{
+    m_client = ::accept4(m_listen, nullptr, nullptr, SOCK_CLOEXEC);
+    if (m_client < 0) {
+        return;
+    }
+    m_rxLine.clear();
+    m_reportedStop = false;
+    std::cerr << "[INFO] Debugger connected on " << m_path << "\n";
+
+    if (!vpCpu()) {
+        send("error: the configured cpu can't be debugged\n");
+        close(m_client);
+        m_client = -1;
+        return;
+    }
+    send("wangemu microcode debugger; \"help\" lists commands\nok\n");
+}
+
+
+// remove all breakpoints and watchpoints, let the cpu run, and hang up
+void DebugServer::detach(Cpu2200vp *cpu)
+{
+    if (cpu) {
+        for (auto ic : cpu->getBreakpoints()) {
+            cpu->clearBreakpoint(ic);
+        }
+        for (const auto &w : cpu->getWatchpoints()) {
+            cpu->clearWatchpoint(w.first);
+        }
+        cpu->dbgContinue();
+    }
+    close(m_client);
+    m_client = -1;
+}
+
+
+void DebugServer::send(const std::string &text)
+{
+    // replies are small; a client which isn't reading loses them rather
+    // than stalling the emulator
+    if (m_client >= 0) {
+        const ssize_t n = ::send(m_client, text.data(), text.size(),
+                                 MSG_DONTWAIT | MSG_NOSIGNAL);
+        (void)n;
+    }
+}
+
+
+std::string DebugServer::describeStop(const Cpu2200vp &cpu) const
+{
+    const auto &info = cpu.dbgStopInfo();
+    char buf[120];
+    switch (info.reason) {
+        case Cpu2200vp::DBG_STOP_BREAK:
+            snprintf(buf, sizeof(buf), "stopped break %04X", info.ic);
+            break;
+        case Cpu2200vp::DBG_STOP_WATCH:
+            snprintf(buf, sizeof(buf), "stopped watch %06X %02X->%02X by op at %04X",
+                     info.addr, info.old_value, info.new_value, info.ic);
+            break;
+        case Cpu2200vp::DBG_STOP_STEP:
+            snprintf(buf, sizeof(buf), "stopped step %04X", info.ic);
+            break;
+        default:
+            snprintf(buf, sizeof(buf), "stopped %04X", info.ic);
+            break;
+    }
+    return buf;
+}
+
+
+void DebugServer::command(const std::string &line)
+{
+    std::istringstream in(line);
+    std::string cmd;
+    in >> cmd;
+    if (cmd.empty()) {
+        return;
+    }
+
+    // up to two hex arguments
+    std::vector<long> args;
+    std::string tok;
+    while (in >> tok) {
+        try {
+            args.push_back(std::stol(tok, nullptr, 16));
+        } catch (...) {
+            send("error: bad number '" + tok + "'\n");
+            return;
+        }
+    }
+    auto arg = [&args](size_t n, long dflt) { return (args.size() > n) ? args[n] : dflt; };
+
+    Cpu2200vp *cpu = vpCpu();
+    if (!cpu) {
+        send("error: no cpu\n");
+        return;
+    }
+
+    std::ostringstream out;
+    char buf[120];
+    bool ok = true;
+
+    if (cmd == "break" && args.size() == 1) {
+        cpu->setBreakpoint(static_cast<uint16>(args[0]));
+    } else if (cmd == "delete" && args.size() == 1) {
+        ok = cpu->clearBreakpoint(static_cast<uint16>(args[0]));
+    } else if (cmd == "watch" && !args.empty()) {
+        // check the range before narrowing to int
+        const long addr = args[0];
+        const long len = arg(1, 1);
+        const long ramSize = cpu->dbgRamSize();
+        ok = (addr >= 0) && (addr < ramSize) && (len >= 1) && (len <= ramSize - addr)
+          && cpu->setWatchpoint(static_cast<int>(addr), static_cast<int>(len));
+    } else if (cmd == "unwatch" && args.size() == 1) {
+        ok = (args[0] >= 0) && (args[0] < cpu->dbgRamSize())
+          && cpu->clearWatchpoint(static_cast<int>(args[0]));
+    } else if (cmd == "list") {
+        for (auto ic : cpu->getBreakpoints()) {
+            snprintf(buf, sizeof(buf), "break %04X\n", ic);
+            out << buf;
+        }
+        for (const auto &w : cpu->getWatchpoints()) {
+            snprintf(buf, sizeof(buf), "watch %06X %X\n", w.first, w.second);
+            out << buf;
+        }
+    } else if (cmd == "stop") {
+        cpu->dbgStop();
+        if (cpu->status() == Cpu2200::CPU_STOPPED) {
+            out << describeStop(*cpu) << "\n";
+            m_reportedStop = true;
+        } else {
+            ok = false;
+        }
+    } else if (cmd == "cont") {
+        ok = (cpu->status() == Cpu2200::CPU_STOPPED);
+        cpu->dbgContinue();
+        m_reportedStop = false;
+    } else if (cmd == "step") {
+        ok = (cpu->status() == Cpu2200::CPU_STOPPED);
+        // the steps run on the emulation thread, so keep the count small
+        for (long n = std::min(arg(0, 1), 0x1000L); ok && n > 0; n--) {
+            cpu->dbgStep();
+            if (cpu->dbgStopInfo().reason != Cpu2200vp::DBG_STOP_STEP) {
+                break;  // halted, or a watchpoint was written
+            }
+        }
+        if (ok) {
+            out << describeStop(*cpu) << "\n";
+            m_reportedStop = true;
+        }
+    } else if (cmd == "regs") {
+        out << cpu->dbgFormatState();
+    } else if (cmd == "mem" && !args.empty()) {
+        const long addr = args[0];
+        const long len = std::min(arg(1, 0x40), 0x1000L);
+        for (long row = addr; row < addr + len; row += 16) {
+            snprintf(buf, sizeof(buf), "%06lX:", row);
+            out << buf;
+            for (long a = row; a < row + 16 && a < addr + len; a++) {
+                const int byte = cpu->dbgReadRam(static_cast<int>(a));
+                if (byte < 0) {
+                    break;
+                }
+                snprintf(buf, sizeof(buf), " %02X", byte);
+                out << buf;
+            }
+            out << "\n";
+        }
+    } else if (cmd == "ucode" && !args.empty()) {
+        const auto bps = cpu->getBreakpoints();
+        const long count = std::min(arg(1, 8), 0x100L);
+        for (long n = 0; n < count; n++) {
+            const uint16 ic = static_cast<uint16>(args[0] + n);
+            char dasm[200];
+            dasmOneVpOp(&dasm[0], ic, cpu->dbgReadUcode(ic));
+            const bool bp = std::find(bps.begin(), bps.end(), ic) != bps.end();
+            out << (bp ? "*" : " ") << dasm;
+        }
+    } else if (cmd == "detach") {
+        send("ok\n");
+        std::cerr << "[INFO] Debugger detached\n";
+        detach(cpu);
+        return;
+    } else if (cmd == "help") {
+        out << "break IC | delete IC | watch ADDR [LEN] | unwatch ADDR | list\n"
+               "stop | cont | step [N] | regs | mem ADDR [LEN] | ucode IC [N] | detach\n"
+               "all numbers are hex; memory addresses are after bank mapping\n";
+    } else {
+        send("error: unknown command or wrong arguments: " + line + "\n");
+        return;
+    }
+
+    out << (ok ? "ok\n" : "error: not possible now\n");
+    send(out.str());
+}
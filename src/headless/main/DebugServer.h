@@ -0,0 +1,68 @@
+#ifndef _INCLUDE_DEBUG_SERVER_H_
+#define _INCLUDE_DEBUG_SERVER_H_
+
+#include <string>
+
+class Cpu2200vp;
+
+/**
+ * DebugServer - microcode debugger on a local (unix domain) socket
+ *
+ * One client at a time connects and sends text commands, one per line;
+ * `nc -U PATH` or `socat - UNIX-CONNECT:PATH` is all that is needed.
+ * Every reply ends with a line "ok" or "error: ...".  When the CPU stops
+ * on its own, a "stopped ..." line is sent without being asked.
+ *
+ *   break IC | delete IC        set/clear a breakpoint on a ucode address
+ *   watch ADDR [LEN] | unwatch ADDR
+ *                               stop after a write to bytes of main memory
+ *   list                        show breakpoints and watchpoints
+ *   stop | cont | step [N]      control execution; N is at most 1000 (hex)
+ *   regs                        registers, stack, and the next op
+ *   mem ADDR [LEN]              hex dump of main memory
+ *   ucode IC [N]                disassemble microcode
+ *   detach                      clear everything, resume, and disconnect
+ *
+ * Numbers are hex.  Memory addresses are offsets into main memory, ie,
+ * after bank mapping.  A client which goes away is treated as a detach,
+ * so a live system is never left stopped.
+ *
+ * Everything runs on the emulation thread: poll() is called from the
+ * main loop, so the CPU is never touched while it is executing.  Only
+ * the VP family of CPUs is supported.
+ */
+class DebugServer
+{
+public:
+    explicit DebugServer(const std::string &path);
+    ~DebugServer();
+
+    // create the listening socket; returns false on error
+    bool start();
+
+    // service the client, if any; returns quickly if there is nothing to do
+    void poll();
+
+    // true while a client has the cpu stopped
+    bool cpuStopped() const;
+
+    // the descriptor the main loop should wait on: the client if one is
+    // connected, otherwise the listening socket (-1 if not started)
+    int waitFd() const { return (m_client >= 0) ? m_client : m_listen; }
+
+private:
+    const std::string m_path;
+    int m_listen = -1;
+    int m_client = -1;
+    std::string m_rxLine;       // partial command line
+    bool m_reportedStop = false;  // the current stop has been reported
+
+    static Cpu2200vp* vpCpu();
+    void accept();      // take a waiting client, if any
+    void detach(Cpu2200vp *cpu);
+    void command(const std::string &line);
+    void send(const std::string &text);
+    std::string describeStop(const Cpu2200vp &cpu) const;
+};
+
+#endif // _INCLUDE_DEBUG_SERVER_H_
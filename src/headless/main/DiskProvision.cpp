@@ -0,0 +1,74 @@
+// Batch creation of blank disk images from the command line
+
+#include "DiskProvision.h"
+#include "../../core/disk/Wvd.h"
+#include <chrono>
+#include <iostream>
+
+namespace {
+
+// TYPE as given on the command line is the geometry's short name
+const Wvd::geometry_t* findGeometry(const std::string &name)
+{
+    for (int i = 0; i < Wvd::num_geometries; ++i) {
+        if (name == Wvd::geometries[i].name) {
+            return &Wvd::geometries[i];
+        }
+    }
+    return nullptr;
+}
+
+} // namespace
+
+
+int DiskProvision::createImages(const std::vector<std::string> &specs, bool preallocate)
+{
+    int failures = 0;
+
+    for (const auto &spec : specs) {
+        const size_t colon = spec.find(':');
+        if (colon == std::string::npos || colon == 0 || colon+1 == spec.size()) {
+            std::cerr << "[ERROR] Bad disk spec '" << spec << "', expected TYPE:PATH\n";
+            failures++;
+            continue;
+        }
+
+        const std::string type = spec.substr(0, colon);
+        const std::string path = spec.substr(colon+1);
+        const Wvd::geometry_t *geom = findGeometry(type);
+        if (!geom) {
+            std::cerr << "[ERROR] Unknown disk type '" << type << "' (see --help)\n";
+            failures++;
+            continue;
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+
+        Wvd wvd;
+        wvd.create(geom->disk_type, geom->platters, geom->sectors_per_platter);
+        wvd.save(path, preallocate);
+        const bool ok = !wvd.isModified();  // save() clears it on success
+
+        const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                            std::chrono::steady_clock::now() - start).count();
+        if (ok) {
+            std::cerr << "[INFO] Created " << path << ": " << geom->description
+                      << " (" << ms << " ms)\n";
+        } else {
+            std::cerr << "[ERROR] Failed to create " << path << "\n";
+            failures++;
+        }
+    }
+
+    return failures;
+}
+
+
+void DiskProvision::listDiskPresets(std::ostream &os)
+{
+    for (int i = 0; i < Wvd::num_geometries; ++i) {
+        const Wvd::geometry_t &g = Wvd::geometries[i];
+        os << "    " << g.name << std::string(10 - std::string(g.name).size(), ' ')
+           << g.description << std::endl;
+    }
+}
@@ -0,0 +1,32 @@
+#ifndef _INCLUDE_DISK_PROVISION_H_
+#define _INCLUDE_DISK_PROVISION_H_
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * DiskProvision - batch creation of blank, formatted disk images
+ *
+ * Each spec has the form TYPE:PATH, where TYPE is the short name of one
+ * of Wvd::geometries, the same list the GUI disk factory offers (see
+ * listDiskPresets()).
+ * Images are created at full size but sparse, so even a 14 platter
+ * DS-224 image is written in a few milliseconds; with preallocate set,
+ * the host is asked to reserve the blocks up front as well.
+ */
+namespace DiskProvision
+{
+    /**
+     * Create every image named in specs.  Existing files are overwritten.
+     * @return number of images which could not be created
+     */
+    int createImages(const std::vector<std::string> &specs, bool preallocate);
+
+    /**
+     * Write the list of TYPE names with a short description of each
+     */
+    void listDiskPresets(std::ostream &os);
+}
+
+#endif // _INCLUDE_DISK_PROVISION_H_
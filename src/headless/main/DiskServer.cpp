@@ -0,0 +1,440 @@
+// Share disk images with emulators on other hosts.
+// See DiskServer.h for the overview, and core/disk/WvdProtocol.h for
+// the protocol.
+
+#include "DiskServer.h"
+#include "../../core/disk/WvdProtocol.h"
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace wvdproto;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+volatile sig_atomic_t stopping = 0;
+
+// who holds each image, and until when
+struct Lease {
+    uint64_t token;
+    Clock::time_point expires;
+};
+
+std::mutex leaseMutex;
+std::map<std::string, Lease> leases;
+
+// one client connection
+struct Client {
+    int fd = -1;
+    std::thread thread;
+    bool done = false;          // the thread has finished
+};
+
+std::mutex clientMutex;
+
+uint64_t
+getN(const uint8_t *p, int bytes)
+{
+    uint64_t x = 0;
+    for (int i = 0; i < bytes; i++) {
+        x |= static_cast<uint64_t>(p[i]) << (8*i);
+    }
+    return x;
+}
+
+void
+putN(std::vector<uint8_t> &v, uint64_t x, int bytes)
+{
+    for (int i = 0; i < bytes; i++) {
+        v.push_back(static_cast<uint8_t>(x >> (8*i)));
+    }
+}
+
+bool
+sendAll(int fd, const uint8_t *data, size_t len)
+{
+    while (len > 0) {
+        const ssize_t n = send(fd, data, len, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        data += n;
+        len -= n;
+    }
+    return true;
+}
+
+bool
+recvAll(int fd, uint8_t *data, size_t len)
+{
+    while (len > 0) {
+        const ssize_t n = recv(fd, data, len, 0);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        data += n;
+        len -= n;
+    }
+    return true;
+}
+
+bool
+reply(int fd, uint8_t status, const std::vector<uint8_t> &payload = {})
+{
+    std::vector<uint8_t> frame;
+    frame.reserve(5 + payload.size());
+    frame.push_back(status);
+    putN(frame, payload.size(), 4);
+    frame.insert(frame.end(), payload.begin(), payload.end());
+    return sendAll(fd, frame.data(), frame.size());
+}
+
+// take or renew the lease on name for token; false if someone else has it
+bool
+claimLease(const std::string &name, uint64_t token)
+{
+    std::lock_guard<std::mutex> lock(leaseMutex);
+    const auto now = Clock::now();
+    auto it = leases.find(name);
+    if (it != leases.end() && it->second.token != token && it->second.expires > now) {
+        return false;
+    }
+    leases[name] = Lease{ token, now + std::chrono::milliseconds(DiskServer::LEASE_MS) };
+    return true;
+}
+
+void
+releaseLease(const std::string &name, uint64_t token)
+{
+    std::lock_guard<std::mutex> lock(leaseMutex);
+    auto it = leases.find(name);
+    if (it != leases.end() && it->second.token == token) {
+        leases.erase(it);
+    }
+}
+
+// each image's generation, bumped by every write served.  the count
+// starts from the time the server started, so a disk cache kept from a
+// previous run of the server never matches, even if the image was
+// changed behind its back in between.
+std::mutex generationMutex;
+std::map<std::string, uint64_t> generations;
+uint64_t firstGeneration = 1;
+
+uint64_t
+generation(const std::string &name)
+{
+    std::lock_guard<std::mutex> lock(generationMutex);
+    return generations.emplace(name, firstGeneration).first->second;
+}
+
+void
+bumpGeneration(const std::string &name)
+{
+    std::lock_guard<std::mutex> lock(generationMutex);
+    generations.emplace(name, firstGeneration).first->second++;
+}
+
+// a plain file name in the served directory
+bool
+validName(const std::string &name)
+{
+    return !name.empty() && name.size() <= MAX_NAME_LEN
+        && name.find('/') == std::string::npos
+        && name.find('\0') == std::string::npos
+        && name != "." && name != "..";
+}
+
+// serve one connection until the client goes away
+void
+serveClient(const std::string &dir, int fd, const std::string &peer)
+{
+    std::string name;           // the open image
+    int image = -1;
+    int sectors = 0;
+    uint64_t token = 0;
+
+    std::vector<uint8_t> req;
+    std::vector<uint8_t> out;
+    while (!stopping) {
+        uint8_t hdr[5];
+        if (!recvAll(fd, hdr, 5)) {
+            break;
+        }
+        const uint8_t op = hdr[0];
+        const size_t len = static_cast<size_t>(getN(&hdr[1], 4));
+        if (len > 6 + 256u*MAX_IO_SECTORS) {
+            break;
+        }
+        req.resize(len);
+        if (!recvAll(fd, req.data(), len)) {
+            break;
+        }
+        out.clear();
+
+        if (op == OP_OPEN) {
+            if (len < 8 || len > 8 + MAX_NAME_LEN) {
+                reply(fd, ST_BAD);
+                continue;
+            }
+            const uint64_t new_token = getN(&req[0], 8);
+            const std::string new_name(req.begin() + 8, req.end());
+            if (!validName(new_name)) {
+                reply(fd, ST_BAD);
+                continue;
+            }
+            const int new_image = open((dir + "/" + new_name).c_str(), O_RDWR | O_CLOEXEC);
+            struct stat st{};
+            if (new_image < 0 || fstat(new_image, &st) != 0 || !S_ISREG(st.st_mode)) {
+                if (new_image >= 0) {
+                    close(new_image);
+                }
+                reply(fd, ST_NOT_FOUND);
+                continue;
+            }
+            if (!claimLease(new_name, new_token)) {
+                close(new_image);
+                std::cerr << "[INFO] Disk server: " << peer << " refused '"
+                          << new_name << "', it is in use\n";
+                reply(fd, ST_BUSY);
+                continue;
+            }
+            if (image >= 0) {
+                close(image);
+            }
+            image = new_image;
+            name = new_name;
+            token = new_token;
+            sectors = static_cast<int>(st.st_size / 256);
+            std::cerr << "[INFO] Disk server: " << peer << " opened '" << name << "'\n";
+            putN(out, sectors, 4);
+            putN(out, DiskServer::LEASE_MS, 4);
+            putN(out, generation(name), 8);
+            reply(fd, ST_OK, out);
+            continue;
+        }
+
+        if (image < 0) {
+            reply(fd, ST_BAD);
+            continue;
+        }
+        if (!claimLease(name, token)) {
+            reply(fd, ST_NO_LEASE);
+            continue;
+        }
+
+        switch (op) {
+        case OP_READ:
+        case OP_WRITE: {
+            if (len < 6) {
+                reply(fd, ST_BAD);
+                break;
+            }
+            const int first = static_cast<int>(getN(&req[0], 4));
+            const int count = static_cast<int>(getN(&req[4], 2));
+            const size_t bytes = 256u * count;
+            if (count < 1 || count > MAX_IO_SECTORS || first < 0 || first + count > sectors
+                || (op == OP_READ  && len != 6)
+                || (op == OP_WRITE && len != 6 + bytes)) {
+                reply(fd, ST_BAD);
+                break;
+            }
+            if (op == OP_READ) {
+                out.resize(bytes);
+                if (pread(image, out.data(), bytes, 256LL*first) != static_cast<ssize_t>(bytes)) {
+                    reply(fd, ST_IO_ERROR);
+                    break;
+                }
+                reply(fd, ST_OK, out);
+            } else {
+                // the client treats a write as done once it is acknowledged
+                // even a failed write may have changed part of the image
+                bumpGeneration(name);
+                if (pwrite(image, &req[6], bytes, 256LL*first) != static_cast<ssize_t>(bytes)
+                    || fdatasync(image) != 0) {
+                    reply(fd, ST_IO_ERROR);
+                    break;
+                }
+                reply(fd, ST_OK);
+            }
+            break;
+        }
+        case OP_RENEW:
+            reply(fd, ST_OK);
+            break;
+        case OP_CLOSE:
+            putN(out, generation(name), 8);
+            releaseLease(name, token);
+            close(image);
+            image = -1;
+            std::cerr << "[INFO] Disk server: " << peer << " closed '" << name << "'\n";
+            reply(fd, ST_OK, out);
+            break;
+        default:
+            reply(fd, ST_BAD);
+            break;
+        }
+    }
+
+    // a client which just dropped off keeps its lease until it expires,
+    // so it can reconnect and carry on
+    if (image >= 0) {
+        close(image);
+    }
+}
+
+std::string
+peerName(const sockaddr_storage &addr)
+{
+    char host[INET6_ADDRSTRLEN] = "?";
+    int port = 0;
+    if (addr.ss_family == AF_INET) {
+        const auto *in = reinterpret_cast<const sockaddr_in*>(&addr);
+        inet_ntop(AF_INET, &in->sin_addr, host, sizeof(host));
+        port = ntohs(in->sin_port);
+    } else if (addr.ss_family == AF_INET6) {
+        const auto *in6 = reinterpret_cast<const sockaddr_in6*>(&addr);
+        inet_ntop(AF_INET6, &in6->sin6_addr, host, sizeof(host));
+        port = ntohs(in6->sin6_port);
+    }
+    return std::string(host) + ":" + std::to_string(port);
+}
+
+void
+signalHandler(int)
+{
+    DiskServer::stop();
+}
+
+} // namespace
+
+
+void DiskServer::stop()
+{
+    stopping = 1;
+}
+
+
+int DiskServer::run(const std::string &dir, int port)
+{
+    if (port == 0) {
+        port = DEFAULT_PORT;
+    }
+    struct stat st{};
+    if (stat(dir.c_str(), &st) != 0 || !S_ISDIR(st.st_mode)) {
+        std::cerr << "[ERROR] Disk server: '" << dir << "' isn't a directory\n";
+        return 1;
+    }
+
+    // listen on every address, v4 and v6
+    const int listenFd = socket(AF_INET6, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listenFd < 0) {
+        std::cerr << "[ERROR] Disk server: socket: " << strerror(errno) << "\n";
+        return 1;
+    }
+    const int one = 1;
+    const int zero = 0;
+    setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    setsockopt(listenFd, IPPROTO_IPV6, IPV6_V6ONLY, &zero, sizeof(zero));
+    sockaddr_in6 addr{};
+    addr.sin6_family = AF_INET6;
+    addr.sin6_addr = in6addr_any;
+    addr.sin6_port = htons(static_cast<uint16_t>(port));
+    if (bind(listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0
+        || listen(listenFd, 16) < 0) {
+        std::cerr << "[ERROR] Disk server: can't listen on port " << port
+                  << ": " << strerror(errno) << "\n";
+        close(listenFd);
+        return 1;
+    }
+
+    firstGeneration = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
+
+    signal(SIGINT, signalHandler);
+    signal(SIGTERM, signalHandler);
+    signal(SIGPIPE, SIG_IGN);
+    std::cerr << "[INFO] Disk server: serving '" << dir << "' on port " << port << "\n";
+
+    std::vector<std::unique_ptr<Client>> clients;
+    while (!stopping) {
+        pollfd pfd{ listenFd, POLLIN, 0 };
+        const int n = poll(&pfd, 1, 500);
+        if (n < 0 && errno != EINTR) {
+            std::cerr << "[ERROR] Disk server: poll: " << strerror(errno) << "\n";
+            break;
+        }
+
+        // reap the connections which have ended
+        {
+            std::lock_guard<std::mutex> lock(clientMutex);
+            for (auto it = clients.begin(); it != clients.end(); ) {
+                if ((*it)->done) {
+                    (*it)->thread.join();
+                    close((*it)->fd);
+                    it = clients.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+        }
+
+        if (n <= 0 || !(pfd.revents & POLLIN)) {
+            continue;
+        }
+        sockaddr_storage peer{};
+        socklen_t peerLen = sizeof(peer);
+        const int fd = accept4(listenFd, reinterpret_cast<sockaddr*>(&peer), &peerLen, SOCK_CLOEXEC);
+        if (fd < 0) {
+            continue;
+        }
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        auto client = std::make_unique<Client>();
+        client->fd = fd;
+        Client *c = client.get();
+        const std::string name = peerName(peer);
+        std::lock_guard<std::mutex> lock(clientMutex);
+        c->thread = std::thread([dir, c, name]() {
+            serveClient(dir, c->fd, name);
+            std::lock_guard<std::mutex> doneLock(clientMutex);
+            c->done = true;
+        });
+        clients.push_back(std::move(client));
+    }
+
+    std::cerr << "[INFO] Disk server: stopping\n";
+    close(listenFd);
+    for (auto &c : clients) {
+        shutdown(c->fd, SHUT_RDWR);     // wakes its thread
+    }
+    for (auto &c : clients) {
+        c->thread.join();
+        close(c->fd);
+    }
+    return 0;
+}
@@ -0,0 +1,38 @@
+#ifndef _INCLUDE_DISK_SERVER_H_
+#define _INCLUDE_DISK_SERVER_H_
+
+#include <string>
+
+/**
+ * DiskServer - share disk images with emulators on other hosts
+ *
+ * Serves the .wvd files in one directory over TCP, using the block
+ * protocol described in core/disk/WvdProtocol.h.  An emulator mounts an
+ * image as wvd://HOST[:PORT]/NAME and caches it locally (see WvdRemote),
+ * so the server only sees cache misses and batched write-backs.
+ *
+ * Each image can be held by one client at a time.  A client's lease is
+ * renewed by every request it makes, and expires LEASE_MS after the last
+ * one, so an image held by a crashed or unplugged system becomes free
+ * again on its own.
+ *
+ * There is no authentication: anyone who can reach the port can read and
+ * write the images, so it belongs on a trusted network.
+ */
+namespace DiskServer
+{
+    constexpr int LEASE_MS = 15000;
+
+    /**
+     * Serve the images in dir on port (0 = the default) until stop()
+     * @return process exit status
+     */
+    int run(const std::string &dir, int port);
+
+    /**
+     * Make run() return; safe to call from a signal handler
+     */
+    void stop();
+}
+
+#endif // _INCLUDE_DISK_SERVER_H_
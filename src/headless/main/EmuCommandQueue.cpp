@@ -0,0 +1,221 @@
+// Commands from other threads to the emulation thread.
+// See EmuCommandQueue.h for the overview.
+
+#include "EmuCommandQueue.h"
+#include "../../core/io/IoCardDisk.h"
+#include "../../core/system/system2200.h"
+#include "../../platform/common/host.h"
+#include "../../shared/config/SysCfgState.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+namespace {
+
+// ------------------------------------------------------------------------
+// the queue: an intrusive multi-producer, single-consumer linked list.
+// producers swing s_head to their node with one atomic exchange, then
+// link the previous head to it.  the consumer follows next pointers from
+// s_tail.  a stub node keeps the list from ever being empty, so neither
+// side needs to special-case the last node.
+// ------------------------------------------------------------------------
+
+struct Node {
+    std::atomic<Node*> next{nullptr};
+    EmuCommandQueue::Command cmd;
+    std::promise<EmuCommandQueue::Result> reply;
+};
+
+Node s_stub;
+std::atomic<Node*> s_head{&s_stub};  // most recently pushed; producers
+Node *s_tail = &s_stub;              // oldest; consumer only
+
+void
+push(Node *node)
+{
+    node->next.store(nullptr, std::memory_order_relaxed);
+    Node *prev = s_head.exchange(node, std::memory_order_acq_rel);
+    prev->next.store(node, std::memory_order_release);
+}
+
+// returns nullptr if the queue is empty, or if a producer is between its
+// exchange and its link; in that case the node is picked up next time
+Node *
+pop()
+{
+    Node *tail = s_tail;
+    Node *next = tail->next.load(std::memory_order_acquire);
+    if (tail == &s_stub) {
+        if (next == nullptr) {
+            return nullptr;
+        }
+        s_tail = next;
+        tail = next;
+        next = next->next.load(std::memory_order_acquire);
+    }
+    if (next != nullptr) {
+        s_tail = next;
+        return tail;
+    }
+    if (tail != s_head.load(std::memory_order_acquire)) {
+        return nullptr;
+    }
+    push(&s_stub);
+    next = tail->next.load(std::memory_order_acquire);
+    if (next != nullptr) {
+        s_tail = next;
+        return tail;
+    }
+    return nullptr;
+}
+
+int
+eventFd()
+{
+    static const int fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    return fd;
+}
+
+} // namespace
+
+
+std::future<EmuCommandQueue::Result>
+EmuCommandQueue::post(Command cmd)
+{
+    Node *node = new Node;
+    node->cmd = std::move(cmd);
+    std::future<Result> reply = node->reply.get_future();
+    push(node);
+
+    const uint64_t one = 1;
+    ssize_t s = write(eventFd(), &one, sizeof(one));
+    (void)s;  // only fails if the counter is saturated, i.e. already readable
+    return reply;
+}
+
+
+EmuCommandQueue::Result
+EmuCommandQueue::call(Command cmd, int timeout_ms)
+{
+    std::future<Result> reply = post(std::move(cmd));
+    if (reply.wait_for(std::chrono::milliseconds(timeout_ms)) != std::future_status::ready) {
+        // the command still runs when the emulation thread gets to it
+        Result result;
+        result.status = Result::status_t::TIMEOUT;
+        result.message = "emulator did not respond";
+        return result;
+    }
+    return reply.get();
+}
+
+
+int
+EmuCommandQueue::waitFd()
+{
+    return eventFd();
+}
+
+
+void
+EmuCommandQueue::drain()
+{
+    // clear the wakeup before looking at the queue.  a node which pop()
+    // can't reach yet belongs to a producer still in post(), and that
+    // producer's write will wake us again.
+    uint64_t count;
+    ssize_t s = read(eventFd(), &count, sizeof(count));
+    (void)s;
+
+    while (Node *node = pop()) {
+        Result result;
+        try {
+            result = execute(node->cmd);
+        } catch (const std::exception &e) {
+            result.status = Result::status_t::FAILED;
+            result.message = e.what();
+        } catch (...) {
+            result.status = Result::status_t::FAILED;
+            result.message = "unknown error";
+        }
+        node->reply.set_value(std::move(result));
+        delete node;
+    }
+}
+
+
+EmuCommandQueue::Result
+EmuCommandQueue::execute(const Command &cmd)
+{
+    Result result;
+
+    switch (cmd.type) {
+
+    case Command::type_t::DISK_INSERT:
+        if (IoCardDisk::wvdDriveStatus(cmd.slot, cmd.drive) & IoCardDisk::WVD_STAT_DRIVE_OCCUPIED) {
+            result.status = Result::status_t::REJECTED;
+            result.message = "Drive already contains a disk. Remove it first.";
+        } else if (!IoCardDisk::wvdInsertDisk(cmd.slot, cmd.drive, cmd.path)) {
+            result.status = Result::status_t::FAILED;
+            result.message = "Failed to insert disk";
+        }
+        break;
+
+    case Command::type_t::DISK_REMOVE:
+        if (!(IoCardDisk::wvdDriveStatus(cmd.slot, cmd.drive) & IoCardDisk::WVD_STAT_DRIVE_OCCUPIED)) {
+            result.status = Result::status_t::REJECTED;
+            result.message = "No disk in drive to remove.";
+        } else if (!IoCardDisk::wvdRemoveDisk(cmd.slot, cmd.drive)) {
+            result.status = Result::status_t::FAILED;
+            result.message = "Failed to remove disk";
+        }
+        break;
+
+    case Command::type_t::DISK_REALTIME: {
+        const bool realtime = (cmd.value != 0);
+        system2200::setDiskRealtime(realtime);
+        // persist it, as the GUI does when saving its configuration
+        host::configWriteBool("misc", "disk_realtime", realtime);
+        break;
+    }
+
+    case Command::type_t::CPU_SPEED: {
+        const bool regulated = (cmd.value > 0);
+        if (regulated) {
+            system2200::setCpuSpeedMultiplier(cmd.value);
+        }
+        system2200::regulateCpuSpeed(regulated);
+        // persist it the way SysCfgState::saveIni() would
+        host::configWriteStr("cpu", "speed", regulated ? "regulated" : "unregulated");
+        host::configWriteInt("cpu", "speed_multiplier", system2200::getCpuSpeedMultiplier());
+        break;
+    }
+
+    case Command::type_t::RELOAD_CONFIG:
+        host::loadConfigFile(cmd.path);
+        std::cerr << "[INFO] Configuration reloaded from " << cmd.path << "\n";
+        break;
+
+    case Command::type_t::RESTART: {
+        // the GUI's "OK, reboot": reload the host configuration, build a
+        // new system configuration from it, and apply that
+        std::cerr << "[INFO] Internal restart requested, performing safe system reconfiguration...\n";
+        host::loadConfigFile(cmd.path);
+        std::cerr << "[INFO] Host configuration reloaded from " << cmd.path << "\n";
+
+        SysCfgState newConfig;
+        newConfig.loadIni();
+        std::cerr << "[DEBUG] CPU Type: " << newConfig.getCpuType() << "\n";
+        std::cerr << "[DEBUG] RAM Size: " << newConfig.getRamKB() << " KB\n";
+
+        system2200::setConfig(newConfig);
+        std::cerr << "[INFO] System configuration applied - internal restart complete\n";
+        break;
+    }
+    }
+
+    return result;
+}
+
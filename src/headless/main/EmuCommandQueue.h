@@ -0,0 +1,73 @@
+#ifndef _INCLUDE_EMU_COMMAND_QUEUE_H_
+#define _INCLUDE_EMU_COMMAND_QUEUE_H_
+
+#include <future>
+#include <string>
+
+/**
+ * EmuCommandQueue - requests from other threads to the emulation thread
+ *
+ * Emulator state belongs to the main (emulation) thread.  Other threads,
+ * the web server in particular, don't touch it directly: they post a
+ * typed Command, which the main loop executes between timeslices, and
+ * get the Result through a future.  Posting is lock-free (many producers,
+ * one consumer), and an eventfd wakes the main loop so a command doesn't
+ * wait out an idle quantum.
+ *
+ * Reads which the web UI polls for don't go through here; the disk
+ * controllers publish drive status themselves as it changes (see
+ * IoCardDisk::wvdPublishedStatus()).
+ */
+class EmuCommandQueue
+{
+public:
+    static constexpr int DEFAULT_TIMEOUT_MS = 2000;
+
+    struct Command {
+        enum class type_t {
+            DISK_INSERT,     // slot, drive, path
+            DISK_REMOVE,     // slot, drive
+            DISK_REALTIME,   // value: 0=unregulated, 1=realtime
+            CPU_SPEED,       // value: speed multiplier, 0=unregulated
+            RELOAD_CONFIG,   // path: ini file
+            RESTART,         // path: ini file; reconfigure from it
+        } type;
+        int slot  = 0;
+        int drive = 0;
+        int value = 0;
+        std::string path;
+    };
+
+    struct Result {
+        enum class status_t {
+            OK,
+            REJECTED,   // not possible in the current state
+            FAILED,     // attempted, but it didn't work
+            TIMEOUT,    // the emulation thread didn't get to it in time
+        } status = status_t::OK;
+        std::string message;
+
+        bool ok() const { return status == status_t::OK; }
+    };
+
+    // ---- any thread ----
+
+    // queue a command; the future is ready once it has been executed
+    static std::future<Result> post(Command cmd);
+
+    // post a command and wait up to timeout_ms for its result
+    static Result call(Command cmd, int timeout_ms = DEFAULT_TIMEOUT_MS);
+
+    // ---- emulation thread ----
+
+    // readable while commands are waiting; for poll()
+    static int waitFd();
+
+    // execute every queued command
+    static void drain();
+
+private:
+    static Result execute(const Command &cmd);
+};
+
+#endif // _INCLUDE_EMU_COMMAND_QUEUE_H_
@@ -0,0 +1,228 @@
+// Fork-based fan-out of identical systems from one warm boot.
+// See Fanout.h for the overview.
+
+#include "Fanout.h"
+#include "../../core/disk/WvdRemote.h"
+#include "../../core/io/IoCard.h"
+#include "../../core/io/IoCardDisk.h"
+#include "../../core/io/IoCardTermMux.h"
+#include "../../core/system/Scheduler.h"
+#include "../../core/system/system2200.h"
+#include <chrono>
+#include <csignal>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+
+// supervisor signal state
+volatile sig_atomic_t s_stop = 0;
+volatile sig_atomic_t s_forwardStatus = 0;
+
+// the handlers in place before the supervisor took over; workers get
+// them back right after fork()
+struct sigaction s_oldInt, s_oldTerm, s_oldUsr1;
+
+void onSupervisorSignal(int signal)
+{
+    if (signal == SIGUSR1) {
+        s_forwardStatus = 1;
+    } else {
+        s_stop = 1;
+    }
+}
+
+} // namespace
+
+
+Fanout::Fanout(const Settings &settings, IoCardTermMux *termMux) :
+    m_settings(settings),
+    m_termMux(termMux)
+{
+}
+
+
+void Fanout::warmUp()
+{
+    using clock = std::chrono::steady_clock;
+
+    // nobody is waiting on the warm-up, so get it over with
+    const bool regulated = system2200::isCpuSpeedRegulated();
+    const bool diskRealtime = system2200::isDiskRealtime();
+    system2200::regulateCpuSpeed(false);
+    system2200::setDiskRealtime(false);
+
+    auto scheduler = m_termMux->getScheduler();
+    const auto start = clock::now();
+    const int64 endNs = scheduler->getTimeNs() + 1000000000LL * m_settings.warmupSec;
+    while (scheduler->getTimeNs() < endNs) {
+        if (!system2200::onIdle()) {
+            break;
+        }
+    }
+
+    system2200::regulateCpuSpeed(regulated);
+    system2200::setDiskRealtime(diskRealtime);
+
+    const auto wallMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                            clock::now() - start).count();
+    std::cerr << "[INFO] Fan-out: warmed up " << m_settings.warmupSec
+              << " emulated seconds in " << wallMs << " ms\n";
+}
+
+
+void Fanout::makeDiskOverlays()
+{
+    for (int slot = 0; slot < NUM_IOSLOTS; ++slot) {
+        int cardtype_idx = 0, io_addr = 0;
+        if (!system2200::getSlotInfo(slot, &cardtype_idx, &io_addr)
+            || (cardtype_idx != static_cast<int>(IoCard::card_t::disk))) {
+            continue;
+        }
+        for (int drive = 0; drive < 4; ++drive) {
+            if (IoCardDisk::wvdDriveStatus(slot, drive) & IoCardDisk::WVD_STAT_DRIVE_OCCUPIED) {
+                IoCardDisk::wvdMakeOverlay(slot, drive);
+            }
+        }
+    }
+}
+
+
+bool Fanout::findRemoteDisk()
+{
+    for (int slot = 0; slot < NUM_IOSLOTS; ++slot) {
+        int cardtype_idx = 0, io_addr = 0;
+        if (!system2200::getSlotInfo(slot, &cardtype_idx, &io_addr)
+            || (cardtype_idx != static_cast<int>(IoCard::card_t::disk))) {
+            continue;
+        }
+        for (int drive = 0; drive < 4; ++drive) {
+            std::string filename;
+            if (IoCardDisk::wvdGetFilename(slot, drive, &filename)
+                && WvdRemote::isRemotePath(filename)) {
+                std::cerr << "[ERROR] Fan-out: can't share '" << filename
+                          << "' between workers; use a local copy of the image\n";
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+
+int Fanout::spawn(int worker)
+{
+    std::cout.flush();
+    std::cerr.flush();
+
+    const pid_t pid = fork();
+    if (pid < 0) {
+        std::cerr << "[ERROR] Fan-out: fork for worker " << worker
+                  << " failed: " << strerror(errno) << "\n";
+        return -1;
+    }
+    if (pid == 0) {
+        sigaction(SIGINT, &s_oldInt, nullptr);
+        sigaction(SIGTERM, &s_oldTerm, nullptr);
+        sigaction(SIGUSR1, &s_oldUsr1, nullptr);
+        makeDiskOverlays();
+        return 0;
+    }
+    std::cerr << "[INFO] Fan-out: worker " << worker << " is pid " << pid << "\n";
+    return pid;
+}
+
+
+int Fanout::run()
+{
+    if (findRemoteDisk()) {
+        return REFUSED;
+    }
+
+    warmUp();
+
+    struct sigaction sa{};
+    sa.sa_handler = onSupervisorSignal;
+    sigemptyset(&sa.sa_mask);
+    sa.sa_flags = 0;  // no SA_RESTART: the signals must interrupt waitpid()
+    sigaction(SIGINT, &sa, &s_oldInt);
+    sigaction(SIGTERM, &sa, &s_oldTerm);
+    sigaction(SIGUSR1, &sa, &s_oldUsr1);
+
+    std::vector<pid_t> pids(m_settings.workers, -1);
+    for (int w = 0; w < m_settings.workers; ++w) {
+        pids[w] = spawn(w);
+        if (pids[w] == 0) {
+            return w;
+        }
+    }
+
+    while (!s_stop) {
+        int status = 0;
+        const pid_t pid = waitpid(-1, &status, 0);
+        if (pid < 0) {
+            if (errno != EINTR) {
+                break;  // no workers left
+            }
+            if (s_forwardStatus) {
+                s_forwardStatus = 0;
+                for (auto p : pids) {
+                    if (p > 0) {
+                        kill(p, SIGUSR1);
+                    }
+                }
+            }
+            continue;
+        }
+
+        int w = 0;
+        while (w < m_settings.workers && pids[w] != pid) {
+            w++;
+        }
+        if (w == m_settings.workers) {
+            continue;
+        }
+        pids[w] = -1;
+        if (WIFSIGNALED(status)) {
+            std::cerr << "[WARN] Fan-out: worker " << w << " killed by signal " << WTERMSIG(status) << "\n";
+        } else {
+            std::cerr << "[INFO] Fan-out: worker " << w << " exited with status " << WEXITSTATUS(status) << "\n";
+        }
+        if (s_stop) {
+            break;
+        }
+
+        // a fresh copy of the warm system takes its place; the pause
+        // keeps a worker which can't start from spinning
+        sleep(1);
+        if (s_stop) {
+            break;
+        }
+        pids[w] = spawn(w);
+        if (pids[w] == 0) {
+            return w;
+        }
+    }
+
+    std::cerr << "[INFO] Fan-out: stopping workers\n";
+    for (auto p : pids) {
+        if (p > 0) {
+            kill(p, SIGTERM);
+        }
+    }
+    for (auto p : pids) {
+        if (p > 0) {
+            waitpid(p, nullptr, 0);
+        }
+    }
+
+    sigaction(SIGINT, &s_oldInt, nullptr);
+    sigaction(SIGTERM, &s_oldTerm, nullptr);
+    sigaction(SIGUSR1, &s_oldUsr1, nullptr);
+    return -1;
+}
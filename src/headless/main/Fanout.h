@@ -0,0 +1,72 @@
+#ifndef _INCLUDE_FANOUT_H_
+#define _INCLUDE_FANOUT_H_
+
+class IoCardTermMux;
+
+/**
+ * Fanout - many identical systems forked from one warm boot
+ *
+ * The configured system is booted once and run (unregulated, with disk
+ * timing off) for a few emulated seconds so the OS is loaded and idle.
+ * Then the process forks one worker per system.  Each worker inherits
+ * the warmed emulator copy-on-write: main memory, the microcode store and
+ * all card state are shared with the others until written, so starting
+ * N systems takes milliseconds and little more memory than one.
+ *
+ * Each worker puts every mounted disk in overlay mode (see Wvd): the
+ * shared images are only read, and writes stay private to the worker
+ * and are discarded when it exits.  The caller gives each worker its own
+ * serial ports (see TerminalServerConfig::specializeForWorker()).
+ * Disks served over the network (wvd://) can't be shared that way: the
+ * workers would all talk over the one connection, which belongs to the
+ * parent's helper thread, so fan-out is refused while one is mounted.
+ *
+ * The original process stays behind as a supervisor.  It does no
+ * emulation of its own, so its warm state is still intact when a worker
+ * exits, and a fresh copy is forked in its place.  SIGUSR1 is passed on
+ * to all workers; SIGINT or SIGTERM stops them all.
+ *
+ * run() must be called before any other thread is started, as fork()
+ * only copies the calling thread.
+ */
+class Fanout
+{
+public:
+    struct Settings {
+        int workers = 0;             // number of systems; enables fan-out
+        int warmupSec = 10;          // emulated seconds to run before forking
+
+        bool enabled() const { return workers > 0; }
+    };
+
+    static constexpr int MAX_WORKERS = 256;
+    static constexpr int REFUSED = -2;
+
+    Fanout(const Settings &settings, IoCardTermMux *termMux);
+
+    /**
+     * Warm up, fork the workers, and supervise them
+     * @return the worker number (0..workers-1) in a worker, which should
+     *         go on to run its terminals; -1 in the supervisor once every
+     *         worker has stopped, and it is time to exit; REFUSED if
+     *         the system can't be forked, after saying why
+     */
+    int run();
+
+private:
+    const Settings m_settings;
+    IoCardTermMux *m_termMux;
+
+    void warmUp();
+
+    // fork one worker; returns its pid in the supervisor, 0 in the worker
+    int spawn(int worker);
+
+    // give the worker private views of all mounted disks
+    static void makeDiskOverlays();
+
+    // report the first disk mounted from a disk server, if any
+    static bool findRemoteDisk();
+};
+
+#endif // _INCLUDE_FANOUT_H_
@@ -0,0 +1,272 @@
+// Host cpu accounting for the terminal server
+// Per-thread cpu time history, and a sampling split of the emulation
+// thread's time by system2200::host_activity.
+
+#include "HostCpuStats.h"
+#include "../../core/system/system2200.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <vector>
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// older glibc headers don't name this union member
+#ifndef sigev_notify_thread_id
+#define sigev_notify_thread_id _sigev_un._tid
+#endif
+
+namespace {
+
+// the emulation thread is sampled every this many us of its cpu time
+constexpr long SAMPLE_US = 4000;
+
+struct thread_info_t {
+    std::string name;
+    pid_t       tid;
+    clockid_t   clock;
+};
+
+struct snapshot_t {
+    int64_t wall_ns    = 0;   // CLOCK_MONOTONIC
+    int64_t process_ns = 0;   // whole process, all threads
+    std::vector<std::pair<pid_t, int64_t>> thread_ns;  // per registered thread
+    uint32_t samples[system2200::ACTIVITY_NUM] = {};   // activity sample counts
+};
+
+std::mutex                 s_mutex;
+std::vector<thread_info_t> s_threads;
+std::deque<snapshot_t>     s_history;    // oldest first, one per second
+std::atomic<int64_t>       s_nextTickNs{0};
+
+// activity sampler
+pid_t                 s_emuTid = 0;
+timer_t               s_timer;
+bool                  s_timerCreated = false;
+std::atomic<uint32_t> s_samples[system2200::ACTIVITY_NUM];
+
+pid_t currentTid()
+{
+    return static_cast<pid_t>(syscall(SYS_gettid));
+}
+
+int64_t readClockNs(clockid_t clock, bool *ok = nullptr)
+{
+    timespec ts{};
+    const bool good = (clock_gettime(clock, &ts) == 0);
+    if (ok) {
+        *ok = good;
+    }
+    return good ? (int64_t(ts.tv_sec) * 1000000000LL + ts.tv_nsec) : 0;
+}
+
+// SIGPROF handler; only ever delivered to the emulation thread
+void onProfileTick(int)
+{
+    const int act = system2200::host_activity.load(std::memory_order_relaxed);
+    if (act >= 0 && act < system2200::ACTIVITY_NUM) {
+        s_samples[act].fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+// read all clocks now.  threads whose clock can't be read have exited
+// and are dropped from the registry.  caller holds s_mutex.
+snapshot_t takeSnapshot()
+{
+    snapshot_t snap;
+    snap.wall_ns    = readClockNs(CLOCK_MONOTONIC);
+    snap.process_ns = readClockNs(CLOCK_PROCESS_CPUTIME_ID);
+    for (int act = 0; act < system2200::ACTIVITY_NUM; act++) {
+        snap.samples[act] = s_samples[act].load(std::memory_order_relaxed);
+    }
+
+    auto it = s_threads.begin();
+    while (it != s_threads.end()) {
+        bool ok = false;
+        const int64_t ns = readClockNs(it->clock, &ok);
+        if (!ok) {
+            it = s_threads.erase(it);
+            continue;
+        }
+        snap.thread_ns.emplace_back(it->tid, ns);
+        ++it;
+    }
+    return snap;
+}
+
+std::string pct(int64_t part_ns, int64_t whole_ns)
+{
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.1f", (whole_ns > 0) ? (100.0 * part_ns / whole_ns) : 0.0);
+    return buf;
+}
+
+} // namespace
+
+
+void HostCpuStats::registerThread(const std::string &name)
+{
+    const pid_t tid = currentTid();
+    if (tid != getpid()) {
+        // the kernel limits names to 15 characters
+        pthread_setname_np(pthread_self(), name.substr(0, 15).c_str());
+    }
+
+    clockid_t clock;
+    if (pthread_getcpuclockid(pthread_self(), &clock) != 0) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(s_mutex);
+    // a recycled thread id belongs to the new thread
+    s_threads.erase(std::remove_if(s_threads.begin(), s_threads.end(),
+                                   [tid](const thread_info_t &t) { return t.tid == tid; }),
+                    s_threads.end());
+    s_threads.push_back({name, tid, clock});
+}
+
+
+bool HostCpuStats::startActivitySampler()
+{
+    if (s_timerCreated) {
+        return true;
+    }
+
+    struct sigaction sa{};
+    sa.sa_handler = onProfileTick;
+    sa.sa_flags = SA_RESTART;   // don't disturb blocking calls on the thread
+    sigemptyset(&sa.sa_mask);
+    if (sigaction(SIGPROF, &sa, nullptr) != 0) {
+        std::cerr << "[WARN] Host cpu stats: can't install SIGPROF handler: " << strerror(errno) << "\n";
+        return false;
+    }
+
+    // the timer runs on this thread's cpu clock, so it is silent while
+    // the thread sleeps and the samples only ever see busy time
+    s_emuTid = currentTid();
+    sigevent sev{};
+    sev.sigev_notify = SIGEV_THREAD_ID;
+    sev.sigev_signo = SIGPROF;
+    sev.sigev_notify_thread_id = s_emuTid;
+    if (timer_create(CLOCK_THREAD_CPUTIME_ID, &sev, &s_timer) != 0) {
+        std::cerr << "[WARN] Host cpu stats: can't create profiling timer: " << strerror(errno) << "\n";
+        return false;
+    }
+
+    itimerspec its{};
+    its.it_interval.tv_nsec = SAMPLE_US * 1000;
+    its.it_value = its.it_interval;
+    if (timer_settime(s_timer, 0, &its, nullptr) != 0) {
+        std::cerr << "[WARN] Host cpu stats: can't start profiling timer: " << strerror(errno) << "\n";
+        timer_delete(s_timer);
+        return false;
+    }
+
+    s_timerCreated = true;
+    return true;
+}
+
+
+void HostCpuStats::stopActivitySampler()
+{
+    if (s_timerCreated) {
+        timer_delete(s_timer);
+        s_timerCreated = false;
+    }
+}
+
+
+void HostCpuStats::tick()
+{
+    const int64_t now = readClockNs(CLOCK_MONOTONIC);
+    if (now < s_nextTickNs.load(std::memory_order_relaxed)) {
+        return;
+    }
+    s_nextTickNs.store(now + 1000000000LL, std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lock(s_mutex);
+    s_history.push_back(takeSnapshot());
+    while (s_history.size() > HISTORY_SECONDS + 1) {
+        s_history.pop_front();
+    }
+}
+
+
+void HostCpuStats::outputStatus(std::ostream &os, int seconds)
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+    const snapshot_t cur = takeSnapshot();
+
+    // the window starts at the newest history point at least `seconds`
+    // old, or the oldest one there is
+    seconds = std::max(1, std::min(seconds, HISTORY_SECONDS));
+    const snapshot_t *base = nullptr;
+    for (const auto &snap : s_history) {
+        if (!base || cur.wall_ns - snap.wall_ns >= seconds * 1000000000LL) {
+            base = &snap;
+        }
+    }
+    snapshot_t empty;
+    if (!base) {
+        empty.wall_ns = cur.wall_ns;
+        base = &empty;
+    }
+    const int64_t wall_ns = cur.wall_ns - base->wall_ns;
+
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.1f", wall_ns / 1e9);
+    os << "  \"host_cpu\":{"
+       << "\"window_s\":" << buf
+       << ",\"process_pct\":" << pct(cur.process_ns - base->process_ns, wall_ns)
+       << ",\"threads\":[";
+
+    int64_t emu_ns = -1;
+    bool first = true;
+    for (const auto &tn : cur.thread_ns) {
+        // a thread missing from the base started inside the window
+        int64_t used_ns = tn.second;
+        for (const auto &old : base->thread_ns) {
+            if (old.first == tn.first) {
+                used_ns -= old.second;
+                break;
+            }
+        }
+        if (tn.first == s_emuTid) {
+            emu_ns = used_ns;
+        }
+        const auto info = std::find_if(s_threads.begin(), s_threads.end(),
+                                       [&tn](const thread_info_t &t) { return t.tid == tn.first; });
+        os << (first ? "" : ",")
+           << "{\"name\":\"" << info->name << "\""
+           << ",\"tid\":" << tn.first
+           << ",\"cpu_pct\":" << pct(used_ns, wall_ns) << "}";
+        first = false;
+    }
+    os << "]";
+
+    // split the emulation thread's busy time in proportion to the samples
+    if (s_timerCreated && emu_ns >= 0) {
+        uint32_t counts[system2200::ACTIVITY_NUM];
+        uint64_t total = 0;
+        for (int act = 0; act < system2200::ACTIVITY_NUM; act++) {
+            counts[act] = cur.samples[act] - base->samples[act];  // wraps cleanly
+            total += counts[act];
+        }
+        os << ",\"emulation\":{\"samples\":" << total;
+        for (int act = 0; act < system2200::ACTIVITY_NUM; act++) {
+            const int64_t act_ns = total ? int64_t(emu_ns * counts[act] / total) : 0;
+            os << ",\"" << system2200::hostActivityName(act) << "\":" << pct(act_ns, wall_ns);
+        }
+        os << ",\"sleep\":" << pct(std::max<int64_t>(0, wall_ns - emu_ns), wall_ns) << "}";
+    }
+    os << "}";
+}
@@ -0,0 +1,57 @@
+#ifndef _INCLUDE_HOST_CPU_STATS_H_
+#define _INCLUDE_HOST_CPU_STATS_H_
+
+#include <ostream>
+#include <string>
+
+/**
+ * HostCpuStats - where the host's cpu cycles go
+ *
+ * Every thread of the server registers itself under a name (which also
+ * shows up in top -H and /proc/PID/task/TID/comm).  About once a second
+ * the host cpu time of each registered thread is read through its
+ * CLOCK_THREAD_CPUTIME_ID clock and kept in a short history, so the
+ * report can give rates over any of the last HISTORY_SECONDS seconds.
+ *
+ * The emulation thread's time is further split by what it was doing, as
+ * published in system2200::host_activity (cpu microcode, 8080, timer
+ * callbacks, disk transfers, other).  That split comes from a profiling
+ * timer on the thread's own cpu clock, which only ticks while the thread
+ * runs; each tick reads the current activity and counts it.  Whatever
+ * time the thread isn't on a cpu is reported as "sleep".
+ *
+ * All functions are thread safe.
+ */
+class HostCpuStats
+{
+public:
+    static constexpr int HISTORY_SECONDS = 60;
+    static constexpr int DEFAULT_WINDOW  = 10;
+
+    /**
+     * Name the calling thread and include it in the report.
+     * The main thread keeps its OS name, as that is the process name.
+     */
+    static void registerThread(const std::string &name);
+
+    /**
+     * Start splitting the calling (emulation) thread's cpu time by
+     * activity.  Returns false if the profiling timer can't be created.
+     */
+    static bool startActivitySampler();
+    static void stopActivitySampler();
+
+    /**
+     * Add a point to the history if a second has passed since the last.
+     * Cheap enough to call on every main loop iteration.
+     */
+    static void tick();
+
+    /**
+     * Write the "host_cpu" JSON member: rates averaged over the last
+     * `seconds` (clamped to the history that exists)
+     */
+    static void outputStatus(std::ostream &os, int seconds = DEFAULT_WINDOW);
+};
+
+#endif // _INCLUDE_HOST_CPU_STATS_H_
@@ -0,0 +1,389 @@
+// Hand a running system over to a newer binary.
+// See LiveUpgrade.h for the overview.
+
+#include "LiveUpgrade.h"
+#include "../session/SerialTermSession.h"
+#include "../../core/system/StateStream.h"
+#include "../../core/system/system2200.h"
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+// the header ahead of the state: magic, version, line count, state length
+constexpr int64 UPGRADE_MAGIC   = 0x47505557;  // "WUPG"
+constexpr int   UPGRADE_VERSION = 1;
+constexpr size_t HEADER_LEN     = 4 + 2 + 2 + 8;
+constexpr int   MAX_LINES       = 16;
+
+// the new server's one byte answer
+constexpr uint8 ACK  = 0x06;
+constexpr uint8 NACK = 0x15;
+
+// neither side waits longer than this on the other
+constexpr int PEER_TIMEOUT_SEC = 10;
+
+void
+setTimeouts(int fd)
+{
+    timeval tv{};
+    tv.tv_sec = PEER_TIMEOUT_SEC;
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+}
+
+bool
+sendAll(int fd, const uint8 *data, size_t len)
+{
+    while (len > 0) {
+        const ssize_t n = send(fd, data, len, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        data += n;
+        len -= n;
+    }
+    return true;
+}
+
+bool
+recvAll(int fd, uint8 *data, size_t len)
+{
+    while (len > 0) {
+        const ssize_t n = recv(fd, data, len, 0);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        data += n;
+        len -= n;
+    }
+    return true;
+}
+
+// send the header, with the descriptors attached to it
+bool
+sendHeader(int fd, const std::vector<uint8> &header, const std::vector<int> &fds)
+{
+    iovec iov = { const_cast<uint8*>(header.data()), header.size() };
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+
+    char control[CMSG_SPACE(sizeof(int) * MAX_LINES)] = {};
+    if (!fds.empty()) {
+        msg.msg_control = control;
+        msg.msg_controllen = CMSG_SPACE(sizeof(int) * fds.size());
+        cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int) * fds.size());
+        memcpy(CMSG_DATA(cmsg), fds.data(), sizeof(int) * fds.size());
+    }
+    return sendmsg(fd, &msg, MSG_NOSIGNAL) == static_cast<ssize_t>(header.size());
+}
+
+// receive the header, and any descriptors attached to it
+bool
+recvHeader(int fd, uint8 *header, std::vector<int> *fds)
+{
+    iovec iov = { header, HEADER_LEN };
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    char control[CMSG_SPACE(sizeof(int) * MAX_LINES)] = {};
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    const ssize_t n = recvmsg(fd, &msg, MSG_WAITALL | MSG_CMSG_CLOEXEC);
+    for (cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+        if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS) {
+            const size_t count = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+            for (size_t i = 0; i < count; i++) {
+                int received;
+                memcpy(&received, CMSG_DATA(cmsg) + i * sizeof(int), sizeof(int));
+                fds->push_back(received);
+            }
+        }
+    }
+    return (n == static_cast<ssize_t>(HEADER_LEN)) && !(msg.msg_flags & MSG_CTRUNC);
+}
+
+void
+closeAll(const std::vector<int> &fds)
+{
+    for (int fd : fds) {
+        close(fd);
+    }
+}
+
+} // namespace
+
+
+LiveUpgrade::LiveUpgrade(const std::string &path) :
+    m_path(path)
+{
+}
+
+
+LiveUpgrade::~LiveUpgrade()
+{
+    if (m_listen >= 0) {
+        close(m_listen);
+        unlink(m_path.c_str());
+    }
+    // last, so the new server only binds the path after it is free
+    if (m_handedOff >= 0) {
+        close(m_handedOff);
+    }
+}
+
+
+bool LiveUpgrade::start()
+{
+    sockaddr_un addr{};
+    if (m_path.size() >= sizeof(addr.sun_path)) {
+        std::cerr << "[ERROR] Upgrade socket path is too long: " << m_path << "\n";
+        return false;
+    }
+
+    m_listen = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (m_listen < 0) {
+        std::cerr << "[ERROR] Failed to create upgrade socket: " << strerror(errno) << "\n";
+        return false;
+    }
+
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, m_path.c_str(), sizeof(addr.sun_path) - 1);
+    unlink(m_path.c_str());  // left over from a previous run
+
+    // owner only: whoever connects gets the terminals and the machine
+    const mode_t oldMask = umask(0077);
+    const int rc = bind(m_listen, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+    umask(oldMask);
+
+    if (rc < 0 || listen(m_listen, 1) < 0) {
+        std::cerr << "[ERROR] Failed to listen on " << m_path << ": " << strerror(errno) << "\n";
+        close(m_listen);
+        m_listen = -1;
+        return false;
+    }
+    return true;
+}
+
+
+bool LiveUpgrade::poll(std::vector<std::shared_ptr<SerialTermSession>> &sessions)
+{
+    if (m_listen < 0) {
+        return false;
+    }
+    const int conn = ::accept4(m_listen, nullptr, nullptr, SOCK_CLOEXEC);
+    if (conn < 0) {
+        return false;
+    }
+
+    std::cerr << "[INFO] Live upgrade: a new server is taking over\n";
+    if (!handOver(conn, sessions)) {
+        close(conn);
+        std::cerr << "[INFO] Live upgrade: not handed over, carrying on\n";
+        return false;
+    }
+    m_handedOff = conn;
+    std::cerr << "[INFO] Live upgrade: handed over, exiting\n";
+    return true;
+}
+
+
+// runs between timeslices, so the cpu is between instructions and no
+// timer is firing; the emulation simply doesn't continue until this returns
+bool LiveUpgrade::handOver(int conn, std::vector<std::shared_ptr<SerialTermSession>> &sessions)
+{
+    setTimeouts(conn);
+
+    // stop the lines first, so nothing arrives after the state is taken
+    std::vector<Line> lines;
+    std::vector<std::shared_ptr<SerialPort>> ports;
+    for (size_t i = 0; i < sessions.size() && lines.size() < MAX_LINES; i++) {
+        if (sessions[i]) {
+            sessions[i]->flushOutput(true);     // queue any held run with the rest
+        }
+        auto port = sessions[i] ? sessions[i]->getSerialPort() : nullptr;
+        Line line{ static_cast<int>(i), {} };
+        if (port && port->release(&line.state)) {
+            lines.push_back(std::move(line));
+            ports.push_back(port);
+        }
+    }
+    auto takeBack = [&]() {
+        for (size_t i = 0; i < lines.size(); i++) {
+            if (!ports[i]->reclaim(lines[i].state)) {
+                std::cerr << "[WARN] Live upgrade: terminal " << lines[i].term
+                          << " couldn't be restarted\n";
+            }
+        }
+    };
+
+    StateWriter state;
+    bool ok = system2200::saveState(state);
+    if (ok) {
+        state.put16(static_cast<int>(lines.size()));
+        for (auto const &line : lines) {
+            state.put16(line.term);
+            state.putBool(line.state.xoffSent);
+            state.putBool(line.state.rtsAsserted);
+            state.putBool(line.state.txStopped);
+            state.put32(static_cast<int64>(line.state.pendingTx.size()));
+            state.putBytes(line.state.pendingTx.data(), line.state.pendingTx.size());
+        }
+    }
+
+    // an empty state tells the client the system can't be handed over now
+    StateWriter header;
+    header.put32(UPGRADE_MAGIC);
+    header.put16(UPGRADE_VERSION);
+    header.put16(ok ? static_cast<int>(lines.size()) : 0);
+    header.put64(ok ? static_cast<int64>(state.data().size()) : 0);
+
+    std::vector<int> fds;
+    if (ok) {
+        for (auto const &line : lines) {
+            fds.push_back(line.state.fd);
+        }
+    }
+    if (!sendHeader(conn, header.data(), fds) || !ok
+        || !sendAll(conn, state.data().data(), state.data().size())) {
+        takeBack();
+        return false;
+    }
+
+    uint8 reply = NACK;
+    if (!recvAll(conn, &reply, 1) || reply != ACK) {
+        std::cerr << "[WARN] Live upgrade: the new server didn't take over\n";
+        takeBack();
+        return false;
+    }
+
+    // the new server has its own copies now
+    for (auto const &line : lines) {
+        close(line.state.fd);
+    }
+    return true;
+}
+
+
+int LiveUpgrade::takeOver(const std::string &path, std::vector<Line> *lines)
+{
+    sockaddr_un addr{};
+    if (path.size() >= sizeof(addr.sun_path)) {
+        std::cerr << "[ERROR] Upgrade socket path is too long: " << path << "\n";
+        return -1;
+    }
+    const int conn = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (conn < 0) {
+        std::cerr << "[ERROR] Failed to create upgrade socket: " << strerror(errno) << "\n";
+        return -1;
+    }
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+    if (connect(conn, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        std::cerr << "[ERROR] Failed to connect to " << path << ": " << strerror(errno) << "\n";
+        close(conn);
+        return -1;
+    }
+    setTimeouts(conn);
+
+    uint8 hdr[HEADER_LEN];
+    std::vector<int> fds;
+    if (!recvHeader(conn, hdr, &fds)) {
+        std::cerr << "[ERROR] Live upgrade: no answer from the running server\n";
+        closeAll(fds);
+        close(conn);
+        return -1;
+    }
+    StateReader header(hdr, sizeof(hdr));
+    const bool compatible = (header.get32() == UPGRADE_MAGIC)
+                         && (header.get16() == UPGRADE_VERSION);
+    const size_t numLines = static_cast<size_t>(header.get16());
+    const size_t length = static_cast<size_t>(header.get64());
+    if (!compatible || (length == 0) || (numLines != fds.size())) {
+        std::cerr << (compatible ? "[ERROR] Live upgrade: the running server can't hand over at the moment\n"
+                                 : "[ERROR] Live upgrade: the running server is an incompatible version\n");
+        closeAll(fds);
+        close(conn);
+        return -1;
+    }
+
+    std::vector<uint8> blob(length);
+    bool ok = recvAll(conn, blob.data(), blob.size());
+    StateReader state(blob.data(), blob.size());
+    ok = ok && system2200::restoreState(state);
+    if (ok && (static_cast<size_t>(state.get16()) == numLines)) {
+        for (size_t i = 0; i < numLines; i++) {
+            Line line;
+            line.term = state.get16();
+            line.state.fd = fds[i];
+            line.state.xoffSent = state.getBool();
+            line.state.rtsAsserted = state.getBool();
+            line.state.txStopped = state.getBool();
+            const size_t pending = static_cast<size_t>(state.get32());
+            if (pending > blob.size()) {
+                state.fail();
+                break;
+            }
+            line.state.pendingTx.resize(pending);
+            state.getBytes(line.state.pendingTx.data(), pending);
+            lines->push_back(std::move(line));
+        }
+    }
+    ok = ok && state.ok();
+
+    if (!ok) {
+        std::cerr << "[ERROR] Live upgrade: couldn't restore the running system\n";
+        const uint8 nack = NACK;
+        sendAll(conn, &nack, 1);
+        lines->clear();
+        closeAll(fds);
+        close(conn);
+        return -1;
+    }
+    return conn;
+}
+
+
+bool LiveUpgrade::finishTakeOver(int conn, bool adoptedAll)
+{
+    if (!adoptedAll) {
+        // the old server takes its lines back and carries on
+        std::cerr << "[ERROR] Live upgrade: not every serial line could be taken over\n";
+        const uint8 nack = NACK;
+        sendAll(conn, &nack, 1);
+        close(conn);
+        return false;
+    }
+
+    const uint8 ack = ACK;
+    if (!sendAll(conn, &ack, 1)) {
+        std::cerr << "[ERROR] Live upgrade: the running server stopped waiting for us\n";
+        close(conn);
+        return false;
+    }
+
+    // the old server closes the connection as it exits
+    uint8 dummy;
+    while (recv(conn, &dummy, 1, 0) > 0) {
+    }
+    close(conn);
+    std::cerr << "[INFO] Live upgrade: took over from the previous server\n";
+    return true;
+}
@@ -0,0 +1,77 @@
+#ifndef _INCLUDE_LIVE_UPGRADE_H_
+#define _INCLUDE_LIVE_UPGRADE_H_
+
+#include "../../platform/common/SerialPort.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+class SerialTermSession;
+
+/**
+ * LiveUpgrade - hand a running system over to a newer binary
+ *
+ * The running server listens on a local (unix domain) socket.  A new
+ * server started with --take-over=PATH connects to it, and the old one
+ * stops its serial lines without closing them, saves the machine state
+ * (cpu, memory, cards, pending timers), and sends both across: the open
+ * descriptors with SCM_RIGHTS, the state as a byte stream.  The new one
+ * restores the state into its freshly initialized system, adopts the
+ * lines, and acknowledges; only then does the old one exit.  The
+ * terminals don't notice anything beyond a short pause.
+ *
+ * If the state can't be saved (eg, the debugger has the cpu stopped) or
+ * the new server can't restore it or can't set up every line (eg, a
+ * different configuration), the old one takes its lines back and carries
+ * on.
+ *
+ * The listening sockets (web, debugger, upgrade) are not passed along;
+ * the new server opens its own once the old one is gone.
+ */
+class LiveUpgrade
+{
+public:
+    // a serial line handed over, and the terminal it belongs to
+    struct Line {
+        int term;
+        SerialPort::HandoffState state;
+    };
+
+    explicit LiveUpgrade(const std::string &path);
+    ~LiveUpgrade();
+
+    // ---- the running server ----
+
+    // create the listening socket; returns false on error
+    bool start();
+
+    // the descriptor the main loop should wait on (-1 if not started)
+    int waitFd() const { return m_listen; }
+
+    // hand the system to a waiting client, if any.  returns true once
+    // the new server has taken over, and this one should exit.
+    bool poll(std::vector<std::shared_ptr<SerialTermSession>> &sessions);
+
+    // ---- the new server ----
+
+    // connect to the server behind path, restore its machine state into
+    // this (freshly initialized) system, and receive its serial lines.
+    // returns the connection for finishTakeOver(), or -1 on failure, in
+    // which case the old server carries on.
+    static int takeOver(const std::string &path, std::vector<Line> *lines);
+
+    // tell the old server we have taken over, and wait for it to exit.
+    // if not every line could be adopted, tell it to carry on instead.
+    // returns false unless the old server is gone and we should run.
+    static bool finishTakeOver(int conn, bool adoptedAll);
+
+private:
+    const std::string m_path;
+    int m_listen = -1;
+    int m_handedOff = -1;   // kept open until exit; its EOF tells the
+                            // new server we are gone
+
+    bool handOver(int conn, std::vector<std::shared_ptr<SerialTermSession>> &sessions);
+};
+
+#endif // _INCLUDE_LIVE_UPGRADE_H_
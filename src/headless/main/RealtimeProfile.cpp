@@ -0,0 +1,176 @@
+// Real-time execution profile for the terminal server
+// Pins threads, optionally uses SCHED_FIFO with a bounded duty cycle,
+// locks memory, and tracks main loop scheduling jitter.
+
+#include "RealtimeProfile.h"
+#include <iostream>
+#include <cerrno>
+#include <cstring>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+RealtimeProfile::RealtimeProfile(const Settings &settings) :
+    m_settings(settings),
+    m_windowStart(clock::now())
+{
+    if (m_settings.fifoPriority < 1)   m_settings.fifoPriority = 1;
+    if (m_settings.fifoPriority > 99)  m_settings.fifoPriority = 99;
+    if (m_settings.dutyPercent < 10)   m_settings.dutyPercent = 10;
+    if (m_settings.dutyPercent > 100)  m_settings.dutyPercent = 100;
+}
+
+bool RealtimeProfile::pinCurrentThread(int cpu)
+{
+    const long ncpus = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cpu < 0 || cpu >= ncpus) {
+        std::cerr << "[WARN] Realtime: CPU " << cpu << " not available (" << ncpus << " online)\n";
+        return false;
+    }
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    const int err = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    if (err != 0) {
+        std::cerr << "[WARN] Realtime: failed to pin thread to CPU " << cpu
+                  << ": " << strerror(err) << "\n";
+        return false;
+    }
+    return true;
+}
+
+int RealtimeProfile::setCurrentThreadFifo(bool fifo)
+{
+    sched_param param{};
+    param.sched_priority = fifo ? m_settings.fifoPriority : 0;
+    return pthread_setschedparam(pthread_self(), fifo ? SCHED_FIFO : SCHED_OTHER, &param);
+}
+
+void RealtimeProfile::applyToEmulationThread()
+{
+    if (!m_settings.enabled) {
+        return;
+    }
+
+    if (m_settings.emuCpu >= 0) {
+        m_emuPinned = pinCurrentThread(m_settings.emuCpu);
+        if (m_emuPinned) {
+            std::cerr << "[INFO] Realtime: emulation thread pinned to CPU " << m_settings.emuCpu << "\n";
+        }
+    }
+
+    if (m_settings.schedFifo) {
+        const int err = setCurrentThreadFifo(true);
+        m_emuFifo = (err == 0);
+        if (m_emuFifo) {
+            std::cerr << "[INFO] Realtime: emulation thread SCHED_FIFO priority " << m_settings.fifoPriority
+                      << ", duty cycle " << m_settings.dutyPercent << "%\n";
+        } else {
+            std::cerr << "[WARN] Realtime: SCHED_FIFO not permitted (" << strerror(err)
+                      << "), continuing with normal scheduling\n";
+        }
+    }
+
+    if (m_settings.lockMemory) {
+        // MCL_CURRENT faults in every mapped page, including emulated RAM
+        // and microcode store; MCL_FUTURE covers RAM reallocated when the
+        // system is reconfigured.
+        if (mlockall(MCL_CURRENT | MCL_FUTURE) == 0) {
+            m_memLocked = true;
+            std::cerr << "[INFO] Realtime: process memory locked\n";
+        } else {
+            std::cerr << "[WARN] Realtime: mlockall failed (" << strerror(errno)
+                      << "), memory may be paged\n";
+        }
+
+        // pre-fault stack for the emulation thread so deep call chains
+        // don't take page faults on the first run through
+        volatile unsigned char stack_prefault[256 * 1024];
+        for (size_t i = 0; i < sizeof(stack_prefault); i += 4096) {
+            stack_prefault[i] = 0;
+        }
+    }
+
+    m_windowStart = clock::now();
+    m_windowBusy = clock::duration::zero();
+}
+
+void RealtimeProfile::applyToSerialThread()
+{
+    if (!m_settings.enabled) {
+        return;
+    }
+
+    if (m_settings.serialCpu >= 0 && pinCurrentThread(m_settings.serialCpu)) {
+        m_serialThreadsPinned.fetch_add(1);
+    }
+
+    if (m_settings.schedFifo) {
+        const int err = setCurrentThreadFifo(true);
+        if (err == 0) {
+            m_serialThreadsFifo.fetch_add(1);
+        } else if (!m_warnedSerial.exchange(true)) {
+            std::cerr << "[WARN] Realtime: SCHED_FIFO not permitted for serial threads ("
+                      << strerror(err) << ")\n";
+        }
+    }
+}
+
+void RealtimeProfile::noteWakeup(clock::time_point deadline, clock::time_point woke)
+{
+    const int64_t late_us = std::chrono::duration_cast<std::chrono::microseconds>(woke - deadline).count();
+    m_wakeups++;
+    if (late_us > 0) {
+        m_latenessSum += late_us;
+        if (late_us > m_latenessMax) {
+            m_latenessMax = late_us;
+        }
+    }
+    if (woke - deadline > MISSED_DEADLINE) {
+        m_missed++;
+    }
+}
+
+void RealtimeProfile::noteBusy(clock::duration busy)
+{
+    if (!m_emuFifo) {
+        return;
+    }
+
+    const auto now = clock::now();
+    if (now - m_windowStart >= DUTY_WINDOW) {
+        // new window: restore real-time priority if we had backed off
+        if (m_throttled) {
+            setCurrentThreadFifo(true);
+            m_throttled = false;
+        }
+        m_windowStart = now;
+        m_windowBusy = clock::duration::zero();
+    }
+
+    m_windowBusy += busy;
+    if (!m_throttled && m_windowBusy * 100 > DUTY_WINDOW * m_settings.dutyPercent) {
+        setCurrentThreadFifo(false);
+        m_throttled = true;
+        m_throttleCount++;
+    }
+}
+
+void RealtimeProfile::outputStatus(std::ostream &os) const
+{
+    os << "  \"realtime\":{"
+       << "\"enabled\":" << (m_settings.enabled ? "true" : "false")
+       << ",\"emu_pinned\":" << (m_emuPinned ? "true" : "false")
+       << ",\"emu_fifo\":" << (m_emuFifo ? "true" : "false")
+       << ",\"mem_locked\":" << (m_memLocked ? "true" : "false")
+       << ",\"serial_pinned\":" << m_serialThreadsPinned.load()
+       << ",\"serial_fifo\":" << m_serialThreadsFifo.load()
+       << ",\"duty_throttles\":" << m_throttleCount
+       << ",\"wakeups\":" << m_wakeups
+       << ",\"missed_deadlines\":" << m_missed
+       << ",\"avg_late_us\":" << (m_wakeups ? (m_latenessSum / static_cast<int64_t>(m_wakeups)) : 0)
+       << ",\"max_late_us\":" << m_latenessMax
+       << "}";
+}
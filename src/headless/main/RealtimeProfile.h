@@ -0,0 +1,108 @@
+#ifndef _INCLUDE_REALTIME_PROFILE_H_
+#define _INCLUDE_REALTIME_PROFILE_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+/**
+ * RealtimeProfile - opt-in deterministic scheduling for dedicated appliances
+ *
+ * When enabled, the emulation thread and the serial receive threads are
+ * pinned to configured cores, optionally run under SCHED_FIFO, and all
+ * process memory (including emulated RAM) is locked and pre-faulted.
+ *
+ * SCHED_FIFO is bounded by a duty cycle: if the emulation thread is busy
+ * for more than dutyPercent of a 100ms window it drops back to
+ * SCHED_OTHER until the window ends, so a runaway guest program cannot
+ * starve the rest of the system.
+ *
+ * Every step degrades gracefully: if a call fails (typically EPERM when
+ * not running as root or without CAP_SYS_NICE / CAP_IPC_LOCK) a warning
+ * is logged once and the server runs with whatever was granted.
+ *
+ * Main loop wake-ups are compared against their deadlines and the
+ * resulting jitter and missed-deadline counts are reported in the
+ * SIGUSR1 status dump, whether or not the profile is enabled.
+ */
+class RealtimeProfile
+{
+public:
+    using clock = std::chrono::steady_clock;
+
+    struct Settings {
+        bool enabled       = false;  // master switch
+        int  emuCpu        = -1;     // core for the emulation thread (-1 = don't pin)
+        int  serialCpu     = -1;     // core for serial receive threads (-1 = don't pin)
+        bool schedFifo     = false;  // run emulation + serial threads SCHED_FIFO
+        int  fifoPriority  = 50;     // SCHED_FIFO priority (1..99)
+        int  dutyPercent   = 80;     // max share of each window under SCHED_FIFO
+        bool lockMemory    = true;   // mlockall() + pre-fault
+    };
+
+    explicit RealtimeProfile(const Settings &settings);
+
+    /**
+     * Apply the profile to the calling (emulation) thread and lock memory.
+     * Call after the emulated system has been built and after any helper
+     * threads that should not inherit the profile have been started.
+     */
+    void applyToEmulationThread();
+
+    /**
+     * Apply the profile to the calling serial receive thread.
+     * Safe to call concurrently from several threads.
+     */
+    void applyToSerialThread();
+
+    /**
+     * Record a main loop wake-up against the deadline it was waiting for
+     */
+    void noteWakeup(clock::time_point deadline, clock::time_point woke);
+
+    /**
+     * Record time the emulation thread spent working (not sleeping);
+     * enforces the SCHED_FIFO duty cycle bound.
+     */
+    void noteBusy(clock::duration busy);
+
+    /**
+     * Write the "realtime" JSON member for the status dump
+     */
+    void outputStatus(std::ostream &os) const;
+
+private:
+    // wake-ups later than this count as a missed deadline
+    static constexpr auto MISSED_DEADLINE = std::chrono::milliseconds(2);
+    // duty cycle accounting window
+    static constexpr auto DUTY_WINDOW = std::chrono::milliseconds(100);
+
+    bool pinCurrentThread(int cpu);
+    // returns 0, or the error number pthread_setschedparam() gave
+    int setCurrentThreadFifo(bool fifo);
+
+    Settings m_settings;
+
+    // what was actually granted
+    bool m_emuPinned  = false;
+    bool m_emuFifo    = false;
+    bool m_memLocked  = false;
+    std::atomic<int> m_serialThreadsPinned{0};
+    std::atomic<int> m_serialThreadsFifo{0};
+    std::atomic<bool> m_warnedSerial{false};
+
+    // jitter statistics (emulation thread only)
+    uint64_t m_wakeups      = 0;
+    uint64_t m_missed       = 0;
+    int64_t  m_latenessSum  = 0;  // us
+    int64_t  m_latenessMax  = 0;  // us
+
+    // duty cycle state (emulation thread only)
+    clock::time_point m_windowStart;
+    clock::duration   m_windowBusy{0};
+    bool              m_throttled   = false;
+    uint64_t          m_throttleCount = 0;
+};
+
+#endif // _INCLUDE_REALTIME_PROFILE_H_
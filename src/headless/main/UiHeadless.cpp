@@ -45,12 +45,6 @@ void UI_setSimSeconds(unsigned long seconds, float relative_speed)
     }
 }
 
-// Disk events
-void UI_diskEvent(int /*slot*/, int /*drive*/)
-{
-    // no-op for terminal server, or could log
-}
-
 // Printer functions - no-ops for terminal server
 std::shared_ptr<PrinterFrame> UI_printerInit(int io_addr)
 {
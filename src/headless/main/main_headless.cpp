@@ -13,8 +13,19 @@
 #include "../../core/io/IoCardTermMux.h"
 #include "../../core/io/IoCard.h"
 #include "../../core/system/Scheduler.h"
+#include "../../core/disk/WvdRemote.h"
 #include "../terminal/WebConfigServer.h"
+#include "RealtimeProfile.h"
+#include "DiskProvision.h"
+#include "BatchJob.h"
+#include "DebugServer.h"
+#include "HostCpuStats.h"
+#include "Fanout.h"
+#include "EmuCommandQueue.h"
+#include "LiveUpgrade.h"
+#include "DiskServer.h"
 #include "../../shared/config/SysCfgState.h"
+#include "../../shared/config/CardInfo.h"
 #include <iostream>
 #include <csignal>
 #include <chrono>
@@ -34,18 +45,16 @@
 // Global state for graceful shutdown
 static volatile bool running = true;
 static volatile bool dumpStatus = false;
-static volatile bool internalRestartRequested = false;
+static bool batchMode = false;
 static std::vector<std::shared_ptr<SerialTermSession>> sessions;
 static IoCardTermMux* termMux = nullptr;
+static std::unique_ptr<RealtimeProfile> rtProfile;
+static std::unique_ptr<DebugServer> debugServer;
+static std::unique_ptr<LiveUpgrade> liveUpgrade;
 #ifndef DISABLE_WEBCONFIG
 static std::unique_ptr<WebConfigServer> webServer;
 #endif
 
-// Function to request internal restart from web server (thread-safe)
-void requestInternalRestart() {
-    internalRestartRequested = true;
-}
-
 // Signal handler for graceful shutdown
 void signalHandler(int signal) {
     if (signal == SIGUSR1) {
@@ -63,11 +72,63 @@ void signalHandler(int signal) {
         }
         
         if (signal == SIGTERM || signal == SIGINT) {
-            exit(0);
+            exit(batchMode ? BatchJob::EXIT_ERROR : 0);
         }
     }
 }
 
+// Emit one profiler record as JSON: event counts and host time per event
+static void outputIoProfileCounters(const system2200::ioprof_t &prof) {
+    std::cout << "\"reselects\":" << prof.reselects;
+    for (int ev = 0; ev < system2200::IOPROF_NUM_EVENTS; ++ev) {
+        const char *name = system2200::ioProfileEventName(ev);
+        std::cout << ",\"" << name << "\":" << prof.count[ev]
+                  << ",\"" << name << "_us\":" << (prof.host_ns[ev] / 1000);
+    }
+}
+
+// Generate the "io_profile" JSON member: per-card breakdown, then every
+// I/O address which has seen any bus traffic
+static void outputIoProfile() {
+    std::cout << "  \"io_profile\":{" << std::endl;
+    std::cout << "    \"cards\":[";
+    bool first = true;
+    for (int slot = 0; slot < NUM_IOSLOTS; ++slot) {
+        int cardtype_idx = 0, io_addr = 0;
+        if (!system2200::getSlotInfo(slot, &cardtype_idx, &io_addr)) {
+            continue;
+        }
+        std::cout << (first ? "" : ",") << std::endl;
+        first = false;
+        const auto cardtype = static_cast<IoCard::card_t>(cardtype_idx);
+        std::cout << "      {\"slot\":" << slot
+                  << ",\"card\":\"" << CardInfo::getCardName(cardtype) << "\""
+                  << ",\"addr\":" << io_addr << ",";
+        outputIoProfileCounters(system2200::getIoProfileBySlot(slot));
+        std::cout << "}";
+    }
+    std::cout << std::endl << "    ]," << std::endl;
+    std::cout << "    \"addresses\":[";
+    first = true;
+    for (int addr = 0; addr < 256; ++addr) {
+        const auto &prof = system2200::getIoProfileByAddr(addr);
+        uint64_t total = prof.reselects;
+        for (auto cnt : prof.count) {
+            total += cnt;
+        }
+        if (total == 0) {
+            continue;
+        }
+        std::cout << (first ? "" : ",") << std::endl;
+        first = false;
+        std::cout << "      {\"addr\":" << addr << ",";
+        outputIoProfileCounters(prof);
+        std::cout << "}";
+    }
+    std::cout << std::endl << "    ]" << std::endl;
+    std::cout << "  }";
+}
+
 // Generate runtime JSON status with statistics
 void outputRuntimeStatus() {
     std::cout << "{" << std::endl;
@@ -92,11 +153,40 @@ void outputRuntimeStatus() {
         } else {
             std::cout << ",\"active\":false";
         }
+        if (termMux) {
+            IoCardTermMux::rx_flow_stats_t fc;
+            termMux->getRxFlowStats(static_cast<int>(i), &fc);
+            std::cout << ",\"rx_flow\":{"
+                      << "\"fifo\":" << fc.fifo_size
+                      << ",\"xoff_level\":" << fc.xoff_level
+                      << ",\"xon_level\":" << fc.xon_level
+                      << ",\"mode\":\"" << (fc.hw_flow ? "rtscts" : "xonxoff") << "\""
+                      << ",\"throttled\":" << (fc.throttled ? "true" : "false")
+                      << ",\"drain_bps\":" << fc.drain_bps
+                      << ",\"rtt_us\":" << fc.link_rtt_us
+                      << ",\"skid_bytes\":" << fc.skid_bytes
+                      << ",\"overrun_drops\":" << fc.rx_overrun_drops
+                      << ",\"stalls\":" << fc.xoff_sent_count
+                      << ",\"stalled_ms\":" << fc.throttled_us / 1000
+                      << ",\"longest_stall_ms\":" << fc.longest_throttle_us / 1000
+                      << ",\"dry_after_xon\":" << fc.dry_after_xon
+                      << "}";
+        }
         std::cout << "}";
     }
     
-    std::cout << std::endl << "  ]" << std::endl;
-    std::cout << "}" << std::endl;
+    std::cout << std::endl << "  ]";
+    if (rtProfile) {
+        std::cout << "," << std::endl;
+        rtProfile->outputStatus(std::cout);
+    }
+    std::cout << "," << std::endl;
+    HostCpuStats::outputStatus(std::cout);
+    if (system2200::isIoProfileEnabled()) {
+        std::cout << "," << std::endl;
+        outputIoProfile();
+    }
+    std::cout << std::endl << "}" << std::endl;
     std::cout.flush();
 }
 
@@ -150,6 +240,16 @@ int main(int argc, char* argv[]) {
         if (!config.parseCommandLine(argc, argv)) {
             return config.shouldExitCleanly() ? 0 : 1; // Clean exit for help/status
         }
+
+        // Disk provisioning mode: create the images and exit
+        if (!config.createDisks.empty()) {
+            return (DiskProvision::createImages(config.createDisks, config.preallocateDisks) == 0) ? 0 : 1;
+        }
+
+        // Disk server mode: share the images until stopped
+        if (!config.serveDisks.empty()) {
+            return DiskServer::run(config.serveDisks, config.servePort);
+        }
         
         // Load from specific INI file if provided, otherwise use default
         if (!config.iniPath.empty()) {
@@ -166,6 +266,8 @@ int main(int argc, char* argv[]) {
         
         config.printSummary();
         
+        rtProfile = std::make_unique<RealtimeProfile>(config.realtime);
+        
     } catch (const std::exception& e) {
         std::cerr << "[ERROR] Configuration error: " << e.what() << "\n";
         return 1;
@@ -182,8 +284,14 @@ int main(int argc, char* argv[]) {
     try {
         // Initialize the system2200 emulator core
         std::cerr << "[INFO] Initializing Wang 2200 emulator...\n";
+        WvdRemote::setCache(config.diskCacheDir, config.diskCacheMB);
         system2200::initialize();
         system2200_initialized = true;
+
+        if (config.ioProfile) {
+            system2200::enableIoProfile(true);
+            std::cerr << "[INFO] I/O bus profiler enabled (send SIGUSR1 for report)\n";
+        }
         
         // Find the MXD card at the configured address
         // Note: MXD cards claim addresses base_addr+1 to base_addr+7, not base_addr itself
@@ -205,9 +313,99 @@ int main(int argc, char* argv[]) {
         }
         
         std::cerr << "[INFO] Found MXD Terminal Multiplexer card\n";
+
+        // Batch mode: the script stands in for the terminals, then exit
+        if (config.batch.enabled()) {
+            // Parallel jobs often share one INI; leave it alone
+            batchMode = true;
+            host::setConfigSaveOnExit(false);
+            const int status = BatchJob(config.batch, termMux).run();
+            system2200::cleanup();
+            host::terminate();
+            return status;
+        }
+        
+        // Fan-out: everything below happens once in each forked worker
+        if (config.fanout.enabled()) {
+            // Dozens of processes share one INI; leave it alone
+            host::setConfigSaveOnExit(false);
+            const int worker = Fanout(config.fanout, termMux).run();
+            if (worker < 0) {
+                system2200::cleanup();
+                host::terminate();
+                return (worker == Fanout::REFUSED) ? 1 : 0;
+            }
+            config.specializeForWorker(worker);
+            std::cerr << "[INFO] Fan-out worker " << worker << " starting\n";
+        }
         
         // Create and configure terminal sessions
         sessions.resize(config.numTerminals);
+
+        // Live upgrade: continue the system another server is running,
+        // on the serial lines it already has open
+        if (!config.takeOver.empty()) {
+            std::vector<LiveUpgrade::Line> lines;
+            const int conn = LiveUpgrade::takeOver(config.takeOver, &lines);
+            if (conn < 0) {
+                host::setConfigSaveOnExit(false);
+                system2200::cleanup();
+                host::terminate();
+                return 1;
+            }
+            // every line has to come across, or the old server keeps them
+            // all; none is read or written until the old server has gone
+            bool adoptedAll = true;
+            std::vector<std::shared_ptr<SerialPort>> adopted;
+            for (auto &line : lines) {
+                const int i = line.term;
+                if (adoptedAll && (i >= config.numTerminals)) {
+                    std::cerr << "[ERROR] Terminal " << i << " isn't configured here, so it can't be taken over\n";
+                    adoptedAll = false;
+                }
+                if (!adoptedAll) {
+                    close(line.state.fd);
+                    continue;
+                }
+                auto serialPort = std::make_shared<SerialPort>(termMux->getScheduler());
+                serialPort->setThreadInitCallback([i] {
+                    HostCpuStats::registerThread("term" + std::to_string(i) + "-rx");
+                    rtProfile->applyToSerialThread();
+                });
+                if (config.captureEnabled && !config.captureDir.empty()) {
+                    serialPort->setCaptureCallback(createCaptureCallback(i, config.captureDir));
+                }
+                if (!serialPort->adopt(config.terminals[i].toSerialConfig(), line.state)) {
+                    std::cerr << "[ERROR] Terminal " << i << " couldn't be taken over on "
+                              << config.terminals[i].portName << "\n";
+                    adoptedAll = false;
+                    continue;
+                }
+                adopted.push_back(serialPort);
+                sessions[i] = std::make_shared<SerialTermSession>(serialPort, createTermToMxdCallback(i));
+                sessions[i]->setCompression(config.terminals[i].compress);
+                termMux->setSession(i, sessions[i]);
+                std::cerr << "[INFO] Terminal " << i << " taken over on " << config.terminals[i].portName << "\n";
+            }
+            if (!LiveUpgrade::finishTakeOver(conn, adoptedAll)) {
+                host::setConfigSaveOnExit(false);
+                for (auto &port : adopted) {
+                    port->abandonAdopted();
+                }
+                for (int i = 0; i < config.numTerminals; i++) {
+                    if (sessions[i]) {
+                        termMux->setSession(i, nullptr);
+                        sessions[i].reset();
+                    }
+                }
+                system2200::cleanup();
+                host::terminate();
+                return 1;
+            }
+            for (auto &port : adopted) {
+                port->startAdopted();
+            }
+        }
         
         // Debug: Print terminal configuration
         std::cerr << "[DEBUG] Terminal server configuration:\n";
@@ -217,6 +415,10 @@ int main(int argc, char* argv[]) {
         }
         
         for (int i = 0; i < config.numTerminals; i++) {
+            if (sessions[i]) {
+                continue;  // taken over above
+            }
+
             // Skip if terminal has no port configured
             if (config.terminals[i].portName.empty()) {
                 std::cerr << "[INFO] Terminal " << i << " has no port configured, skipping\n";
@@ -242,6 +444,10 @@ int main(int argc, char* argv[]) {
             // Create serial port using the shared scheduler from termMux
             auto scheduler = termMux->getScheduler();
             auto serialPort = std::make_shared<SerialPort>(scheduler);
+            serialPort->setThreadInitCallback([i] {
+                HostCpuStats::registerThread("term" + std::to_string(i) + "-rx");
+                rtProfile->applyToSerialThread();
+            });
             
             // Open serial port
             SerialConfig serialConfig = config.terminals[i].toSerialConfig();
@@ -261,6 +467,7 @@ int main(int argc, char* argv[]) {
             // Create session with Terminal → MXD callback
             auto termToMxdCallback = createTermToMxdCallback(i);
             sessions[i] = std::make_shared<SerialTermSession>(serialPort, termToMxdCallback);
+            sessions[i]->setCompression(config.terminals[i].compress);
             
             // Connect session to MXD
             termMux->setSession(i, sessions[i]);
@@ -287,6 +494,37 @@ int main(int argc, char* argv[]) {
 #else
         std::cerr << "[INFO] Web configuration server disabled in this build\n";
 #endif
+
+        // Microcode debugger; serviced from the main loop below
+        if (!config.debugSocket.empty()) {
+            debugServer = std::make_unique<DebugServer>(config.debugSocket);
+            if (debugServer->start()) {
+                std::cerr << "[INFO] Microcode debugger listening on " << config.debugSocket << "\n";
+            } else {
+                debugServer.reset();
+            }
+        }
+
+        // Live upgrade; serviced from the main loop below
+        if (!config.upgradeSocket.empty()) {
+            liveUpgrade = std::make_unique<LiveUpgrade>(config.upgradeSocket);
+            if (liveUpgrade->start()) {
+                std::cerr << "[INFO] Live upgrade offered on " << config.upgradeSocket << "\n";
+            } else {
+                liveUpgrade.reset();
+            }
+        }
+        
+        // Apply the real-time profile last so helper threads started above
+        // (web server) don't inherit the emulation thread's pinning/priority
+        rtProfile->applyToEmulationThread();
+
+        // Host cpu accounting; the sampler must be started on this thread
+        HostCpuStats::registerThread("emulation");
+        if (!HostCpuStats::startActivitySampler()) {
+            std::cerr << "[WARN] Emulation thread time won't be split by activity\n";
+        }
+        HostCpuStats::tick();
         
         std::cerr << "[INFO] Wang 2200 system ready for terminal connections\n";
         std::cerr << "[INFO] Press Ctrl+C to shutdown gracefully\n";
@@ -329,46 +567,50 @@ int main(int argc, char* argv[]) {
         static int totalRapidTimers = 0; // Track total over time window
 
         while (running) {
+            HostCpuStats::tick();
+
             // Check for status dump request
             if (dumpStatus) {
                 outputRuntimeStatus();
                 dumpStatus = false;
             }
             
-            // Check for internal restart request (safer than doing it in web handler)
-            if (internalRestartRequested) {
-                std::cerr << "[INFO] Internal restart requested, performing safe system reconfiguration...\n";
-                
-                try {
-                    // Reload host configuration from file (same as web handler)
-                    std::string iniPath = config.iniPath.empty() ? "wangemu.ini" : config.iniPath;
-                    host::loadConfigFile(iniPath);
-                    std::cerr << "[INFO] Host configuration reloaded from " << iniPath << "\n";
-                    
-                    // Create new system configuration from host config
-                    SysCfgState newConfig;
-                    newConfig.loadIni();
-                    std::cerr << "[DEBUG] System configuration loaded from host config\n";
-                    std::cerr << "[DEBUG] CPU Type: " << newConfig.getCpuType() << "\n";
-                    std::cerr << "[DEBUG] RAM Size: " << newConfig.getRamKB() << " KB\n";
-                    
-                    // Apply the configuration (this is now safe because we're in the main thread)
-                    system2200::setConfig(newConfig);
-                    std::cerr << "[INFO] System configuration applied - internal restart complete\n";
-                    
-                } catch (const std::exception& e) {
-                    std::cerr << "[ERROR] Internal restart failed: " << e.what() << "\n";
-                } catch (...) {
-                    std::cerr << "[ERROR] Internal restart failed: unknown error\n";
-                }
-                
-                internalRestartRequested = false;
-            }
+            // Run whatever the web server has asked for
+            EmuCommandQueue::drain();
             
             // Call the core emulator's idle processing
+            const auto idleStart = clock::now();
             if (!system2200::onIdle()) {
                 break;
             }
+            rtProfile->noteBusy(clock::now() - idleStart);
+
+            // Runs held back by output compression go out shortly after
+            // they start, so a wait for input (or a stop in the debugger)
+            // never leaves part of the screen unsent
+            for (const auto& session : sessions) {
+                if (session) {
+                    session->flushOutput();
+                }
+            }
+
+            if (debugServer) {
+                debugServer->poll();
+                if (debugServer->cpuStopped()) {
+                    // nothing is emulated until the debugger resumes,
+                    // so just wait for its next command
+                    pollfd dbgPfd[2] = {
+                        { .fd = debugServer->waitFd(), .events = POLLIN, .revents = 0 },
+                        { .fd = EmuCommandQueue::waitFd(), .events = POLLIN, .revents = 0 },
+                    };
+                    ::poll(dbgPfd, 2, 100);
+                    continue;
+                }
+            }
+
+            if (liveUpgrade && liveUpgrade->poll(sessions)) {
+                break;  // the new server has the system now
+            }
 
             // Calculate next deadline as minimum of:
             // 1. Next fixed time slice (30ms)
@@ -510,10 +752,17 @@ int main(int argc, char* argv[]) {
                     // Fallback to sleep_until if timerfd fails
                     std::this_thread::sleep_until(deadline);
                 } else {
-                    // Use ppoll to wait on timerfd with safety timeout to prevent hangs
-                    pollfd pfd = { .fd = timerFd, .events = POLLIN, .revents = 0 };
+                    // Use ppoll to wait on timerfd with safety timeout to prevent hangs;
+                    // a command from the web server, or a server taking over,
+                    // also ends the wait
+                    pollfd pfds[3] = {
+                        { .fd = timerFd, .events = POLLIN, .revents = 0 },
+                        { .fd = EmuCommandQueue::waitFd(), .events = POLLIN, .revents = 0 },
+                        { .fd = liveUpgrade ? liveUpgrade->waitFd() : -1, .events = POLLIN, .revents = 0 },
+                    };
+                    pollfd &pfd = pfds[0];
                     timespec timeout = { .tv_sec = 0, .tv_nsec = 50000000 }; // 50ms max timeout
-                    int result = ppoll(&pfd, 1, &timeout, nullptr);
+                    int result = ppoll(pfds, 3, &timeout, nullptr);
 
 #ifdef DEBUG_WAKEUPS
                     if (result == 0) {
@@ -532,6 +781,7 @@ int main(int argc, char* argv[]) {
                 }
 
                 auto wakeTime = clock::now();
+                rtProfile->noteWakeup(deadline, wakeTime);
 
                 // Debug wakeup reasons if enabled
                 if (config.debugWakeups) {
@@ -594,6 +844,10 @@ int main(int argc, char* argv[]) {
                     // Try to create and open serial port
                     auto reconnect_scheduler = termMux->getScheduler();
                     auto serialPort = std::make_shared<SerialPort>(reconnect_scheduler);
+                    serialPort->setThreadInitCallback([i] {
+                        HostCpuStats::registerThread("term" + std::to_string(i) + "-rx");
+                        rtProfile->applyToSerialThread();
+                    });
                     SerialConfig serialConfig = config.terminals[i].toSerialConfig();
                     
                     if (serialPort->open(serialConfig)) {
@@ -606,6 +860,7 @@ int main(int argc, char* argv[]) {
                         // Create session and connect to MXD
                         auto termToMxdCallback = createTermToMxdCallback(i);
                         sessions[i] = std::make_shared<SerialTermSession>(serialPort, termToMxdCallback);
+                        sessions[i]->setCompression(config.terminals[i].compress);
                         termMux->setSession(i, sessions[i]);
                         
                         std::cerr << "[INFO] Terminal " << i << " reconnected successfully to " << portName << "\n";
@@ -632,6 +887,11 @@ int main(int argc, char* argv[]) {
         }
 #endif
 
+        // Let go of the cpu if a debugger is attached
+        debugServer.reset();
+
+        HostCpuStats::stopActivitySampler();
+
         // Clean up sessions
         for (int i = 0; i < config.numTerminals; i++) {
             if (sessions[i]) {
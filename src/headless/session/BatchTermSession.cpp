@@ -0,0 +1,244 @@
+// BatchTermSession - Unattended Terminal Session Implementation
+//
+// Types a script into the MXD and captures what comes back, for running
+// Wang programs as batch jobs.  See BatchTermSession.h for the overview.
+
+#include "BatchTermSession.h"
+#include "../../core/io/IoCardKeyboard.h"
+#include "../../core/system/Scheduler.h"
+#include "../../shared/script/ScriptFile.h"
+#include "../../shared/terminal/Terminal.h"
+#include "../../platform/common/host.h"  // for dbglog()
+#include <algorithm>
+
+// Enough trailing text to hold any reasonable completion pattern
+static const size_t TAIL_KEEP = 256;
+
+BatchTermSession::BatchTermSession(std::shared_ptr<Scheduler> scheduler,
+                                   TermToMxdCallback onFromTerm,
+                                   int settleMs) :
+    m_scheduler(std::move(scheduler)),
+    m_onFromTerm(std::move(onFromTerm)),
+    m_settleNs(TIMER_MS(std::max(settleMs, 0)))
+{
+}
+
+BatchTermSession::~BatchTermSession()
+{
+    m_tmrType = nullptr;
+    dbglog("BatchTermSession: Destroyed session (RX: %llu, TX: %llu bytes)\n",
+           (unsigned long long)m_rxBytes,
+           (unsigned long long)m_txBytes);
+}
+
+bool BatchTermSession::openCapture(const std::string &crtPath, const std::string &prtPath)
+{
+    if (!crtPath.empty()) {
+        m_crtFile.open(crtPath, std::ios::binary | std::ios::trunc);
+        if (!m_crtFile.is_open()) {
+            return false;
+        }
+    }
+    if (!prtPath.empty()) {
+        m_prtFile.open(prtPath, std::ios::binary | std::ios::trunc);
+        if (!m_prtFile.is_open()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool BatchTermSession::startInput(const std::string &scriptPath)
+{
+    m_script = std::make_unique<ScriptFile>(scriptPath,
+                                            ScriptFile::SCRIPT_META_KEY |
+                                            ScriptFile::SCRIPT_META_HEX |
+                                            ScriptFile::SCRIPT_META_INC |
+                                            ScriptFile::SCRIPT_META_JOIN,
+                                            3 /* max nesting */);
+    if (!m_script->openedOk()) {
+        m_script = nullptr;
+        return false;
+    }
+
+    // Let the system boot and draw its first screen before typing
+    m_waitSettle = true;
+    m_lastOutputNs = m_scheduler->getTimeNs();
+    scheduleTyping(m_settleNs);
+    return true;
+}
+
+bool BatchTermSession::inputFinished() const
+{
+    return m_inputDone
+        && (m_scheduler->getTimeNs() - m_lastOutputNs >= m_settleNs);
+}
+
+void BatchTermSession::getStats(uint64_t* rxBytes, uint64_t* txBytes) const
+{
+    if (rxBytes) *rxBytes = m_rxBytes;
+    if (txBytes) *txBytes = m_txBytes;
+}
+
+bool BatchTermSession::isActive() const
+{
+    return true;
+}
+
+std::string BatchTermSession::getDescription() const
+{
+    return "Batch:" + std::string(m_inputDone ? "Idle" : "Typing");
+}
+
+// ----------------------------------------------------------------------------
+// keyboard side
+// ----------------------------------------------------------------------------
+
+void BatchTermSession::scheduleTyping(int64 delayNs)
+{
+    m_tmrType = m_scheduler->createTimer(std::max(delayNs, int64(1)),
+                                         std::bind(&BatchTermSession::typeNext, this));
+}
+
+void BatchTermSession::typeNext()
+{
+    m_tmrType = nullptr;
+
+    if (m_keyPos >= m_keyBytes.size()) {
+        int keycode = 0;
+        if (!m_script || !m_script->getNextByte(&keycode)) {
+            m_script = nullptr;
+            m_inputDone = true;
+            dbglog("BatchTermSession: Script finished\n");
+            return;
+        }
+        m_keyBytes = Terminal::encodeKeystroke(keycode);
+        m_keyPos = 0;
+    }
+
+    if (m_waitSettle) {
+        const int64 quietNs = m_scheduler->getTimeNs() - m_lastOutputNs;
+        if (quietNs < m_settleNs) {
+            scheduleTyping(m_settleNs - quietNs);
+            return;
+        }
+        m_waitSettle = false;
+    }
+
+    if (m_xoff) {
+        // Poll rather than hook XON so the settle logic stays in one place
+        scheduleTyping(Terminal::serial_char_delay);
+        return;
+    }
+
+    const uint8 byte = m_keyBytes[m_keyPos++];
+    m_rxBytes++;
+    if (m_onFromTerm) {
+        m_onFromTerm(byte);
+    }
+
+    // Carriage return, RESET and the special function keys usually start
+    // something on the host; give it a chance to finish before going on
+    if (m_keyPos == m_keyBytes.size()) {
+        const bool sfKey = (m_keyBytes.size() == 2) && (m_keyBytes[0] == 0xFD)
+                        && (m_keyBytes[1] < 0x20);
+        m_waitSettle = (byte == 0x0D) || (byte == 0x12) || sfKey;
+        if (m_waitSettle) {
+            // the quiet period starts now, not at the last output
+            m_lastOutputNs = m_scheduler->getTimeNs();
+        }
+    }
+
+    scheduleTyping(Terminal::serial_char_delay);
+}
+
+// ----------------------------------------------------------------------------
+// display side
+// ----------------------------------------------------------------------------
+
+void BatchTermSession::mxdToTerm(uint8 byte)
+{
+    m_txBytes++;
+
+    if (m_seqLen == 0) {
+        if (byte == 0x13) {            // XOFF
+            m_xoff = true;
+            return;
+        }
+        if (byte == 0x11) {            // XON
+            m_xoff = false;
+            return;
+        }
+        m_lastOutputNs = m_scheduler->getTimeNs();
+        if (byte == 0xFB) {
+            m_seqLen = 1;
+        } else {
+            emit(byte);
+        }
+        return;
+    }
+
+    m_lastOutputNs = m_scheduler->getTimeNs();
+
+    if (m_seqLen == 2) {
+        // FB nn cc: a run of nn copies of cc
+        for (int i = 0; i < m_seqCount; i++) {
+            emit(byte);
+        }
+        m_seqLen = 0;
+        return;
+    }
+
+    // Second byte of an FB sequence; see Terminal::processChar() and
+    // Terminal::processCrtChar1() for the full set
+    m_seqLen = 0;
+    if (byte == 0xF0) {
+        m_crtSink = true;
+    } else if (byte == 0xF1) {
+        m_crtSink = false;
+    } else if (byte < 0x60) {
+        m_seqCount = byte;
+        m_seqLen = 2;
+    } else if (byte <= 0xBF) {
+        for (int i = 0x60; i < byte; i++) {
+            emit(0x20);
+        }
+    }
+    // Anything else (delays, terminal resets, literal FB) has no text
+}
+
+void BatchTermSession::emit(uint8 byte)
+{
+    char ch;
+    if (0x20 <= byte && byte < 0x7F) {
+        ch = static_cast<char>(byte);
+    } else if (byte == 0x0D) {
+        ch = '\n';
+    } else if (byte == 0x0C && !m_crtSink) {
+        ch = '\f';                     // printer form feed
+    } else {
+        return;                        // cursor movement and the like
+    }
+
+    std::ofstream &file = m_crtSink ? m_crtFile : m_prtFile;
+    std::string &tail = m_crtSink ? m_crtTail : m_prtTail;
+
+    if (file.is_open()) {
+        file.put(ch);
+    }
+
+    if (m_donePattern.empty() || m_patternSeen) {
+        return;
+    }
+    tail.push_back(ch);
+    if (tail.size() > TAIL_KEEP + m_donePattern.size()) {
+        tail.erase(0, tail.size() - m_donePattern.size());
+    }
+    if (tail.size() >= m_donePattern.size()
+        && tail.compare(tail.size() - m_donePattern.size(),
+                        m_donePattern.size(), m_donePattern) == 0) {
+        m_patternSeen = true;
+        dbglog("BatchTermSession: Done pattern seen on %s\n",
+               m_crtSink ? "crt" : "printer");
+    }
+}
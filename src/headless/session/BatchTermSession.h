@@ -0,0 +1,126 @@
+#ifndef _INCLUDE_BATCH_TERM_SESSION_H_
+#define _INCLUDE_BATCH_TERM_SESSION_H_
+
+#include "ITermSession.h"
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+class Scheduler;
+class ScriptFile;
+class Timer;
+
+/**
+ * BatchTermSession - Unattended Terminal Session
+ *
+ * Stands in for a 2236 terminal during a batch job.  Keystrokes come from
+ * a script file and are typed at the terminal's line rate.  After each
+ * carriage return, RESET or special function key, typing pauses until the
+ * host has been quiet for the settle time, much as an operator would wait
+ * for the prompt.  XOFF/XON from the MXD pause and resume typing.
+ *
+ * Output from the MXD is split into the crt and printer streams (FB F0 and
+ * FB F1), run compression is expanded, and the printable text is written
+ * to the capture files.  Both streams are checked for the completion
+ * pattern.
+ *
+ * Everything runs on the emulation thread: the MXD calls mxdToTerm() from
+ * its transmit timer, and typing is driven by scheduler timers.
+ */
+class BatchTermSession : public ITermSession
+{
+public:
+    /**
+     * Construct a batch session
+     * @param scheduler  Emulator scheduler, for pacing and the settle time
+     * @param onFromTerm Callback which delivers a typed byte to the MXD
+     * @param settleMs   Emulated ms of output silence before typing resumes
+     */
+    BatchTermSession(std::shared_ptr<Scheduler> scheduler,
+                     TermToMxdCallback onFromTerm,
+                     int settleMs);
+
+    virtual ~BatchTermSession();
+
+    // ITermSession interface
+    void mxdToTerm(uint8 byte) override;
+    bool isActive() const override;
+    std::string getDescription() const override;
+
+    /**
+     * Open the output capture files; an empty name skips that stream
+     * @return false if a file could not be created
+     */
+    bool openCapture(const std::string &crtPath, const std::string &prtPath);
+
+    /**
+     * Start typing the named script, after the initial settle time
+     * @return false if the script could not be opened
+     */
+    bool startInput(const std::string &scriptPath);
+
+    /**
+     * Text which ends the job when it appears on the crt or printer
+     */
+    void setDonePattern(const std::string &pattern) { m_donePattern = pattern; }
+
+    /**
+     * True once the done pattern has been seen
+     */
+    bool patternSeen() const { return m_patternSeen; }
+
+    /**
+     * True once the whole script has been typed and the host has been
+     * quiet for the settle time since
+     */
+    bool inputFinished() const;
+
+    /**
+     * Get statistics about this session
+     * @param rxBytes Output parameter for bytes typed to the MXD
+     * @param txBytes Output parameter for bytes received from the MXD
+     */
+    void getStats(uint64_t* rxBytes, uint64_t* txBytes) const;
+
+private:
+    std::shared_ptr<Scheduler> m_scheduler;
+    TermToMxdCallback m_onFromTerm;
+    const int64 m_settleNs;
+
+    // Keyboard side
+    std::unique_ptr<ScriptFile> m_script;
+    std::vector<uint8> m_keyBytes;      // encoding of the key being typed
+    size_t m_keyPos = 0;                // next byte of m_keyBytes to send
+    bool m_waitSettle = false;          // hold typing until output is quiet
+    bool m_xoff = false;                // MXD asked us to stop sending
+    bool m_inputDone = false;           // script exhausted
+    std::shared_ptr<Timer> m_tmrType;
+
+    // Output side
+    int64 m_lastOutputNs = 0;           // when the MXD last sent us anything
+    bool m_crtSink = true;              // FB F0 / FB F1 routing
+    int m_seqLen = 0;                   // FB escape bytes buffered
+    uint8 m_seqCount = 0;               // count byte of an FB nn cc run
+    std::ofstream m_crtFile;
+    std::ofstream m_prtFile;
+    std::string m_donePattern;
+    std::string m_crtTail;              // recent text, for pattern matching
+    std::string m_prtTail;
+    bool m_patternSeen = false;
+
+    // Statistics
+    uint64_t m_rxBytes = 0;
+    uint64_t m_txBytes = 0;
+
+    // Timer callback which types the next byte
+    void typeNext();
+
+    // Arm the typing timer
+    void scheduleTyping(int64 delayNs);
+
+    // Deliver one decoded byte to the current sink
+    void emit(uint8 byte);
+};
+
+#endif // _INCLUDE_BATCH_TERM_SESSION_H_
@@ -35,6 +35,32 @@ struct ITermSession {
      * @return A string describing the session (e.g., "Serial:/dev/ttyUSB0", "GUI:Terminal1")
      */
     virtual std::string getDescription() const = 0;
+
+    /**
+     * Pause or resume input from the terminal out of band (eg, with RTS)
+     * @param stop true to pause, false to resume
+     * @return false if the session has no such means, and XOFF/XON must
+     *         be sent in band instead
+     */
+    virtual bool throttleInput(bool stop) { (void)stop; return false; }
+
+    /**
+     * Send XOFF or XON to the terminal in band, when throttleInput() can't
+     * @param stop true to send XOFF, false to send XON
+     */
+    virtual void sendFlowControl(bool stop) { mxdToTerm(stop ? 0x13 : 0x11); }
+
+    /**
+     * Get the line rate of the link to the terminal
+     * @return bits per second, or 0 if unknown
+     */
+    virtual uint32_t getBaudRate() const { return 0; }
+
+    /**
+     * Get how full the output queue towards the terminal is
+     * @return 0.0 (empty) to 1.0 (full); the MXD holds back output near full
+     */
+    virtual float getTxQueueFullness() const { return 0.0f; }
 };
 
 /**
@@ -0,0 +1,119 @@
+// RunLengthEncoder - compress MXD output for a 2236 terminal
+//
+// The parse state mirrors Terminal::processChar() (immediate FB commands
+// and CRT/printer routing) and Terminal::processCrtChar1() (FB sequences
+// in the CRT stream), so a run is only rewritten where the terminal would
+// have drawn its characters one by one.
+
+#include "RunLengthEncoder.h"
+
+void RunLengthEncoder::encode(uint8 byte, std::vector<uint8> &out)
+{
+    if (byte == 0xFB) {
+        flush(out);
+        if (m_escapeSeen) {
+            // two escapes in a row: the first goes to the current sink
+            (void)crtByte(0xFB);
+        }
+        m_escapeSeen = true;
+        out.push_back(byte);
+        return;
+    }
+
+    if (m_escapeSeen) {
+        // the held run was flushed when the FB arrived
+        m_escapeSeen = false;
+        switch (byte) {
+            case 0xF0:  // route to crt
+                m_crtSink = true;
+                break;
+            case 0xF1:  // route to prt
+                m_crtSink = false;
+                break;
+            case 0xF2:  // restart terminal
+                m_crtSink = true;
+                m_seqCnt = 0;
+                break;
+            case 0xF6:  // reset crt
+                m_seqCnt = 0;
+                break;
+            default:    // not immediate: both bytes go to the sink
+                (void)crtByte(0xFB);
+                (void)crtByte(byte);
+                break;
+        }
+        out.push_back(byte);
+        return;
+    }
+
+    // control codes, including those which end 02 ... sequences, are
+    // never folded into a run
+    const bool plain = crtByte(byte) && (byte >= 0x20);
+
+    if (plain && (m_runLen > 0) && (byte == m_runChar)) {
+        if (++m_runLen == MAX_RUN) {
+            flush(out);
+        }
+        return;
+    }
+
+    flush(out);
+    if (plain) {
+        m_runChar = byte;
+        m_runLen = 1;
+    } else {
+        out.push_back(byte);
+    }
+}
+
+void RunLengthEncoder::flush(std::vector<uint8> &out)
+{
+    if (m_runLen == 0) {
+        return;
+    }
+
+    if ((m_runChar == 0x20) && (m_runLen >= 3)) {
+        out.push_back(0xFB);
+        out.push_back(static_cast<uint8>(0x60 + m_runLen));
+        m_saved += m_runLen - 2;
+    } else if (m_runLen >= 4) {
+        out.push_back(0xFB);
+        out.push_back(static_cast<uint8>(m_runLen));
+        out.push_back(m_runChar);
+        m_saved += m_runLen - 3;
+    } else {
+        out.insert(out.end(), m_runLen, m_runChar);
+    }
+    m_runLen = 0;
+}
+
+void RunLengthEncoder::reset()
+{
+    m_escapeSeen = false;
+    m_crtSink = true;
+    m_seqCnt = 0;
+    m_runLen = 0;
+}
+
+bool RunLengthEncoder::crtByte(uint8 byte)
+{
+    if (!m_crtSink) {
+        return false;   // the printer stream isn't expanded
+    }
+
+    switch (m_seqCnt) {
+        case 0:
+            if (byte == 0xFB) {
+                m_seqCnt = 1;
+                return false;
+            }
+            return true;
+        case 1:
+            // FB nn cc is a run; every other FB xx is complete
+            m_seqCnt = (byte < 0x60) ? 2 : 0;
+            return false;
+        default:
+            m_seqCnt = 0;
+            return false;
+    }
+}
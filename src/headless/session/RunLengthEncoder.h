@@ -0,0 +1,75 @@
+#ifndef _INCLUDE_RUN_LENGTH_ENCODER_H_
+#define _INCLUDE_RUN_LENGTH_ENCODER_H_
+
+#include "../../core/system/w2200.h"
+#include <vector>
+
+/**
+ * RunLengthEncoder - compress MXD output for a 2236 terminal
+ *
+ * The 2236 protocol has two run-length forms, which the terminal expands
+ * before interpreting anything else (see Terminal::processCrtChar1):
+ *
+ *     FB nn cc    nn copies of the character cc, 0x01 <= nn < 0x60
+ *     FB nn       nn-0x60 spaces, 0x60 <= nn <= 0xBF
+ *
+ * The MXD sends runs exactly as the program produced them, so on a slow
+ * line a screen of boxes, rules and blank fields takes far longer than it
+ * needs to.  This rewrites runs of identical characters into these forms.
+ *
+ * Only bytes the terminal will take as plain CRT characters are touched.
+ * The encoder follows the stream the way the terminal parses it, so FB
+ * sequences (including immediate commands nested inside one), control
+ * codes, and anything routed to the printer (FB F1) pass through as is.
+ *
+ * A run is held until a different byte arrives, so the caller must call
+ * flush() regularly; that bounds how late a held character can be.
+ */
+class RunLengthEncoder
+{
+public:
+    /**
+     * Take one byte from the MXD
+     * @param byte The byte the MXD sent
+     * @param out Receives the bytes to send now, if any
+     */
+    void encode(uint8 byte, std::vector<uint8> &out);
+
+    /**
+     * Emit the run being held, if any
+     * @param out Receives the bytes to send
+     */
+    void flush(std::vector<uint8> &out);
+
+    /**
+     * Drop any held run and assume the terminal has just been reset,
+     * eg, before a repaint
+     */
+    void reset();
+
+    /**
+     * Check whether a run is being held back
+     */
+    bool holding() const { return m_runLen > 0; }
+
+    /**
+     * Get how many bytes compression has saved so far
+     */
+    uint64 bytesSaved() const { return m_saved; }
+
+private:
+    static constexpr int MAX_RUN = 0x5F;    // longest run in one sequence
+
+    // track the terminal's parse of a byte which reached the CRT stream;
+    // returns true if it is a plain character
+    bool crtByte(uint8 byte);
+
+    bool  m_escapeSeen = false;     // FB seen; the next byte says what for
+    bool  m_crtSink    = true;      // false while routed to the printer
+    int   m_seqCnt     = 0;         // bytes so far of an FB sequence in the CRT stream
+    uint8 m_runChar    = 0;
+    int   m_runLen     = 0;         // held copies of m_runChar
+    uint64 m_saved     = 0;
+};
+
+#endif // _INCLUDE_RUN_LENGTH_ENCODER_H_
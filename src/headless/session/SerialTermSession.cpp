@@ -5,6 +5,8 @@
 // between the MXD card and the actual serial port hardware.
 
 #include "SerialTermSession.h"
+#include "../../shared/terminal/Terminal.h"
+#include "../../gui/system/Ui.h"         // for UI_SCREEN_2236DE
 #include "../../platform/common/host.h"  // for dbglog()
 #include <sstream>
 
@@ -12,6 +14,7 @@ SerialTermSession::SerialTermSession(std::shared_ptr<SerialPort> serialPort,
                                      TermToMxdCallback onFromTerm) :
     m_serialPort(std::move(serialPort)),
     m_onFromTerm(std::move(onFromTerm)),
+    m_shadow(std::make_unique<Terminal>(UI_SCREEN_2236DE)),
     m_rxBytes(0),
     m_txBytes(0)
 {
@@ -25,30 +28,85 @@ SerialTermSession::SerialTermSession(std::shared_ptr<SerialPort> serialPort,
         std::bind(&SerialTermSession::onSerialRx, this, std::placeholders::_1)
     );
     
+    // Repaint the terminal when the link comes back
+    m_serialPort->setLinkUpCallback(std::bind(&SerialTermSession::onLinkUp, this));
+    
     dbglog("SerialTermSession: Created session for %s\n", getDescription().c_str());
 }
 
 SerialTermSession::~SerialTermSession()
 {
     if (m_serialPort) {
-        // Clear the receive callback to avoid dangling pointer
+        // Clear the callbacks to avoid dangling pointers
         m_serialPort->setReceiveCallback(nullptr);
-        dbglog("SerialTermSession: Destroyed session for %s (RX: %llu, TX: %llu bytes)\n",
+        m_serialPort->setLinkUpCallback(nullptr);
+        dbglog("SerialTermSession: Destroyed session for %s (RX: %llu, TX: %llu bytes, %llu saved by compression)\n",
                getDescription().c_str(), 
                (unsigned long long)m_rxBytes, 
-               (unsigned long long)m_txBytes);
+               (unsigned long long)m_txBytes,
+               (unsigned long long)m_encoder.bytesSaved());
     }
 }
 
 void SerialTermSession::mxdToTerm(uint8 byte)
 {
+    // The shadow tracks everything the host sends, even while the port
+    // is down, so it can be replayed when the terminal comes back
+    std::lock_guard<std::mutex> lock(m_shadowMutex);
+    m_shadow->processChar(byte);
+    
     if (!m_serialPort || !m_serialPort->isOpen()) {
         // Silently drop data if port is closed - this is normal during
         // startup/shutdown or when terminals are disconnected
         return;
     }
     
-    m_serialPort->sendByte(byte);
+    if (!m_compress) {
+        m_serialPort->sendByte(byte);
+        return;
+    }
+    const bool wasHolding = m_encoder.holding();
+    m_encoder.encode(byte, m_txBuf);
+    // A run which keeps growing keeps its start time; anything sent
+    // means the run held before, if any, has ended
+    if (m_encoder.holding() && (!wasHolding || !m_txBuf.empty())) {
+        m_holdStart = std::chrono::steady_clock::now();
+    }
+    sendTxBuf();
+}
+
+void SerialTermSession::setCompression(bool enable)
+{
+    std::lock_guard<std::mutex> lock(m_shadowMutex);
+    if (m_compress && !enable) {
+        m_encoder.flush(m_txBuf);
+        sendTxBuf();
+    }
+    m_compress = enable;
+}
+
+void SerialTermSession::flushOutput(bool force)
+{
+    std::lock_guard<std::mutex> lock(m_shadowMutex);
+    // Timed from the start of the run, so a run which keeps growing
+    // still goes out on time
+    if (m_compress && (force || (m_encoder.holding()
+                                 && std::chrono::steady_clock::now() - m_holdStart
+                                    >= std::chrono::milliseconds(COMPRESS_HOLD_MS)))) {
+        m_encoder.flush(m_txBuf);
+        sendTxBuf();
+    }
+}
+
+void SerialTermSession::sendTxBuf()
+{
+    if (m_txBuf.empty()) {
+        return;
+    }
+    if (m_serialPort && m_serialPort->isOpen()) {
+        m_serialPort->sendData(m_txBuf.data(), m_txBuf.size());
+    }
+    m_txBuf.clear();
 }
 
 bool SerialTermSession::isActive() const
@@ -70,6 +128,45 @@ std::string SerialTermSession::getDescription() const
     return oss.str();
 }
 
+bool SerialTermSession::throttleInput(bool stop)
+{
+    // only when the cable carries RTS/CTS; otherwise the caller uses XOFF/XON
+    if (!m_serialPort || !m_serialPort->hasHwFlowControl()) {
+        return false;
+    }
+    m_serialPort->setRts(!stop);
+    return true;
+}
+
+void SerialTermSession::sendFlowControl(bool stop)
+{
+    // XOFF/XON aren't MXD output: they must not go through the compressor,
+    // which would take them as part of the screen stream, nor wait behind
+    // the output already queued.  The port sends them ahead of it.
+    if (!m_serialPort || !m_serialPort->isOpen()) {
+        return;
+    }
+    if (stop) {
+        m_serialPort->sendXOFF();
+    } else {
+        m_serialPort->sendXON();
+    }
+}
+
+uint32_t SerialTermSession::getBaudRate() const
+{
+    return m_serialPort ? m_serialPort->getBaudRate() : 0;
+}
+
+float SerialTermSession::getTxQueueFullness() const
+{
+    if (!m_serialPort || !m_serialPort->isOpen()) {
+        return 0.0f;
+    }
+    return static_cast<float>(m_serialPort->getTxQueueSize())
+         / static_cast<float>(m_serialPort->getTxQueueCapacity());
+}
+
 void SerialTermSession::getStats(uint64_t* rxBytes, uint64_t* txBytes) const
 {
     if (m_serialPort) {
@@ -87,4 +184,23 @@ void SerialTermSession::onSerialRx(uint8 byte)
     if (m_onFromTerm) {
         m_onFromTerm(byte);
     }
-}
\ No newline at end of file
+}
+
+void SerialTermSession::onLinkUp()
+{
+    std::lock_guard<std::mutex> lock(m_shadowMutex);
+    
+    // Output queued while the terminal was away is already reflected in
+    // the shadow; sending it as well would just be drawn over
+    m_serialPort->flushTxQueue();
+    
+    // The repaint resets the terminal's parse state, and a held run is
+    // in the shadow too
+    m_encoder.reset();
+    
+    const std::vector<uint8> repaint = m_shadow->getRepaintStream();
+    if (!repaint.empty()) {
+        m_serialPort->sendData(repaint.data(), repaint.size());
+    }
+    dbglog("SerialTermSession: Link up, sent %zu byte screen repaint\n", repaint.size());
+}
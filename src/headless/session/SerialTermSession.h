@@ -2,10 +2,15 @@
 #define _INCLUDE_SERIAL_TERM_SESSION_H_
 
 #include "ITermSession.h"
+#include "RunLengthEncoder.h"
 #include "../../platform/common/SerialPort.h"
+#include <chrono>
 #include <memory>
+#include <mutex>
 #include <string>
 
+class Terminal;
+
 /**
  * SerialTermSession - Serial Terminal Session Implementation
  * 
@@ -16,10 +21,23 @@
  * Data flow:
  * - MXD → Terminal: mxdToTerm() calls SerialPort::sendByte()
  * - Terminal → MXD: SerialPort RX callback calls the TermToMxdCallback
+ *
+ * The session also keeps a shadow Terminal model fed by the MXD → Terminal
+ * stream.  When the serial port reports that the link came back (device
+ * reopened, or DSR asserted after a terminal power cycle), any stale queued
+ * output is discarded and a compact repaint of the shadow screen is sent.
+ *
+ * For slow lines the output can also be run-length compressed on its way
+ * to the terminal (see RunLengthEncoder).  A run is held back until it
+ * ends, so the owner must call flushOutput() regularly; the run goes out
+ * at most COMPRESS_HOLD_MS after its first character, even if the MXD is
+ * still adding to it.
  */
 class SerialTermSession : public ITermSession
 {
 public:
+    static constexpr int COMPRESS_HOLD_MS = 40;  // longer than a timeslice
+
     /**
      * Construct a serial terminal session
      * @param serialPort The serial port instance to use for communication
@@ -34,6 +52,10 @@ public:
     void mxdToTerm(uint8 byte) override;
     bool isActive() const override;
     std::string getDescription() const override;
+    bool throttleInput(bool stop) override;
+    void sendFlowControl(bool stop) override;
+    uint32_t getBaudRate() const override;
+    float getTxQueueFullness() const override;
     
     /**
      * Get the underlying serial port instance
@@ -48,16 +70,48 @@ public:
      */
     void getStats(uint64_t* rxBytes, uint64_t* txBytes) const;
     
+    /**
+     * Enable or disable run-length compression of output to the terminal;
+     * the compressor follows the stream from its start, so enable it
+     * before any output is sent
+     * @param enable true to compress runs of identical characters
+     */
+    void setCompression(bool enable);
+    
+    /**
+     * Send the run the compressor is holding back, if it has been held
+     * for COMPRESS_HOLD_MS
+     * @param force Send it regardless, eg, before the line is released
+     */
+    void flushOutput(bool force = false);
+    
 private:
     std::shared_ptr<SerialPort> m_serialPort;
     TermToMxdCallback m_onFromTerm;
     
+    // Shadow screen model and output compressor; guarded because
+    // link-up runs on the RX thread
+    std::unique_ptr<Terminal> m_shadow;
+    std::mutex m_shadowMutex;
+    
+    // Output compression (optional)
+    bool m_compress = false;
+    RunLengthEncoder m_encoder;
+    std::vector<uint8> m_txBuf;
+    std::chrono::steady_clock::time_point m_holdStart;  // of the held run
+    
     // Statistics
     mutable uint64_t m_rxBytes;
     mutable uint64_t m_txBytes;
     
     // Internal callback for SerialPort RX
     void onSerialRx(uint8 byte);
+    
+    // Internal callback for SerialPort link (re)established
+    void onLinkUp();
+    
+    // Send what the compressor produced, if anything
+    void sendTxBuf();
 };
 
 #endif // _INCLUDE_SERIAL_TERM_SESSION_H_
\ No newline at end of file
@@ -3,10 +3,12 @@
 
 #include "TerminalServerConfig.h"
 #include "../../platform/common/host.h"  // for config functions
+#include "../main/DiskProvision.h"
 #include <iostream>
 #include <sstream>
 #include <cstring>
 #include <cstdlib>
+#include <sys/stat.h>
 
 // ============================================================================
 // TerminalPortConfig Implementation
@@ -45,6 +47,10 @@ std::string TerminalPortConfig::getDescription() const
         oss << ", no flow control";
     }
     
+    if (compress) {
+        oss << ", compressed";
+    }
+    
     return oss.str();
 }
 
@@ -77,6 +83,44 @@ void TerminalServerConfig::loadFromHostConfig()
         captureDir = captureDirStr;
         captureEnabled = !captureDir.empty();
     }
+
+    // Load real-time profile settings (--realtime on the command line also enables)
+    bool rtEnabled = false;
+    host::configReadBool("terminal_server", "realtime", &rtEnabled, false);
+    realtime.enabled = realtime.enabled || rtEnabled;
+    host::configReadInt("terminal_server", "realtime_emu_cpu", &realtime.emuCpu, -1);
+    host::configReadInt("terminal_server", "realtime_serial_cpu", &realtime.serialCpu, -1);
+    host::configReadBool("terminal_server", "realtime_fifo", &realtime.schedFifo, false);
+    host::configReadInt("terminal_server", "realtime_fifo_priority", &realtime.fifoPriority, 50);
+    host::configReadInt("terminal_server", "realtime_duty_percent", &realtime.dutyPercent, 80);
+    host::configReadBool("terminal_server", "realtime_mlock", &realtime.lockMemory, true);
+
+    // Load debugger socket (--debug-socket on the command line takes precedence)
+    std::string debugSocketStr;
+    if (debugSocket.empty()
+        && host::configReadStr("terminal_server", "debug_socket", &debugSocketStr, nullptr)) {
+        debugSocket = debugSocketStr;
+    }
+
+    // Load live upgrade socket (--upgrade-socket on the command line takes precedence)
+    std::string upgradeSocketStr;
+    if (upgradeSocket.empty()
+        && host::configReadStr("terminal_server", "upgrade_socket", &upgradeSocketStr, nullptr)) {
+        upgradeSocket = upgradeSocketStr;
+    }
+
+    // Load the cache settings for disk images on a disk server
+    std::string diskCacheDirStr;
+    if (host::configReadStr("terminal_server", "disk_cache_dir", &diskCacheDirStr, nullptr)) {
+        diskCacheDir = diskCacheDirStr;
+    }
+    host::configReadInt("terminal_server", "disk_cache_mb", &diskCacheMB, 16);
+
+    // Load fan-out settings (--fanout on the command line takes precedence)
+    if (!m_fanoutFromCmdLine) {
+        host::configReadInt("terminal_server", "fanout", &fanout.workers, 0);
+        host::configReadInt("terminal_server", "fanout_warmup", &fanout.warmupSec, 10);
+    }
     
     // Load per-terminal settings
     for (int i = 0; i < MAX_TERMINALS; i++) {
@@ -116,6 +160,9 @@ void TerminalServerConfig::loadFromHostConfig()
                 terminals[i].hwFlowControl = (flowStr == "rtscts");
                 terminals[i].swFlowControl = (flowStr == "xonxoff");
             }
+            
+            // Run-length compress output, for 9600 baud and slower links
+            host::configReadBool(section, "compress", &terminals[i].compress, false);
         }
     }
 }
@@ -140,6 +187,46 @@ bool TerminalServerConfig::parseCommandLine(int argc, char* argv[])
             webServerEnabled = true; // Enable web server when port is specified
         } else if (arg == "--debug-wakeups") {
             debugWakeups = true;
+        } else if (arg == "--io-profile") {
+            ioProfile = true;
+        } else if (arg == "--realtime") {
+            realtime.enabled = true;
+        } else if (arg.find("--create-disk=") == 0) {
+            createDisks.push_back(arg.substr(14));
+        } else if (arg == "--preallocate") {
+            preallocateDisks = true;
+        } else if (arg.find("--batch=") == 0) {
+            batch.script = arg.substr(8);
+        } else if (arg.find("--batch-crt=") == 0) {
+            batch.crtCapture = arg.substr(12);
+        } else if (arg.find("--batch-prt=") == 0) {
+            batch.prtCapture = arg.substr(12);
+        } else if (arg.find("--batch-done=") == 0) {
+            batch.donePattern = arg.substr(13);
+        } else if (arg.find("--batch-timeout=") == 0) {
+            batch.timeoutSec = std::stoi(arg.substr(16));
+        } else if (arg.find("--batch-settle=") == 0) {
+            batch.settleMs = std::stoi(arg.substr(15));
+        } else if (arg.find("--batch-term=") == 0) {
+            batch.terminal = std::stoi(arg.substr(13));
+        } else if (arg.find("--mount=") == 0) {
+            batch.mounts.push_back(arg.substr(8));
+        } else if (arg.find("--debug-socket=") == 0) {
+            debugSocket = arg.substr(15);
+        } else if (arg.find("--upgrade-socket=") == 0) {
+            upgradeSocket = arg.substr(17);
+        } else if (arg.find("--take-over=") == 0) {
+            takeOver = arg.substr(12);
+        } else if (arg.find("--serve-disks=") == 0) {
+            serveDisks = arg.substr(14);
+        } else if (arg.find("--serve-port=") == 0) {
+            servePort = std::stoi(arg.substr(13));
+        } else if (arg.find("--fanout=") == 0) {
+            fanout.workers = std::stoi(arg.substr(9));
+            m_fanoutFromCmdLine = true;
+        } else if (arg.find("--fanout-warmup=") == 0) {
+            fanout.warmupSec = std::stoi(arg.substr(16));
+            m_fanoutFromCmdLine = true;
         }
     }
     
@@ -164,6 +251,45 @@ bool TerminalServerConfig::validate() const
     
     // Validation is done elsewhere, just count enabled terminals here
     (void)enabledCount;  // Suppress unused variable warning
+
+    if (batch.enabled()) {
+        if (batch.terminal < 0 || batch.terminal >= MAX_TERMINALS) {
+            std::cerr << "Error: Invalid batch terminal: " << batch.terminal << std::endl;
+            return false;
+        }
+        if (batch.timeoutSec <= 0) {
+            std::cerr << "Error: Invalid batch timeout: " << batch.timeoutSec << std::endl;
+            return false;
+        }
+    }
+
+    if (fanout.workers < 0 || fanout.workers > Fanout::MAX_WORKERS) {
+        std::cerr << "Error: Invalid fan-out worker count: " << fanout.workers << std::endl;
+        return false;
+    }
+    if (!takeOver.empty() && (batch.enabled() || fanout.enabled())) {
+        std::cerr << "Error: --take-over can't be combined with --batch or --fanout" << std::endl;
+        return false;
+    }
+    if (fanout.enabled()) {
+        if (batch.enabled()) {
+            std::cerr << "Error: --fanout can't be combined with --batch" << std::endl;
+            return false;
+        }
+        if (fanout.warmupSec < 0) {
+            std::cerr << "Error: Invalid fan-out warm-up: " << fanout.warmupSec << std::endl;
+            return false;
+        }
+        // one physical terminal can't belong to several systems
+        for (int i = 0; i < numTerminals; i++) {
+            if (fanout.workers > 1 && terminals[i].enabled
+                && terminals[i].portName.find("%w") == std::string::npos) {
+                std::cerr << "Error: Terminal " << i << " port " << terminals[i].portName
+                          << " needs %w (the worker number) for fan-out" << std::endl;
+                return false;
+            }
+        }
+    }
     
     return true;
 }
@@ -181,6 +307,39 @@ void TerminalServerConfig::printSummary() const
     if (webServerEnabled) {
         std::cout << "  Web Configuration: Enabled on port " << webServerPort << std::endl;
     }
+
+    if (!debugSocket.empty()) {
+        std::cout << "  Microcode Debugger: " << debugSocket << std::endl;
+    }
+
+    if (!upgradeSocket.empty()) {
+        std::cout << "  Live Upgrade: " << upgradeSocket << std::endl;
+    }
+    if (!takeOver.empty()) {
+        std::cout << "  Taking Over From: " << takeOver << std::endl;
+    }
+
+    if (!diskCacheDir.empty()) {
+        std::cout << "  Disk Server Cache: " << diskCacheDir << ", "
+                  << diskCacheMB << " MB in memory per image" << std::endl;
+    }
+
+    if (batch.enabled()) {
+        std::cout << "  Batch Job: " << batch.script << " on terminal " << batch.terminal
+                  << ", timeout " << batch.timeoutSec << "s" << std::endl;
+    }
+
+    if (fanout.enabled()) {
+        std::cout << "  Fan-out: " << fanout.workers << " systems after a "
+                  << fanout.warmupSec << "s warm-up" << std::endl;
+    }
+
+    if (realtime.enabled) {
+        std::cout << "  Real-time Profile: emu CPU " << realtime.emuCpu
+                  << ", serial CPU " << realtime.serialCpu
+                  << (realtime.schedFifo ? ", SCHED_FIFO" : "")
+                  << (realtime.lockMemory ? ", mlock" : "") << std::endl;
+    }
     
     std::cout << std::endl << "Terminal Configurations:" << std::endl;
     for (int i = 0; i < numTerminals; i++) {
@@ -193,6 +352,36 @@ void TerminalServerConfig::printSummary() const
 }
 
 
+void TerminalServerConfig::specializeForWorker(int worker)
+{
+    const std::string num = std::to_string(worker);
+    for (auto &term : terminals) {
+        for (size_t pos; (pos = term.portName.find("%w")) != std::string::npos; ) {
+            term.portName.replace(pos, 2, num);
+        }
+    }
+
+    // the supervisor's INI is edited in one place, not by every worker
+    webServerEnabled = false;
+
+    if (!debugSocket.empty()) {
+        debugSocket += "." + num;
+    }
+
+    // a worker's terminals don't outlive it; a new one is forked instead
+    upgradeSocket.clear();
+
+    if (captureEnabled) {
+        captureDir += "/worker" + num;
+        mkdir(captureDir.c_str(), 0755);
+    }
+
+    // mlockall() faults in private pages for writing, which would give
+    // each worker its own copy of everything it shares with the others
+    realtime.lockMemory = false;
+}
+
+
 void TerminalServerConfig::showHelp() const
 {
     std::cout << "Wang 2200 Terminal Server" << std::endl;
@@ -204,6 +393,25 @@ void TerminalServerConfig::showHelp() const
     std::cout << "  --web-config               Enable web configuration interface" << std::endl;
     std::cout << "  --web-port=PORT            Web server port (default: 8080, enables web interface)" << std::endl;
     std::cout << "  --debug-wakeups            Log main loop wake-up reasons (for CPU debugging)" << std::endl;
+    std::cout << "  --io-profile               Count I/O bus traffic per address/card (dumped on SIGUSR1)" << std::endl;
+    std::cout << "  --realtime                 Enable real-time profile (see realtime_* INI keys)" << std::endl;
+    std::cout << "  --create-disk=TYPE:PATH    Create a blank formatted disk image and exit (repeatable)" << std::endl;
+    std::cout << "  --preallocate              Reserve disk blocks for --create-disk images (default: sparse)" << std::endl;
+    std::cout << "  --batch=SCRIPT             Run unattended: type SCRIPT into a terminal, then exit" << std::endl;
+    std::cout << "  --batch-crt=FILE           Write the batch terminal's screen text to FILE" << std::endl;
+    std::cout << "  --batch-prt=FILE           Write the batch terminal's printer text to FILE" << std::endl;
+    std::cout << "  --batch-done=TEXT          Finish the batch job when TEXT is displayed or printed" << std::endl;
+    std::cout << "  --batch-timeout=SEC        Give up on the batch job after SEC seconds (default: 600)" << std::endl;
+    std::cout << "  --batch-settle=MS          Emulated quiet time awaited after CR, RESET, SF keys (default: 2000)" << std::endl;
+    std::cout << "  --batch-term=N             MXD terminal the script is typed into (default: 0)" << std::endl;
+    std::cout << "  --mount=ADDR:DRIVE:PATH    Mount a disk image for the batch job (repeatable)" << std::endl;
+    std::cout << "  --debug-socket=PATH        Accept microcode debugger connections on a unix socket" << std::endl;
+    std::cout << "  --upgrade-socket=PATH      Offer the running system to a newer binary on a unix socket" << std::endl;
+    std::cout << "  --take-over=PATH           Take over the system running behind an upgrade socket" << std::endl;
+    std::cout << "  --serve-disks=DIR          Share the .wvd images in DIR as wvd://HOST/NAME and exit when stopped" << std::endl;
+    std::cout << "  --serve-port=PORT          Disk server TCP port (default: 22600)" << std::endl;
+    std::cout << "  --fanout=N                 Boot once, then fork N identical systems (%w in port names = system #)" << std::endl;
+    std::cout << "  --fanout-warmup=SEC        Emulated seconds to run before forking (default: 10)" << std::endl;
     std::cout << "  --help, -h                 Show this help message" << std::endl;
     std::cout << std::endl;
     std::cout << "Configuration:" << std::endl;
@@ -217,4 +425,17 @@ void TerminalServerConfig::showHelp() const
     std::cout << std::endl;
     std::cout << "  # Use custom INI file" << std::endl;
     std::cout << "  wangemu-terminal-server --ini=/path/to/custom.ini" << std::endl;
+    std::cout << std::endl;
+    std::cout << "  # Provision disk images" << std::endl;
+    std::cout << "  wangemu-terminal-server --create-disk=hd80-5:sys.wvd --create-disk=fd8:a.wvd" << std::endl;
+    std::cout << std::endl;
+    std::cout << "  # Share disk images; clients mount them as wvd://server/sys.wvd" << std::endl;
+    std::cout << "  wangemu-terminal-server --serve-disks=/srv/wang" << std::endl;
+    std::cout << std::endl;
+    std::cout << "  # Nightly report: exit status 0 when done, 2 on timeout" << std::endl;
+    std::cout << "  wangemu-terminal-server --ini=job.ini --batch=report.txt --mount=310:1:data.wvd \\" << std::endl;
+    std::cout << "      --batch-done=\"END OF REPORT\" --batch-prt=report.prt --batch-timeout=300" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Disk types for --create-disk:" << std::endl;
+    DiskProvision::listDiskPresets(std::cout);
 }
\ No newline at end of file
@@ -2,6 +2,9 @@
 #define _INCLUDE_TERMINAL_SERVER_CONFIG_H_
 
 #include "../../platform/common/SerialPort.h"
+#include "../main/RealtimeProfile.h"
+#include "../main/BatchJob.h"
+#include "../main/Fanout.h"
 #include <string>
 #include <vector>
 
@@ -16,6 +19,7 @@ struct TerminalPortConfig {
     StopBitsType stopBits;         // ONESTOPBIT, TWOSTOPBITS
     bool hwFlowControl;            // Hardware flow control (RTS/CTS)
     bool swFlowControl;            // Software flow control (XON/XOFF)
+    bool compress;                 // Run-length compress output (slow links)
     bool enabled;                  // Whether this terminal is enabled
     
     // Flow control configuration
@@ -32,6 +36,7 @@ struct TerminalPortConfig {
         stopBits(ONESTOPBIT),
         hwFlowControl(false),      // Wang terminals don't use hardware flow control
         swFlowControl(true),       // Enable XON/XOFF for Wang terminals
+        compress(false),           // Send output as the MXD produced it
         enabled(false),
         rxFifoSize(2048),          // 2KB FIFO for better flow control
         txQueueSize(8192),         // 8KB TX queue for high-output scenarios
@@ -80,6 +85,38 @@ public:
 
     // Debug settings
     bool debugWakeups = false;         // Enable wakeup reason logging
+    bool ioProfile = false;            // Enable I/O bus profiler (reported on SIGUSR1)
+
+    // Real-time execution profile (pinning, SCHED_FIFO, mlockall)
+    RealtimeProfile::Settings realtime;
+
+    // Disk image provisioning (--create-disk); when non-empty the server
+    // creates the images and exits instead of starting the emulator
+    std::vector<std::string> createDisks;  // TYPE:PATH specs
+    bool preallocateDisks = false;         // reserve blocks instead of sparse
+
+    // Unattended batch job (--batch=SCRIPT); replaces the serial terminals
+    BatchJob::Settings batch;
+
+    // Microcode debugger socket (--debug-socket=PATH; empty = disabled)
+    std::string debugSocket;
+
+    // Identical systems forked from one warm boot (--fanout=N)
+    Fanout::Settings fanout;
+
+    // Hand the running system to a newer binary (--upgrade-socket=PATH
+    // to offer it, --take-over=PATH to pick it up; empty = disabled)
+    std::string upgradeSocket;
+    std::string takeOver;
+
+    // Disk image server mode (--serve-disks=DIR); when non-empty the server
+    // shares the images in DIR over the network instead of starting the emulator
+    std::string serveDisks;
+    int servePort = 0;                     // 0 = the protocol's default port
+
+    // Cache for wvd://host/name disk images (disk_cache_dir, disk_cache_mb)
+    std::string diskCacheDir;              // empty = memory only
+    int diskCacheMB = 16;                  // memory cache per image
     
     /**
      * Load configuration from host config system (INI-style)
@@ -111,10 +148,18 @@ public:
      */
     void printSummary() const;
 
+    /**
+     * Adjust a fan-out worker's copy of the configuration: "%w" in port
+     * names becomes the worker number, and anything which can't be
+     * shared between workers is made private or turned off
+     */
+    void specializeForWorker(int worker);
+
     bool shouldExit() const { return m_cleanExit; }
 
 private:
     bool m_cleanExit = false;  // Track clean exits for help/status
+    bool m_fanoutFromCmdLine = false;  // --fanout* given; ignore the INI keys
     
 private:
     
@@ -4,6 +4,8 @@
 #include "../../shared/config/SysCfgState.h"
 #include "../../core/io/IoCardDisk.h"
 #include "../../core/cpu/Cpu2200.h"
+#include "../main/HostCpuStats.h"
+#include "../main/EmuCommandQueue.h"
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <unistd.h>
@@ -11,11 +13,21 @@
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <cstdlib>
 #include <cstring>
 #include <regex>
 #include <thread>
 #include <chrono>
 
+// HTTP status for a command the emulation thread didn't carry out
+static int commandStatus(const EmuCommandQueue::Result& result) {
+    switch (result.status) {
+        case EmuCommandQueue::Result::status_t::REJECTED: return 400;
+        case EmuCommandQueue::Result::status_t::TIMEOUT:  return 503;
+        default:                                          return 500;
+    }
+}
+
 WebConfigServer::WebConfigServer(int port, const std::string& iniPath) 
     : m_port(port), m_iniPath(iniPath) 
 {
@@ -48,6 +60,8 @@ void WebConfigServer::stop() {
 }
 
 void WebConfigServer::serverLoop() {
+    HostCpuStats::registerThread("web-config");
+
     int serverSocket = socket(AF_INET, SOCK_STREAM, 0);
     if (serverSocket < 0) {
         std::cerr << "[ERROR] Failed to create socket\n";
@@ -129,6 +143,8 @@ void WebConfigServer::handleRequest(int clientSocket, const HttpRequest& request
             response = handleGetConfig();
         } else if (request.path == "/api/disk-status") {
             response = handleGetDiskStatus();
+        } else if (request.path == "/api/host-cpu") {
+            response = handleGetHostCpu(request.query);
         } else if (request.path.find("/static/") == 0) {
             response = serveStaticFile(request.path);
         } else {
@@ -152,6 +168,8 @@ void WebConfigServer::handleRequest(int clientSocket, const HttpRequest& request
             response = handlePostDiskRemove(request.body);
         } else if (request.path == "/api/disk-speed-toggle") {
             response = handlePostDiskSpeedToggle(request.body);
+        } else if (request.path == "/api/cpu-speed") {
+            response = handlePostCpuSpeed(request.body);
         } else {
             response.status = 404;
             response.body = "Not Found";
@@ -270,21 +288,27 @@ WebConfigServer::HttpResponse WebConfigServer::handlePostInternalRestart() {
         
         std::cout << "[INFO] Requesting safe internal system restart...\n";
         
-        // Reload configuration to ensure disk_realtime setting is current
-        host::loadConfigFile(m_iniPath);
-        
-        // Apply disk realtime setting immediately (this doesn't require restart)
-        system2200::setDiskRealtime(system2200::config().getDiskRealtime());
+        // The main thread performs the restart between timeslices; doing it
+        // here would race the emulator
+        EmuCommandQueue::Command cmd;
+        cmd.type = EmuCommandQueue::Command::type_t::RESTART;
+        cmd.path = m_iniPath;
+        auto reply = EmuCommandQueue::post(cmd);
         
-        // Instead of doing the restart directly (which can cause race conditions),
-        // set a flag for the main thread to perform the restart safely
-        extern void requestInternalRestart();  // Defined in main_headless.cpp
-        requestInternalRestart();
-        
-        // Give the main thread a moment to start processing
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
-        
-        response.body = "{\"status\":\"internal restart requested - system will reconfigure safely\"}";
+        // Reconfiguring can take a while (disk images are reopened), so
+        // don't hold the browser for more than a moment
+        if (reply.wait_for(std::chrono::seconds(1)) != std::future_status::ready) {
+            response.body = "{\"status\":\"internal restart requested - system will reconfigure safely\"}";
+        } else {
+            const EmuCommandQueue::Result result = reply.get();
+            if (result.ok()) {
+                response.body = "{\"status\":\"internal restart complete\"}";
+            } else {
+                response.status = commandStatus(result);
+                response.body = "{\"error\":\"Failed to perform internal restart: " + result.message + "\"}";
+                std::cerr << "[ERROR] Failed to perform internal restart: " << result.message << "\n";
+            }
+        }
         
     } catch (const std::exception& e) {
         response.status = 500;
@@ -307,7 +331,16 @@ WebConfigServer::HttpResponse WebConfigServer::handlePostReloadConfig() {
     try {
         // Reload configuration from the INI file into the host system only
         // This is for configuration that doesn't require restart
-        host::loadConfigFile(m_iniPath);
+        EmuCommandQueue::Command cmd;
+        cmd.type = EmuCommandQueue::Command::type_t::RELOAD_CONFIG;
+        cmd.path = m_iniPath;
+        const EmuCommandQueue::Result result = EmuCommandQueue::call(cmd);
+        if (!result.ok()) {
+            response.status = commandStatus(result);
+            response.body = "{\"error\":\"Failed to reload configuration: " + result.message + "\"}";
+            std::cerr << "[ERROR] Failed to reload configuration: " << result.message << "\n";
+            return response;
+        }
         response.body = "{\"status\":\"configuration reloaded successfully\"}";
         std::cout << "[INFO] Configuration reloaded from " << m_iniPath << " via web interface\n";
     } catch (const std::exception& e) {
@@ -331,6 +364,7 @@ WebConfigServer::HttpResponse WebConfigServer::handlePostShutdown() {
     
     // Execute system shutdown in a separate thread after sending response
     std::thread([]() {
+        HostCpuStats::registerThread("web-worker");
         std::this_thread::sleep_for(std::chrono::milliseconds(500));
         
         std::cout << "[INFO] System shutdown requested from web interface\n";
@@ -362,6 +396,7 @@ WebConfigServer::HttpResponse WebConfigServer::handlePostRestart() {
     
     // Execute system restart in a separate thread after sending response
     std::thread([]() {
+        HostCpuStats::registerThread("web-worker");
         std::this_thread::sleep_for(std::chrono::milliseconds(500));
         
         std::cout << "[INFO] System restart requested from web interface\n";
@@ -435,24 +470,22 @@ WebConfigServer::HttpResponse WebConfigServer::handlePostDiskInsert(const std::s
         
         std::cout << "[INFO] Inserting disk: slot=" << slot << ", drive=" << drive << ", file=" << filename << "\n";
         
-        // Check if drive already has a disk (like GUI does)
-        const int status = IoCardDisk::wvdDriveStatus(slot, drive);
-        if ((status & IoCardDisk::WVD_STAT_DRIVE_OCCUPIED) != 0) {
-            response.status = 400;
-            response.body = "{\"error\":\"Drive already contains a disk. Remove it first.\"}";
-            return response;
-        }
-        
-        // Use the same direct disk operation as the GUI
-        bool ok = IoCardDisk::wvdInsertDisk(slot, drive, filename);
+        // The emulation thread does the same disk operation as the GUI,
+        // refusing if the drive already has a disk (like GUI does)
+        EmuCommandQueue::Command cmd;
+        cmd.type = EmuCommandQueue::Command::type_t::DISK_INSERT;
+        cmd.slot = slot;
+        cmd.drive = drive;
+        cmd.path = filename;
+        const EmuCommandQueue::Result result = EmuCommandQueue::call(cmd);
         
-        if (ok) {
+        if (result.ok()) {
             response.body = "{\"status\":\"disk inserted successfully\"}";
             std::cout << "[INFO] Disk inserted successfully\n";
         } else {
-            response.status = 500;
-            response.body = "{\"error\":\"Failed to insert disk\"}";
-            std::cout << "[ERROR] Failed to insert disk\n";
+            response.status = commandStatus(result);
+            response.body = "{\"error\":\"" + result.message + "\"}";
+            std::cout << "[ERROR] Failed to insert disk: " << result.message << "\n";
         }
         
     } catch (const std::exception& e) {
@@ -506,24 +539,21 @@ WebConfigServer::HttpResponse WebConfigServer::handlePostDiskRemove(const std::s
         
         std::cout << "[INFO] Removing disk: slot=" << slot << ", drive=" << drive << "\n";
         
-        // Check if drive actually has a disk to remove
-        const int status = IoCardDisk::wvdDriveStatus(slot, drive);
-        if ((status & IoCardDisk::WVD_STAT_DRIVE_OCCUPIED) == 0) {
-            response.status = 400;
-            response.body = "{\"error\":\"No disk in drive to remove.\"}";
-            return response;
-        }
-        
-        // Use the same direct disk operation as the GUI
-        bool ok = IoCardDisk::wvdRemoveDisk(slot, drive);
+        // The emulation thread does the same disk operation as the GUI,
+        // refusing if the drive has no disk to remove
+        EmuCommandQueue::Command cmd;
+        cmd.type = EmuCommandQueue::Command::type_t::DISK_REMOVE;
+        cmd.slot = slot;
+        cmd.drive = drive;
+        const EmuCommandQueue::Result result = EmuCommandQueue::call(cmd);
         
-        if (ok) {
+        if (result.ok()) {
             response.body = "{\"status\":\"disk removed successfully\"}";
             std::cout << "[INFO] Disk removed successfully\n";
         } else {
-            response.status = 500;
-            response.body = "{\"error\":\"Failed to remove disk\"}";
-            std::cout << "[ERROR] Failed to remove disk\n";
+            response.status = commandStatus(result);
+            response.body = "{\"error\":\"" + result.message + "\"}";
+            std::cout << "[ERROR] Failed to remove disk: " << result.message << "\n";
         }
         
     } catch (const std::exception& e) {
@@ -548,11 +578,12 @@ WebConfigServer::HttpResponse WebConfigServer::handleGetDiskStatus() {
         std::ostringstream json;
         json << "{\"drives\":[";
         
-        // Check status of drives 0-3 in slot 1
+        // Check status of drives 0-3 in slot 1, as last published by the
+        // disk controller
         for (int drive = 0; drive < 4; drive++) {
             if (drive > 0) json << ",";
             
-            const int status = IoCardDisk::wvdDriveStatus(1, drive);
+            const int status = IoCardDisk::wvdPublishedStatus(1, drive);
             const bool exists = (status & IoCardDisk::WVD_STAT_DRIVE_EXISTENT) != 0;
             const bool occupied = (status & IoCardDisk::WVD_STAT_DRIVE_OCCUPIED) != 0;
             const bool busy = (status & IoCardDisk::WVD_STAT_DRIVE_BUSY) != 0;
@@ -579,6 +610,26 @@ WebConfigServer::HttpResponse WebConfigServer::handleGetDiskStatus() {
     return response;
 }
 
+WebConfigServer::HttpResponse WebConfigServer::handleGetHostCpu(const std::string& query) {
+    HttpResponse response;
+    response.headers["Content-Type"] = "application/json";
+    response.headers["Access-Control-Allow-Origin"] = "*";
+
+    // optional ?seconds=N selects the averaging window
+    int seconds = HostCpuStats::DEFAULT_WINDOW;
+    const size_t pos = query.find("seconds=");
+    if (pos != std::string::npos) {
+        seconds = std::atoi(query.c_str() + pos + 8);
+    }
+
+    std::ostringstream json;
+    json << "{" << std::endl;
+    HostCpuStats::outputStatus(json, seconds);
+    json << std::endl << "}";
+    response.body = json.str();
+    return response;
+}
+
 WebConfigServer::HttpResponse WebConfigServer::handlePostDiskSpeedToggle(const std::string& body) {
     HttpResponse response;
     response.headers["Content-Type"] = "application/json";
@@ -605,13 +656,18 @@ WebConfigServer::HttpResponse WebConfigServer::handlePostDiskSpeedToggle(const s
         
         std::cout << "[INFO] Setting disk speed to: " << (realtime ? "realtime" : "unregulated") << "\n";
         
-        // Apply the setting immediately (like the original GUI does)
-        system2200::setDiskRealtime(realtime);
-        
-        // Also update the host config so it persists across restarts
-        // This mimics what the original GUI does when saving configuration
-        std::string subgroup("misc");
-        host::configWriteBool(subgroup, "disk_realtime", realtime);
+        // Apply the setting at the next timeslice (like the original GUI does);
+        // the emulation thread also updates the host config so it persists
+        EmuCommandQueue::Command cmd;
+        cmd.type = EmuCommandQueue::Command::type_t::DISK_REALTIME;
+        cmd.value = realtime ? 1 : 0;
+        const EmuCommandQueue::Result result = EmuCommandQueue::call(cmd);
+        if (!result.ok()) {
+            response.status = commandStatus(result);
+            response.body = "{\"error\":\"Failed to set disk speed: " + result.message + "\"}";
+            std::cerr << "[ERROR] Failed to set disk speed: " << result.message << "\n";
+            return response;
+        }
         
         response.body = "{\"status\":\"disk speed setting applied immediately\",\"realtime\":" + 
                         std::string(realtime ? "true" : "false") + "}";
@@ -630,6 +686,65 @@ WebConfigServer::HttpResponse WebConfigServer::handlePostDiskSpeedToggle(const s
     return response;
 }
 
+WebConfigServer::HttpResponse WebConfigServer::handlePostCpuSpeed(const std::string& body) {
+    HttpResponse response;
+    response.headers["Content-Type"] = "application/json";
+    response.headers["Access-Control-Allow-Origin"] = "*";
+    
+    try {
+        // Parse JSON request: {"multiplier": N}, where 0 means unregulated
+        std::cout << "[INFO] CPU speed request: " << body << "\n";
+        
+        int multiplier = -1;
+        size_t multPos = body.find("\"multiplier\":");
+        if (multPos != std::string::npos) {
+            multPos += 13; // Skip "multiplier":
+            while (multPos < body.size() && (body[multPos] == ' ' || body[multPos] == '\t')) multPos++;
+            if (multPos < body.size() && isdigit(body[multPos])) {
+                multiplier = std::atoi(body.c_str() + multPos);
+            }
+        }
+        
+        if (multiplier < 0 || multiplier > SysCfgState::MAX_SPEED_MULTIPLIER) {
+            response.status = 400;
+            response.body = "{\"error\":\"multiplier must be 0 (unregulated) to " +
+                            std::to_string(SysCfgState::MAX_SPEED_MULTIPLIER) + "\"}";
+            return response;
+        }
+        
+        const bool regulated = (multiplier > 0);
+        std::cout << "[INFO] Setting CPU speed to: "
+                  << (regulated ? std::to_string(multiplier) + "x" : std::string("unregulated")) << "\n";
+        
+        // Apply the setting at the next timeslice; the emulation thread
+        // also persists it the way SysCfgState::saveIni() would
+        EmuCommandQueue::Command cmd;
+        cmd.type = EmuCommandQueue::Command::type_t::CPU_SPEED;
+        cmd.value = multiplier;
+        const EmuCommandQueue::Result result = EmuCommandQueue::call(cmd);
+        if (!result.ok()) {
+            response.status = commandStatus(result);
+            response.body = "{\"error\":\"Failed to set cpu speed: " + result.message + "\"}";
+            std::cerr << "[ERROR] Failed to set cpu speed: " << result.message << "\n";
+            return response;
+        }
+        
+        response.body = "{\"status\":\"cpu speed setting applied immediately\",\"multiplier\":" +
+                        std::to_string(multiplier) + "}";
+        
+    } catch (const std::exception& e) {
+        response.status = 500;
+        response.body = "{\"error\":\"Failed to set cpu speed: " + std::string(e.what()) + "\"}";
+        std::cerr << "[ERROR] Failed to set cpu speed: " << e.what() << "\n";
+    } catch (...) {
+        response.status = 500;
+        response.body = "{\"error\":\"Failed to set cpu speed: unknown error\"}";
+        std::cerr << "[ERROR] Failed to set cpu speed: unknown error\n";
+    }
+    
+    return response;
+}
+
 WebConfigServer::HttpResponse WebConfigServer::handleGetRoot() {
     HttpResponse response;
     response.headers["Content-Type"] = "text/html";
@@ -710,6 +825,17 @@ WebConfigServer::HttpResponse WebConfigServer::handleGetRoot() {
     html << "                            <!-- RAM options will be populated dynamically based on CPU type -->\n";
     html << "                        </select>\n";
     html << "                    </div>\n";
+    html << "                    <div class=\"form-group\">\n";
+    html << "                        <label for=\"cpuSpeed\">Speed:</label>\n";
+    html << "                        <select id=\"cpuSpeed\">\n";
+    html << "                            <option value=\"1\" selected>Real (1x)</option>\n";
+    html << "                            <option value=\"2\">2x</option>\n";
+    html << "                            <option value=\"4\">4x</option>\n";
+    html << "                            <option value=\"8\">8x</option>\n";
+    html << "                            <option value=\"16\">16x</option>\n";
+    html << "                            <option value=\"0\">Unregulated</option>\n";
+    html << "                        </select>\n";
+    html << "                    </div>\n";
     html << "                </div>\n";
     html << "                <div class=\"checkbox-group\">\n";
     html << "                    <input type=\"checkbox\" id=\"warnInvalidIo\"> <label for=\"warnInvalidIo\">Warn on Invalid I/O Device Access</label>\n";
@@ -733,7 +859,7 @@ WebConfigServer::HttpResponse WebConfigServer::handleGetRoot() {
     html << "                    <div>Terminal</div>\n";
     html << "                    <div>Port Name</div>\n";
     html << "                    <div>Baud Rate</div>\n";
-    html << "                    <div></div>\n";
+    html << "                    <div>RTS/CTS</div>\n";
     html << "                </div>\n";
     html << "                \n";
     html << "                <div class=\"terminal-grid terminal-row\" id=\"terminalRow0\">\n";
@@ -746,7 +872,7 @@ WebConfigServer::HttpResponse WebConfigServer::handleGetRoot() {
     html << "                        <option value=\"2400\">2400</option>\n";
     html << "                        <option value=\"1200\">1200</option>\n";
     html << "                    </select>\n";
-    html << "                    <div></div>\n";
+    html << "                    <input type=\"checkbox\" id=\"term1_rtscts\">\n";
     html << "                </div>\n";
     html << "                \n";
     html << "                <div class=\"terminal-grid terminal-row\" id=\"terminalRow1\" style=\"display: none;\">\n";
@@ -759,7 +885,7 @@ WebConfigServer::HttpResponse WebConfigServer::handleGetRoot() {
     html << "                        <option value=\"2400\">2400</option>\n";
     html << "                        <option value=\"1200\">1200</option>\n";
     html << "                    </select>\n";
-    html << "                    <div></div>\n";
+    html << "                    <input type=\"checkbox\" id=\"term2_rtscts\">\n";
     html << "                </div>\n";
     html << "                \n";
     html << "                <div class=\"terminal-grid terminal-row\" id=\"terminalRow2\" style=\"display: none;\">\n";
@@ -772,7 +898,7 @@ WebConfigServer::HttpResponse WebConfigServer::handleGetRoot() {
     html << "                        <option value=\"2400\">2400</option>\n";
     html << "                        <option value=\"1200\">1200</option>\n";
     html << "                    </select>\n";
-    html << "                    <div></div>\n";
+    html << "                    <input type=\"checkbox\" id=\"term3_rtscts\">\n";
     html << "                </div>\n";
     html << "                \n";
     html << "                <div class=\"terminal-grid terminal-row\" id=\"terminalRow3\" style=\"display: none;\">\n";
@@ -785,7 +911,7 @@ WebConfigServer::HttpResponse WebConfigServer::handleGetRoot() {
     html << "                        <option value=\"2400\">2400</option>\n";
     html << "                        <option value=\"1200\">1200</option>\n";
     html << "                    </select>\n";
-    html << "                    <div></div>\n";
+    html << "                    <input type=\"checkbox\" id=\"term4_rtscts\">\n";
     html << "                </div>\n";
     html << "            </div>\n";
     html << "        </div>\n";
@@ -933,7 +1059,9 @@ WebConfigServer::HttpResponse WebConfigServer::handleGetRoot() {
     html << "            ini += '[wangemu/config-0/cpu]\\n';\n";
     html << "            ini += 'cpu=' + document.getElementById('cpu').value + '\\n';\n";
     html << "            ini += 'memsize=' + document.getElementById('ram').value + '\\n';\n";
-    html << "            ini += 'speed=regulated\\n';\n";
+    html << "            const cpuSpeed = document.getElementById('cpuSpeed').value;\n";
+    html << "            ini += 'speed=' + (cpuSpeed === '0' ? 'unregulated' : 'regulated') + '\\n';\n";
+    html << "            ini += 'speed_multiplier=' + (cpuSpeed === '0' ? '1' : cpuSpeed) + '\\n';\n";
     html << "            ini += '[wangemu/config-0/io/slot-0]\\n';\n";
     html << "            ini += 'addr=0x000\\n';\n";
     html << "            ini += 'type=2236 MXD\\n';\n";
@@ -946,10 +1074,11 @@ WebConfigServer::HttpResponse WebConfigServer::handleGetRoot() {
     html << "                const enabled = i < numTerminals; // Enable based on number of terminals selected\n";
     html << "                const port = document.getElementById('term' + (i+1) + '_port').value;\n";
     html << "                const baud = document.getElementById('term' + (i+1) + '_baud').value;\n";
+    html << "                const rtscts = document.getElementById('term' + (i+1) + '_rtscts').checked;\n";
     html << "                \n";
     html << "                ini += 'terminal' + i + '_baud_rate=' + baud + '\\n';\n";
     html << "                ini += 'terminal' + i + '_com_port=' + (enabled ? port : '') + '\\n';\n";
-    html << "                ini += 'terminal' + i + '_flow_control=0\\n';\n";
+    html << "                ini += 'terminal' + i + '_flow_control=' + (rtscts ? '1' : '0') + '\\n';\n";
     html << "                ini += 'terminal' + i + '_sw_flow_control=1\\n'; // Always enable XON/XOFF flow control\n";
     html << "            }\n";
     html << "            \n";
@@ -991,6 +1120,9 @@ WebConfigServer::HttpResponse WebConfigServer::handleGetRoot() {
     html << "                const ramSize = config['wangemu/config-0/cpu']['memsize'] || '512';\n";
     html << "                document.getElementById('cpu').value = cpuType;\n";
     html << "                updateRamOptions(cpuType, ramSize);\n";
+    html << "                const speed = config['wangemu/config-0/cpu']['speed'];\n";
+    html << "                const multiplier = config['wangemu/config-0/cpu']['speed_multiplier'] || '1';\n";
+    html << "                document.getElementById('cpuSpeed').value = (speed === 'unregulated') ? '0' : multiplier;\n";
     html << "            }\n";
     html << "            \n";
     html << "            // Misc settings\n";
@@ -1014,6 +1146,7 @@ WebConfigServer::HttpResponse WebConfigServer::handleGetRoot() {
     html << "                    \n";
     html << "                    document.getElementById('term' + (i+1) + '_port').value = port || '/dev/ttyUSB' + i;\n";
     html << "                    document.getElementById('term' + (i+1) + '_baud').value = baud;\n";
+    html << "                    document.getElementById('term' + (i+1) + '_rtscts').checked = (cardcfg['terminal' + i + '_flow_control'] === '1');\n";
     html << "                }\n";
     html << "            }\n";
     html << "            \n";
@@ -1363,6 +1496,28 @@ WebConfigServer::HttpResponse WebConfigServer::handleGetRoot() {
     html << "            });\n";
     html << "        }\n";
     html << "        \n";
+    html << "        // Change the emulated CPU speed immediately\n";
+    html << "        function setCpuSpeed() {\n";
+    html << "            const multiplier = parseInt(document.getElementById('cpuSpeed').value, 10);\n";
+    html << "            \n";
+    html << "            fetch('/api/cpu-speed', {\n";
+    html << "                method: 'POST',\n";
+    html << "                headers: { 'Content-Type': 'application/json' },\n";
+    html << "                body: JSON.stringify({ multiplier: multiplier })\n";
+    html << "            })\n";
+    html << "            .then(function(response) { return response.json(); })\n";
+    html << "            .then(function(data) {\n";
+    html << "                if (data.error) {\n";
+    html << "                    showStatus('Error setting CPU speed: ' + data.error, true);\n";
+    html << "                } else {\n";
+    html << "                    showStatus('CPU speed set to ' + (multiplier ? multiplier + 'x real speed' : 'unregulated'));\n";
+    html << "                }\n";
+    html << "            })\n";
+    html << "            .catch(function(error) {\n";
+    html << "                showStatus('Error setting CPU speed: ' + error, true);\n";
+    html << "            });\n";
+    html << "        }\n";
+    html << "        \n";
     html << "        // Function to update RAM options based on CPU type (matching GUI behavior)\n";
     html << "        function updateRamOptions(cpuType, selectedRam) {\n";
     html << "            const ramSelect = document.getElementById('ram');\n";
@@ -1450,6 +1605,7 @@ WebConfigServer::HttpResponse WebConfigServer::handleGetRoot() {
     html << "        \n";
     html << "        // Add event listener to disk realtime checkbox for immediate toggle\n";
     html << "        document.getElementById('diskRealtime').addEventListener('change', toggleDiskSpeed);\n";
+    html << "        document.getElementById('cpuSpeed').addEventListener('change', setCpuSpeed);\n";
     html << "        \n";
     html << "        // Initial updates\n";
     html << "        updateDriveSlots();\n";
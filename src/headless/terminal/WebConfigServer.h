@@ -73,7 +73,9 @@ private:
     HttpResponse handlePostDiskInsert(const std::string& body);
     HttpResponse handlePostDiskRemove(const std::string& body);
     HttpResponse handlePostDiskSpeedToggle(const std::string& body);
+    HttpResponse handlePostCpuSpeed(const std::string& body);
     HttpResponse handleGetDiskStatus();
+    HttpResponse handleGetHostCpu(const std::string& query);
     HttpResponse handleGetRoot();
     HttpResponse serveStaticFile(const std::string& path);
     
@@ -118,10 +118,12 @@ bool SerialPort::open(const SerialConfig &config)
     dcb.fOutX = dcb.fInX = FALSE;
     dcb.fDsrSensitivity = FALSE;
 
-    // Optional hardware CTS flow control (not used for Wang terminals)
+    // Optional hardware CTS flow control (not used for Wang terminals).
+    // RTS stays under our control so it follows the MXD's receive FIFO
+    // (see setRts()) rather than the driver's buffer.
     if (config.hwFlowControl) {
         dcb.fOutxCtsFlow = TRUE;
-        dcb.fRtsControl  = RTS_CONTROL_HANDSHAKE;
+        dcb.fRtsControl  = m_rtsAsserted.load() ? RTS_CONTROL_ENABLE : RTS_CONTROL_DISABLE;
     }
 
     // Optional software XON/XOFF flow control (recommended for Wang terminals)
@@ -273,6 +275,14 @@ void SerialPort::sendXOFF()
     }
 }
 
+void SerialPort::setRts(bool asserted)
+{
+    m_rtsAsserted.store(asserted);
+    if (m_handle != INVALID_HANDLE_VALUE) {
+        EscapeCommFunction(m_handle, asserted ? SETRTS : CLRRTS);
+    }
+}
+
 void SerialPort::startReceiving()
 {
     m_stopReceiving = false;
@@ -293,6 +303,10 @@ void SerialPort::receiveThreadProc()
     uint8  buffer[512];
     DWORD  bytesRead = 0;
 
+    if (m_threadInitCallback) {
+        m_threadInitCallback();
+    }
+
     while (!m_stopReceiving && isOpen()) {
         // reset event and issue overlapped read
         ResetEvent(m_readEvent);
@@ -484,8 +498,11 @@ void SerialPort::flushTxQueue()
 #include <fcntl.h>
 #include <unistd.h>
 #include <sys/select.h>
+#include <sys/ioctl.h>
+#include <sys/uio.h>
 #include <poll.h>
 #include <errno.h>
+#include <algorithm>
 #include <cstring>
 #include <cassert>
 // POSIX implementation helper functions
@@ -538,7 +555,187 @@ bool SerialPort::open(const SerialConfig &config)
     }
 
     m_config = config;
+    resetTx(config);
+
+    if (!openDevice(config)) {
+        return false;
+    }
+
+    // Start receiving thread
+    startReceiving();
+    
+    // Reset reconnection state on successful connection
+    m_connected.store(true);
+    m_reconnectAttempts.store(0);
+
+    dbglog("SerialPort::open() - Opened %s at %d baud, %d%c%d, flow %s\n",
+           config.portName.c_str(), config.baudRate, config.dataBits,
+           (config.parity==ODDPARITY ? 'O' : (config.parity==EVENPARITY ? 'E' : 'N')),
+           (config.stopBits==ONESTOPBIT ? 1 : 2),
+           config.hwFlowControl && config.swFlowControl ? "RTS/CTS+XON/XOFF" :
+           config.hwFlowControl ? "RTS/CTS" :
+           config.swFlowControl ? "XON/XOFF" : "none");
+
+    return true;
+}
+
+// empty the transmit ring, sized for this configuration
+void SerialPort::resetTx(const SerialConfig &config)
+{
+    // the transmit ring holds at least txQueueSize bytes
+    size_t ring = 256;
+    while (ring < config.txQueueSize) {
+        ring <<= 1;
+    }
+    m_txRing.assign(ring, 0);
+    m_txMask = ring - 1;
+    m_txHead.store(0);
+    m_txTail.store(0);
+    m_txLocal.clear();
+    m_txDiscard.store(false);
+    m_txStopped = false;
+
+    // keep about TX_OUTQ_MS of output queued in the kernel
+    const int charBits = 1 + config.dataBits + (config.parity != NOPARITY ? 1 : 0)
+                       + (config.stopBits == TWOSTOPBITS ? 2 : 1);
+    m_charNs = static_cast<int64_t>(charBits) * 1000000000LL / std::max<uint32_t>(config.baudRate, 1);
+    m_txOutqTarget = std::max<size_t>(TX_OUTQ_MIN, TX_OUTQ_MS * 1000000LL / m_charNs);
+}
+
+// Stop using the device without closing it, so another process can carry
+// on with the same open line.  Output not yet written goes along with it.
+bool SerialPort::release(HandoffState *out)
+{
+    if (!isOpen()) {
+        return false;
+    }
+    stopReceiving();
+
+    out->fd          = m_fd;
+    out->xoffSent    = m_xoffSent.load();
+    out->rtsAsserted = m_rtsAsserted.load();
+    out->txStopped   = m_txStopped;
+    out->pendingTx   = m_txLocal;
+    if (!m_txDiscard.exchange(false)) {
+        const size_t head = m_txHead.load();
+        for (size_t pos = m_txTail.load(); pos != head; ++pos) {
+            out->pendingTx.push_back(m_txRing[pos & m_txMask]);
+        }
+    }
+
+    m_txTail.store(m_txHead.load());
+    m_txLocal.clear();
+    m_fd = -1;
+    m_connected.store(false);
+
+    dbglog("SerialPort::release() - Released %s\n", m_config.portName.c_str());
+    return true;
+}
+
+// Take over a device released by release(), possibly in another process.
+bool SerialPort::adopt(const SerialConfig &config, const HandoffState &state)
+{
+    if (isOpen()) {
+        close();
+    }
+
+    m_config = config;
+    resetTx(config);
+
+    m_fd = state.fd;
+    m_rtsAsserted.store(state.rtsAsserted);
+    if (tcgetattr(m_fd, &m_adoptedTermios) != 0) {
+        dbglog("SerialPort::adopt() - tcgetattr failed: %s\n", strerror(errno));
+        ::close(m_fd);
+        m_fd = -1;
+        return false;
+    }
+    if (!configureDevice(config, false)) {
+        return false;
+    }
+    loadHandoff(state);
+    m_adoptPending = true;
+
+    dbglog("SerialPort::adopt() - Adopted %s with %zu bytes pending\n",
+           config.portName.c_str(), state.pendingTx.size());
+    return true;
+}
+
+// Begin reading and writing a line set up by adopt().
+void SerialPort::startAdopted()
+{
+    if (!m_adoptPending) {
+        return;
+    }
+    m_adoptPending = false;
+    startHandoff();
+}
+
+// Give up a line set up by adopt() but never started, leaving it the way
+// adopt() found it for the process which released it.  Its pending output
+// is dropped: that process still has it, and sends it when it reclaims.
+void SerialPort::abandonAdopted()
+{
+    if (!m_adoptPending) {
+        return;
+    }
+    m_adoptPending = false;
+    if (tcsetattr(m_fd, TCSANOW, &m_adoptedTermios) != 0) {
+        dbglog("SerialPort::abandonAdopted() - tcsetattr failed: %s\n", strerror(errno));
+    }
+    ::close(m_fd);
+    m_fd = -1;
+    m_txTail.store(m_txHead.load());
+
+    dbglog("SerialPort::abandonAdopted() - Gave back %s\n", m_config.portName.c_str());
+}
 
+// Take back a device this port handed to release(), after the process it
+// went to gave up on it.  That process put back the settings it found
+// (see abandonAdopted()), so the line is set up the way this port left it;
+// setting it up again can fail where the first time didn't (eg, a pty
+// refuses to be given the parity it ignored the first time).
+bool SerialPort::reclaim(const HandoffState &state)
+{
+    if (isOpen() || (state.fd == -1)) {
+        return false;
+    }
+
+    resetTx(m_config);
+    m_fd = state.fd;
+    m_rtsAsserted.store(state.rtsAsserted);
+    loadHandoff(state);
+    startHandoff();
+
+    dbglog("SerialPort::reclaim() - Reclaimed %s with %zu bytes pending\n",
+           m_config.portName.c_str(), state.pendingTx.size());
+    return true;
+}
+
+// pick up where the releasing port stopped, on the line now in m_fd
+void SerialPort::loadHandoff(const HandoffState &state)
+{
+    m_xoffSent.store(state.xoffSent);
+    m_txStopped = state.txStopped;
+    for (size_t i = 0; i < state.pendingTx.size() && i < m_txRing.size(); ++i) {
+        m_txRing[i] = state.pendingTx[i];
+    }
+    m_txHead.store(std::min(state.pendingTx.size(), m_txRing.size()));
+}
+
+// and carry on from there
+void SerialPort::startHandoff()
+{
+    startReceiving();
+    m_connected.store(true);
+    m_reconnectAttempts.store(0);
+}
+
+// open and configure the device, without touching the receive thread.
+// this is shared by open() and by attemptReconnect(), which runs on the
+// receive thread itself.
+bool SerialPort::openDevice(const SerialConfig &config)
+{
     // Open the serial port in blocking mode for more efficient I/O
     m_fd = ::open(config.portName.c_str(), O_RDWR | O_NOCTTY);
     if (m_fd == -1) {
@@ -546,12 +743,19 @@ bool SerialPort::open(const SerialConfig &config)
                config.portName.c_str(), strerror(errno));
         return false;
     }
+    return configureDevice(config, true);
+}
 
+// set up the line on m_fd.  a fresh device has whatever was in its queues
+// discarded; one adopted from another process keeps them.
+bool SerialPort::configureDevice(const SerialConfig &config, bool fresh)
+{
     // Configure the port
     struct termios tty;
     if (tcgetattr(m_fd, &tty) != 0) {
         dbglog("SerialPort::open() - tcgetattr failed: %s\n", strerror(errno));
-        close();
+        ::close(m_fd);
+        m_fd = -1;
         return false;
     }
 
@@ -598,6 +802,10 @@ bool SerialPort::open(const SerialConfig &config)
     // Enable receiver and set local mode
     tty.c_cflag |= (CREAD | CLOCAL);
 
+    // tcflow() sends these for sendXON()/sendXOFF()
+    tty.c_cc[VSTART] = 0x11;
+    tty.c_cc[VSTOP]  = 0x13;
+
     // Hardware flow control (disabled by default for Wang terminals)
     if (config.hwFlowControl) {
         tty.c_cflag |= CRTSCTS;
@@ -620,27 +828,32 @@ bool SerialPort::open(const SerialConfig &config)
     // Apply the configuration
     if (tcsetattr(m_fd, TCSANOW, &tty) != 0) {
         dbglog("SerialPort::open() - tcsetattr failed: %s\n", strerror(errno));
-        close();
+        ::close(m_fd);
+        m_fd = -1;
         return false;
     }
 
+    // tcsetattr() succeeds if any of the changes took, so check that IXON
+    // did; if not, processReceivedByte() stops and starts output instead
+    struct termios applied;
+    m_kernelIxon = (tcgetattr(m_fd, &applied) == 0) && (applied.c_iflag & IXON);
+
     // Flush any existing data
-    tcflush(m_fd, TCIOFLUSH);
+    if (fresh) {
+        tcflush(m_fd, TCIOFLUSH);
+    }
 
-    // Start receiving thread
-    startReceiving();
-    
-    // Reset reconnection state on successful connection
-    m_connected.store(true);
-    m_reconnectAttempts.store(0);
+    // Sample DSR so a later rising edge can be detected; not all
+    // devices (eg, ptys) support modem control lines.
+    int modem = 0;
+    m_dsrSupported = (ioctl(m_fd, TIOCMGET, &modem) == 0);
+    m_dsrAsserted  = m_dsrSupported && ((modem & TIOCM_DSR) != 0);
 
-    dbglog("SerialPort::open() - Opened %s at %d baud, %d%c%d, flow %s\n",
-           config.portName.c_str(), config.baudRate, config.dataBits,
-           (config.parity==ODDPARITY ? 'O' : (config.parity==EVENPARITY ? 'E' : 'N')),
-           (config.stopBits==ONESTOPBIT ? 1 : 2),
-           config.hwFlowControl && config.swFlowControl ? "RTS/CTS+XON/XOFF" :
-           config.hwFlowControl ? "RTS/CTS" :
-           config.swFlowControl ? "XON/XOFF" : "none");
+    // a reopened device comes up with RTS asserted
+    if (!m_rtsAsserted.load()) {
+        int bits = TIOCM_RTS;
+        ioctl(m_fd, TIOCMBIC, &bits);
+    }
 
     return true;
 }
@@ -654,12 +867,11 @@ void SerialPort::close()
 
     ::close(m_fd);
     m_fd = -1;
+    m_adoptPending = false;
 
-    // Clear TX buffer
-    {
-        std::lock_guard<std::recursive_mutex> lock(m_txMutex);
-        m_outbuf.clear();
-    }
+    // Clear TX buffer; the receive thread is gone, so this is safe
+    m_txTail.store(m_txHead.load());
+    m_txLocal.clear();
     
     // Update connection state
     m_connected.store(false);
@@ -674,8 +886,7 @@ bool SerialPort::isOpen() const
 
 size_t SerialPort::getTxQueueSize() const
 {
-    std::lock_guard<std::recursive_mutex> lock(m_txMutex);
-    return m_outbuf.size();
+    return m_txHead.load(std::memory_order_relaxed) - m_txTail.load(std::memory_order_relaxed);
 }
 
 bool SerialPort::isTxQueueNearFull(float threshold) const
@@ -686,9 +897,15 @@ bool SerialPort::isTxQueueNearFull(float threshold) const
 
 void SerialPort::flushTxQueue()
 {
-    std::lock_guard<std::recursive_mutex> lock(m_txMutex);
-    // Clear the TX buffer without sending the bytes
-    m_outbuf.clear();
+    // Clear the TX buffer without sending the bytes.  Only the receive
+    // thread may move the tail, so ask it to if it is running.
+    if (m_receiveThread.joinable() && std::this_thread::get_id() != m_receiveThread.get_id()) {
+        m_txDiscard.store(true);
+        wakeReceiveThread();
+    } else {
+        m_txTail.store(m_txHead.load());
+        m_txLocal.clear();
+    }
     dbglog("SerialPort::flushTxQueue() - Cleared TX buffer for %s\n", m_config.portName.c_str());
 }
 
@@ -709,34 +926,10 @@ void SerialPort::setReceiveCallback(RxCallback cb)
 
 void SerialPort::sendByte(uint8 byte)
 {
-    if (!isOpen()) {
-        dbglog("SerialPort::sendByte() - port closed, drop 0x%02X\n", byte);
-        return;
-    }
-
-    // Direct write for responsive terminal display
-    ssize_t written = write(m_fd, &byte, 1);
-    if (written == 1) {
-        m_txByteCount.fetch_add(1);
-        if (m_captureCallback) {
-            m_captureCallback(byte, false); // false = TX
-        }
-
-        // Track activity for adaptive timing
-        {
-            std::lock_guard<std::mutex> lock(m_activityMutex);
-            m_lastTxTime = std::chrono::steady_clock::now();
-        }
-        m_recentTxBytes.fetch_add(1);
-    } else if (written == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
-        // Port busy, try enqueueTx as fallback
-        enqueueTx(&byte, 1);
-    } else if (written != 1) {
-        dbglog("SerialPort::sendByte() - write failed: %s\n",
-               written == -1 ? strerror(errno) : "partial write");
-    }
+    sendData(&byte, 1);
 }
 
+// queue bytes for the receive thread, which does all writes to the device
 void SerialPort::sendData(const uint8 *data, size_t length)
 {
     if (!isOpen()) {
@@ -744,42 +937,49 @@ void SerialPort::sendData(const uint8 *data, size_t length)
         return;
     }
 
-    // Try direct write first for responsive display
-    ssize_t written = write(m_fd, data, length);
-    if (written > 0) {
-        m_txByteCount.fetch_add(written);
-        if (m_captureCallback) {
-            for (ssize_t i = 0; i < written; i++) {
-                m_captureCallback(data[i], false); // false = TX
-            }
-        }
+    // the receive thread itself (eg, a link-up repaint) queues privately;
+    // those bytes go out ahead of the ring
+    if (std::this_thread::get_id() == m_receiveThread.get_id()) {
+        m_txLocal.insert(m_txLocal.end(), data, data + length);
+        return;
+    }
 
-        // Track activity for adaptive timing
-        {
-            std::lock_guard<std::mutex> lock(m_activityMutex);
-            m_lastTxTime = std::chrono::steady_clock::now();
-        }
-        m_recentTxBytes.fetch_add(written);
+    const size_t head = m_txHead.load(std::memory_order_relaxed);
+    const size_t tail = m_txTail.load(std::memory_order_acquire);
+    if (m_txRing.size() - (head - tail) < length) {
+        dbglog("SerialPort::sendData() - TX buffer full (%zu + %zu > %zu), dropping data\n",
+               head - tail, length, m_txRing.size());
+        return;
+    }
+    for (size_t i = 0; i < length; ++i) {
+        m_txRing[(head + i) & m_txMask] = data[i];
+    }
+    m_txHead.store(head + length);
 
-        // If partial write, queue the remaining data
-        if (static_cast<size_t>(written) < length) {
-            enqueueTx(data + written, length - written);
-        }
-    } else if (written == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
-        // Port busy, queue all data
-        enqueueTx(data, length);
-    } else {
-        dbglog("SerialPort::sendData() - write failed: %s\n",
-               written == -1 ? strerror(errno) : "write returned 0");
+    // only an idle receive thread needs a nudge; a busy one is pacing
+    // output and will come back for these bytes on its own
+    if (m_txWakeArmed.exchange(false)) {
+        wakeReceiveThread();
+    }
+}
+
+void SerialPort::wakeReceiveThread()
+{
+    if (m_cancelPipe[1] != -1) {
+        char dummy = 0;
+        ssize_t result = write(m_cancelPipe[1], &dummy, 1);
+        (void)result; // suppress unused variable warning
     }
 }
 
 void SerialPort::sendXON()
 {
     if (m_xoffSent.load()) {
-        sendByte(0x11); // DC1 (XON)
+        // the kernel sends START ahead of anything already queued
+        tcflow(m_fd, TCION); // DC1 (XON)
         m_xoffSent.store(false);
         m_xonSentCount.fetch_add(1);
+        m_txByteCount.fetch_add(1);
         
         // Capture for debugging if enabled
         if (m_captureCallback) {
@@ -792,9 +992,11 @@ void SerialPort::sendXON()
 void SerialPort::sendXOFF()
 {
     if (!m_xoffSent.load()) {
-        sendByte(0x13); // DC3 (XOFF)
+        // the kernel sends STOP ahead of anything already queued
+        tcflow(m_fd, TCIOFF); // DC3 (XOFF)
         m_xoffSent.store(true);
         m_xoffSentCount.fetch_add(1);
+        m_txByteCount.fetch_add(1);
         
         // Capture for debugging if enabled
         if (m_captureCallback) {
@@ -804,6 +1006,17 @@ void SerialPort::sendXOFF()
     }
 }
 
+void SerialPort::setRts(bool asserted)
+{
+    m_rtsAsserted.store(asserted);
+    if (m_fd != -1) {
+        // with CRTSCTS the kernel only touches RTS when its own buffer
+        // fills, which it never does as the receive thread keeps reading
+        int bits = TIOCM_RTS;
+        ioctl(m_fd, asserted ? TIOCMBIS : TIOCMBIC, &bits);
+    }
+}
+
 void SerialPort::startReceiving()
 {
     m_stopReceiving = false;
@@ -815,11 +1028,7 @@ void SerialPort::stopReceiving()
     if (m_receiveThread.joinable()) {
         m_stopReceiving = true;
         // Signal cancellation pipe to wake up the receive thread
-        if (m_cancelPipe[1] != -1) {
-            char dummy = 1;
-            ssize_t result = write(m_cancelPipe[1], &dummy, 1);
-            (void)result; // suppress unused variable warning
-        }
+        wakeReceiveThread();
         m_receiveThread.join();
     }
 }
@@ -830,6 +1039,10 @@ void SerialPort::receiveThreadProc()
     pollfd pfds[2];
     int nfds = 1;
 
+    if (m_threadInitCallback) {
+        m_threadInitCallback();
+    }
+
     // Setup poll descriptors
     pfds[0].fd = m_fd;
     pfds[0].events = POLLIN; // Always monitor for RX data
@@ -840,27 +1053,47 @@ void SerialPort::receiveThreadProc()
         nfds = 2;
     }
 
+    auto lastDsrCheck = std::chrono::steady_clock::now();
+
     while (!m_stopReceiving && isOpen()) {
-        // Check if we have data to send and update POLLOUT accordingly
-        {
-            std::lock_guard<std::recursive_mutex> lock(m_txMutex);
-            if (!m_outbuf.empty()) {
-                pfds[0].events = POLLIN | POLLOUT; // Monitor both RX and TX
-            } else {
-                pfds[0].events = POLLIN; // Only monitor RX
+        // the fd changes if attemptReconnect() reopened the device
+        pfds[0].fd = m_fd;
+
+        // watch for DSR returning, eg, the terminal was power cycled
+        // while the USB adapter stayed connected
+        if (m_dsrSupported) {
+            auto now = std::chrono::steady_clock::now();
+            if (now - lastDsrCheck >= std::chrono::milliseconds(DSR_POLL_MS)) {
+                lastDsrCheck = now;
+                checkDsr();
+            }
+        }
+
+        // Top up the kernel's output queue.  Once everything is out,
+        // let producers wake us through the pipe; while the terminal has
+        // us paused, only its XON matters.
+        int timeoutMs = pumpTx();
+        if (timeoutMs < 0 && !m_txStopped) {
+            m_txWakeArmed.store(true);
+            if (pendingTx() > 0) {
+                // raced with a producer which saw the flag still clear
+                m_txWakeArmed.store(false);
+                timeoutMs = 0;
             }
         }
 
         // Use poll() with 10ms timeout for responsive terminal display
-        int result = poll(pfds, nfds, 10);
+        int result = poll(pfds, nfds, (timeoutMs < 0) ? 10 : std::min(timeoutMs, 10));
         
         if (result > 0) {
-            // Check for cancellation signal
+            // Check for cancellation or a producer's wake up
             if (nfds > 1 && (pfds[1].revents & POLLIN)) {
-                char dummy;
-                ssize_t readResult = read(m_cancelPipe[0], &dummy, 1);
+                char dummy[64];
+                ssize_t readResult = read(m_cancelPipe[0], dummy, sizeof(dummy));
                 (void)readResult; // suppress unused variable warning
-                break; // Exit thread
+                if (m_stopReceiving) {
+                    break; // Exit thread
+                }
             }
 
             // Check for data on serial port
@@ -920,11 +1153,6 @@ void SerialPort::receiveThreadProc()
                     }
                 }
             }
-
-            // Check if we can send data (TX ready)
-            if (pfds[0].revents & POLLOUT) {
-                flushTxBuffer();
-            }
         } else if (result == -1 && errno != EINTR) {
             dbglog("SerialPort::receiveThreadProc - select failed: %s, attempting reconnection\n", strerror(errno));
             m_connected.store(false);
@@ -972,6 +1200,18 @@ void SerialPort::processReceivedByte(uint8 byte)
         m_captureCallback(byte, true);  // true = RX
     }
 
+    // With XON/XOFF flow control, honor the terminal's XOFF/XON at once,
+    // unless the kernel already does (IXON).  tcflow() also holds back
+    // what is queued in the kernel.  Without it, DC1 and DC3 are data.
+    if (m_config.swFlowControl && !m_kernelIxon) {
+        if (byte == 0x13 && !m_txStopped) {
+            tcflow(m_fd, TCOOFF);
+            m_txStopped = true;
+        } else if (byte == 0x11 && m_txStopped) {
+            resumeTx();
+        }
+    }
+
     // Send to MXD callback first (for COM port mode)
     if (m_rxCallback) {
         m_rxCallback(byte);
@@ -995,77 +1235,153 @@ bool SerialPort::attemptReconnect()
     }
     return open(m_config);
 #else
+    // this runs on the receive thread, so it must not restart it
     if (m_fd != -1) {
         ::close(m_fd);
         m_fd = -1;
     }
-    return open(m_config);
+    if (!openDevice(m_config)) {
+        return false;
+    }
+    m_connected.store(true);
+    m_reconnectAttempts.store(0);
+    m_txStopped = false;
+    dbglog("SerialPort::attemptReconnect() - Reopened %s\n", m_config.portName.c_str());
+
+    // whatever is attached has likely lost its state
+    if (m_linkUpCallback) {
+        m_linkUpCallback();
+    }
+    return true;
 #endif
 }
 
-void SerialPort::enqueueTx(const uint8_t* data, size_t len)
+#ifndef _WIN32
+// sample the DSR line and report a rising edge
+void SerialPort::checkDsr()
 {
-    if (!isOpen() || len == 0) {
+    int modem = 0;
+    if (ioctl(m_fd, TIOCMGET, &modem) != 0) {
         return;
     }
-
-    std::lock_guard<std::recursive_mutex> lock(m_txMutex);
-
-    // Check buffer size limit
-    if (m_outbuf.size() + len > m_config.txQueueSize) {
-        dbglog("SerialPort::enqueueTx() - TX buffer full (%zu + %zu > %zu), dropping data\n",
-               m_outbuf.size(), len, m_config.txQueueSize);
-        return;
+    const bool dsr = (modem & TIOCM_DSR) != 0;
+    if (dsr && !m_dsrAsserted) {
+        dbglog("SerialPort::checkDsr() - DSR asserted on %s\n", m_config.portName.c_str());
+        // a terminal which was switched off while paused won't send XON
+        resumeTx();
+        if (m_linkUpCallback) {
+            m_linkUpCallback();
+        }
     }
-
-    // Append data to output buffer
-    m_outbuf.insert(m_outbuf.end(), data, data + len);
-
-#ifdef WANGEMU_TX_DEBUG
-    dbglog("SerialPort::enqueueTx() - Added %zu bytes, buffer now %zu bytes\n",
-           len, m_outbuf.size());
-#endif
-
-    // Try immediate flush for responsive display (non-blocking)
-    flushTxBuffer();
+    m_dsrAsserted = dsr;
 }
+#endif
 
-bool SerialPort::flushTxBuffer()
+// undo a received XOFF
+void SerialPort::resumeTx()
 {
-    if (!isOpen()) {
-        return false;
+    if (m_txStopped) {
+        tcflow(m_fd, TCOON);
+        m_txStopped = false;
     }
+}
 
-    std::lock_guard<std::recursive_mutex> lock(m_txMutex);
+// bytes waiting to be written to the device; receive thread only
+size_t SerialPort::pendingTx() const
+{
+    return m_txLocal.size() + (m_txHead.load() - m_txTail.load(std::memory_order_relaxed));
+}
 
-    if (m_outbuf.empty()) {
-        return false; // Nothing to send
+// Write queued output, keeping no more than m_txOutqTarget bytes in the
+// kernel/driver queue.  Anything beyond that would still go out after a
+// terminal's XOFF, and make the MXD's backpressure act late.  Runs on the
+// receive thread, the only writer.  Returns the ms until there will be
+// room for more, or -1 if nothing is left to write.
+int SerialPort::pumpTx()
+{
+    if (m_txDiscard.exchange(false)) {
+        m_txTail.store(m_txHead.load());
+    }
+
+    const size_t tail = m_txTail.load(std::memory_order_relaxed);
+    const size_t head = m_txHead.load(std::memory_order_acquire);
+    const size_t queued = m_txLocal.size() + (head - tail);
+    if (queued == 0 || m_txStopped) {
+        return -1;  // after XOFF, the XON arrives as input
+    }
+
+    // devices which can't report their queue are paced by the line rate
+    int outq = 0;
+    if (ioctl(m_fd, TIOCOUTQ, &outq) != 0) {
+        outq = 0;
+    }
+    const size_t half = m_txOutqTarget / 2;
+    if (static_cast<size_t>(outq) >= m_txOutqTarget) {
+        return msUntilSent(outq - half);
+    }
+    size_t budget = std::min(queued, m_txOutqTarget - outq);
+
+    // local bytes first, then the ring, which may wrap
+    iovec iov[3];
+    int iovcnt = 0;
+    size_t want = 0;
+    if (!m_txLocal.empty()) {
+        const size_t n = std::min(budget, m_txLocal.size());
+        iov[iovcnt++] = { m_txLocal.data(), n };
+        want += n;
+    }
+    size_t pos = tail;
+    while (want < budget && pos != head) {
+        const size_t idx = pos & m_txMask;
+        const size_t n = std::min({budget - want, head - pos, m_txRing.size() - idx});
+        iov[iovcnt++] = { &m_txRing[idx], n };
+        want += n;
+        pos += n;
+    }
+
+    const ssize_t written = writev(m_fd, iov, iovcnt);
+    if (written <= 0) {
+        if (written == -1 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+            dbglog("SerialPort::pumpTx() - write failed: %s\n", strerror(errno));
+        }
+        return 1;
     }
 
-    // Try to write as much as the kernel will accept
-    ssize_t written = write(m_fd, m_outbuf.data(), m_outbuf.size());
-    if (written > 0) {
-        // Update TX byte counter
-        m_txByteCount.fetch_add(written);
-
-        // Remove sent bytes from buffer
-        m_outbuf.erase(m_outbuf.begin(), m_outbuf.begin() + written);
+    // account for and release what went out
+    size_t done = static_cast<size_t>(written);
+    if (m_captureCallback) {
+        size_t left = done;
+        for (int i = 0; i < iovcnt && left > 0; ++i) {
+            const size_t n = std::min(left, iov[i].iov_len);
+            const auto *bytes = static_cast<const uint8*>(iov[i].iov_base);
+            for (size_t j = 0; j < n; ++j) {
+                m_captureCallback(bytes[j], false); // false = TX
+            }
+            left -= n;
+        }
+    }
+    const size_t fromLocal = std::min(done, m_txLocal.size());
+    m_txLocal.erase(m_txLocal.begin(), m_txLocal.begin() + fromLocal);
+    m_txTail.store(tail + (done - fromLocal), std::memory_order_release);
 
-#ifdef WANGEMU_TX_DEBUG
-        dbglog("SerialPort::flushTxBuffer() - Wrote %zd bytes, %zu remain\n",
-               written, m_outbuf.size());
-#endif
+    m_txByteCount.fetch_add(done);
+    {
+        std::lock_guard<std::mutex> lock(m_activityMutex);
+        m_lastTxTime = std::chrono::steady_clock::now();
+    }
+    m_recentTxBytes.fetch_add(static_cast<uint32_t>(done));
 
-        return true; // Successfully sent some data
-    } else if (written == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
-        // Kernel buffer full, try again later
-        return false;
-    } else {
-        // Real error
-        dbglog("SerialPort::flushTxBuffer() - write failed: %s\n",
-               written == -1 ? strerror(errno) : "partial write");
-        return false;
+    if (done == queued) {
+        return -1;
     }
+    return msUntilSent(outq + done - std::min(outq + done, half));
+}
+
+// time for the line to send this many characters, at least 1 ms
+int SerialPort::msUntilSent(size_t chars) const
+{
+    const int64_t ms = static_cast<int64_t>(chars) * m_charNs / 1000000;
+    return static_cast<int>(std::max<int64_t>(ms, 1));
 }
 
 int SerialPort::getReconnectDelayMs() const
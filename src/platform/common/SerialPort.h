@@ -25,12 +25,15 @@ class Timer;
 #ifdef TWOSTOPBITS
 #undef TWOSTOPBITS
 #endif
+#else
+#include <termios.h>
 #endif
 
 #include <string>
 #include <memory>
 #include <functional>
 #include <queue>
+#include <vector>
 #include <thread>
 #include <atomic>
 #include <mutex>
@@ -104,6 +107,13 @@ public:
     void sendXON();
     void sendXOFF();
     bool isXOFFSent() const { return m_xoffSent.load(); }
+
+    // Hardware flow control: drop RTS to ask the terminal to pause.
+    // Only meaningful when the port was opened with hwFlowControl.
+    void setRts(bool asserted);
+    bool hasHwFlowControl() const { return m_config.hwFlowControl; }
+    const SerialConfig& getConfig() const { return m_config; }
+    uint32_t getBaudRate() const { return m_config.baudRate; }
     
     // Receive callback for MXD integration
     using RxCallback = std::function<void(uint8)>;
@@ -133,6 +143,42 @@ public:
     using CaptureCallback = std::function<void(uint8, bool)>;  // byte, isRx
     void setCaptureCallback(CaptureCallback cb) { m_captureCallback = std::move(cb); }
 
+    // Hook run on the receive thread as it starts (e.g. to set CPU affinity
+    // or scheduling policy).  Must be set before open().
+    using ThreadInitCallback = std::function<void()>;
+    void setThreadInitCallback(ThreadInitCallback cb) { m_threadInitCallback = std::move(cb); }
+
+#ifndef _WIN32
+    // Hand an open device over to another process without dropping the
+    // line: release() stops using it but leaves it open, and adopt() picks
+    // it up again, from the same or another process.  Output which had
+    // not been written yet travels along in pendingTx.
+    //
+    // adopt() only sets the line up; nothing is read or written until
+    // startAdopted(), so a take-over can still fall through.  Then
+    // abandonAdopted() puts back the settings adopt() found and lets go,
+    // and the releasing side's reclaim() carries on as before, without
+    // setting up the device again.
+    struct HandoffState {
+        int fd = -1;
+        bool xoffSent = false;      // we asked the terminal to pause
+        bool rtsAsserted = true;
+        bool txStopped = false;     // the terminal asked us to pause
+        std::vector<uint8_t> pendingTx;
+    };
+    bool release(HandoffState *out);
+    bool adopt(const SerialConfig &config, const HandoffState &state);
+    void startAdopted();
+    void abandonAdopted();
+    bool reclaim(const HandoffState &state);
+#endif
+
+    // Hook run on the receive thread when the link comes back: the device
+    // was reopened after a failure, or DSR was asserted again (terminal
+    // powered on or cable reseated).
+    using LinkUpCallback = std::function<void()>;
+    void setLinkUpCallback(LinkUpCallback cb) { m_linkUpCallback = std::move(cb); }
+
 private:
     // Internal communication methods
     void startReceiving();
@@ -140,10 +186,6 @@ private:
     void receiveThreadProc();
     void processReceivedByte(uint8 byte);
 
-    // Serial port transmission with batching
-    void enqueueTx(const uint8_t* data, size_t len);
-    bool flushTxBuffer();
-
     std::shared_ptr<Scheduler> m_scheduler;
     std::shared_ptr<Terminal> m_terminal;
     
@@ -153,6 +195,12 @@ private:
     // Capture callback for debugging
     CaptureCallback m_captureCallback;
 
+    // Receive thread start hook
+    ThreadInitCallback m_threadInitCallback;
+
+    // Link (re)established hook
+    LinkUpCallback m_linkUpCallback;
+
 #ifdef _WIN32
     HANDLE m_handle;
     OVERLAPPED m_readOverlapped;
@@ -172,15 +220,50 @@ private:
 #else
     int m_fd;                   // POSIX file descriptor
     int m_cancelPipe[2];        // pipe for thread cancellation
+    bool m_dsrSupported = false;  // device reports modem control lines
+    bool m_dsrAsserted  = false;  // last sampled DSR state
+    bool m_kernelIxon   = false;  // the tty driver honors XOFF/XON itself
+    static constexpr int DSR_POLL_MS = 250;
+
+    bool openDevice(const SerialConfig &config);
+    bool configureDevice(const SerialConfig &config, bool fresh);
+    void resetTx(const SerialConfig &config);
+    void loadHandoff(const HandoffState &state);
+    void startHandoff();
+    struct termios m_adoptedTermios;    // the line's settings before adopt()
+    bool m_adoptPending = false;        // adopted, but not started yet
+    void checkDsr();
+
+    // Transmit path.  sendData() may be called by the receive thread and by
+    // one other thread (the emulation); the receive thread does all the
+    // writes, keeping about TX_OUTQ_MS of output in the kernel's queue.
+    static constexpr int    TX_OUTQ_MS  = 40;
+    static constexpr size_t TX_OUTQ_MIN = 64;   // bytes
+    std::vector<uint8_t> m_txRing;              // size is a power of two
+    size_t               m_txMask = 0;
+    alignas(64) std::atomic<size_t> m_txHead{0};   // advanced by the producer
+    alignas(64) std::atomic<size_t> m_txTail{0};   // advanced by the receive thread
+    std::vector<uint8_t> m_txLocal;             // queued by the receive thread itself
+    std::atomic<bool>    m_txWakeArmed{false};  // receive thread is idle
+    std::atomic<bool>    m_txDiscard{false};    // flushTxQueue() request
+    bool                 m_txStopped = false;   // terminal sent XOFF
+    size_t               m_txOutqTarget = TX_OUTQ_MIN;
+    int64_t              m_charNs = 1;          // time to send one character
+
+    void   wakeReceiveThread();
+    void   resumeTx();
+    size_t pendingTx() const;
+    int    pumpTx();
+    int    msUntilSent(size_t chars) const;
 #endif
 
     // Receiving thread
     std::thread m_receiveThread;
     std::atomic<bool> m_stopReceiving;
 
-    // Transmit buffer for batched writes (eliminates per-byte syscalls)
-    std::vector<uint8_t> m_outbuf;
+#ifdef _WIN32
     mutable std::recursive_mutex m_txMutex;  // mutable for const methods
+#endif
 
     // Configuration
     SerialConfig m_config;
@@ -200,6 +283,7 @@ private:
     alignas(std::atomic<bool>) std::atomic<bool> m_xoffSent{false};
     alignas(std::atomic<uint64_t>) std::atomic<uint64_t> m_xonSentCount{0};
     alignas(std::atomic<uint64_t>) std::atomic<uint64_t> m_xoffSentCount{0};
+    alignas(std::atomic<bool>) std::atomic<bool> m_rtsAsserted{true};
     
     // Reconnection state
     alignas(std::atomic<bool>) std::atomic<bool> m_connected{false};
@@ -47,6 +47,9 @@ namespace host
     // load configuration from a specific INI file (headless mode only)
     void loadConfigFile(const std::string& filename);
 
+    // when false, terminate() leaves the INI file untouched (headless mode only)
+    void setConfigSaveOnExit(bool save);
+
     // ---- read or write an entry in the configuration file ----
     // there are keys maintained for separate categories.
     // the configRead* functions take a defaultval; this is the value returned
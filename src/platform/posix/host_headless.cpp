@@ -21,6 +21,7 @@
 // In-memory configuration storage - preserving original INI structure
 static std::map<std::string, std::map<std::string, std::string>> config_sections;
 static std::string ini_filename = "wangemu.ini";
+static bool save_on_exit = true;
 
 // Helper to create config key for internal flat storage (backward compatibility)
 [[maybe_unused]] static std::string makeConfigKey(const std::string &subgroup, const std::string &key) {
@@ -222,9 +223,14 @@ void loadConfigFile(const std::string& filename)
     }
 }
 
+void setConfigSaveOnExit(bool save)
+{
+    save_on_exit = save;
+}
+
 void terminate()
 {
-    if (!config_sections.empty()) {
+    if (save_on_exit && !config_sections.empty()) {
         saveIniFile(ini_filename);
     }
     config_sections.clear();
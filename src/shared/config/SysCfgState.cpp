@@ -15,6 +15,7 @@
 #include <windows.h>
 #endif
 
+#include <algorithm>
 #include <sstream>
 
 // ------------------------------------------------------------------------
@@ -66,7 +67,9 @@ SysCfgState::operator=(const SysCfgState &rhs)
     setCpuType(rhs.getCpuType());
     setRamKB(rhs.getRamKB());
     regulateCpuSpeed(rhs.isCpuSpeedRegulated());
+    setCpuSpeedMultiplier(rhs.getCpuSpeedMultiplier());
     setDiskRealtime(rhs.getDiskRealtime());
+    setFastBoot(rhs.getFastBoot());
     setWarnIo(rhs.getWarnIo());
     
     // Copy COM terminal settings for 2236WD terminal mode
@@ -98,7 +101,9 @@ SysCfgState::SysCfgState(const SysCfgState &obj)
     m_cpu_type        = obj.m_cpu_type;
     m_ramsize         = obj.m_ramsize;
     m_speed_regulated = obj.m_speed_regulated;
+    m_speed_multiplier = obj.m_speed_multiplier;
     m_disk_realtime   = obj.m_disk_realtime;
+    m_fast_boot       = obj.m_fast_boot;
     m_warn_io         = obj.m_warn_io;
     
     // Copy COM terminal settings for 2236WD terminal mode
@@ -140,7 +145,9 @@ SysCfgState::operator==(const SysCfgState &rhs) const
     return (m_cpu_type        == rhs.m_cpu_type)        &&
            (m_ramsize         == rhs.m_ramsize)         &&
            (m_speed_regulated == rhs.m_speed_regulated) &&
+           (m_speed_multiplier == rhs.m_speed_multiplier) &&
            (m_disk_realtime   == rhs.m_disk_realtime)   &&
+           (m_fast_boot       == rhs.m_fast_boot)       &&
            (m_warn_io         == rhs.m_warn_io)         ;
 }
 
@@ -159,6 +166,7 @@ SysCfgState::setDefaults()
     setCpuType(Cpu2200::CPUTYPE_2200T);
     setRamKB(32);
     setDiskRealtime(true);
+    setFastBoot(false);
     setWarnIo(true);
     
     // Set COM port defaults for 2236WD terminal mode
@@ -238,6 +246,8 @@ SysCfgState::loadIni()
         if (b && (sval == "unregulated")) {
             regulateCpuSpeed(false);
         }
+        host::configReadInt(subgroup, "speed_multiplier", &ival, 1);
+        setCpuSpeedMultiplier(ival);
     }
 
     // get IO slot attributes
@@ -287,6 +297,9 @@ SysCfgState::loadIni()
         host::configReadBool(subgroup, "disk_realtime", &bval, true);
         setDiskRealtime(bval);  // default
 
+        host::configReadBool(subgroup, "fast_boot", &bval, false);
+        setFastBoot(bval);  // default
+
         host::configReadBool(subgroup, "warnio", &bval, true);
         setWarnIo(bval);  // default
     }
@@ -390,12 +403,14 @@ SysCfgState::saveIni() const
 
         const char *foo = (system2200::isCpuSpeedRegulated()) ? "regulated" : "unregulated";
         host::configWriteStr(subgroup, "speed", foo);
+        host::configWriteInt(subgroup, "speed_multiplier", system2200::getCpuSpeedMultiplier());
     }
 
     // save misc other config bits
     {
         const std::string subgroup("misc");
         host::configWriteBool(subgroup, "disk_realtime", getDiskRealtime());
+        host::configWriteBool(subgroup, "fast_boot",     getFastBoot());
         host::configWriteBool(subgroup, "warnio",        getWarnIo());
     }
 
@@ -442,6 +457,14 @@ SysCfgState::setDiskRealtime(bool realtime) noexcept
 }
 
 
+void
+SysCfgState::setFastBoot(bool fast) noexcept
+{
+    m_fast_boot = fast;
+    m_initialized = true;
+}
+
+
 void
 SysCfgState::setWarnIo(bool warn) noexcept
 {
@@ -489,6 +512,21 @@ SysCfgState::isCpuSpeedRegulated() const noexcept
 }
 
 
+void
+SysCfgState::setCpuSpeedMultiplier(int multiplier) noexcept
+{
+    m_speed_multiplier = std::max(1, std::min(multiplier, MAX_SPEED_MULTIPLIER));
+    m_initialized = true;
+}
+
+
+int
+SysCfgState::getCpuSpeedMultiplier() const noexcept
+{
+    return m_speed_multiplier;
+}
+
+
 int
 SysCfgState::getRamKB() const noexcept
 {
@@ -503,6 +541,13 @@ SysCfgState::getDiskRealtime() const noexcept
 }
 
 
+bool
+SysCfgState::getFastBoot() const noexcept
+{
+    return m_fast_boot;
+}
+
+
 bool
 SysCfgState::getWarnIo() const noexcept
 {
@@ -700,7 +745,7 @@ SysCfgState::configOk(bool warn) const
 
 
 // returns true if the state has changed in a way that requires a reboot.
-// that is, if the disk realtime or warning flags are the only things to
+// that is, if the disk realtime, fast boot, or warning flags are the only things to
 // have changed, or if nothing has changed, then a reboot isn't required.
 bool
 SysCfgState::needsReboot(const SysCfgState &other) const
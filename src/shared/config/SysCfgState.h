@@ -58,6 +58,11 @@ public:
     void regulateCpuSpeed(bool regulated) noexcept;
     bool isCpuSpeedRegulated() const noexcept;
 
+    // when regulated, run this many times faster than the real hardware
+    static constexpr int MAX_SPEED_MULTIPLIER = 16;
+    void setCpuSpeedMultiplier(int multiplier) noexcept;
+    int  getCpuSpeedMultiplier() const noexcept;
+
     // set/get amount of RAM in the system configuration
     void setRamKB(int kb) noexcept;
     int  getRamKB() const noexcept;
@@ -66,6 +71,11 @@ public:
     void setDiskRealtime(bool realtime) noexcept;
     bool getDiskRealtime() const noexcept;
 
+    // set/get whether the VP boot ROM's RAM test is charged a nominal time
+    // per loop pass instead of what the microcode would have taken
+    void setFastBoot(bool fast) noexcept;
+    bool getFastBoot() const noexcept;
+
     // warn the user when an attempt is made to access a device at a bad addr
     void setWarnIo(bool warn) noexcept;
     bool getWarnIo() const noexcept;
@@ -115,7 +125,9 @@ private:
     int  m_cpu_type        = Cpu2200::CPUTYPE_2200T;  // which CPU type
     int  m_ramsize         = 32;    // amount of memory in CPU
     bool m_speed_regulated = true;  // emulation speed throttling
+    int  m_speed_multiplier = 1;    // regulated speed relative to real hardware
     bool m_disk_realtime   = true;  // boolean whether disk emulation is realtime or not
+    bool m_fast_boot       = false; // boolean whether the VP RAM test is shortened
     bool m_warn_io         = true;  // boolean whether to warn on access to invalid IO device
     
     // -------------- 2236WD terminal COM port settings --------------
@@ -59,7 +59,7 @@ private:
     struct TerminalCfg {
         std::string com_port = "";      // empty = use GUI window, non-empty = COM port name
         int baud_rate = 19200;
-        bool flow_control = false;      // Hardware flow control (RTS/CTS) - not used for Wang terminals
+        bool flow_control = false;      // Hardware flow control (RTS/CTS) - CRTSCTS, and RTS dropped when the rx fifo fills
         bool sw_flow_control = false;   // Software flow control (XON/XOFF) - recommended for Wang terminals
     };
     
@@ -389,6 +389,14 @@ ScriptFile::getNextByte(int *byte)
             return true;
         }
 
+        // Escape case #0: "\" at the end of a line joins it to the next
+        // without the usual carriage return
+        if (((m_meta_flags & SCRIPT_META_JOIN) != 0) &&
+            (m_line_buf[m_cur_char] == 0)) {
+            prepareNextLine();
+            continue;
+        }
+
         // Escape case #1: "\\" -> "\"
         if (m_line_buf[m_cur_char] == '\\') {
             *byte = '\\';
@@ -14,9 +14,10 @@ public:
     CANT_ASSIGN_OR_COPY_CLASS(ScriptFile);
 
     // options when opening file
-    enum { SCRIPT_META_KEY = 0x0001,  // interpret \<LOAD> and the like
-           SCRIPT_META_HEX = 0x0002,  // interpret \3F and the like
-           SCRIPT_META_INC = 0x0004   // interpret \include filename.foo
+    enum { SCRIPT_META_KEY  = 0x0001,  // interpret \<LOAD> and the like
+           SCRIPT_META_HEX  = 0x0002,  // interpret \3F and the like
+           SCRIPT_META_INC  = 0x0004,  // interpret \include filename.foo
+           SCRIPT_META_JOIN = 0x0008  // trailing \ suppresses the end-of-line CR
          };
 
     // Open a script file.
@@ -54,6 +54,7 @@ Terminal::Terminal(std::shared_ptr<Scheduler> scheduler,
     m_muxd(muxd),
     //m_serialPort(nullptr),
     m_vp_cpu(vp_cpu),
+    m_shadow(false),
     m_io_addr(io_addr),
     m_term_num(term_num)
 {
@@ -93,6 +94,7 @@ Terminal::Terminal(std::shared_ptr<Scheduler> scheduler,
     m_muxd(nullptr),
     m_serialPort(serialPort),
     m_vp_cpu(false),  // COM port terminals don't need CPU throttling
+    m_shadow(false),
     m_io_addr(io_addr),
     m_term_num(term_num)
 {
@@ -125,6 +127,23 @@ Terminal::Terminal(std::shared_ptr<Scheduler> scheduler,
     }
 }
 
+// Constructor for shadow model
+Terminal::Terminal(ui_screen_t screen_type) :
+    m_scheduler(nullptr),
+    m_muxd(nullptr),
+    m_vp_cpu(false),
+    m_shadow(true),
+    m_io_addr(-1),
+    m_term_num(-1)
+{
+    m_disp.screen_type = screen_type;
+    m_disp.chars_w  = (screen_type == UI_SCREEN_64x16)  ? 64 : 80;
+    m_disp.chars_h  = (screen_type == UI_SCREEN_64x16)  ? 16 : 24;
+    m_disp.chars_h2 = (screen_type == UI_SCREEN_2236DE) ? 25 : m_disp.chars_h;
+
+    reset(true);
+}
+
 // free resources on destruction
 Terminal::~Terminal()
 {
@@ -146,7 +165,9 @@ Terminal::~Terminal()
     m_prt_tmr     = nullptr;
     m_selectp_tmr = nullptr;
 
-    UI_displayDestroy(m_wndhnd.get());
+    if (!m_shadow) {
+        UI_displayDestroy(m_wndhnd.get());
+    }
 }
 
 
@@ -283,42 +304,56 @@ Terminal::receiveKeystroke(int keycode)
         return;
     }
 
-    // remap certain keycodes from first-generation encoding to what is
-    // send over the serial line
     if (keycode == IoCardKeyboard::KEYCODE_RESET) {
         reset(false);  // clear screen, home cursor, and empty fifos
-        m_kb_buff.push(static_cast<uint8>(0x12));
+    }
+    for (const uint8 byte : encodeKeystroke(keycode)) {
+        m_kb_buff.push(byte);
+    }
+
+    checkKbBuffer();
+}
+
+
+// remap certain keycodes from first-generation encoding to what is
+// sent over the serial line
+std::vector<uint8>
+Terminal::encodeKeystroke(int keycode)
+{
+    std::vector<uint8> bytes;
+    if (keycode == IoCardKeyboard::KEYCODE_RESET) {
+        bytes.push_back(static_cast<uint8>(0x12));
     } else if (keycode == IoCardKeyboard::KEYCODE_HALT) {
         // halt/step
-        m_kb_buff.push(static_cast<uint8>(0x13));
+        bytes.push_back(static_cast<uint8>(0x13));
     } else if (keycode == (IoCardKeyboard::KEYCODE_SF | IoCardKeyboard::KEYCODE_EDIT)) {
         // edit
         // Note: logging what comes out of my 2336, Shift-EDIT produces FD 50.
         //       I tried adding it but its purpose escapes me, so I removed it.
-        m_kb_buff.push(static_cast<uint8>(0xBD));
+        bytes.push_back(static_cast<uint8>(0xBD));
     } else if ((keycode & IoCardKeyboard::KEYCODE_SF) != 0) {
         // special function
-        m_kb_buff.push(static_cast<uint8>(0xFD));
-        m_kb_buff.push(static_cast<uint8>(keycode & 0xff));
+        bytes.push_back(static_cast<uint8>(0xFD));
+        bytes.push_back(static_cast<uint8>(keycode & 0xff));
     } else if (keycode == 0xE6) {
         // the pc TAB key maps to "STMT" in 2200T mode,
         // but it maps to "FN" (function) in 2336 mode
-        m_kb_buff.push(static_cast<uint8>(0xFD));
-        m_kb_buff.push(static_cast<uint8>(0x7E));
+        bytes.push_back(static_cast<uint8>(0xFD));
+        bytes.push_back(static_cast<uint8>(0x7E));
     } else if (keycode == 0xE5) {
         // erase
-        m_kb_buff.push(static_cast<uint8>(0xE5));
+        bytes.push_back(static_cast<uint8>(0xE5));
     } else if (0x80 <= keycode && keycode < 0xE5) {
         // it is an atom; add prefix
-        m_kb_buff.push(static_cast<uint8>(0xFD));
-        m_kb_buff.push(static_cast<uint8>(keycode & 0xff));
+        bytes.push_back(static_cast<uint8>(0xFD));
+        bytes.push_back(static_cast<uint8>(keycode & 0xff));
     } else {
         // the mapping is unchanged
         assert(keycode == (keycode & 0xff));
-        m_kb_buff.push(static_cast<uint8>(keycode));
+        bytes.push_back(static_cast<uint8>(keycode));
     }
 
-    checkKbBuffer();
+    return bytes;
 }
 
 
@@ -327,6 +362,11 @@ Terminal::receiveKeystroke(int keycode)
 void
 Terminal::checkKbBuffer()
 {
+    if (m_shadow) {
+        // no back channel: flow control and keys go nowhere
+        return;
+    }
+
     if (m_tx_tmr) {
         // serial channel is in use
         return;
@@ -593,6 +633,9 @@ Terminal::processChar(uint8 byte)
         case 0xF2: // restart terminal (FB F2)
             // TODO: study LDMOD#AB UARTRX5 routine
             reset(false);  // soft reset
+            if (m_shadow) {
+                break;
+            }
 #if 0
             // a real 2336 sends E4 then F8 (crt go flow control)
             // TODO: LDMOD#40 says of E4 "SET RSD FLAG IN MXD"
@@ -607,6 +650,9 @@ Terminal::processChar(uint8 byte)
         case 0xF6: // reset crt (FB F6)
             // TODO: study LDMOD#AB UARTRX5 routine
             resetCrt();
+            if (m_shadow) {
+                break;
+            }
             // a real 2336 sends E9 (crt stop flow control),
             // then F8 (crt go flow control), then another F8, then E4,
             // then F8 every three seconds while not throttled.
@@ -737,7 +783,7 @@ Terminal::processCrtChar1(uint8 byte)
     if ((0xC1 <= m_raw_buf[1]) && (m_raw_buf[1] <= 0xC9)) {
         const int delay_ms = 1000 * (m_raw_buf[1] - 0xC0) / 6;
         assert(m_selectp_tmr == nullptr);
-        if (delay_ms > 0) {
+        if (delay_ms > 0 && !m_shadow) {
 //UI_info("Got FB Cn, delay=%d ms", delay_ms);
             m_selectp_tmr = m_scheduler->createTimer(
                                    TIMER_MS(delay_ms),
@@ -930,7 +976,7 @@ Terminal::processCrtChar2(uint8 byte)
     if (m_input_cnt >= 3 && m_input_buf[1] == 0x08) {
         m_ignore = ignore_t::ALL;
         if (terminator && (m_input_cnt == 4)) {
-            if  (m_input_buf[2] == 0x09 && m_input_buf[3] == 0x0F) {
+            if  (m_input_buf[2] == 0x09 && m_input_buf[3] == 0x0F && !m_shadow) {
                 char *idptr = &id_string[1];  // skip the leading asterisk
                 while (*idptr != '\0') {
                     system2200::dispatchKeystroke(m_io_addr+0x01, m_term_num, *idptr);
@@ -1092,7 +1138,9 @@ Terminal::processCrtChar3(uint8 byte)
             break;
 
         case 0x07:      // bell
-            UI_displayDing(m_wndhnd.get());
+            if (!m_shadow) {
+                UI_displayDing(m_wndhnd.get());
+            }
             break;
 
         case 0x08:      // cursor left
@@ -1178,6 +1226,243 @@ Terminal::processCrtChar3(uint8 byte)
 }
 
 
+// ----------------------------------------------------------------------------
+// screen repaint
+// ----------------------------------------------------------------------------
+
+// The 2236 has no absolute cursor addressing, so the repaint clears the
+// screen and then walks the cursor with home/CR/LF/reverse-index/tab/
+// backspace.  It is done in three passes:
+//   1. characters, row by row, with charset and attribute mode switched
+//      as needed and runs compressed with FB nn cc / FB (60+n);
+//   2. box graphics, which can only be drawn by moving the cursor in box
+//      mode: horizontal runs via 09, vertical runs via 0B then 0A;
+//   3. cursor position, cursor mode and the attribute state the host
+//      program last set up.
+std::vector<uint8>
+Terminal::getRepaintStream() const
+{
+    std::vector<uint8> out;
+    if (m_disp.screen_type != UI_SCREEN_2236DE) {
+        return out;  // only smart terminals get repainted
+    }
+    out.reserve(2048);
+
+    const int w = m_disp.chars_w;
+    const int h = m_disp.chars_h;  // the status line is terminal-local
+    const uint8 vis_mask = char_attr_t::CHAR_ATTR_BRIGHT
+                         | char_attr_t::CHAR_ATTR_BLINK
+                         | char_attr_t::CHAR_ATTR_INV;
+
+    int  cx = 0, cy = 0;         // terminal cursor as we drive it
+    bool cur_alt   = false;      // alternate character set selected
+    bool cur_on    = false;      // attribute mode enabled (02 04 .. 0E)
+    int  cur_vis   = 0;          // visual attributes when enabled
+    bool cur_under = false;      // attribute-driven underline when enabled
+
+    // relative cursor motion, choosing the shorter of the alternatives
+    auto moveTo = [&](int x, int y) {
+        if (y < cy && (cy - y) > (y + 1)) {
+            out.push_back(0x01);  // home
+            cx = cy = 0;
+        }
+        while (cy < y) { out.push_back(0x0A); cy++; }
+        while (cy > y) { out.push_back(0x0C); cy--; }
+        if (x < cx && (cx - x) > (x + 1)) {
+            out.push_back(0x0D);  // carriage return
+            cx = 0;
+        }
+        while (cx < x) { out.push_back(0x09); cx++; }
+        while (cx > x) { out.push_back(0x08); cx--; }
+    };
+
+    // select the normal or alternate character set
+    auto setCharset = [&](bool alt) {
+        out.insert(out.end(), { 0x02, 0x02, static_cast<uint8>(alt ? 0x02 : 0x00), 0x0F });
+        cur_alt = alt;
+    };
+
+    // 02 04 xx yy {0E|0F}: define attributes and optionally enable them
+    auto defineAttrs = [&](int vis, bool under, bool enable) {
+        const bool bright = (vis & char_attr_t::CHAR_ATTR_BRIGHT) != 0;
+        const bool blink  = (vis & char_attr_t::CHAR_ATTR_BLINK)  != 0;
+        const bool inv    = (vis & char_attr_t::CHAR_ATTR_INV)    != 0;
+        const uint8 xx = (bright && blink) ? 0x0B : bright ? 0x02 : blink ? 0x04 : 0x00;
+        const uint8 yy = (inv && under)    ? 0x0B : inv    ? 0x02 : under ? 0x04 : 0x00;
+        out.insert(out.end(), { 0x02, 0x04, xx, yy, static_cast<uint8>(enable ? 0x0E : 0x0F) });
+        cur_on    = enable;
+        cur_vis   = vis;
+        cur_under = under;
+    };
+
+    // one literal character, escaping the FB prefix
+    auto putChar = [&](uint8 byte) {
+        if (byte == 0xFB) {
+            out.push_back(0xFB);
+            out.push_back(0xD0);
+        } else {
+            out.push_back(byte);
+        }
+        cx = (cx + 1 == w) ? 0 : cx + 1;
+    };
+
+    // resynchronize: route to crt, end any partial sequence, clear
+    out.insert(out.end(), { 0xFB, 0xF0, 0x0F, 0x06 });
+    setCharset(false);
+    out.push_back(0x03);  // clear screen and home
+
+    // ---- pass 1: characters ----
+    for (int y = 0; y < h; y++) {
+        const uint8 *row_d = &m_disp.display[w*y];
+        const uint8 *row_a = &m_disp.attr[w*y];
+
+        auto isBlank = [&](int x) {
+            return (row_d[x] == 0x20)
+                && ((row_a[x] & (vis_mask | char_attr_t::CHAR_ATTR_ALT)) == 0);
+        };
+        int last = w - 1;
+        while (last >= 0 && isBlank(last)) {
+            last--;
+        }
+
+        int x = 0;
+        while (x <= last) {
+            // the screen was cleared, so skip blanks by moving the cursor;
+            // it never costs more than writing them
+            if (isBlank(x)) {
+                while (x <= last && isBlank(x)) {
+                    x++;
+                }
+                continue;
+            }
+            moveTo(x, y);
+
+            const uint8 d     = row_d[x];
+            const uint8 a     = row_a[x];
+            const uint8 ch    = d & 0x7F;
+            const bool  ul    = (d & 0x80) != 0;
+            const bool  alt   = (a & char_attr_t::CHAR_ATTR_ALT) != 0;
+            const int   vis   = a & vis_mask;
+            // underline normally rides on the character code (>= 0x90),
+            // but alternate and low characters need the attribute mode
+            const bool  attr_ul = ul && (alt || ch < 0x10);
+            const uint8 code  = (alt || ul || ch < 0x10) ? (ch | 0x80) : ch;
+
+            if (alt != cur_alt) {
+                setCharset(alt);
+            }
+            const bool want_on = (vis != 0) || attr_ul;
+            if (want_on && (!cur_on || vis != cur_vis || attr_ul != cur_under)) {
+                defineAttrs(vis, attr_ul, true);
+            } else if (!want_on && cur_on) {
+                out.push_back(0x0F);
+                cur_on = false;
+            }
+
+            // measure the run of identical cells
+            int run = 1;
+            while (x + run <= last
+                   && row_d[x+run] == d
+                   && (row_a[x+run] & (vis_mask | char_attr_t::CHAR_ATTR_ALT))
+                      == (a & (vis_mask | char_attr_t::CHAR_ATTR_ALT))) {
+                run++;
+            }
+
+            if (run >= 4 && code == 0x20) {
+                out.push_back(0xFB);
+                out.push_back(static_cast<uint8>(0x60 + run));
+                cx = (cx + run) % w;
+            } else if (run >= 4 && code != 0xFB) {
+                out.push_back(0xFB);
+                out.push_back(static_cast<uint8>(run));
+                out.push_back(code);
+                cx = (cx + run) % w;
+            } else {
+                for (int i = 0; i < run; i++) {
+                    putChar(code);
+                }
+            }
+            x += run;
+            // writing the last column wraps the cursor but stays on the row
+            if (x == w) {
+                cx = 0;
+            }
+        }
+    }
+
+    if (cur_on) {
+        out.push_back(0x0F);
+        cur_on = false;
+    }
+
+    // ---- pass 2: box graphics ----
+    // a horizontal segment sets RIGHT in one cell and LEFT in the next
+    // (wrapping to column 0 from the last column, as the terminal does)
+    for (int y = 0; y < h; y++) {
+        const uint8 *row_a = &m_disp.attr[w*y];
+        int x = 0;
+        while (x < w) {
+            if ((row_a[x] & char_attr_t::CHAR_ATTR_RIGHT) == 0) {
+                x++;
+                continue;
+            }
+            int run = 1;
+            while (x + run < w && (row_a[x+run] & char_attr_t::CHAR_ATTR_RIGHT)) {
+                run++;
+            }
+            moveTo(x, y);
+            out.insert(out.end(), { 0x02, 0x0B, 0x02 });
+            out.insert(out.end(), run, static_cast<uint8>(0x09));
+            out.push_back(0x0F);
+            cx = (cx + run) % w;
+            x += run;
+        }
+    }
+    for (int x = 0; x < w; x++) {
+        int y = 0;
+        while (y < h) {
+            if ((m_disp.attr[w*y + x] & char_attr_t::CHAR_ATTR_VERT) == 0) {
+                y++;
+                continue;
+            }
+            int run = 1;
+            while (y + run < h && (m_disp.attr[w*(y+run) + x] & char_attr_t::CHAR_ATTR_VERT)) {
+                run++;
+            }
+            moveTo(x, y);
+            out.insert(out.end(), { 0x02, 0x0B, 0x02, 0x0B });
+            out.insert(out.end(), run - 1, static_cast<uint8>(0x0A));
+            out.push_back(0x0F);
+            cy += run - 1;
+            y += run;
+        }
+    }
+
+    // ---- pass 3: cursor and attribute state ----
+    moveTo(m_disp.curs_x, m_disp.curs_y);
+    const bool alt = (m_attrs & char_attr_t::CHAR_ATTR_ALT) != 0;
+    if (alt != cur_alt) {
+        setCharset(alt);
+    }
+    defineAttrs(m_attrs & vis_mask, m_attr_under, m_attr_on);
+    if (m_attr_temp) {
+        out.push_back(0x0E);
+    }
+    switch (m_disp.curs_attr) {
+        case cursor_attr_t::CURSOR_OFF:
+            break;  // already off
+        case cursor_attr_t::CURSOR_ON:
+            out.push_back(0x05);
+            break;
+        case cursor_attr_t::CURSOR_BLINK:
+            out.insert(out.end(), { 0x05, 0x02, 0x05, 0x0F });
+            break;
+    }
+
+    return out;
+}
+
+
 // callback after SELECT Pn timer expires
 void
 Terminal::selectPCallback()
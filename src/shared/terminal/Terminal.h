@@ -31,6 +31,12 @@ public:
     Terminal(std::shared_ptr<Scheduler> scheduler,
              std::shared_ptr<SerialPort> serialPort,
              int io_addr, int term_num, ui_screen_t screen_type);
+
+    // Constructor for a shadow model: it tracks the screen contents from
+    // the host byte stream but has no window, keyboard, or back channel.
+    // The headless server keeps one per terminal to repaint the physical
+    // terminal after it has been power cycled or reconnected.
+    explicit Terminal(ui_screen_t screen_type);
     ~Terminal();
 
     // hardware reset
@@ -42,6 +48,15 @@ public:
     // get the IO address for this terminal
     int getIoAddr() const { return m_io_addr; }
 
+    // return a byte stream which reproduces the current screen contents,
+    // attributes, box graphics and cursor state on a freshly reset 2236.
+    // runs are compressed with the terminal's FB escape sequences.
+    std::vector<uint8> getRepaintStream() const;
+
+    // translate an emulator keycode (as produced by the keyboard handler or
+    // a script file) into the byte sequence a 2236 sends for that key
+    static std::vector<uint8> encodeKeystroke(int keycode);
+
     // character transmission time, in nanoseconds
     static const int64 serial_char_delay =
             TIMER_US(  11.0              /* bits per character */
@@ -130,6 +145,7 @@ private:
     IoCardTermMux *m_muxd;          // nullptr if COM port mode
     std::shared_ptr<SerialPort> m_serialPort;  // nullptr if MUX mode
     const bool     m_vp_cpu;        // scripting throttle needs this info
+    const bool     m_shadow;        // shadow model: no ui, no back channel
 
     // display state and geometry
     std::shared_ptr<CrtFrame> m_wndhnd;  // opaque handle to UI window